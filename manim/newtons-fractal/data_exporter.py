@@ -1,6 +1,9 @@
-﻿import os
+﻿import ctypes
+import mmap
+import os
 import struct
-from typing import List
+import time
+from typing import List, NamedTuple, Optional
 
 import itertools
 import numpy as np
@@ -20,12 +23,285 @@ u32 = 'I'
 f32 = 'f'
 d64 = 'd'
 
+# Version 2 drops the per-record magics and stores coordinates as zig-zag
+# varint deltas, quantized to 1 / COORD_SCALE frame units. The layout is
+# documented next to manim_file_header_t in the compiler's manim_fe.h.
+DATA_VERSION_1 = 1
+DATA_VERSION_2 = 2
+COORD_SCALE = float(1 << 16)
+# Version 2 frames after the first carry only the vmos that changed, with a
+# full key frame every KEYFRAME_INTERVAL frames to bound seeking.
+KEYFRAME_INTERVAL = 60
+
+# Version 3 stores each frame as 64-byte aligned columns, one per field.
+DATA_VERSION_3 = 3
+COLUMN_ALIGN = 64
+
+
+# Version 1 records, packed exactly as the compiler's manim_fe.h structs
+_RGBA_DTYPE = np.dtype([('magic', 'S4'), ('rgba', '<f4', (4,))])
+_SUBPATH_DTYPE = np.dtype([('magic', 'S4'), ('x', '<f4'), ('y', '<f4'), ('quad_count', '<u4')])
+_QUAD_DTYPE = np.dtype([('magic', 'S4'), ('points', '<f4', (6,))])
+
+
+# Live ingest ring, the layout is documented in the compiler's manim_ring.h.
+# The compiler reads it with --ring while frames are still being exported.
+RING_CAPACITY = 64 << 20
+_RING_DATA_OFFSET = 192
+_RING_CLOSED, _RING_CAPACITY, _RING_WRITER_PID, _RING_READER_PID = 4, 8, 16, 20
+_RING_HEAD, _RING_TAIL = 64, 128
+_RING_READER_DETACHED = 0xFFFFFFFF
+_RING_POLL_SEC = 50e-6
+# Sleeps on a full ring between checks that the reader is still alive
+_RING_READER_CHECK_POLLS = 2000
+
+
+class _RingWriter:
+    """File-like writer into the live ingest ring, single producer.
+
+    A name of the form "/name" is a POSIX shared memory object, which glibc
+    keeps in /dev/shm, any other name is a plain file path.
+    """
+
+    def __init__(self, name: str, capacity: int = RING_CAPACITY):
+        if name.startswith('/') and '/' not in name[1:]:
+            path = os.path.join('/dev/shm', name[1:])
+        else:
+            path = name
+        self._capacity = 1 << max(capacity - 1, 0).bit_length()
+        self._head = 0
+
+        # A stale ring of a previous run would otherwise be read as this one
+        if os.path.exists(path):
+            os.unlink(path)
+        fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_EXCL, 0o600)
+        try:
+            os.ftruncate(fd, _RING_DATA_OFFSET + self._capacity)
+            self._map = mmap.mmap(fd, _RING_DATA_OFFSET + self._capacity)
+        finally:
+            os.close(fd)
+        self._data = memoryview(self._map)[_RING_DATA_OFFSET:]
+
+        struct.pack_into(LE + 'Q', self._map, _RING_CAPACITY, self._capacity)
+        struct.pack_into(LE + u32, self._map, _RING_WRITER_PID, os.getpid())
+        self._map[0:4] = b'RING'
+
+    def _reader_gone(self) -> bool:
+        pid, = struct.unpack_from(LE + u32, self._map, _RING_READER_PID)
+        if pid == _RING_READER_DETACHED:
+            return True
+        if pid == 0:
+            # The reader has not attached yet
+            return False
+        try:
+            os.kill(pid, 0)
+        except ProcessLookupError:
+            return True
+        except PermissionError:
+            pass
+        return False
+
+    def write(self, data: bytes) -> int:
+        view = memoryview(data).cast('B')
+        polls = 0
+        while view:
+            tail, = struct.unpack_from(LE + 'Q', self._map, _RING_TAIL)
+            space = self._capacity - (self._head - tail)
+            if space == 0:
+                polls += 1
+                if polls % _RING_READER_CHECK_POLLS == 0 and self._reader_gone():
+                    raise BrokenPipeError('ring reader exited before draining the stream')
+                time.sleep(_RING_POLL_SEC)
+                continue
+            polls = 0
+
+            count = min(space, len(view))
+            start = self._head & (self._capacity - 1)
+            first = min(count, self._capacity - start)
+            self._data[start:start + first] = view[:first]
+            self._data[:count - first] = view[first:count]
+
+            # An aligned 8 byte store, published after the data above
+            self._head += count
+            struct.pack_into(LE + 'Q', self._map, _RING_HEAD, self._head)
+            view = view[count:]
+        return len(data)
+
+    def flush(self):
+        pass
+
+    def close(self):
+        struct.pack_into(LE + u32, self._map, _RING_CLOSED, 1)
+        self._data.release()
+        self._map.close()
+
+
+# In-process compiler, the C interface is documented in the compiler's
+# lib/include/svganim/svganim.h. SVGANIM_LIBRARY overrides where it is loaded
+# from.
+SVGANIM_LIBRARY = os.environ.get('SVGANIM_LIBRARY', 'libsvganim.so')
+SVGANIM_RENDERER_DIRECT = 1 << 0
+SVGANIM_CAIRO_FRAME_SURFACE = 1 << 1
+SVGANIM_NO_RENDER_CACHE = 1 << 2
+
+
+def _load_svganim(path: str) -> ctypes.CDLL:
+    lib = ctypes.CDLL(path)
+    session, size = ctypes.c_void_p, ctypes.c_size_t
+    lib.svganim_open.argtypes = [ctypes.c_void_p, size, ctypes.c_uint32]
+    lib.svganim_open.restype = session
+    lib.svganim_push_frame.argtypes = [session, ctypes.c_void_p, size]
+    lib.svganim_push_frame.restype = ctypes.c_int
+    lib.svganim_finish.argtypes = [session]
+    lib.svganim_finish.restype = ctypes.c_int
+    lib.svganim_frame_count.argtypes = [session]
+    lib.svganim_frame_count.restype = size
+    lib.svganim_frame_svg.argtypes = [session, size, ctypes.POINTER(size)]
+    lib.svganim_frame_svg.restype = ctypes.c_void_p
+    lib.svganim_defs_svg.argtypes = [session, ctypes.POINTER(size)]
+    lib.svganim_defs_svg.restype = ctypes.c_void_p
+    lib.svganim_error.argtypes = [session]
+    lib.svganim_error.restype = ctypes.c_char_p
+    lib.svganim_close.argtypes = [session]
+    lib.svganim_close.restype = None
+    return lib
+
+
+class SvgAnimSession:
+    """File-like writer compiling the data in process through libsvganim.
+
+    Writes are collected until end_record(), which hands them over as one
+    record: the file header first, then one frame per call. Nothing is written
+    to disk and no compiler process is started.
+    """
+
+    def __init__(self, flags: int = 0, library: str = SVGANIM_LIBRARY):
+        self._lib = _load_svganim(library)
+        self._flags = flags
+        self._buf = bytearray()
+        self._session = None
+
+    def write(self, data: bytes) -> int:
+        self._buf += data
+        return len(data)
+
+    def flush(self):
+        pass
+
+    def end_record(self):
+        # Handed over without a copy, the library only reads it during the call
+        size = len(self._buf)
+        view = (ctypes.c_char * size).from_buffer(self._buf)
+        try:
+            if self._session is None:
+                self._session = self._lib.svganim_open(view, size, self._flags)
+                if not self._session:
+                    raise RuntimeError("libsvganim rejected the file header")
+            elif self._lib.svganim_push_frame(self._session, view, size) != 0:
+                raise RuntimeError(self._lib.svganim_error(self._session).decode())
+        finally:
+            del view
+            self._buf.clear()
+
+    def close(self):
+        """Ends the scene, the svgs can be read until release()."""
+        if self._session is not None and self._lib.svganim_finish(self._session) != 0:
+            raise RuntimeError(self._lib.svganim_error(self._session).decode())
+
+    def _text(self, address: Optional[int], length: ctypes.c_size_t) -> str:
+        return ctypes.string_at(address, length.value).decode() if length.value else ''
+
+    def svg_frames(self) -> List[str]:
+        frames = []
+        for i in range(self._lib.svganim_frame_count(self._session)):
+            length = ctypes.c_size_t()
+            address = self._lib.svganim_frame_svg(self._session, i, ctypes.byref(length))
+            frames.append(self._text(address, length))
+        return frames
+
+    def defs(self) -> str:
+        length = ctypes.c_size_t()
+        return self._text(self._lib.svganim_defs_svg(self._session, ctypes.byref(length)), length)
+
+    def release(self):
+        if self._session is not None:
+            self._lib.svganim_close(self._session)
+            self._session = None
+
+
+def _pad(length: int) -> bytes:
+    return bytes(-length % COLUMN_ALIGN)
+
+
+class _VmoRecord(NamedTuple):
+    """Everything written for one vmo, shared by all the writers."""
+    id: int
+    stroke_bg_width: float
+    stroke_width: float
+    gradient: tuple
+    stroke_bg_rgbas: np.ndarray
+    stroke_rgbas: np.ndarray
+    fill_rgbas: np.ndarray
+    # Per subpath: start point, then the 3 control points of each quad
+    points: np.ndarray
+    quad_counts: list
+
+
+def _zigzag(values: np.ndarray) -> np.ndarray:
+    values = values.astype(np.int64)
+    return ((values << np.int64(1)) ^ (values >> np.int64(63))).view(np.uint64)
+
+
+def _varints(values: np.ndarray) -> bytes:
+    """LEB128 encodes an array of unsigned 64-bit values."""
+    values = np.asarray(values, dtype=np.uint64)
+    if values.size == 0:
+        return b''
+
+    # One column per 7-bit group, masked down to each value's length
+    groups = np.empty((values.size, 10), dtype=np.uint8)
+    lengths = np.ones(values.size, dtype=np.int64)
+    rest = values.copy()
+    for k in range(10):
+        groups[:, k] = (rest & np.uint64(0x7F)).astype(np.uint8)
+        rest >>= np.uint64(7)
+        more = rest != 0
+        groups[:, k] |= more.astype(np.uint8) << np.uint8(7)
+        lengths += more
+    return groups[np.arange(10) < lengths[:, None]].tobytes()
+
 
 class ManimDataExporter:
-    def __init__(self, data_file: os.path):
-        os.makedirs(os.path.dirname(data_file), exist_ok=True)
-        self._fh = open(data_file, "wb", buffering=1 << 20)
+    def __init__(self, data_file: os.path, version: int = DATA_VERSION_2,
+                 coord_scale: float = COORD_SCALE,
+                 keyframe_interval: int = KEYFRAME_INTERVAL,
+                 ring: Optional[str] = None, ring_capacity: int = RING_CAPACITY,
+                 session: Optional[SvgAnimSession] = None):
+        if version not in (DATA_VERSION_1, DATA_VERSION_2, DATA_VERSION_3):
+            raise ValueError(f"unsupported data version {version}")
+        self._version = version
+        self._coord_scale = coord_scale
+        self._keyframe_interval = keyframe_interval
+        # Version 2 deltas: the last frame's encoded vmos by id, in order
+        self._prev = None
+        self._prev_order = []
+        self._frames_since_key = 0
+        self._session = session
+        if session is not None:
+            # Frames are compiled in this process as they are exported
+            self._fh = session
+        elif ring is not None:
+            # Frames go straight to a compiler running with --ring
+            self._fh = _RingWriter(ring, ring_capacity)
+        else:
+            os.makedirs(os.path.dirname(data_file), exist_ok=True)
+            self._fh = open(data_file, "wb", buffering=1 << 20)
         self._emit_ctx_config()
+        self._end_record()
+
+    def _end_record(self):
+        if self._session is not None:
+            self._session.end_record()
 
     def _write(self, fmt, *vals):
         self._fh.write(struct.pack(LE + fmt, *vals))
@@ -39,83 +315,199 @@ class ManimDataExporter:
     def _emit_ctx_config(self):
         self._write(mgc, b'CTXT')
         self._write(u32 + d64 + d64 + d64 + d64,
-                    1,
+                    self._version,
                     config.pixel_width, config.pixel_height,
                     config.frame_width, config.frame_height
                      )
+        if self._version == DATA_VERSION_2:
+            self._write(f32, self._coord_scale)
+        if self._version == DATA_VERSION_3:
+            self._fh.write(_pad(struct.calcsize(LE + mgc + u32 + d64 * 4)))
 
     def _emit_frame(self, _VMOcount):
         self._write(mgc, b'FRAM')
         self._write(u32, _VMOcount)
 
-    def _emit_vmobject(self, vmo: VMobject):
+    def _encode_record_v1(self, record: _VmoRecord) -> bytes:
+        """Packs a vmo as read_frame expects it, every array in one buffer."""
+        head = struct.pack(LE + mgc + u32 + f32 + f32 + u32 * 3 + f32 * 4 + u32,
+                           b'VMOB', record.id, record.stroke_bg_width, record.stroke_width,
+                           len(record.stroke_bg_rgbas), len(record.stroke_rgbas), len(record.fill_rgbas),
+                           *record.gradient, len(record.quad_counts))
+
+        rgba_values = np.concatenate((record.stroke_bg_rgbas, record.stroke_rgbas, record.fill_rgbas))
+        rgbas = np.empty(len(rgba_values), dtype=_RGBA_DTYPE)
+        rgbas['magic'] = b'RGBA'
+        rgbas['rgba'] = rgba_values
+
+        if not record.quad_counts:
+            return head + rgbas.tobytes()
+
+        # Split the points back into subpath starts and quad control points
+        quad_counts = np.asarray(record.quad_counts, dtype=np.int64)
+        starts = np.cumsum(1 + 3 * quad_counts) - (1 + 3 * quad_counts)
+        is_start = np.zeros(len(record.points), dtype=bool)
+        is_start[starts] = True
+
+        subpaths = np.empty(len(quad_counts), dtype=_SUBPATH_DTYPE)
+        subpaths['magic'] = b'SUBP'
+        subpaths['x'] = record.points[starts, 0]
+        subpaths['y'] = record.points[starts, 1]
+        subpaths['quad_count'] = quad_counts
 
-        _stroke_width_background = vmo.get_stroke_width(True)
-        _stroke_width = vmo.get_stroke_width(False)
+        quads = np.empty(int(quad_counts.sum()), dtype=_QUAD_DTYPE)
+        quads['magic'] = b'QUAD'
+        quads['points'] = record.points[~is_start].reshape(-1, 6)
 
-        stroke_RGBAs_background = vmo.get_stroke_rgbas(True)
-        _stroke_RGBAs_background_count = len(list(stroke_RGBAs_background))
-        stroke_RGBAs = vmo.get_stroke_rgbas(False)
-        _stroke_RGBAs_count = len(list(stroke_RGBAs))
+        # Each subpath header is followed by its quads, so a record's offset is
+        # the headers and quads before it. Scatter both into place.
+        subpath_offsets = (np.arange(len(quad_counts)) * _SUBPATH_DTYPE.itemsize
+                           + (np.cumsum(quad_counts) - quad_counts) * _QUAD_DTYPE.itemsize)
+        quad_offsets = (np.repeat(np.arange(1, len(quad_counts) + 1), quad_counts) * _SUBPATH_DTYPE.itemsize
+                        + np.arange(len(quads)) * _QUAD_DTYPE.itemsize)
 
-        fill_RGBAs = vmo.get_fill_rgbas()
-        _fill_RGBAs_count = len(list(fill_RGBAs))
+        body = np.empty(subpaths.nbytes + quads.nbytes, dtype=np.uint8)
+        body[subpath_offsets[:, None] + np.arange(_SUBPATH_DTYPE.itemsize)] = \
+            subpaths.view(np.uint8).reshape(-1, _SUBPATH_DTYPE.itemsize)
+        body[quad_offsets[:, None] + np.arange(_QUAD_DTYPE.itemsize)] = \
+            quads.view(np.uint8).reshape(-1, _QUAD_DTYPE.itemsize)
 
+        return head + rgbas.tobytes() + body.tobytes()
+
+    def _gather_vmobject(self, vmo: VMobject) -> _VmoRecord:
         gradient_points = vmo.get_gradient_start_and_end_points()
         gradient_points = self._transform_points_pre_display(gradient_points)
-        _gradient_x0, _gradient_y0, _gradient_x1, _gradient_y1 = (itertools.chain(*(p[:2] for p in gradient_points)))
         points = ManimDataExporter._transform_points_pre_display(vmo.points)
-        subpaths = list(vmo.gen_subpaths_from_points_2d(points))
-        _subpaths_count = len(subpaths)
-
-        self._write(mgc, b'VMOB')
-        self._write(u32, vmo.tagged_name)
-        # Style
-        self._write(f32, _stroke_width_background)
-        self._write(f32, _stroke_width)
-        self._write(u32, _stroke_RGBAs_background_count)
-        self._write(u32, _stroke_RGBAs_count)
-        self._write(u32, _fill_RGBAs_count)
-        self._write(f32 + f32 + f32 + f32, _gradient_x0, _gradient_y0, _gradient_x1, _gradient_y1)
-        self._write(u32, _subpaths_count)
-
-        for _rgba in stroke_RGBAs_background:
-            self._write(mgc, b'RGBA')
-            self._write(f32 + f32 + f32 + f32, *_rgba)
-
-        for _rgba in stroke_RGBAs:
-            self._write(mgc, b'RGBA')
-            self._write(f32 + f32 + f32 + f32, *_rgba)
-
-        for _rgba in fill_RGBAs:
-            self._write(mgc, b'RGBA')
-            self._write(f32 + f32 + f32 + f32, *_rgba)
-
-        # ctx.new_path()
-        for subpath in vmo.gen_subpaths_from_points_2d(points):
-
-            quads = list(vmo.gen_cubic_bezier_tuples_from_points(subpath))
-            _quad_count = len(quads)
-            _x, _y = subpath[0][:2]
-
-            self._write(mgc, b'SUBP')
-            self._write(f32 + f32, _x, _y)
-            self._write(u32, _quad_count)
-
-            # ctx.new_sub_path()
-            # ctx.move_to(*subpath[0][:2])
-            for _p0, p1, p2, p3 in quads:
-                x1, y1 = p1[:2]
-                x2, y2 = p2[:2]
-                x3, y3 = p3[:2]
-
-                self._write(mgc, b'QUAD')
-                self._write(f32 + f32 + f32 + f32 + f32 + f32, x1, y1, x2, y2, x3, y3)
+
+        # Split into subpaths where a curve does not start at the previous
+        # curve's end, as gen_subpaths_from_points_2d does, but with the
+        # indices worked out in numpy rather than a generator per subpath
+        nppcc = vmo.n_points_per_cubic_curve
+        curve_starts = np.arange(nppcc, len(points), nppcc)
+        prev_ends = points[curve_starts - 1, :2]
+        next_starts = points[curve_starts, :2]
+        breaks = np.any(np.abs(prev_ends - next_starts)
+                        > vmo.tolerance_for_point_equality + 1.0e-5 * np.abs(next_starts), axis=1)
+        bounds = np.concatenate(([0], curve_starts[breaks], [len(points)]))
+        lengths = np.diff(bounds)
+        keep = lengths >= nppcc
+        subpath_starts = bounds[:-1][keep]
+        counts = lengths[keep] // nppcc
+
+        # Each subpath is its start point followed by the control points of its
+        # quads, so gather them all with one index array
+        quad_starts = (np.repeat(subpath_starts, counts)
+                       + nppcc * (np.arange(int(counts.sum())) - np.repeat(np.cumsum(counts) - counts, counts)))
+        sizes = 1 + (nppcc - 1) * counts
+        is_start = np.zeros(int(sizes.sum()), dtype=bool)
+        is_start[np.cumsum(sizes) - sizes] = True
+        indices = np.empty(len(is_start), dtype=np.int64)
+        indices[is_start] = subpath_starts
+        indices[~is_start] = (quad_starts[:, None] + np.arange(1, nppcc)).reshape(-1)
+
+        return _VmoRecord(
+            id=vmo.tagged_name,
+            stroke_bg_width=vmo.get_stroke_width(True),
+            stroke_width=vmo.get_stroke_width(False),
+            gradient=tuple(itertools.chain(*(p[:2] for p in gradient_points))),
+            stroke_bg_rgbas=np.asarray(vmo.get_stroke_rgbas(True), dtype='<f4').reshape(-1, 4),
+            stroke_rgbas=np.asarray(vmo.get_stroke_rgbas(False), dtype='<f4').reshape(-1, 4),
+            fill_rgbas=np.asarray(vmo.get_fill_rgbas(), dtype='<f4').reshape(-1, 4),
+            points=points[indices, :2],
+            quad_counts=counts.tolist(),
+        )
+
+    def _encode_record_v2(self, record: _VmoRecord) -> bytes:
+        head = struct.pack(LE + f32 * 6, record.stroke_bg_width, record.stroke_width, *record.gradient)
+        counts = _varints(np.array([record.id,
+                                    len(record.stroke_bg_rgbas), len(record.stroke_rgbas), len(record.fill_rgbas),
+                                    len(record.quad_counts)], dtype=np.uint64))
+        rgbas = np.concatenate((record.stroke_bg_rgbas, record.stroke_rgbas, record.fill_rgbas)).tobytes()
+
+        if not record.quad_counts:
+            return head + counts + rgbas
+
+        # Quantize, delta against the previous point, zig-zag, then put each
+        # subpath's quad count in front of its start point
+        quantized = np.round(record.points * self._coord_scale).astype(np.int64)
+        deltas = np.diff(quantized, axis=0, prepend=np.zeros((1, 2), dtype=np.int64))
+        stream = _zigzag(deltas).reshape(-1)
+        starts = np.cumsum([0] + [1 + 3 * n for n in record.quad_counts[:-1]]) * 2
+        stream = np.insert(stream, starts, np.array(record.quad_counts, dtype=np.uint64))
+
+        return head + counts + rgbas + _varints(stream)
+
+    def _emit_frame_v2(self, vmobjs: List[VMobject]):
+        records = [self._gather_vmobject(vmo) for vmo in vmobjs]
+        ids = [record.id for record in records]
+        frame = [self._encode_record_v2(record) for record in records]
+        encoded = dict(zip(ids, frame))
+        # Deltas address vmos by id, the reader's id map reserves 0xFFFFFFFF
+        addressable = len(encoded) == len(ids) and 0xFFFFFFFF not in encoded
+
+        # A delta keeps the previous order, drops the removed ids and appends
+        # the new ones, anything else needs a key frame
+        delta = (self._prev is not None and addressable
+                 and self._frames_since_key + 1 < self._keyframe_interval)
+        if delta:
+            kept = [i for i in self._prev_order if i in encoded]
+            delta = ids == kept + [i for i in ids if i not in self._prev]
+
+        if delta:
+            removed = [i for i in self._prev_order if i not in encoded]
+            changed = [encoded[i] for i in ids if self._prev.get(i) != encoded[i]]
+            payload = _varints(np.array([len(removed)] + removed, dtype=np.uint64)) + b''.join(changed)
+            self._write(mgc + u32 + u32, b'FDLT', len(changed), len(payload))
+            self._frames_since_key += 1
+        else:
+            payload = b''.join(frame)
+            self._write(mgc + u32 + u32, b'FRAM', len(records), len(payload))
+            self._frames_since_key = 0
+        self._fh.write(payload)
+
+        self._prev = encoded if addressable else None
+        self._prev_order = ids
+
+    def _emit_frame_v3(self, vmobjs: List[VMobject]):
+        records = [self._gather_vmobject(vmo) for vmo in vmobjs]
+
+        def column(values, dtype) -> bytes:
+            data = np.asarray(values, dtype=dtype).tobytes()
+            return data + _pad(len(data))
+
+        rgbas = [r for record in records for r in (record.stroke_bg_rgbas, record.stroke_rgbas, record.fill_rgbas)]
+        points = np.concatenate([record.points for record in records]) if records else np.zeros((0, 2))
+        quad_counts = [n for record in records for n in record.quad_counts]
+
+        # Same order as the version 3 layout in manim_fe.h
+        payload = b''.join((
+            column([record.id for record in records], '<u4'),
+            column([record.stroke_bg_width for record in records], '<f4'),
+            column([record.stroke_width for record in records], '<f4'),
+            column([record.gradient for record in records], '<f4'),
+            column([len(record.stroke_bg_rgbas) for record in records], '<u4'),
+            column([len(record.stroke_rgbas) for record in records], '<u4'),
+            column([len(record.fill_rgbas) for record in records], '<u4'),
+            column([len(record.quad_counts) for record in records], '<u4'),
+            column(np.concatenate(rgbas) if rgbas else [], '<f4'),
+            column(quad_counts, '<u4'),
+            column(points[:, 0], '<f4'),
+            column(points[:, 1], '<f4'),
+        ))
+
+        header = struct.pack(LE + mgc + u32 * 5, b'FRAM', len(records),
+                             sum(len(r) for r in rgbas), len(quad_counts), len(points), len(payload))
+        self._fh.write(header + _pad(len(header)) + payload)
 
     def _flush(self):
         self._fh.flush()
         self._fh.close()
 
+    def close(self):
+        """Ends the data, a compiler reading the ring sees the end of input and
+        a session finishes the scene."""
+        self._flush()
+
     def export_frame(self, vgroup: VGroup, frame_number):
 
         # Gather all drawable VMobjects
@@ -126,9 +518,11 @@ class ManimDataExporter:
             )
         )
 
-        self._emit_frame(len(flat_vmobjs))
-
-        for vmobj in flat_vmobjs:
-            self._emit_vmobject(vmobj)
-
-        pass
+        if self._version == DATA_VERSION_3:
+            self._emit_frame_v3(flat_vmobjs)
+        elif self._version == DATA_VERSION_2:
+            self._emit_frame_v2(flat_vmobjs)
+        else:
+            self._emit_frame(len(flat_vmobjs))
+            self._fh.write(b''.join(self._encode_record_v1(self._gather_vmobject(vmobj)) for vmobj in flat_vmobjs))
+        self._end_record()
@@ -455,7 +455,10 @@ class HTMLParsedVMobject:
         self.width = width
         self.basic_html = basic_html
         
-        self.data_exporter = ManimDataExporter(os.path.join(os.getcwd(), 'out.dat'))
+        # MANIM_DATA_RING names a live ingest ring an svgAnimCompiler --ring is
+        # reading from, frames are compiled while the scene is still rendering
+        self.data_exporter = ManimDataExporter(os.path.join(os.getcwd(), 'out.dat'),
+                                               ring=os.environ.get('MANIM_DATA_RING'))
         
         self.debug = False
 
@@ -645,6 +648,7 @@ class HTMLParsedVMobject:
 
 
     def finish(self):
+        self.data_exporter.close()
         return
         """Stop collection, run compilation pipeline, write .js / .html."""
         # Freeze data collection
@@ -2,6 +2,7 @@
 #define ARENA_H
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(__APPLE__) || defined(__unix__)
 #include <unistd.h>
@@ -187,11 +188,25 @@ static void *arena_push(arena_t *arena, size_t size) {
   return ptr;
 }
 
+static void *arena_push_zero(arena_t *arena, size_t size) {
+  void *ptr = arena_push(arena, size);
+  if (ptr)
+    memset(ptr, 0, size);
+  return ptr;
+}
+
 static void arena_pop(arena_t *arena, size_t size) {
   assert(size <= arena->pos);
   arena->pos -= size;
 }
 
+static size_t arena_get_pos(arena_t *arena) { return arena->pos; }
+
+static void arena_set_pos_back(arena_t *arena, size_t pos) {
+  assert(pos <= arena->pos);
+  arena->pos = pos;
+}
+
 static void arena_clear(arena_t *arena) {
   arena_pop(arena, arena->pos);
 }
@@ -0,0 +1,127 @@
+#ifndef COOKIE_H
+#define COOKIE_H
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ *  Read-only FILE over callbacks
+ * -----------------------------------------------------------------------------
+ *
+ * fopencookie with glibc (the including file defines _GNU_SOURCE before any
+ * header), funopen on macOS and the BSDs. Elsewhere cookie_fopen fails with
+ * ENOTSUP and callers fall back or refuse their input.
+ */
+
+#if defined(__GLIBC__) ||                                                      \
+    (defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) ||      \
+     defined(__OpenBSD__) || defined(__DragonFly__))
+#define COOKIE_SUPPORTED 1
+#else
+#define COOKIE_SUPPORTED 0
+#endif
+
+typedef struct cookie_io_t {
+  /** Reads up to size bytes. Returns the bytes read, 0 at end, -1 on error **/
+  ssize_t (*read)(void *cookie, char *buf, size_t size);
+  /**
+   * Moves to *offset relative to whence (SEEK_SET, SEEK_CUR or SEEK_END) and
+   * writes the new position back to *offset. Returns 0, or -1 if it cannot.
+   * NULL if the stream does not seek.
+   */
+  int (*seek)(void *cookie, int64_t *offset, int whence);
+  /** Called by fclose, NULL if the cookie outlives the FILE **/
+  int (*close)(void *cookie);
+} cookie_io_t;
+
+/**
+ * @brief Opens a read-only FILE whose reads and seeks go to io.
+ *
+ * @return The FILE, or NULL with errno set. The cookie is not closed on
+ * failure.
+ */
+static FILE *cookie_fopen(void *cookie, const cookie_io_t *io);
+
+//*******************************************//
+
+typedef struct _cookie_file_t {
+  void *cookie;
+  cookie_io_t io;
+} _cookie_file_t;
+
+static int _cookie_close(void *file) {
+  _cookie_file_t *cookie_file = file;
+  const int result =
+      cookie_file->io.close ? cookie_file->io.close(cookie_file->cookie) : 0;
+  free(cookie_file);
+  return result;
+}
+
+#if defined(__GLIBC__)
+
+static ssize_t _cookie_read(void *file, char *buf, const size_t size) {
+  _cookie_file_t *cookie_file = file;
+  return cookie_file->io.read(cookie_file->cookie, buf, size);
+}
+
+static int _cookie_seek(void *file, off64_t *offset, const int whence) {
+  _cookie_file_t *cookie_file = file;
+  int64_t target = *offset;
+  if (!cookie_file->io.seek ||
+      cookie_file->io.seek(cookie_file->cookie, &target, whence) != 0)
+    return -1;
+  *offset = target;
+  return 0;
+}
+
+#elif COOKIE_SUPPORTED
+
+static int _cookie_read(void *file, char *buf, const int size) {
+  _cookie_file_t *cookie_file = file;
+  return (int)cookie_file->io.read(cookie_file->cookie, buf, (size_t)size);
+}
+
+static fpos_t _cookie_seek(void *file, const fpos_t offset, const int whence) {
+  _cookie_file_t *cookie_file = file;
+  int64_t target = offset;
+  if (!cookie_file->io.seek ||
+      cookie_file->io.seek(cookie_file->cookie, &target, whence) != 0)
+    return -1;
+  return (fpos_t)target;
+}
+
+#endif
+
+static FILE *cookie_fopen(void *cookie, const cookie_io_t *io) {
+#if COOKIE_SUPPORTED
+  _cookie_file_t *cookie_file = malloc(sizeof(*cookie_file));
+  if (!cookie_file)
+    return NULL;
+  cookie_file->cookie = cookie;
+  cookie_file->io = *io;
+
+#if defined(__GLIBC__)
+  const cookie_io_functions_t functions = {.read = _cookie_read,
+                                           .write = NULL,
+                                           .seek = _cookie_seek,
+                                           .close = _cookie_close};
+  FILE *fp = fopencookie(cookie_file, "rb", functions);
+#else
+  FILE *fp =
+      funopen(cookie_file, _cookie_read, NULL, _cookie_seek, _cookie_close);
+#endif
+  if (!fp)
+    free(cookie_file);
+  return fp;
+#else
+  (void)cookie;
+  (void)io;
+  errno = ENOTSUP;
+  return NULL;
+#endif
+}
+
+#endif // COOKIE_H
@@ -16,7 +16,8 @@
 typedef enum SvgAnimStatus {
   SVG_ANIM_STATUS_SUCCESS,
   SVG_ANIM_STATUS_NO_MEMORY,
-  SVG_ANIM_STATUS_MALFORMED_SVG
+  SVG_ANIM_STATUS_MALFORMED_SVG,
+  SVG_ANIM_STATUS_IO_ERROR
 } SvgAnimStatus;
 
 /*
@@ -42,6 +43,8 @@ typedef struct svg_frames_t {
   size_t num_frames;
   svg_record_t *frames;
   void *blob;
+  /** <defs> shared by all frames, offset into blob. Empty if length is 0 **/
+  svg_record_t defs;
 } svg_frames_t;
 
 /**
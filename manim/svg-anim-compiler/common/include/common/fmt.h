@@ -0,0 +1,207 @@
+#ifndef FMT_H
+#define FMT_H
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ *  Fixed precision number formatting
+ * -----------------------------------------------------------------------------
+ */
+
+/**
+ * Formats numbers like "%.*f" with trailing fractional zeros (and a trailing
+ * '.') stripped and "-0" written as "0": 12.5, 3, -0.125.
+ *
+ * The value is scaled by 10^precision and rounded to an integer once, then
+ * written two digits at a time from a lookup table. Rounding is half away from
+ * zero on the scaled double, so a value within an ulp of a rounding boundary
+ * can differ from printf in its last digit. fmt_fixed and fmt_fixed_array
+ * round identically. Values too large to scale exactly (and nan/inf) fall back
+ * to snprintf.
+ */
+
+#define FMT_FIXED_MAX_PRECISION 9
+
+/** Upper bound of the bytes fmt_fixed writes for one value **/
+#define FMT_FIXED_MAX_LENGTH 48
+
+/**
+ * @brief Writes value with at most precision fractional digits.
+ *
+ * @param out Buffer of at least FMT_FIXED_MAX_LENGTH bytes. Not terminated.
+ * @param value Value to format.
+ * @param precision Fractional digits, 0 to FMT_FIXED_MAX_PRECISION.
+ * @return Bytes written.
+ */
+static size_t fmt_fixed(char *out, double value, int precision);
+
+/**
+ * @brief Writes count values, separated by sep, with at most precision
+ * fractional digits each.
+ *
+ * Values are scaled and rounded in blocks by a loop the compiler can
+ * vectorize before their digits are written.
+ *
+ * @param out Buffer of at least count * (FMT_FIXED_MAX_LENGTH + 1) bytes.
+ * @return Bytes written.
+ */
+static size_t fmt_fixed_array(char *out, const double *values, size_t count,
+                              int precision, char sep);
+
+//*******************************************//
+
+static const double fmt_pow10[FMT_FIXED_MAX_PRECISION + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9};
+
+static const uint64_t fmt_pow10_u64[FMT_FIXED_MAX_PRECISION + 1] = {
+    1ULL,      10ULL,      100ULL,      1000ULL,      10000ULL,
+    100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL};
+
+static const char fmt_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/** Scaled magnitudes must stay below this to be exact in a double **/
+#define FMT_FIXED_SCALED_MAX 9.0e15
+
+/** Writes the decimal digits of v, returns their count **/
+static size_t _fmt_u64(char *out, uint64_t v) {
+  char buf[20];
+  char *p = buf + sizeof(buf);
+
+  while (v >= 100) {
+    const uint64_t pair = (v % 100) * 2;
+    v /= 100;
+    p -= 2;
+    memcpy(p, &fmt_digit_pairs[pair], 2);
+  }
+  if (v >= 10) {
+    p -= 2;
+    memcpy(p, &fmt_digit_pairs[v * 2], 2);
+  } else {
+    *--p = (char)('0' + v);
+  }
+
+  const size_t length = (size_t)(buf + sizeof(buf) - p);
+  memcpy(out, p, length);
+  return length;
+}
+
+/** Writes an already scaled and rounded value **/
+static size_t _fmt_fixed_scaled(char *out, const int64_t scaled,
+                                const int precision) {
+  char *p = out;
+  uint64_t magnitude = (uint64_t)scaled;
+  if (scaled < 0) {
+    *p++ = '-';
+    magnitude = 0 - magnitude;
+  }
+
+  const uint64_t unit = fmt_pow10_u64[precision];
+  p += _fmt_u64(p, magnitude / unit);
+
+  uint64_t frac = magnitude % unit;
+  if (frac != 0) {
+    int digits = precision;
+    while (frac % 10 == 0) {
+      frac /= 10;
+      --digits;
+    }
+
+    *p++ = '.';
+    for (int i = digits - 1; i >= 0; i--) {
+      p[i] = (char)('0' + frac % 10);
+      frac /= 10;
+    }
+    p += digits;
+  }
+
+  return (size_t)(p - out);
+}
+
+/** printf path for values the scaled path cannot represent **/
+static size_t _fmt_fixed_slow(char *out, const double value,
+                              const int precision) {
+  char buf[512];
+  int count = snprintf(buf, sizeof(buf), "%.*f", precision, value);
+  if (count < 0)
+    return 0;
+  if ((size_t)count >= FMT_FIXED_MAX_LENGTH) {
+    // Too long for FMT_FIXED_MAX_LENGTH, fall back to exponent form
+    count = snprintf(buf, sizeof(buf), "%.*g", 17, value);
+  }
+  // %g already drops trailing zeros, and stripping would eat exponent digits
+  if (strchr(buf, '.') && !strchr(buf, 'e')) {
+    while (buf[count - 1] == '0')
+      --count;
+    if (buf[count - 1] == '.')
+      --count;
+  }
+  if (count == 2 && buf[0] == '-' && buf[1] == '0') {
+    buf[0] = '0';
+    count = 1;
+  }
+  memcpy(out, buf, (size_t)count);
+  return (size_t)count;
+}
+
+/** Rounds half away from zero. Out of range inputs (and nan) are clamped so
+ * the conversion stays defined, callers check the range themselves **/
+static int64_t _fmt_round(const double scaled) {
+  const double clamped =
+      fmin(fmax(scaled, -FMT_FIXED_SCALED_MAX), FMT_FIXED_SCALED_MAX);
+  return (int64_t)(clamped + copysign(0.5, clamped));
+}
+
+static size_t fmt_fixed(char *out, const double value, const int precision) {
+  const double scaled = value * fmt_pow10[precision];
+  if (!(fabs(scaled) < FMT_FIXED_SCALED_MAX))
+    return _fmt_fixed_slow(out, value, precision);
+  return _fmt_fixed_scaled(out, _fmt_round(scaled), precision);
+}
+
+static size_t fmt_fixed_array(char *out, const double *values,
+                              const size_t count, const int precision,
+                              const char sep) {
+  enum { BLOCK = 64 };
+  const double scale = fmt_pow10[precision];
+  int64_t scaled[BLOCK];
+  char *p = out;
+
+  for (size_t begin = 0; begin < count; begin += BLOCK) {
+    const size_t n = count - begin < BLOCK ? count - begin : BLOCK;
+    const double *block = values + begin;
+
+    /** Scale and round, branch free **/
+    int in_range = 1;
+    for (size_t i = 0; i < n; i++) {
+      const double v = block[i] * scale;
+      in_range &= fabs(v) < FMT_FIXED_SCALED_MAX;
+      scaled[i] = _fmt_round(v);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      if (begin + i > 0)
+        *p++ = sep;
+      // A block holding an out of range value goes through the checked path
+      p += in_range ? _fmt_fixed_scaled(p, scaled[i], precision)
+                    : fmt_fixed(p, block[i], precision);
+    }
+  }
+
+  return (size_t)(p - out);
+}
+
+#endif // FMT_H
@@ -0,0 +1,69 @@
+#ifndef HASH_H
+#define HASH_H
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ *  Hashing
+ * -----------------------------------------------------------------------------
+ */
+
+#define HASH_SEED 0x9e3779b97f4a7c15ULL
+
+/**
+ * @brief Finalizes a 64-bit value so every input bit affects every output bit.
+ *
+ * @param x Value to mix.
+ * @return Mixed value.
+ */
+static uint64_t hash_mix64(uint64_t x);
+
+/**
+ * @brief Fast non-cryptographic 64-bit hash of a byte range.
+ *
+ * Consumes 8 bytes per step. Hashes can be chained across several ranges by
+ * passing the previous result as the seed of the next call.
+ *
+ * @param data Bytes to hash.
+ * @param length Number of bytes.
+ * @param seed Initial state, HASH_SEED or a previous hash.
+ * @return 64-bit hash.
+ */
+static uint64_t hash_bytes(const void *data, size_t length, uint64_t seed);
+
+//*******************************************//
+
+static uint64_t hash_mix64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+static uint64_t hash_bytes(const void *data, size_t length, uint64_t seed) {
+  const unsigned char *bytes = data;
+  uint64_t h = seed ^ (length * 0xff51afd7ed558ccdULL);
+
+  while (length >= 8) {
+    uint64_t k;
+    memcpy(&k, bytes, 8);
+    h = (h ^ hash_mix64(k)) * 0x9fb21c651e98df25ULL;
+    h ^= h >> 29;
+    bytes += 8;
+    length -= 8;
+  }
+
+  if (length > 0) {
+    uint64_t k = 0;
+    memcpy(&k, bytes, length);
+    h = (h ^ hash_mix64(k)) * 0x9fb21c651e98df25ULL;
+  }
+
+  return hash_mix64(h);
+}
+
+#endif // HASH_H
@@ -0,0 +1,357 @@
+#ifndef POOL_H
+#define POOL_H
+#include <pthread.h>
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/arena.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ *  Work-stealing thread pool
+ * -----------------------------------------------------------------------------
+ */
+
+/**
+ * A pool of num_workers workers running parallel-for jobs. The thread calling
+ * pool_parallel_for is worker 0 and works on the job too, the others are
+ * threads that sleep between jobs.
+ *
+ * A job's index range starts on worker 0's deque. A worker takes the newest
+ * range from its own deque, and while the range is larger than the grain it
+ * pushes the upper half back and keeps the lower half. Idle workers steal the
+ * oldest, and so largest, range of another worker's deque. Deques are
+ * Chase-Lev deques of ranges. Their indices only grow, so a steal that raced
+ * with another can never succeed on a recycled slot.
+ *
+ * Every worker owns a scratch arena, cleared when a job ends. Range functions
+ * must not call pool_parallel_for themselves.
+ */
+
+#define POOL_CACHE_LINE 64
+
+/** Ranges a worker's deque holds, enough to halve any size_t range **/
+#define POOL_DEQUE_SIZE 128
+
+/** Failed steal rounds spent spinning, then yielding, before sleeping **/
+#define POOL_SPIN_ROUNDS 64
+#define POOL_SLEEP_NS 20000L
+
+typedef struct pool_worker_t pool_worker_t;
+
+/**
+ * @brief Processes indices [begin, end) of a job.
+ *
+ * @param worker Worker running the range, its scratch arena and index are the
+ * function's to use.
+ */
+typedef void (*pool_range_fn)(void *ctx, size_t begin, size_t end,
+                              pool_worker_t *worker);
+
+typedef struct pool_range_t {
+  _Atomic size_t begin;
+  _Atomic size_t end;
+} pool_range_t;
+
+struct pool_worker_t {
+  /** Owner side **/
+  alignas(POOL_CACHE_LINE) _Atomic int64_t bottom;
+  /** Thief side **/
+  alignas(POOL_CACHE_LINE) _Atomic int64_t top;
+
+  alignas(POOL_CACHE_LINE) pool_range_t ranges[POOL_DEQUE_SIZE];
+
+  struct pool_t *pool;
+  pthread_t thread;
+  size_t index;
+  arena_t *scratch;
+  uint32_t rng;
+
+  /** Ranges this worker stole from others, over the pool's lifetime **/
+  size_t steals;
+};
+
+typedef struct pool_t {
+  size_t num_workers;
+  pool_worker_t *workers;
+
+  /** Current job **/
+  pool_range_fn fn;
+  void *ctx;
+  size_t grain;
+  /** Indices of the job not processed yet **/
+  alignas(POOL_CACHE_LINE) _Atomic size_t pending;
+
+  /** Job generation and shutdown, workers wait on wake between jobs **/
+  pthread_mutex_t lock;
+  pthread_cond_t wake;
+  uint64_t generation;
+  bool shutdown;
+} pool_t;
+
+/**
+ * Notes:
+ * - num_workers of 0 uses one worker per online cpu
+ * - pool_parallel_for must be called from the thread that created the pool
+ */
+static pool_t *pool_create(size_t num_workers);
+static void pool_destroy(pool_t *pool);
+static void pool_parallel_for(pool_t *pool, size_t begin, size_t end,
+                              size_t grain, pool_range_fn fn, void *ctx);
+static size_t pool_cpu_count(void);
+
+//*******************************************//
+
+static size_t pool_cpu_count(void) {
+  const long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t)count : 1;
+}
+
+/** Pushes [begin, end) for the owner, false if the deque is full **/
+static bool _pool_push(pool_worker_t *worker, const size_t begin,
+                       const size_t end) {
+  const int64_t b = atomic_load_explicit(&worker->bottom, memory_order_relaxed);
+  const int64_t t = atomic_load_explicit(&worker->top, memory_order_acquire);
+  if (b - t >= POOL_DEQUE_SIZE)
+    return false;
+
+  pool_range_t *slot = &worker->ranges[b % POOL_DEQUE_SIZE];
+  atomic_store_explicit(&slot->begin, begin, memory_order_relaxed);
+  atomic_store_explicit(&slot->end, end, memory_order_relaxed);
+  atomic_store_explicit(&worker->bottom, b + 1, memory_order_release);
+  return true;
+}
+
+/** Takes the newest range of the owner's deque **/
+static bool _pool_take(pool_worker_t *worker, size_t *begin, size_t *end) {
+  const int64_t b =
+      atomic_load_explicit(&worker->bottom, memory_order_relaxed) - 1;
+  // Both sequentially consistent, a thief sees the smaller bottom or the
+  // owner sees the thief's claim
+  atomic_store_explicit(&worker->bottom, b, memory_order_seq_cst);
+  int64_t t = atomic_load_explicit(&worker->top, memory_order_seq_cst);
+
+  if (t > b) {
+    atomic_store_explicit(&worker->bottom, b + 1, memory_order_relaxed);
+    return false;
+  }
+
+  pool_range_t *slot = &worker->ranges[b % POOL_DEQUE_SIZE];
+  *begin = atomic_load_explicit(&slot->begin, memory_order_relaxed);
+  *end = atomic_load_explicit(&slot->end, memory_order_relaxed);
+  if (t < b)
+    return true;
+
+  // Last range, race the thieves for it
+  const bool won = atomic_compare_exchange_strong_explicit(
+      &worker->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+  atomic_store_explicit(&worker->bottom, b + 1, memory_order_relaxed);
+  return won;
+}
+
+/** Steals the oldest range of victim's deque **/
+static bool _pool_steal(pool_worker_t *victim, size_t *begin, size_t *end) {
+  int64_t t = atomic_load_explicit(&victim->top, memory_order_seq_cst);
+  const int64_t b = atomic_load_explicit(&victim->bottom, memory_order_seq_cst);
+  if (t >= b)
+    return false;
+
+  // Read before the claim, a lost race discards what was read
+  pool_range_t *slot = &victim->ranges[t % POOL_DEQUE_SIZE];
+  *begin = atomic_load_explicit(&slot->begin, memory_order_relaxed);
+  *end = atomic_load_explicit(&slot->end, memory_order_relaxed);
+  return atomic_compare_exchange_strong_explicit(
+      &victim->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+}
+
+/** Splits a range down to the grain, leaving the upper halves to thieves **/
+static void _pool_run(pool_t *pool, pool_worker_t *worker, const size_t begin,
+                      size_t end) {
+  while (end - begin > pool->grain) {
+    const size_t mid = begin + (end - begin) / 2;
+    if (!_pool_push(worker, mid, end))
+      break;
+    end = mid;
+  }
+  pool->fn(pool->ctx, begin, end, worker);
+  atomic_fetch_sub_explicit(&pool->pending, end - begin, memory_order_acq_rel);
+}
+
+/** Works on the current job until all of its indices are processed **/
+static void _pool_work(pool_t *pool, pool_worker_t *worker) {
+  uint32_t idle_rounds = 0;
+  while (atomic_load_explicit(&pool->pending, memory_order_acquire) > 0) {
+    size_t begin, end;
+    bool found = _pool_take(worker, &begin, &end);
+
+    if (!found && pool->num_workers > 1) {
+      // Visit the others from a random start, so thieves spread out
+      uint32_t x = worker->rng;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      worker->rng = x;
+      const size_t start = x % pool->num_workers;
+      for (size_t i = 0; i < pool->num_workers && !found; i++) {
+        pool_worker_t *victim =
+            &pool->workers[(start + i) % pool->num_workers];
+        if (victim != worker && _pool_steal(victim, &begin, &end)) {
+          found = true;
+          ++worker->steals;
+        }
+      }
+    }
+
+    if (found) {
+      idle_rounds = 0;
+      _pool_run(pool, worker, begin, end);
+    } else if (idle_rounds++ < POOL_SPIN_ROUNDS) {
+      sched_yield();
+    } else {
+      const struct timespec ts = {.tv_sec = 0, .tv_nsec = POOL_SLEEP_NS};
+      nanosleep(&ts, NULL);
+    }
+  }
+}
+
+static void *_pool_worker_main(void *arg) {
+  pool_worker_t *worker = arg;
+  pool_t *pool = worker->pool;
+  uint64_t seen = 0;
+
+  for (;;) {
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->shutdown && pool->generation == seen)
+      pthread_cond_wait(&pool->wake, &pool->lock);
+    const bool shutdown = pool->shutdown;
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+    if (shutdown)
+      return NULL;
+
+    _pool_work(pool, worker);
+  }
+}
+
+static pool_t *pool_create(size_t num_workers) {
+  if (num_workers == 0)
+    num_workers = pool_cpu_count();
+
+  pool_t *pool = calloc(1, sizeof(pool_t));
+  if (!pool)
+    return NULL;
+  pool->workers = aligned_alloc(POOL_CACHE_LINE,
+                                ALIGN_UP(sizeof(pool_worker_t) * num_workers,
+                                         POOL_CACHE_LINE));
+  if (!pool->workers) {
+    free(pool);
+    return NULL;
+  }
+  memset(pool->workers, 0, sizeof(pool_worker_t) * num_workers);
+  if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+    free(pool->workers);
+    free(pool);
+    return NULL;
+  }
+  if (pthread_cond_init(&pool->wake, NULL) != 0) {
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+    return NULL;
+  }
+  atomic_init(&pool->pending, 0);
+
+  bool ok = true;
+  for (size_t i = 0; i < num_workers && ok; i++) {
+    pool_worker_t *worker = &pool->workers[i];
+    atomic_init(&worker->bottom, 0);
+    atomic_init(&worker->top, 0);
+    worker->pool = pool;
+    worker->index = i;
+    worker->rng = 2654435761u * (uint32_t)(i + 1);
+    worker->scratch = arena_alloc();
+    ok = worker->scratch != NULL;
+  }
+
+  /** Worker 0 is the calling thread **/
+  pool->num_workers = 1;
+  for (size_t i = 1; i < num_workers && ok; i++) {
+    ok = pthread_create(&pool->workers[i].thread, NULL, _pool_worker_main,
+                        &pool->workers[i]) == 0;
+    if (ok)
+      pool->num_workers = i + 1;
+  }
+
+  if (!ok) {
+    // Workers past num_workers never started, only their arenas are freed
+    for (size_t i = pool->num_workers; i < num_workers; i++)
+      if (pool->workers[i].scratch)
+        arena_release(pool->workers[i].scratch);
+    pool_destroy(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+static void pool_destroy(pool_t *pool) {
+  pthread_mutex_lock(&pool->lock);
+  pool->shutdown = true;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->lock);
+
+  for (size_t i = 0; i < pool->num_workers; i++) {
+    if (i > 0)
+      pthread_join(pool->workers[i].thread, NULL);
+    if (pool->workers[i].scratch)
+      arena_release(pool->workers[i].scratch);
+  }
+
+  pthread_mutex_destroy(&pool->lock);
+  pthread_cond_destroy(&pool->wake);
+  free(pool->workers);
+  free(pool);
+}
+
+/**
+ * @brief Calls fn over [begin, end) in ranges of at most grain indices, on all
+ * workers, and returns once every index is processed.
+ *
+ * @param grain Largest range passed to fn, 0 is taken as 1.
+ */
+static void pool_parallel_for(pool_t *pool, const size_t begin,
+                              const size_t end, const size_t grain,
+                              const pool_range_fn fn, void *ctx) {
+  if (begin >= end)
+    return;
+
+  pool->fn = fn;
+  pool->ctx = ctx;
+  pool->grain = grain > 0 ? grain : 1;
+  atomic_store_explicit(&pool->pending, end - begin, memory_order_relaxed);
+
+  /** The whole range starts on the caller's deque **/
+  pool_worker_t *self = &pool->workers[0];
+  _pool_push(self, begin, end);
+
+  if (pool->num_workers > 1) {
+    pthread_mutex_lock(&pool->lock);
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  _pool_work(pool, self);
+
+  for (size_t i = 0; i < pool->num_workers; i++)
+    arena_clear(pool->workers[i].scratch);
+}
+
+#endif // POOL_H
@@ -0,0 +1,238 @@
+/*=============================================================================
+  fmt_test.h — validation & micro-benchmarks for fmt.h
+  ---------------------------------------------------------------------------
+  Usage:
+      #define FMT_TEST_MAIN        // <- optional: gives you a main() driver
+      #include "fmt_test.h"
+
+      $ cc -O3 -std=c11 fmt_test.c -lm -o fmt_test
+      $ ./fmt_test
+=============================================================================*/
+#ifndef FMT_TEST_H
+#define FMT_TEST_H
+
+#include "common/core.h"
+#include "common/fmt.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef FMT_TEST_ITERATIONS /* values used in stress / perf tests   */
+#define FMT_TEST_ITERATIONS (1u << 20) /* 1 048 576 */
+#endif
+
+/* ---------------------------------------------------------------------------
+   Lightweight RNG (xorshift32)
+   ------------------------------------------------------------------------ */
+static inline uint32_t fmt_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/* Coordinates in a 1920x1080 frame, a few off the page                  */
+static inline double fmt_prng_coord(uint32_t *state) {
+  return (fmt_prng_next(state) / (double)UINT32_MAX) * 4000.0 - 1000.0;
+}
+
+static size_t fmt_test_fixed_str(char *buf, const double value,
+                                 const int precision) {
+  const size_t length = fmt_fixed(buf, value, precision);
+  buf[length] = '\0';
+  return length;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: exact strings
+   ------------------------------------------------------------------------ */
+static void fmt_test_basic(void) {
+  puts("[basic]");
+
+  char buf[FMT_FIXED_MAX_LENGTH + 1];
+  const struct {
+    double value;
+    int precision;
+    const char *expect;
+  } cases[] = {
+      {0.0, 3, "0"},          {-0.0, 3, "0"},       {-0.0001, 3, "0"},
+      {1.0, 3, "1"},          {12.5, 3, "12.5"},    {-0.125, 3, "-0.125"},
+      {123.456789, 3, "123.457"}, {123.456789, 0, "123"},
+      {1000.5, 0, "1001"},    {-1000.5, 0, "-1001"}, {0.05, 1, "0.1"},
+      {99.9996, 3, "100"},    {1e7, 2, "10000000"}, {0.000001, 6, "0.000001"},
+  };
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    fmt_test_fixed_str(buf, cases[i].value, cases[i].precision);
+    if (strcmp(buf, cases[i].expect) != 0) {
+      fprintf(stderr, "fmt_fixed(%.17g, %d) = \"%s\", expected \"%s\"\n",
+              cases[i].value, cases[i].precision, buf, cases[i].expect);
+      assert(0);
+    }
+  }
+
+  /* out of range and non-finite values take the snprintf path           */
+  fmt_test_fixed_str(buf, 1e20, 3);
+  assert(strcmp(buf, "100000000000000000000") == 0);
+
+  /* too long for fixed notation, the exponent must survive intact       */
+  fmt_test_fixed_str(buf, 1e300, 3);
+  assert(strcmp(buf, "1.0000000000000001e+300") == 0);
+  fmt_test_fixed_str(buf, 1e50, 3);
+  assert(strcmp(buf, "1.0000000000000001e+50") == 0);
+  fmt_test_fixed_str(buf, -0x1p200, 0);
+  assert(strcmp(buf, "-1.6069380442589903e+60") == 0);
+  fmt_test_fixed_str(buf, NAN, 3);
+  assert(strcmp(buf, "nan") == 0 || strcmp(buf, "-nan") == 0);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: agreement with snprintf("%.*f") on random coordinates
+   ------------------------------------------------------------------------ */
+static void fmt_test_random(size_t count) {
+  puts("[random vs snprintf]");
+
+  char ours[FMT_FIXED_MAX_LENGTH + 1];
+  char ref[64];
+  uint32_t rng = 1u;
+
+  for (int precision = 0; precision <= 6; ++precision) {
+    size_t last_digit = 0;
+    for (size_t i = 0; i < count / 8; ++i) {
+      const double value = fmt_prng_coord(&rng);
+      fmt_test_fixed_str(ours, value, precision);
+      snprintf(ref, sizeof(ref), "%.*f", precision, value);
+
+      /* both must denote the same number up to one unit in the last digit */
+      const double diff = fabs(strtod(ours, NULL) - strtod(ref, NULL));
+      assert(diff <= 1.5 / fmt_pow10[precision]);
+      last_digit += diff > 0.5 / fmt_pow10[precision];
+    }
+    printf("  precision %d: %zu last digit differences\n", precision,
+           last_digit);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: fmt_fixed_array matches fmt_fixed
+   ------------------------------------------------------------------------ */
+static void fmt_test_array(void) {
+  puts("[array]");
+
+  enum { COUNT = 1000 };
+  double values[COUNT];
+  uint32_t rng = 7u;
+  for (size_t i = 0; i < COUNT; ++i)
+    values[i] = fmt_prng_coord(&rng);
+  values[500] = 1e300; /* forces its block through the checked path    */
+
+  char *array_out = malloc(COUNT * (FMT_FIXED_MAX_LENGTH + 1));
+  char *scalar_out = malloc(COUNT * (FMT_FIXED_MAX_LENGTH + 1));
+  assert(array_out && scalar_out);
+
+  const size_t array_length = fmt_fixed_array(array_out, values, COUNT, 3, ' ');
+
+  size_t scalar_length = 0;
+  for (size_t i = 0; i < COUNT; ++i) {
+    if (i > 0)
+      scalar_out[scalar_length++] = ' ';
+    scalar_length += fmt_fixed(scalar_out + scalar_length, values[i], 3);
+  }
+
+  assert(array_length == scalar_length);
+  assert(memcmp(array_out, scalar_out, array_length) == 0);
+
+  free(array_out);
+  free(scalar_out);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 4: micro-benchmarks against snprintf("%f")
+   ------------------------------------------------------------------------ */
+static void fmt_test_perf(size_t count) {
+  printf("[perf] %zu values\n", count);
+
+  double *values = malloc(count * sizeof(double));
+  char *out = malloc(count * (FMT_FIXED_MAX_LENGTH + 1));
+  if (!values || !out) {
+    fputs("out of memory\n", stderr);
+    exit(EXIT_FAILURE);
+  }
+
+  uint32_t rng = 1u;
+  for (size_t i = 0; i < count; ++i)
+    values[i] = fmt_prng_coord(&rng);
+
+  /* 1) snprintf("%f") -------------------------------------------------- */
+  size_t bytes = 0;
+  timespec_t t0 = ts_now();
+  for (size_t i = 0; i < count; ++i)
+    bytes += (size_t)snprintf(out + bytes, 64, "%f", values[i]);
+  timespec_t t1 = ts_now();
+
+  /* 2) snprintf("%.3f") ------------------------------------------------ */
+  size_t bytes_p3 = 0;
+  for (size_t i = 0; i < count; ++i)
+    bytes_p3 += (size_t)snprintf(out + bytes_p3, 64, "%.3f", values[i]);
+  timespec_t t2 = ts_now();
+
+  /* 3) fmt_fixed, precision 3 ------------------------------------------ */
+  size_t bytes_fixed = 0;
+  for (size_t i = 0; i < count; ++i)
+    bytes_fixed += fmt_fixed(out + bytes_fixed, values[i], 3);
+  timespec_t t3 = ts_now();
+
+  /* 4) fmt_fixed_array, precision 3 ------------------------------------ */
+  const size_t bytes_array = fmt_fixed_array(out, values, count, 3, ' ');
+  timespec_t t4 = ts_now();
+
+  const double s_f = ts_elapsed_sec(t0, t1);
+  const double s_p3 = ts_elapsed_sec(t1, t2);
+  const double s_fixed = ts_elapsed_sec(t2, t3);
+  const double s_array = ts_elapsed_sec(t3, t4);
+
+  printf("  snprintf %%f    : %.2f Mvals/s  (%.1f ns/val, %.1f B/val)\n",
+         count / s_f / 1e6, s_f * 1e9 / count, (double)bytes / count);
+  printf("  snprintf %%.3f  : %.2f Mvals/s  (%.1f ns/val, %.1f B/val)\n",
+         count / s_p3 / 1e6, s_p3 * 1e9 / count, (double)bytes_p3 / count);
+  printf("  fmt_fixed      : %.2f Mvals/s  (%.1f ns/val, %.1f B/val)\n",
+         count / s_fixed / 1e6, s_fixed * 1e9 / count,
+         (double)bytes_fixed / count);
+  printf("  fmt_fixed_array: %.2f Mvals/s  (%.1f ns/val, %.1f B/val)\n",
+         count / s_array / 1e6, s_array * 1e9 / count,
+         (double)bytes_array / count);
+
+  free(values);
+  free(out);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   FMT_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void fmt_tests_run_all(void) {
+  fmt_test_basic();
+  fmt_test_random(FMT_TEST_ITERATIONS);
+  fmt_test_array();
+  fmt_test_perf(FMT_TEST_ITERATIONS);
+  puts("all fmt tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef FMT_TEST_MAIN
+int main(void) {
+  fmt_tests_run_all();
+  return 0;
+}
+#endif /* FMT_TEST_MAIN */
+
+#endif /* FMT_TEST_H */
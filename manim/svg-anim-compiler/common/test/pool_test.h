@@ -0,0 +1,206 @@
+/*=============================================================================
+  pool_test.h — validation & scaling benchmark for pool.h
+  ---------------------------------------------------------------------------
+  Usage:
+      #define POOL_TEST_MAIN       // <- optional: gives you a main() driver
+      #include "pool_test.h"
+
+      $ cc -O3 -std=gnu17 -pthread pool_test.c -lm -o pool_test
+      $ ./pool_test [max_workers]
+
+  The benchmark runs the same jobs on 1, 2, 4, ... workers up to max_workers
+  (default: one per online cpu) and prints the speedup over one worker.
+=============================================================================*/
+#ifndef POOL_TEST_H
+#define POOL_TEST_H
+
+#include "common/core.h"
+#include "common/pool.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef POOL_TEST_ITEMS /* indices per benchmark job              */
+#define POOL_TEST_ITEMS (1u << 16) /* 65 536 */
+#endif
+
+#ifndef POOL_TEST_WORK /* inner iterations per index             */
+#define POOL_TEST_WORK 2000u
+#endif
+
+/* ---------------------------------------------------------------------------
+   Test 1: every index is processed exactly once, ranges respect the grain
+   ------------------------------------------------------------------------ */
+typedef struct pool_test_visit_t {
+  _Atomic uint32_t *visits;
+  size_t grain;
+  _Atomic size_t ranges;
+} pool_test_visit_t;
+
+static void pool_test_visit_range(void *ctx, const size_t begin,
+                                  const size_t end, pool_worker_t *worker) {
+  pool_test_visit_t *visit = ctx;
+  assert(begin < end && end - begin <= visit->grain);
+  for (size_t i = begin; i < end; ++i)
+    atomic_fetch_add_explicit(&visit->visits[i], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&visit->ranges, 1, memory_order_relaxed);
+
+  /* scratch is the worker's own until the job ends */
+  size_t *scratch = arena_push_array(worker->scratch, size_t, end - begin);
+  assert(scratch);
+  scratch[0] = begin;
+}
+
+static void pool_test_coverage(pool_t *pool) {
+  puts("[coverage]");
+
+  enum { COUNT = 100003 };
+  _Atomic uint32_t *visits = calloc(COUNT, sizeof(*visits));
+  assert(visits);
+
+  const size_t grains[] = {1, 7, 1000, COUNT * 2};
+  for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); ++g) {
+    pool_test_visit_t visit = {.visits = visits, .grain = grains[g]};
+    atomic_init(&visit.ranges, 0);
+    memset(visits, 0, sizeof(*visits) * COUNT);
+
+    pool_parallel_for(pool, 3, COUNT, grains[g], pool_test_visit_range, &visit);
+    for (size_t i = 0; i < COUNT; ++i)
+      assert(visits[i] == (i >= 3));
+    assert(atomic_load(&visit.ranges) >= (COUNT - 3 + grains[g] - 1) / grains[g]);
+    for (size_t w = 0; w < pool->num_workers; ++w)
+      assert(pool->workers[w].scratch->pos == 0);
+  }
+
+  /* an empty range never calls fn */
+  pool_test_visit_t visit = {.visits = visits, .grain = 1};
+  atomic_init(&visit.ranges, 0);
+  pool_parallel_for(pool, 5, 5, 1, pool_test_visit_range, &visit);
+  assert(atomic_load(&visit.ranges) == 0);
+
+  free(visits);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: many tiny jobs back to back, workers rejoin every one
+   ------------------------------------------------------------------------ */
+static void pool_test_sum_range(void *ctx, const size_t begin,
+                                const size_t end, pool_worker_t *worker) {
+  _Atomic uint64_t *sum = ctx;
+  uint64_t local = 0;
+  for (size_t i = begin; i < end; ++i)
+    local += i;
+  atomic_fetch_add_explicit(sum, local, memory_order_relaxed);
+}
+
+static void pool_test_jobs(pool_t *pool) {
+  puts("[jobs]");
+  for (uint64_t job = 0; job < 20000; ++job) {
+    _Atomic uint64_t sum;
+    atomic_init(&sum, 0);
+    const uint64_t count = 1 + job % 97;
+    pool_parallel_for(pool, 0, count, 1 + job % 5, pool_test_sum_range, &sum);
+    assert(atomic_load(&sum) == count * (count - 1) / 2);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Benchmark: compute bound indices, even and skewed cost
+   ------------------------------------------------------------------------ */
+typedef struct pool_test_bench_t {
+  double *out;
+  bool skewed;
+} pool_test_bench_t;
+
+static void pool_test_bench_range(void *ctx, const size_t begin,
+                                  const size_t end, pool_worker_t *worker) {
+  pool_test_bench_t *bench = ctx;
+  for (size_t i = begin; i < end; ++i) {
+    /* skewed: the last eighth of the indices costs 8x */
+    const uint32_t work =
+        bench->skewed && i >= POOL_TEST_ITEMS / 8 * 7 ? POOL_TEST_WORK * 8
+                                                      : POOL_TEST_WORK;
+    double x = (double)i;
+    for (uint32_t k = 0; k < work; ++k)
+      x = x * 0.999999 + sqrt(x + k);
+    bench->out[i] = x;
+  }
+}
+
+static double pool_test_bench_run(pool_t *pool, const bool skewed) {
+  pool_test_bench_t bench = {
+      .out = malloc(sizeof(double) * POOL_TEST_ITEMS), .skewed = skewed};
+  assert(bench.out);
+  const timespec_t t0 = ts_now();
+  pool_parallel_for(pool, 0, POOL_TEST_ITEMS, 64, pool_test_bench_range,
+                    &bench);
+  const double secs = ts_elapsed_sec(t0, ts_now());
+  free(bench.out);
+  return secs;
+}
+
+static void pool_test_scaling(const size_t max_workers) {
+  printf("[scaling] %u indices x %u iterations, up to %zu workers\n",
+         POOL_TEST_ITEMS, POOL_TEST_WORK, max_workers);
+  double base[2] = {0, 0};
+  for (size_t workers = 1; workers <= max_workers;
+       workers = workers * 2 <= max_workers || workers == max_workers
+                     ? workers * 2
+                     : max_workers) {
+    pool_t *pool = pool_create(workers);
+    assert(pool);
+    double secs[2];
+    for (int skewed = 0; skewed < 2; ++skewed) {
+      secs[skewed] = pool_test_bench_run(pool, skewed);
+      if (workers == 1)
+        base[skewed] = secs[skewed];
+    }
+    size_t steals = 0;
+    for (size_t w = 0; w < pool->num_workers; ++w)
+      steals += pool->workers[w].steals;
+    printf("  %2zu workers  even %.3fs (%.2fx)  skewed %.3fs (%.2fx)  "
+           "%zu steals\n",
+           workers, secs[0], base[0] / secs[0], secs[1], base[1] / secs[1],
+           steals);
+    pool_destroy(pool);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   POOL_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void pool_tests_run_all(const size_t max_workers) {
+  const size_t sizes[] = {1, 2, 5};
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    pool_t *pool = pool_create(sizes[i]);
+    assert(pool && pool->num_workers == sizes[i]);
+    printf("(%zu workers)\n", sizes[i]);
+    pool_test_coverage(pool);
+    pool_test_jobs(pool);
+    pool_destroy(pool);
+  }
+  pool_test_scaling(max_workers);
+  puts("all pool tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef POOL_TEST_MAIN
+int main(const int argc, const char **argv) {
+  const size_t max_workers =
+      argc > 1 ? strtoull(argv[1], NULL, 10) : pool_cpu_count();
+  pool_tests_run_all(max_workers > 0 ? max_workers : 1);
+  return 0;
+}
+#endif /* POOL_TEST_MAIN */
+
+#endif /* POOL_TEST_H */
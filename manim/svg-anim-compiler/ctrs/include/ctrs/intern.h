@@ -0,0 +1,182 @@
+#ifndef INTERN_H
+#define INTERN_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common/arena.h"
+#include "common/hash.h"
+
+/**
+ * Interns byte strings to dense 32-bit ids. Equal strings get the same id,
+ * ids count up from 0 in the order strings were first seen, so two values are
+ * equal exactly when their ids are and the strings can be written out once as
+ * a table indexed by id.
+ * Methods:
+ * - create
+ * - destroy
+ * - put
+ * - get
+ * - clear
+ * - _resize
+ *
+ * The strings live back to back in an arena, NUL terminated. Slots hold
+ * id + 1, probed linearly, and the hash of every string is kept with it so a
+ * probe rarely touches the bytes of a string it does not match.
+ **/
+
+#define INTERN_START_SIZE 256
+#define INTERN_MAX_LOAD 50
+
+/**
+ * @brief Where the string of an id is within the blob
+ */
+typedef struct intern_record_t {
+  size_t offset;
+  uint32_t length;
+  uint32_t hash;
+} intern_record_t;
+
+typedef struct intern_pool_t {
+  uint32_t size;
+  uint32_t count;
+  uint32_t *slots;
+
+  arena_t *blob_arena;
+  /** intern_record_t per id **/
+  arena_t *record_arena;
+} intern_pool_t;
+
+static intern_pool_t *intern_create(void);
+static void intern_destroy(intern_pool_t *pool);
+static int intern_put(intern_pool_t *pool, const void *data, size_t length,
+                      uint32_t *out_id);
+static const char *intern_get(const intern_pool_t *pool, uint32_t id,
+                              size_t *out_length);
+static void intern_clear(intern_pool_t *pool);
+static int _intern_resize(intern_pool_t *pool);
+static const intern_record_t *_intern_record(const intern_pool_t *pool,
+                                             uint32_t id);
+
+/**
+ * @return The pool, or NULL if memory ran out.
+ */
+static intern_pool_t *intern_create(void) {
+  intern_pool_t *pool = calloc(1, sizeof(intern_pool_t));
+  if (!pool)
+    return NULL;
+  pool->size = INTERN_START_SIZE;
+  pool->slots = calloc(pool->size, sizeof(uint32_t));
+  pool->blob_arena = arena_alloc();
+  pool->record_arena = arena_alloc();
+  if (!pool->slots || !pool->blob_arena || !pool->record_arena) {
+    intern_destroy(pool);
+    return NULL;
+  }
+  return pool;
+}
+
+static void intern_destroy(intern_pool_t *pool) {
+  if (pool->blob_arena)
+    arena_release(pool->blob_arena);
+  if (pool->record_arena)
+    arena_release(pool->record_arena);
+  free(pool->slots);
+  free(pool);
+}
+
+/**
+ * @brief Finds the id of data[0..length), adding it if it is new.
+ *
+ * @return 1 on success, 0 if memory ran out.
+ */
+static int intern_put(intern_pool_t *pool, const void *data,
+                      const size_t length, uint32_t *out_id) {
+  if (length > UINT32_MAX)
+    return 0;
+  // Below the load limit there is always an empty slot to end the probe
+  if ((uint64_t)pool->count * 100 / pool->size >= INTERN_MAX_LOAD &&
+      !_intern_resize(pool))
+    return 0;
+  const uint32_t hash = (uint32_t)hash_bytes(data, length, HASH_SEED);
+  const uint32_t mask = pool->size - 1;
+
+  uint32_t idx = hash & mask;
+  for (;; idx = (idx + 1) & mask) {
+    const uint32_t slot = pool->slots[idx];
+    if (slot == 0)
+      break;
+    const intern_record_t *record = _intern_record(pool, slot - 1);
+    if (record->hash == hash && record->length == length &&
+        memcmp(pool->blob_arena->base + record->offset, data, length) == 0) {
+      *out_id = slot - 1;
+      return 1;
+    }
+  }
+
+  if (pool->count == UINT32_MAX - 1)
+    return 0;
+  char *dest = arena_push(pool->blob_arena, length + 1);
+  intern_record_t *record =
+      arena_push_struct(pool->record_arena, intern_record_t);
+  if (!dest || !record)
+    return 0;
+  memcpy(dest, data, length);
+  dest[length] = '\0';
+  record->offset = (size_t)((uint8_t *)dest - pool->blob_arena->base);
+  record->length = (uint32_t)length;
+  record->hash = hash;
+
+  *out_id = pool->count++;
+  pool->slots[idx] = *out_id + 1;
+  return 1;
+}
+
+/**
+ * @return The NUL terminated string of id, valid until the pool is cleared
+ * or destroyed.
+ */
+static const char *intern_get(const intern_pool_t *pool, const uint32_t id,
+                              size_t *out_length) {
+  const intern_record_t *record = _intern_record(pool, id);
+  if (out_length)
+    *out_length = record->length;
+  return (const char *)pool->blob_arena->base + record->offset;
+}
+
+static void intern_clear(intern_pool_t *pool) {
+  memset(pool->slots, 0, pool->size * sizeof(uint32_t));
+  arena_clear(pool->blob_arena);
+  arena_clear(pool->record_arena);
+  pool->count = 0;
+}
+
+static int _intern_resize(intern_pool_t *pool) {
+  if (pool->size > UINT32_MAX / 2)
+    return 0;
+  const uint32_t new_size = pool->size * 2;
+  uint32_t *new_slots = calloc(new_size, sizeof(uint32_t));
+  if (!new_slots)
+    return 0;
+
+  const uint32_t mask = new_size - 1;
+  for (uint32_t id = 0; id < pool->count; ++id) {
+    uint32_t idx = _intern_record(pool, id)->hash & mask;
+    while (new_slots[idx])
+      idx = (idx + 1) & mask;
+    new_slots[idx] = id + 1;
+  }
+
+  free(pool->slots);
+  pool->slots = new_slots;
+  pool->size = new_size;
+  return 1;
+}
+
+static const intern_record_t *_intern_record(const intern_pool_t *pool,
+                                             const uint32_t id) {
+  return (const intern_record_t *)pool->record_arena->base + id;
+}
+
+#endif // INTERN_H
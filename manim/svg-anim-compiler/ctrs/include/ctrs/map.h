@@ -17,6 +17,7 @@
  * - put
  * - get
  * - remove
+ * - clear
  * - _resize
  *
  **/
@@ -62,6 +63,7 @@ static void map_destroy(map_t *map);
 static int map_put(map_t *map, uint32_t key, const void *element);
 static int map_get(const map_t *map, const uint32_t key, void *out_element);
 static int map_remove(map_t *map, const uint32_t key);
+static void map_clear(map_t *map);
 static int _map_resize(map_t *map);
 static int _load_ok(const map_t *map);
 static bucket_t *_bucket_at(const map_t *map, size_t i);
@@ -172,6 +174,15 @@ static int map_remove(map_t *map, const uint32_t key) {
   }
 }
 
+/** Removes every element, keeping the table at its current size **/
+static void map_clear(map_t *map) {
+  for (size_t i = 0; i < map->size; i++) {
+    _bucket_at(map, i)->key = MAP_EMPTY_KEY;
+    _bucket_at(map, i)->state = MAP_BUCKET_EMPTY;
+  }
+  map->count = 0;
+}
+
 static int _map_resize(map_t *map) {
   const size_t old_map_size = map->size;
   const size_t new_map_size = old_map_size * 2;
@@ -0,0 +1,222 @@
+#ifndef SPSC_H
+#define SPSC_H
+#include <sched.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "common/core.h"
+
+/**
+ * Lock-free ring of fixed size elements between one producer thread and one
+ * consumer thread.
+ * Methods:
+ * - create
+ * - destroy
+ * - push_n / pop_n (never wait, move as many elements as fit)
+ * - push_wait / pop_wait (wait for space or elements)
+ * - close
+ *
+ * head and tail count the elements pushed and popped since creation, element
+ * n lives in slot n & mask. Only the producer stores head, only the consumer
+ * stores tail, each on its own cache line together with the side's cached
+ * copy of the other index, so a side only touches the other's line when its
+ * cached view says the ring is full or empty.
+ **/
+
+#define SPSC_CACHE_LINE 64
+
+/** Empty or full polls spent spinning, then yielding the core, before
+ * sleeping between polls **/
+#define SPSC_SPIN_POLLS 64
+#define SPSC_YIELD_POLLS 1024
+#define SPSC_SLEEP_NS 20000L
+
+typedef struct spsc_t {
+  /** Producer side **/
+  alignas(SPSC_CACHE_LINE) _Atomic size_t head;
+  size_t tail_cache;
+  _Atomic bool closed;
+  /** Times push_wait found the ring full **/
+  size_t push_stalls;
+
+  /** Consumer side **/
+  alignas(SPSC_CACHE_LINE) _Atomic size_t tail;
+  size_t head_cache;
+  /** Times pop_wait found the ring empty **/
+  size_t pop_stalls;
+
+  /** Read-only after create **/
+  alignas(SPSC_CACHE_LINE) size_t mask;
+  size_t element_size;
+  uint8_t *data;
+} spsc_t;
+
+/**
+ * Notes:
+ * - capacity is rounded up to a power of two
+ * - push_* and close are called from the producer only, pop_* from the
+ *   consumer only
+ */
+static spsc_t *spsc_create(size_t capacity, size_t element_size);
+static void spsc_destroy(spsc_t *ring);
+static size_t spsc_push_n(spsc_t *ring, const void *elements, size_t count);
+static size_t spsc_pop_n(spsc_t *ring, void *out_elements, size_t max_count);
+static void spsc_push_wait(spsc_t *ring, const void *elements, size_t count);
+static size_t spsc_pop_wait(spsc_t *ring, void *out_elements,
+                            size_t max_count);
+static void spsc_close(spsc_t *ring);
+static void _spsc_wait(size_t *stalls, uint32_t polls);
+
+static spsc_t *spsc_create(const size_t capacity, const size_t element_size) {
+  spsc_t *ring = aligned_alloc(SPSC_CACHE_LINE, sizeof(spsc_t));
+  if (!ring)
+    return NULL;
+  memset(ring, 0, sizeof(*ring));
+
+  size_t rounded = 1;
+  while (rounded < capacity)
+    rounded <<= 1;
+
+  ring->mask = rounded - 1;
+  ring->element_size = element_size;
+  ring->data = malloc(rounded * element_size);
+  if (!ring->data) {
+    free(ring);
+    return NULL;
+  }
+  atomic_init(&ring->head, 0);
+  atomic_init(&ring->tail, 0);
+  atomic_init(&ring->closed, false);
+  return ring;
+}
+
+static void spsc_destroy(spsc_t *ring) {
+  free(ring->data);
+  free(ring);
+}
+
+/** Copies count elements between the ring, starting at slot pos, and buf **/
+static void _spsc_copy(const spsc_t *ring, const size_t pos, void *buf,
+                       const size_t count, const bool to_ring) {
+  const size_t capacity = ring->mask + 1;
+  const size_t start = pos & ring->mask;
+  const size_t first = count < capacity - start ? count : capacity - start;
+  uint8_t *slots = ring->data + start * ring->element_size;
+  uint8_t *rest = (uint8_t *)buf + first * ring->element_size;
+  if (to_ring) {
+    memcpy(slots, buf, first * ring->element_size);
+    memcpy(ring->data, rest, (count - first) * ring->element_size);
+  } else {
+    memcpy(buf, slots, first * ring->element_size);
+    memcpy(rest, ring->data, (count - first) * ring->element_size);
+  }
+}
+
+static size_t spsc_push_n(spsc_t *ring, const void *elements, size_t count) {
+  const size_t capacity = ring->mask + 1;
+  const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+  size_t space = capacity - (head - ring->tail_cache);
+  if (space < count) {
+    ring->tail_cache =
+        atomic_load_explicit(&ring->tail, memory_order_acquire);
+    space = capacity - (head - ring->tail_cache);
+  }
+  if (count > space)
+    count = space;
+  if (count == 0)
+    return 0;
+
+  _spsc_copy(ring, head, (void *)elements, count, true);
+  atomic_store_explicit(&ring->head, head + count, memory_order_release);
+  return count;
+}
+
+static size_t spsc_pop_n(spsc_t *ring, void *out_elements, size_t max_count) {
+  const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+  size_t available = ring->head_cache - tail;
+  if (available < max_count) {
+    ring->head_cache =
+        atomic_load_explicit(&ring->head, memory_order_acquire);
+    available = ring->head_cache - tail;
+  }
+  if (max_count > available)
+    max_count = available;
+  if (max_count == 0)
+    return 0;
+
+  _spsc_copy(ring, tail, out_elements, max_count, false);
+  atomic_store_explicit(&ring->tail, tail + max_count, memory_order_release);
+  return max_count;
+}
+
+/** Spins, yields, then sleeps, while the ring is empty or full **/
+static void _spsc_wait(size_t *stalls, const uint32_t polls) {
+  if (polls == 0)
+    ++*stalls;
+  if (polls < SPSC_SPIN_POLLS)
+    return;
+  if (polls < SPSC_YIELD_POLLS) {
+    sched_yield();
+    return;
+  }
+  const struct timespec ts = {.tv_sec = 0, .tv_nsec = SPSC_SLEEP_NS};
+  nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief Pushes all count elements, waiting for the consumer whenever the
+ * ring is full.
+ */
+static void spsc_push_wait(spsc_t *ring, const void *elements, size_t count) {
+  const uint8_t *bytes = elements;
+  uint32_t polls = 0;
+  while (count > 0) {
+    const size_t pushed = spsc_push_n(ring, bytes, count);
+    if (pushed == 0) {
+      _spsc_wait(&ring->push_stalls, polls++);
+      continue;
+    }
+    polls = 0;
+    bytes += pushed * ring->element_size;
+    count -= pushed;
+  }
+}
+
+/**
+ * @brief Pops up to max_count elements, waiting until at least one is
+ * available.
+ *
+ * @return Elements popped, 0 once the ring is closed and drained.
+ */
+static size_t spsc_pop_wait(spsc_t *ring, void *out_elements,
+                            const size_t max_count) {
+  uint32_t polls = 0;
+  for (;;) {
+    const size_t popped = spsc_pop_n(ring, out_elements, max_count);
+    if (popped > 0 || max_count == 0)
+      return popped;
+
+    // closed is stored after the last head, so the pop above may have missed
+    // elements pushed just before it
+    if (atomic_load_explicit(&ring->closed, memory_order_acquire))
+      return spsc_pop_n(ring, out_elements, max_count);
+    _spsc_wait(&ring->pop_stalls, polls++);
+  }
+}
+
+/**
+ * @brief Marks the end of the producer's elements. The consumer's pop_wait
+ * returns 0 once it has popped the rest.
+ */
+static void spsc_close(spsc_t *ring) {
+  atomic_store_explicit(&ring->closed, true, memory_order_release);
+}
+
+#endif // SPSC_H
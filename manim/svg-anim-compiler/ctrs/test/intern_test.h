@@ -0,0 +1,172 @@
+/*=============================================================================
+  intern_test.h — validation & micro-benchmarks for intern.h
+  ---------------------------------------------------------------------------
+  Usage:
+      #define INTERN_TEST_MAIN     // <- optional: gives you a main() driver
+      #include "intern_test.h"
+
+      $ cc -O3 -std=gnu17 intern_test.c -o intern_test
+      $ ./intern_test
+=============================================================================*/
+#ifndef INTERN_TEST_H
+#define INTERN_TEST_H
+
+#include "common/core.h"
+#include "ctrs/intern.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef INTERN_TEST_ITERATIONS /* puts in the stress / perf test */
+#define INTERN_TEST_ITERATIONS (1u << 20) /* 1 048 576 */
+#endif
+
+#ifndef INTERN_TEST_DISTINCT /* distinct values among them */
+#define INTERN_TEST_DISTINCT 4096u
+#endif
+
+/* ---------------------------------------------------------------------------
+   Test 1: equal strings share an id, ids are dense
+   ------------------------------------------------------------------------ */
+static void intern_test_basic(void) {
+  puts("[basic]");
+  intern_pool_t *pool = intern_create();
+  assert(pool);
+
+  uint32_t red, white, red_again, empty, nul;
+  assert(intern_put(pool, "rgb(100%, 0%, 0%)", 17, &red));
+  assert(intern_put(pool, "rgb(100%, 100%, 100%)", 21, &white));
+  assert(intern_put(pool, "rgb(100%, 0%, 0%) trailing", 17, &red_again));
+  assert(intern_put(pool, "", 0, &empty));
+  assert(intern_put(pool, "a\0b", 3, &nul));
+  assert(red == 0 && white == 1 && red_again == red && empty == 2 && nul == 3);
+  assert(pool->count == 4);
+
+  /* prefixes and embedded NULs are values of their own */
+  uint32_t id;
+  assert(intern_put(pool, "rgb(100%, 0%, 0%)", 16, &id) && id == 4);
+  assert(intern_put(pool, "a", 1, &id) && id == 5);
+  assert(intern_put(pool, "a\0b", 3, &id) && id == nul);
+
+  size_t length;
+  assert(strcmp(intern_get(pool, red, &length), "rgb(100%, 0%, 0%)") == 0);
+  assert(length == 17);
+  assert(intern_get(pool, empty, &length)[0] == '\0' && length == 0);
+  assert(memcmp(intern_get(pool, nul, &length), "a\0b", 4) == 0 &&
+         length == 3);
+
+  intern_destroy(pool);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: growing past the load limit keeps every id, clear starts over
+   ------------------------------------------------------------------------ */
+static void intern_test_resize(void) {
+  puts("[resize / clear]");
+  intern_pool_t *pool = intern_create();
+  assert(pool);
+  const uint32_t original_size = pool->size;
+
+  char value[32];
+  const uint32_t target = original_size * 4;
+  for (uint32_t i = 0; i < target; ++i) {
+    const int length = snprintf(value, sizeof(value), "%u.5", i);
+    uint32_t id;
+    assert(intern_put(pool, value, (size_t)length, &id) && id == i);
+  }
+  assert(pool->size > original_size);
+  assert(pool->count * 100 / pool->size < INTERN_MAX_LOAD + 1);
+
+  for (uint32_t i = 0; i < target; ++i) {
+    const int length = snprintf(value, sizeof(value), "%u.5", i);
+    uint32_t id;
+    assert(intern_put(pool, value, (size_t)length, &id) && id == i);
+    assert(strcmp(intern_get(pool, i, NULL), value) == 0);
+  }
+  assert(pool->count == target);
+
+  intern_clear(pool);
+  assert(pool->count == 0);
+  uint32_t id;
+  assert(intern_put(pool, "7.5", 3, &id) && id == 0);
+
+  intern_destroy(pool);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: micro-benchmark, mostly repeated values as in a frame's attributes
+   ------------------------------------------------------------------------ */
+static inline uint32_t intern_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static void intern_test_perf(const size_t count) {
+  printf("[perf] %zu puts, %u distinct\n", count, INTERN_TEST_DISTINCT);
+
+  char *values = malloc(count * 32);
+  uint8_t *lengths = malloc(count);
+  if (!values || !lengths) {
+    fputs("out of memory\n", stderr);
+    exit(EXIT_FAILURE);
+  }
+  uint32_t rng = 1u;
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t v = intern_prng_next(&rng) % INTERN_TEST_DISTINCT;
+    lengths[i] = (uint8_t)snprintf(values + i * 32, 32, "rgb(%u%%, %u%%, %u%%)",
+                                   v % 101, v / 101 % 101, v % 7);
+  }
+
+  intern_pool_t *pool = intern_create();
+  assert(pool);
+  uint64_t sum = 0;
+  const timespec_t t0 = ts_now();
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t id;
+    assert(intern_put(pool, values + i * 32, lengths[i], &id));
+    sum += id;
+  }
+  const timespec_t t1 = ts_now();
+  assert(pool->count <= INTERN_TEST_DISTINCT);
+  (void)sum;
+
+  const double s = ts_elapsed_sec(t0, t1);
+  printf("  put : %.2f Mops/s  (%.1f ns/op), %u values, %zu KiB of strings\n",
+         (count / s) / 1e6, s * 1e9 / count, pool->count,
+         pool->blob_arena->pos >> 10);
+
+  intern_destroy(pool);
+  free(values);
+  free(lengths);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   INTERN_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void intern_tests_run_all(void) {
+  intern_test_basic();
+  intern_test_resize();
+  intern_test_perf(INTERN_TEST_ITERATIONS);
+  puts("all intern tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef INTERN_TEST_MAIN
+int main(void) {
+  intern_tests_run_all();
+  return 0;
+}
+#endif /* INTERN_TEST_MAIN */
+
+#endif /* INTERN_TEST_H */
@@ -93,7 +93,34 @@ static void map_test_resize(void) {
 }
 
 /* ---------------------------------------------------------------------------
-   Test 3: stress + micro-benchmarks
+   Test 3: clear keeps the table size and leaves it reusable
+   ------------------------------------------------------------------------ */
+static void map_test_clear(void) {
+  puts("[clear]");
+
+  map_t *m = map_create(sizeof(uint32_t), alignof(uint32_t));
+
+  for (uint32_t key = 0; key < 1000; ++key)
+    assert(map_put(m, key, &key));
+  const size_t grown_size = m->size;
+
+  map_clear(m);
+  assert(m->count == 0);
+  assert(m->size == grown_size);
+
+  uint32_t readback = 0;
+  for (uint32_t key = 0; key < 1000; ++key)
+    assert(map_get(m, key, &readback) == 0);
+
+  const uint32_t value = 7;
+  assert(map_put(m, 3u, &value));
+  assert(map_get(m, 3u, &readback) == 1 && readback == value);
+
+  map_destroy(m);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 4: stress + micro-benchmarks
    ------------------------------------------------------------------------ */
 static void map_test_perf(size_t count) {
   printf("[perf] %lu items\n", count);
@@ -155,6 +182,7 @@ static void map_test_perf(size_t count) {
 static inline void map_tests_run_all(void) {
   map_test_basic();
   map_test_resize();
+  map_test_clear();
   map_test_perf(MAP_TEST_ITERATIONS);
   puts("all map tests passed");
 }
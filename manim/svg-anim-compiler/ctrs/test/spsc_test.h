@@ -0,0 +1,189 @@
+/*=============================================================================
+  spsc_test.h — validation & throughput of the spsc ring in spsc.h
+  ---------------------------------------------------------------------------
+  Usage:
+      #define SPSC_TEST_MAIN       // <- optional: gives you a main() driver
+      #include "spsc_test.h"
+
+      $ cc -O3 -std=gnu17 -pthread spsc_test.c -o spsc_test
+      $ ./spsc_test
+=============================================================================*/
+#ifndef SPSC_TEST_H
+#define SPSC_TEST_H
+
+#include "common/core.h"
+#include "ctrs/spsc.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef SPSC_TEST_ITEMS /* elements streamed per threaded pass     */
+#define SPSC_TEST_ITEMS (1u << 24) /* 16 777 216 */
+#endif
+
+/* ---------------------------------------------------------------------------
+   Lightweight RNG (xorshift32)
+   ------------------------------------------------------------------------ */
+static inline uint32_t spsc_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: push/pop on one thread, full and empty rings, wrap-around
+   ------------------------------------------------------------------------ */
+static void spsc_test_basic(void) {
+  puts("[basic]");
+
+  spsc_t *ring = spsc_create(5, sizeof(uint64_t));
+  assert(ring && ring->mask + 1 == 8);
+
+  uint64_t in[12], out[12];
+  for (uint64_t i = 0; i < 12; ++i)
+    in[i] = i * 0x9e3779b97f4a7c15ULL;
+
+  assert(spsc_pop_n(ring, out, 4) == 0);
+  assert(spsc_push_n(ring, in, 12) == 8); /* only 8 fit */
+  assert(spsc_push_n(ring, in, 1) == 0);
+  assert(spsc_pop_n(ring, out, 3) == 3);
+  assert(memcmp(out, in, 3 * sizeof(uint64_t)) == 0);
+
+  /* wraps around the end of the slots */
+  assert(spsc_push_n(ring, &in[8], 4) == 3);
+  assert(spsc_pop_n(ring, out, 12) == 8);
+  assert(memcmp(out, &in[3], 8 * sizeof(uint64_t)) == 0);
+  assert(spsc_pop_n(ring, out, 1) == 0);
+
+  /* a closed ring still hands out what was pushed before */
+  spsc_push_wait(ring, in, 2);
+  spsc_close(ring);
+  assert(spsc_pop_wait(ring, out, 12) == 2 && out[1] == in[1]);
+  assert(spsc_pop_wait(ring, out, 12) == 0);
+  assert(ring->push_stalls == 0);
+
+  spsc_destroy(ring);
+}
+
+/* ---------------------------------------------------------------------------
+   Producer thread: pushes 0..items-1 in batches of 1..max_batch
+   ------------------------------------------------------------------------ */
+typedef struct spsc_test_producer_t {
+  spsc_t *ring;
+  uint32_t items;
+  uint32_t max_batch;
+} spsc_test_producer_t;
+
+static void *spsc_test_producer_run(void *arg) {
+  spsc_test_producer_t *producer = arg;
+  uint32_t *batch = malloc(sizeof(uint32_t) * producer->max_batch);
+  assert(batch);
+  uint32_t rng = 7u;
+
+  for (uint32_t next = 0; next < producer->items;) {
+    uint32_t count = 1 + spsc_prng_next(&rng) % producer->max_batch;
+    if (count > producer->items - next)
+      count = producer->items - next;
+    for (uint32_t i = 0; i < count; ++i)
+      batch[i] = next + i;
+    spsc_push_wait(producer->ring, batch, count);
+    next += count;
+  }
+
+  spsc_close(producer->ring);
+  free(batch);
+  return NULL;
+}
+
+/** Streams items through a ring of capacity, returns the seconds taken **/
+static double spsc_test_stream(const size_t capacity, const uint32_t items,
+                               const uint32_t max_batch, size_t *out_stalls) {
+  spsc_t *ring = spsc_create(capacity, sizeof(uint32_t));
+  assert(ring);
+  spsc_test_producer_t producer = {
+      .ring = ring, .items = items, .max_batch = max_batch};
+
+  uint32_t *batch = malloc(sizeof(uint32_t) * max_batch);
+  assert(batch);
+  const timespec_t t0 = ts_now();
+  pthread_t thread;
+  const int rc =
+      pthread_create(&thread, NULL, spsc_test_producer_run, &producer);
+  assert(rc == 0);
+  (void)rc;
+
+  uint32_t expected = 0;
+  uint32_t rng = 11u;
+  size_t popped;
+  while ((popped = spsc_pop_wait(ring, batch,
+                                 1 + spsc_prng_next(&rng) % max_batch)) > 0) {
+    for (size_t i = 0; i < popped; ++i)
+      assert(batch[i] == expected + i);
+    expected += (uint32_t)popped;
+  }
+  assert(expected == items);
+
+  pthread_join(thread, NULL);
+  const double secs = ts_elapsed_sec(t0, ts_now());
+  out_stalls[0] = ring->push_stalls;
+  out_stalls[1] = ring->pop_stalls;
+  free(batch);
+  spsc_destroy(ring);
+  return secs;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: order and completeness across threads, tiny ring
+   ------------------------------------------------------------------------ */
+static void spsc_test_threaded(void) {
+  puts("[threaded]");
+  size_t stalls[2];
+  spsc_test_stream(4, 1u << 20, 7, stalls);
+  spsc_test_stream(1, 1u << 16, 1, stalls);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: throughput, single elements and batches
+   ------------------------------------------------------------------------ */
+static void spsc_test_perf(const uint32_t items) {
+  const uint32_t batches[] = {1, 64};
+  for (size_t b = 0; b < sizeof(batches) / sizeof(batches[0]); ++b) {
+    size_t stalls[2];
+    const double secs = spsc_test_stream(1024, items, batches[b], stalls);
+    printf("[perf] batch <= %-3u %.1f M elements/s, producer stalled %zu "
+           "times, consumer %zu times\n",
+           batches[b], items / secs / 1e6, stalls[0], stalls[1]);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   SPSC_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void spsc_tests_run_all(void) {
+  spsc_test_basic();
+  spsc_test_threaded();
+  spsc_test_perf(SPSC_TEST_ITEMS);
+  puts("all spsc tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef SPSC_TEST_MAIN
+int main(void) {
+  spsc_tests_run_all();
+  return 0;
+}
+#endif /* SPSC_TEST_MAIN */
+
+#endif /* SPSC_TEST_H */
@@ -0,0 +1,167 @@
+#ifndef MANIM_EMIT_H
+#define MANIM_EMIT_H
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/arena.h"
+#include "manim/manim_fe.h"
+
+/**
+ * ===================================
+ *          DIRECT EMISSION
+ * ===================================
+ */
+
+/**
+ * Writes the tagged <path> of a vmo straight from its subpaths and style,
+ * without going through a Cairo surface. Coordinates are mapped to pixel
+ * space with the same matrix init_cairo_ctx installs:
+ *
+ *   x' =  x * (pixel_width / frame_width)  + pixel_width / 2
+ *   y' = -y * (pixel_height / frame_height) + pixel_height / 2
+ *
+ * The mapping is applied to each vmo up front by manim_xform_vmo, so the
+ * emitter only formats coordinates that are already in pixel space.
+ *
+ * The paints come in render_vmo's order: the background stroke as a path of
+ * its own, then one path with the fill and the foreground stroke, both tagged
+ * with the vmo. Multi-stop colors reference their gradient table entry, or
+ * fall back to their first stop when no gradient cache is given.
+ */
+
+typedef struct manim_xform_t {
+  double sx, sy;
+  double tx, ty;
+} manim_xform_t;
+
+/**
+ * @brief Builds the frame to pixel space transform of a manim data file.
+ */
+static manim_xform_t manim_xform_from_header(const manim_file_header_t *file_header) {
+  const manim_xform_t xform = {
+      .sx = file_header->pixel_width / file_header->frame_width,
+      .sy = -(file_header->pixel_height / file_header->frame_height),
+      .tx = file_header->pixel_width / 2,
+      .ty = file_header->pixel_height / 2};
+  return xform;
+}
+
+/**
+ * @brief A subpath is closed when its last quad ends on its start point.
+ */
+static bool manim_subpath_is_closed(const manim_subpath_t *subpath) {
+  if (subpath->quad_count == 0)
+    return false;
+  const manim_quad_t *last = &subpath->quads[subpath->quad_count - 1];
+  return fabsf(subpath->x - last->x3) < 1e-6f &&
+         fabsf(subpath->y - last->y3) < 1e-6f;
+}
+
+/**
+ * ===================================
+ *           BULK TRANSFORM
+ * ===================================
+ */
+
+/**
+ * Maps subpath starts and quad control points to pixel space in bulk, with
+ * AVX, SSE2 or NEON (AArch64) when the build targets them and a scalar loop
+ * otherwise. Coordinates are widened to double and mapped in double, the
+ * arithmetic the emitter used to do per coordinate, so the output does not
+ * depend on the path taken.
+ */
+
+/** Doubles per vector of the transform **/
+#if defined(__AVX__)
+#define MANIM_XFORM_LANES 4
+#elif defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__))
+#define MANIM_XFORM_LANES 2
+#else
+#define MANIM_XFORM_LANES 1
+#endif
+
+/** Coordinates manim_xform_quads writes per quad: x1 y1 x2 y2 x3 y3 **/
+#define MANIM_XFORM_QUAD_COORDS 6
+
+typedef struct manim_xform_kernel_t {
+  double sx, sy;
+  double tx, ty;
+} manim_xform_kernel_t;
+
+void manim_xform_kernel_init(manim_xform_kernel_t *kernel,
+                             const manim_xform_t *xform);
+
+/**
+ * @brief Maps count quads from src to MANIM_XFORM_QUAD_COORDS doubles each
+ * in dst.
+ */
+void manim_xform_quads(const manim_xform_kernel_t *kernel, double *dst,
+                       const manim_quad_t *src, size_t count);
+
+/**
+ * @return Doubles manim_xform_vmo writes for a vmo: per subpath its start,
+ * then MANIM_XFORM_QUAD_COORDS per quad.
+ */
+static size_t manim_xform_vmo_coord_count(const manim_vmo_t *vmo) {
+  size_t count = 0;
+  for (uint32_t i = 0; i < vmo->subpath_count; i++)
+    count += 2 + MANIM_XFORM_QUAD_COORDS * (size_t)vmo->subpaths[i].quad_count;
+  return count;
+}
+
+/**
+ * @brief Maps every subpath start and quad of a vmo to pixel space. The vmo is
+ * only read, so its arrays may be shared (MANIM_INPUT_MMAP views, the
+ * reader's version 2 vmo table).
+ *
+ * @return The manim_xform_vmo_coord_count coordinates, pushed 8-byte aligned
+ * to arena, or NULL if the arena is full.
+ */
+const double *manim_xform_vmo(const manim_xform_kernel_t *kernel,
+                              const manim_vmo_t *vmo, arena_t *arena);
+
+/**
+ * @brief Maps count points of the version 3 x and y columns, interleaved the
+ * way manim_xform_vmo lays out a vmo. A vmo's points are contiguous in the
+ * columns, so this maps it without going through its quads.
+ *
+ * @return The 2 * count coordinates, pushed 8-byte aligned to arena, or NULL
+ * if the arena is full.
+ */
+const double *manim_xform_points(const manim_xform_kernel_t *kernel,
+                                 const float *xs, const float *ys,
+                                 size_t count, arena_t *arena);
+
+/**
+ * @brief Appends the tagged <path .../>\n elements of a vmo to out_arena.
+ *
+ * @param out_arena Arena the element is appended to.
+ * @param xform Frame to pixel space transform, used for the stroke widths.
+ * @param vmo Vmo to emit.
+ * @param coords Coordinates of the vmo in pixel space, from manim_xform_vmo.
+ * @param gradients Gradient cache multi-stop paints are registered with, or
+ * NULL.
+ * @return Bytes appended. 0 if the vmo has nothing visible to draw, mirroring
+ * Cairo not emitting a <path> for it.
+ */
+size_t emit_vmo_path(arena_t *out_arena, const manim_xform_t *xform,
+                     const manim_vmo_t *vmo, const double *coords,
+                     manim_gradient_cache_t *gradients);
+
+/**
+ * @brief Appends the <linearGradient> element of a multi-stop paint of a vmo.
+ *
+ * Endpoints are mapped to pixel space and the gradient uses userSpaceOnUse, so
+ * it lines up with paths emitted in pixel space. Stops are spread evenly from
+ * 0 to 1, like the Cairo pattern set_cairo_context_color builds.
+ *
+ * @return Bytes appended.
+ */
+size_t emit_gradient_def(arena_t *out_arena, const manim_xform_t *xform,
+                         const manim_vmo_t *vmo, context_color_t paint,
+                         const char *id);
+
+#endif // MANIM_EMIT_H
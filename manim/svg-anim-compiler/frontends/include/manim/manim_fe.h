@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <cairo.h>
+#include <pthread.h>
 #include <stdbool.h>
 
 
@@ -55,8 +56,70 @@
  *   [FRAM]
  *   ...
  *   [FRAM]
+ *
+ * The file header's version selects the record encoding. Version 1 is the
+ * layout above, every record a packed struct with its magic. Version 2 drops
+ * the record magics and packs coordinates as varints:
+ *
+ * [CTXT] version 2
+ * [manim_file_header_v2_t]
+ *  [FRAM] vmo_count, payload_size, then payload_size bytes of:
+ *    per vmo:
+ *      f32 stroke_bg_width, stroke_width
+ *      f32 gradient_x0, gradient_y0, gradient_x1, gradient_y1
+ *      varint id, stroke_bg_rgbas_count, stroke_rgbas_count,
+ *             fill_rgbas_count, subpath_count
+ *      f32 x 4 per RGBA (stroke background, stroke, fill)
+ *      per subpath:
+ *        varint quad_count
+ *        zigzag varint x, y
+ *        zigzag varint x1, y1, x2, y2, x3, y3 per quad
+ *
+ * Coordinates are quantized to round(v * coord_scale) and each point is stored
+ * as the difference to the point before it in the vmo (subpath start, then
+ * the quad control points in order). The first point of a vmo is relative to
+ * (0, 0). Varints are LEB128, 7 bits per byte, low group first.
+ *
+ * Version 2 frames after the first may be deltas against the frame before:
+ *
+ *  [FDLT] vmo_count, payload_size, then payload_size bytes of:
+ *    varint removed_count, removed ids
+ *    vmo_count vmo records as above, the changed and new vmos
+ *
+ * A changed vmo replaces the vmo with its id in place, new ones are appended
+ * in record order after the vmos kept from the frame before. Deltas are only
+ * written when ids are unique within the frame, and a full [FRAM] key frame
+ * is written every so often so seeking replays a bounded number of deltas.
+ *
+ * Version 3 stores each frame as columns, one contiguous array per field:
+ *
+ * [CTXT] version 3, zero padded to MANIM_COLUMN_ALIGN
+ *  [FRAM] manim_frame_v3_header_t, zero padded to MANIM_COLUMN_ALIGN
+ *    u32 id[vmo_count]
+ *    f32 stroke_bg_width[vmo_count]
+ *    f32 stroke_width[vmo_count]
+ *    f32 gradient[vmo_count][4]              x0, y0, x1, y1
+ *    u32 stroke_bg_rgbas_count[vmo_count]
+ *    u32 stroke_rgbas_count[vmo_count]
+ *    u32 fill_rgbas_count[vmo_count]
+ *    u32 subpath_count[vmo_count]
+ *    f32 rgba[rgba_count][4]                 vmo order, stroke bg/stroke/fill
+ *    u32 quad_count[subpath_count]
+ *    f32 x[point_count]
+ *    f32 y[point_count]
+ *
+ * Every column is zero padded to MANIM_COLUMN_ALIGN bytes, so all of them
+ * start aligned in the file. A subpath contributes its start point followed
+ * by the three control points of each quad to x and y.
  */
 
+#define MANIM_DATA_VERSION_1 1
+#define MANIM_DATA_VERSION_2 2
+#define MANIM_DATA_VERSION_3 3
+
+/** Alignment of version 3 columns, in the file and in memory **/
+#define MANIM_COLUMN_ALIGN 64
+
 typedef struct {
   char magic[4]; /** RGBA **/
   float vals[4];
@@ -108,6 +171,12 @@ typedef struct {
   char magic[4]; /** FRAM **/
   uint32_t vmo_count;
   manim_vmo_t *vmos;
+  /** Per vmo, whether it changed since the frame the reader returned before.
+   * NULL when every vmo is to be treated as changed **/
+  bool *vmo_dirty;
+  /** Version 3: the columns the frame was built from, valid as long as the
+   * frame. NULL for other versions **/
+  const struct manim_frame_columns_t *columns;
 } manim_frame_t;
 
 typedef struct {
@@ -117,6 +186,29 @@ typedef struct {
   double frame_width, frame_height;
 } manim_file_header_t;
 
+/** Follows manim_file_header_t in version 2 files **/
+typedef struct {
+  /** Quantization steps per frame unit, a power of two **/
+  float coord_scale;
+} manim_file_header_v2_t;
+
+/** Version 2 frame header, the payload is skipped without decoding it **/
+typedef struct {
+  char magic[4]; /** FRAM or FDLT **/
+  uint32_t vmo_count;
+  uint32_t payload_size;
+} manim_frame_v2_header_t;
+
+/** Version 3 frame header, payload_size covers the padded columns **/
+typedef struct {
+  char magic[4]; /** FRAM **/
+  uint32_t vmo_count;
+  uint32_t rgba_count;
+  uint32_t subpath_count;
+  uint32_t point_count;
+  uint32_t payload_size;
+} manim_frame_v3_header_t;
+
 #pragma pack(pop)
 
 /**
@@ -125,10 +217,221 @@ typedef struct {
  * ===================================
  */
 
+/**
+ * @brief A version 3 frame as structure-of-arrays.
+ *
+ * Every column starts MANIM_COLUMN_ALIGN aligned, see the version 3 layout
+ * above. Columns either live in the frame arena or point into the mapping.
+ */
+typedef struct manim_frame_columns_t {
+  uint32_t vmo_count;
+  uint32_t rgba_count;
+  uint32_t subpath_count;
+  uint32_t point_count;
+
+  /** Per vmo **/
+  const uint32_t *ids;
+  const float *stroke_bg_widths;
+  const float *stroke_widths;
+  const float *gradients;
+  const uint32_t *stroke_bg_rgbas_counts;
+  const uint32_t *stroke_rgbas_counts;
+  const uint32_t *fill_rgbas_counts;
+  const uint32_t *subpath_counts;
+
+  /** Per RGBA, 4 floats each **/
+  const float *rgbas;
+
+  /** Per subpath **/
+  const uint32_t *quad_counts;
+
+  /** Per point **/
+  const float *xs;
+  const float *ys;
+} manim_frame_columns_t;
+
 int read_header(FILE *fp, manim_file_header_t *file_header);
 int read_frame(arena_t *frame_arena, FILE *fp, manim_frame_t *frame);
 void free_frame(const manim_frame_t *frame);
 
+/**
+ * Input modes for the manim data reader.
+ *
+ * MANIM_INPUT_STREAM reads the file with buffered fread and copies every
+ * record into the frame arena.
+ *
+ * MANIM_INPUT_MMAP maps the whole file read-only. Decoding a version 1 frame
+ * only builds the vmo/subpath headers in the frame arena, the RGBA and quad
+ * arrays of the returned frame point straight into the mapping and are never
+ * copied. The views stay valid until the reader is closed. Version 2 frames
+ * are decoded into the reader's vmo table, their arrays are shared with the
+ * table and must not be written to either.
+ *
+ * MANIM_INPUT_RING reads like MANIM_INPUT_STREAM from a live ingest ring the
+ * exporter is still writing to, see manim_ring.h. The path names the ring.
+ * Frames arrive strictly in order, so the input cannot be indexed.
+ *
+ * MANIM_INPUT_URING reads like MANIM_INPUT_STREAM, with the upcoming chunks of
+ * the file read ahead through io_uring, see manim_io.h. Falls back to plain
+ * stdio where io_uring is unavailable.
+ */
+typedef enum manim_input_mode_e {
+  MANIM_INPUT_STREAM,
+  MANIM_INPUT_MMAP,
+  MANIM_INPUT_RING,
+  MANIM_INPUT_URING
+} manim_input_mode_e;
+
+/** Garbage bytes the vmo table tolerates before compacting its data **/
+#define MANIM_VMO_TABLE_COMPACT_MIN (1 << 20)
+
+/**
+ * @brief The vmos of the last version 2 frame, kept by the reader so delta
+ * frames can be applied to them.
+ *
+ * vmos are kept in frame order in vmo_arena, with index mapping an id to its
+ * position. Every frame applied bumps serial, and a vmo's entry in
+ * serial_arena records the frame it last changed in. Replaced and removed
+ * vmos leave their arrays behind in data_arena, which are dropped by copying
+ * the live ones into spare_arena once they make up most of it.
+ */
+typedef struct manim_vmo_table_t {
+  struct map_t *index;
+  arena_t *vmo_arena;
+  arena_t *serial_arena;
+  arena_t *data_arena;
+  arena_t *spare_arena;
+
+  uint32_t vmo_count;
+  uint64_t serial;
+  size_t garbage_bytes;
+  /** Cleared by a key frame with repeated ids, deltas cannot address them **/
+  bool ids_unique;
+} manim_vmo_table_t;
+
+int manim_vmo_table_init(manim_vmo_table_t *table);
+void manim_vmo_table_release(manim_vmo_table_t *table);
+
+typedef struct manim_reader_t {
+  manim_input_mode_e mode;
+  manim_file_header_t header;
+
+  /** Version 2: frame units per quantization step, 1 / coord_scale **/
+  double coord_unit;
+  manim_vmo_table_t vmo_table;
+  /** Frames decoded into the table before the next one is returned, set by
+   * a seek past a key frame **/
+  size_t replay_frames;
+  /** A frame was returned since the reader was opened or seeked, dirty flags
+   * are relative to it **/
+  bool frame_returned;
+  /** The last manim_reader_next_frame found the end of the input, not a
+   * malformed frame **/
+  bool at_end;
+
+  /** MANIM_INPUT_STREAM, MANIM_INPUT_RING and MANIM_INPUT_URING **/
+  FILE *fp;
+
+  /** MANIM_INPUT_MMAP **/
+  const unsigned char *map_base;
+  size_t map_size;
+  size_t map_pos;
+} manim_reader_t;
+
+/**
+ * @brief Opens a manim data binary and reads its file header.
+ *
+ * @param reader Reader to initialize.
+ * @param file_path Input manim data binary.
+ * @param mode How frames are pulled from the file.
+ * @return 1 on success, 0 if the file could not be opened, mapped or the
+ * header is malformed.
+ */
+int manim_reader_open(manim_reader_t *reader, const char *file_path,
+                      manim_input_mode_e mode);
+
+/**
+ * @brief Opens a reader over an already open stream, positioned at the file
+ * header, as MANIM_INPUT_STREAM. The reader takes ownership of fp.
+ *
+ * @return 1 on success, 0 if the header is malformed.
+ */
+int manim_reader_open_stream(manim_reader_t *reader, FILE *fp);
+
+/**
+ * @brief Decodes the next frame from the reader.
+ *
+ * @param reader Open reader.
+ * @param frame_arena Arena for the frame's vmo/subpath headers (and, in
+ * stream mode, its RGBA and quad arrays).
+ * @param frame Output frame.
+ * @return 1 if a frame was decoded, 0 at end of input (at_end is set) or on
+ * a malformed frame.
+ */
+int manim_reader_next_frame(manim_reader_t *reader, arena_t *frame_arena,
+                            manim_frame_t *frame);
+
+/**
+ * @brief Reads the next version 3 frame as columns, one read per column in
+ * stream mode, views into the mapping in mmap mode.
+ *
+ * @return 1 if a frame was read, 0 at end of input or on a malformed frame.
+ */
+int manim_reader_next_frame_columns(manim_reader_t *reader,
+                                    arena_t *frame_arena,
+                                    manim_frame_columns_t *columns);
+
+/**
+ * @brief Builds the nested frame the renderers take from its columns.
+ */
+void manim_frame_from_columns(arena_t *frame_arena,
+                              const manim_frame_columns_t *columns,
+                              manim_frame_t *frame);
+
+void manim_reader_close(manim_reader_t *reader);
+
+int read_frame_mapped(arena_t *frame_arena, const unsigned char *base,
+                      size_t size, size_t *pos, manim_frame_t *frame);
+
+/**
+ * @brief Byte offset of every frame in a manim data binary.
+ *
+ * Version 1 frame sizes are only known after walking every nested record, so
+ * the index is built by one pre-scan pass that reads the record headers and
+ * skips over the RGBA and quad arrays. Version 2 frames are skipped by their
+ * payload size. With it, any frame can be decoded without decoding
+ * the frames before it, except version 2 deltas, which are replayed from the
+ * key frame before them.
+ */
+typedef struct manim_frame_index_t {
+  size_t num_frames;
+  uint64_t *offsets;
+  /** Per frame, the number of the key frame it is decoded from **/
+  uint64_t *key_frames;
+} manim_frame_index_t;
+
+/**
+ * @brief Pre-scans the reader's input and records the offset of every frame.
+ *
+ * The reader is left positioned at the first frame.
+ *
+ * @param reader Open reader, positioned at the first frame.
+ * @param index_arena Arena for the offsets and key frame arrays.
+ * @param index Output frame index.
+ * @return 1 on success, 0 if the input could not be scanned or a frame is
+ * malformed.
+ */
+int manim_reader_build_index(manim_reader_t *reader, arena_t *index_arena,
+                             manim_frame_index_t *index);
+
+/**
+ * @brief Positions the reader so the next decoded frame is frame_num.
+ *
+ * @return 1 on success, 0 if frame_num is out of range.
+ */
+int manim_reader_seek_frame(manim_reader_t *reader,
+                            const manim_frame_index_t *index, size_t frame_num);
+
 /**
  * ===================================
  *             SVG RENDERING
@@ -137,31 +440,585 @@ void free_frame(const manim_frame_t *frame);
 
 typedef enum context_color_t { C_FILL, C_STROKE, C_STROKE_BG } context_color_t;
 
+/**
+ * @brief RGBA stops of one of the paints of a vmo.
+ */
+static const manim_rgba_t *manim_vmo_paint(const manim_vmo_t *vmo,
+                                           const context_color_t paint,
+                                           uint32_t *out_count) {
+  switch (paint) {
+  case C_FILL:
+    *out_count = vmo->fill_rgbas_count;
+    return vmo->fill_rgbas;
+  case C_STROKE:
+    *out_count = vmo->stroke_rgbas_count;
+    return vmo->stroke_rgbas;
+  case C_STROKE_BG:
+    *out_count = vmo->stroke_bg_rgbas_count;
+    return vmo->stroke_bg_rgbas;
+  }
+  *out_count = 0;
+  return NULL;
+}
+
+/**
+ * ===================================
+ *              GRADIENTS
+ * ===================================
+ */
+
+/**
+ * Paints with more than one stop are linear gradients between the gradient
+ * endpoints of the vmo. A gradient is identified by a hash of its stops and
+ * endpoints and referenced from paths as url(#mg<32 hex digits>). The id is
+ * two hashes of the content under different seeds, so every thread derives
+ * the same id for the same gradient without coordination, and gradients whose
+ * first hash collides are told apart by the second, whichever registers first.
+ * A hash match is only trusted once the stops and endpoints compare equal;
+ * only gradients colliding in both hashes fall back to the next free id.
+ *
+ * The gradient table holds one <linearGradient> per unique gradient of the
+ * run, emitted once as the shared <defs> of all frames, ordered by first use.
+ *
+ * Every worker keeps a gradient cache in front of the table. It owns the Cairo
+ * pattern of each gradient the worker has seen, so patterns are built once and
+ * reused across vmos and frames, and the table lock is only taken the first
+ * time a worker meets a gradient.
+ */
+
+/** "mg" + 32 hex digits + '\0' **/
+#define MANIM_GRADIENT_ID_SIZE 35
+
+/**
+ * @brief What a gradient is compared by on a hash match. The stops are copied
+ * to the stop arena of the table or cache holding the key.
+ */
+typedef struct manim_gradient_key_t {
+  float endpoints[4];
+  uint32_t stop_count;
+  /** Index of the first stop in the owner's stop arena, in manim_rgba_t **/
+  size_t stop_offset;
+} manim_gradient_key_t;
+
+typedef struct manim_gradient_entry_t {
+  /** Hash of the content **/
+  uint64_t hash;
+  /** Second hash of the content, unless both collided with another entry **/
+  uint64_t tag;
+  manim_gradient_key_t key;
+  /** Smallest manim_gradient_use key the gradient was registered with **/
+  uint64_t first_use;
+  size_t def_offset;
+  size_t def_length;
+  /** Next entry sharing the low 32 bits of the hash, or UINT32_MAX **/
+  uint32_t next;
+} manim_gradient_entry_t;
+
+typedef struct manim_gradient_table_t {
+  pthread_mutex_t lock;
+  /** Gradient endpoints are mapped to pixel space like the paths **/
+  manim_file_header_t file_header;
+
+  /** Low 32 bits of the hash -> index of the first entry of its chain **/
+  struct map_t *heads;
+  arena_t *entry_arena;
+  size_t entry_count;
+  arena_t *stop_arena;
+
+  /** <linearGradient> elements, one per entry **/
+  arena_t *def_arena;
+} manim_gradient_table_t;
+
+typedef struct manim_gradient_slot_t {
+  uint64_t hash;
+  /** Tag the table gave the gradient **/
+  uint64_t tag;
+  /** Earliest use this cache registered the gradient with the table at **/
+  uint64_t first_use;
+  manim_gradient_key_t key;
+  cairo_pattern_t *pattern;
+  uint32_t next;
+} manim_gradient_slot_t;
+
+typedef struct manim_gradient_cache_t {
+  manim_gradient_table_t *table;
+
+  /** Position the next lookups are registered at, see manim_gradient_use **/
+  uint64_t use;
+
+  /** Low 32 bits of the hash -> index of the first slot of its chain **/
+  struct map_t *heads;
+  arena_t *slot_arena;
+  size_t slot_count;
+  arena_t *stop_arena;
+} manim_gradient_cache_t;
+
+/**
+ * @brief Orders gradient registrations by frame, then by vmo within the frame.
+ */
+static uint64_t manim_gradient_use(const size_t frame_num,
+                                   const uint32_t vmo_index) {
+  return (uint64_t)frame_num << 32 | (uint64_t)vmo_index << 2;
+}
+
+uint64_t manim_gradient_hash(const manim_vmo_t *vmo, context_color_t paint);
+
+/**
+ * @brief Second hash of a paint, under another seed than manim_gradient_hash.
+ */
+uint64_t manim_gradient_tag(const manim_vmo_t *vmo, context_color_t paint);
+
+void manim_gradient_id(uint64_t hash, uint64_t tag,
+                       char id[MANIM_GRADIENT_ID_SIZE]);
+
+/**
+ * @brief Builds the Cairo pattern of a multi-stop paint, stops spread evenly
+ * from 0 to 1. The caller owns the returned pattern.
+ */
+cairo_pattern_t *manim_gradient_create_pattern(const manim_vmo_t *vmo,
+                                               context_color_t paint);
+
+int manim_gradient_table_init(manim_gradient_table_t *table,
+                              const manim_file_header_t *file_header);
+void manim_gradient_table_release(manim_gradient_table_t *table);
+
+/**
+ * @brief Appends <defs> with every registered gradient, in order of first use.
+ *
+ * @return Bytes appended, 0 if no gradient was registered.
+ */
+size_t manim_gradient_table_emit_defs(manim_gradient_table_t *table,
+                                      arena_t *out_arena);
+
+int manim_gradient_cache_init(manim_gradient_cache_t *cache,
+                              manim_gradient_table_t *table);
+void manim_gradient_cache_release(manim_gradient_cache_t *cache);
+
+/**
+ * @brief Registers the gradient of a multi-stop paint and writes its id.
+ */
+void manim_gradient_cache_ref(manim_gradient_cache_t *cache,
+                              const manim_vmo_t *vmo, context_color_t paint,
+                              char id[MANIM_GRADIENT_ID_SIZE]);
+
+/**
+ * @brief Registers the gradient of a multi-stop paint and returns its Cairo
+ * pattern, built on first use. The pattern is owned by the cache.
+ *
+ * @return NULL if memory ran out.
+ */
+cairo_pattern_t *manim_gradient_cache_pattern(manim_gradient_cache_t *cache,
+                                              const manim_vmo_t *vmo,
+                                              context_color_t paint);
+
 int init_cairo_ctx(cairo_t *ctx, const manim_file_header_t *file_header);
 
-int render_vmo(cairo_t *ctx, const manim_vmo_t *vmo);
+int render_vmo(cairo_t *ctx, const manim_vmo_t *vmo,
+               manim_gradient_cache_t *gradients);
 
 cairo_status_t cairo_buffer_writer(void *closure, const unsigned char *data,
                              unsigned int length);
 
+/**
+ * @brief Streaming state of cairo_path_stream_writer.
+ *
+ * Instead of buffering Cairo's whole svg document, the writer recognises
+ * <path .../> elements as the bytes arrive and copies only those, once,
+ * straight into svg_out_arena. The first path of every vmo is kept with a
+ * data-tag attribute, every other byte is discarded. When a marker is given,
+ * paths equal to it advance to the next vmo (see
+ * MANIM_CAIRO_SURFACE_PER_FRAME).
+ *
+ * Nothing else may push to svg_out_arena while the stream is in use.
+ */
+typedef struct cairo_path_stream_t {
+  arena_t *svg_out_arena;
+
+  const manim_vmo_t *vmos;
+  uint32_t vmo_count;
+  uint32_t vmo_index;
+  bool vmo_emitted;
+
+  const char *marker;
+  size_t marker_length;
+
+  /** When set, Cairo's gradient references are rewritten to the ids of this
+   * cache **/
+  manim_gradient_cache_t *gradients;
+
+  /** When set, receives the range each vmo's path was appended at, length 0
+   * if Cairo emitted none for it. Must be zeroed by the caller. **/
+  svg_record_t *vmo_records;
+
+  /** Scanner state, carried across writes **/
+  bool in_element;
+  size_t open_matched;
+  size_t element_offset;
+
+  /** Bytes appended to svg_out_arena **/
+  size_t svg_length;
+} cairo_path_stream_t;
+
+void cairo_path_stream_init(cairo_path_stream_t *stream,
+                            arena_t *svg_out_arena, const manim_vmo_t *vmos,
+                            uint32_t vmo_count, const char *marker,
+                            size_t marker_length);
+
+cairo_status_t cairo_path_stream_writer(void *closure,
+                                        const unsigned char *data,
+                                        unsigned int length);
+
+/**
+ * @brief Sets the source of ctx to one of the paints of a vmo. Gradients come
+ * from the gradient cache; without one, a pattern is built for the call.
+ */
 void set_cairo_context_color(cairo_t *ctx, const manim_vmo_t *vmo,
-                             context_color_t context_color_type);
+                             context_color_t context_color_type,
+                             manim_gradient_cache_t *gradients);
+
+void apply_stroke(cairo_t *ctx, const manim_vmo_t *vmo, bool background,
+                  manim_gradient_cache_t *gradients);
+
+void apply_fill(cairo_t *ctx, const manim_vmo_t *vmo,
+                manim_gradient_cache_t *gradients);
+
+/**
+ * ===================================
+ *          FRAME RENDERING
+ * ===================================
+ */
+
+/**
+ * MANIM_RENDERER_CAIRO renders every vmo through a Cairo SVG surface and
+ * scrapes the <path> back out. It is the reference output.
+ *
+ * MANIM_RENDERER_DIRECT writes the <path> straight from the vmo, see
+ * manim/manim_emit.h. No Cairo surface is created.
+ */
+typedef enum manim_renderer_e {
+  MANIM_RENDERER_CAIRO,
+  MANIM_RENDERER_DIRECT
+} manim_renderer_e;
+
+/**
+ * MANIM_CAIRO_SURFACE_PER_VMO creates, initializes and destroys a Cairo SVG
+ * surface for every vmo.
+ *
+ * MANIM_CAIRO_SURFACE_PER_FRAME renders all vmos of a frame onto one surface,
+ * each followed by a marker element, and splits the flushed document back into
+ * per-vmo paths on the markers. Surface setup and teardown is paid once per
+ * frame instead of once per vmo.
+ */
+typedef enum manim_cairo_surface_mode_e {
+  MANIM_CAIRO_SURFACE_PER_VMO,
+  MANIM_CAIRO_SURFACE_PER_FRAME
+} manim_cairo_surface_mode_e;
+
+/**
+ * ===================================
+ *            RENDER CACHE
+ * ===================================
+ */
+
+/**
+ * Most vmos are byte-identical from one frame to the next. The render cache
+ * maps a hash of everything a vmo's path is rendered from (id, style, RGBA
+ * arrays, subpaths and quads) to the tagged <path> bytes it rendered to, so an
+ * unchanged vmo is copied instead of rendered.
+ *
+ * Entries live for two frames: a lookup searches the current and the previous
+ * frame, and a hit from the previous frame is carried over into the current
+ * one. Memory stays bounded by two frames of paths however long the scene is.
+ *
+ * Entries are found by a 64-bit hash of the vmo data. A hit is only taken if
+ * the length of the data and a second, independently seeded hash of it match
+ * as well.
+ */
+
+typedef struct manim_vmo_key_t {
+  uint64_t hash;
+  /** Hash of the same bytes from another seed, compared on a hit **/
+  uint64_t check;
+  /** Bytes hashed **/
+  size_t length;
+} manim_vmo_key_t;
+
+typedef struct manim_render_cache_entry_t {
+  manim_vmo_key_t key;
+  size_t offset;
+  size_t length;
+  /** Next entry sharing the low 32 bits of the hash, or UINT32_MAX **/
+  uint32_t next;
+} manim_render_cache_entry_t;
+
+typedef struct manim_render_cache_gen_t {
+  /** Low 32 bits of the hash -> index of the first entry of its chain **/
+  struct map_t *heads;
+  arena_t *entry_arena;
+  arena_t *svg_arena;
+  size_t entry_count;
+} manim_render_cache_gen_t;
+
+typedef struct manim_render_cache_t {
+  manim_render_cache_gen_t current;
+  manim_render_cache_gen_t previous;
+
+  size_t hits;
+  size_t lookups;
+} manim_render_cache_t;
+
+manim_vmo_key_t manim_vmo_key(const manim_vmo_t *vmo);
+
+int manim_render_cache_init(manim_render_cache_t *cache);
+void manim_render_cache_release(manim_render_cache_t *cache);
+
+/**
+ * @brief Appends the cached path of a vmo to svg_out_arena.
+ *
+ * @return true on a hit, with the appended length in out_length (0 for a vmo
+ * Cairo emits nothing for).
+ */
+bool manim_render_cache_get(manim_render_cache_t *cache,
+                            const manim_vmo_key_t *key,
+                            arena_t *svg_out_arena, size_t *out_length);
+
+void manim_render_cache_put(manim_render_cache_t *cache,
+                            const manim_vmo_key_t *key,
+                            const void *svg, size_t length);
+
+/**
+ * @brief Ages the cache by one frame, dropping what the previous frame did not
+ * reuse.
+ */
+void manim_render_cache_next_frame(manim_render_cache_t *cache);
+
+/**
+ * @brief Drops every entry, for a frame that does not follow the last one.
+ */
+void manim_render_cache_clear(manim_render_cache_t *cache);
+
+/**
+ * @brief Scratch state for rendering frames. One per thread, nothing in it is
+ * shared.
+ */
+typedef struct manim_fe_worker_t {
+  manim_renderer_e renderer;
+  manim_cairo_surface_mode_e cairo_surface_mode;
+
+  /** <path/> Cairo emits for the per-frame surface marker, calibrated on first
+   * use **/
+  char *cairo_marker;
+  size_t cairo_marker_length;
+
+  arena_t *scratch_manim_frame_arena;
+  arena_t *scratch_cairo_svg_arena;
+
+  manim_gradient_cache_t gradients;
+
+  bool use_render_cache;
+  manim_render_cache_t render_cache;
+  /** Frame following the last one rendered, the cache is only kept for it **/
+  size_t next_frame_num;
+  /** vmo id -> render cache key taken the last frame, reused for the vmos a
+   * delta frame did not change **/
+  struct map_t *vmo_keys;
+
+  double perf_surface_destroy_cum_time;
+} manim_fe_worker_t;
+
+/**
+ * @param worker Worker to initialize.
+ * @param gradient_table Table the worker registers gradients with, shared by
+ * all workers of a run.
+ */
+int manim_fe_worker_init(manim_fe_worker_t *worker,
+                         manim_gradient_table_t *gradient_table);
+void manim_fe_worker_release(manim_fe_worker_t *worker);
+
+/**
+ * @brief Renders one decoded frame to a tagged svg document.
+ *
+ * @param worker Scratch state of the calling thread.
+ * @param file_header Header of the file the frame was decoded from.
+ * @param frame_num Number of the frame in the file.
+ * @param manim_frame Frame to render.
+ * @param svg_out_arena Arena the svg document is appended to.
+ * @return Length in bytes of the appended svg document.
+ */
+size_t manim_fe_render_frame(manim_fe_worker_t *worker,
+                             const manim_file_header_t *file_header,
+                             size_t frame_num, const manim_frame_t *manim_frame,
+                             arena_t *svg_out_arena);
+
+/**
+ * ===================================
+ *              DRIVER
+ * ===================================
+ */
+
+#define MANIM_FE_FRAME_END SIZE_MAX
+
+/** Frames each thread renders per batch of the threaded driver **/
+#define MANIM_FE_THREAD_BATCH_FRAMES 16
 
-void apply_stroke(cairo_t *ctx, const manim_vmo_t *vmo, bool background);
+/** Frames in flight between two stages of the pipelined driver **/
+#define MANIM_FE_PIPELINE_SLOTS 4
+
+typedef struct manim_fe_opts_t {
+  manim_input_mode_e input_mode;
+  manim_renderer_e renderer;
+  manim_cairo_surface_mode_e cairo_surface_mode;
+
+  /** Reuse the paths of vmos unchanged since the previous frame **/
+  bool render_cache;
+
+  /** Threads rendering whole frames. With more than one thread, frames are
+   * rendered in batches and committed in frame order. **/
+  size_t num_threads;
+
+  /** Decode, render and hand frames to the sink on three threads connected
+   * by rings, so the stages overlap. Single-threaded rendering only. **/
+  bool pipeline;
+
+  /** Inclusive range of frames to emit. Anything other than the full range
+   * builds a frame index and seeks straight to frame_begin. **/
+  size_t frame_begin;
+  size_t frame_end;
+} manim_fe_opts_t;
+
+/**
+ * @brief Default frontend options: buffered stream input, Cairo renderer with
+ * a surface per vmo, render cache on, single thread, all frames.
+ */
+static manim_fe_opts_t manim_fe_opts_default(void) {
+  const manim_fe_opts_t opts = {.input_mode = MANIM_INPUT_STREAM,
+                                .renderer = MANIM_RENDERER_CAIRO,
+                                .cairo_surface_mode =
+                                    MANIM_CAIRO_SURFACE_PER_VMO,
+                                .render_cache = true,
+                                .num_threads = 1,
+                                .pipeline = false,
+                                .frame_begin = 0,
+                                .frame_end = MANIM_FE_FRAME_END};
+  return opts;
+}
 
-void apply_fill(cairo_t *ctx, const manim_vmo_t *vmo);
+/**
+ * @brief Receives the svg frames of a run one at a time, in frame order. The
+ * driver renders each frame into svg_arena and hands over its offset and
+ * length. A sink that consumes frames as they arrive clears svg_arena once it
+ * is done with one, so only a frame (or a batch, when threaded) is ever held.
+ */
+typedef struct manim_fe_sink_t {
+  arena_t *svg_arena;
+  void *ctx;
+
+  /** Called once per frame. Anything but success stops the run. **/
+  SvgAnimStatus (*frame)(void *ctx, size_t frame_num, size_t offset,
+                         size_t length);
+  /** Called once after the last frame with the <defs> of the gradients the
+   * frames reference. May be NULL, the defs are then not emitted. **/
+  SvgAnimStatus (*defs)(void *ctx, size_t offset, size_t length);
+} manim_fe_sink_t;
+
+/**
+ * @brief Ingests a data binary from the manim-fast-svg plugin and passes each
+ * tagged svg frame to sink as soon as it is rendered.
+ *
+ * @param file_path Input manim data binary to process.
+ * @param opts Frontend options.
+ * @param sink Consumer of the frames.
+ * @param out_num_frames Frames passed to the sink.
+ * @return 0 on success.
+ */
+int manim_fe_stream(const char *file_path, const manim_fe_opts_t *opts,
+                    const manim_fe_sink_t *sink, size_t *out_num_frames);
+
+/**
+ * ===================================
+ *        FRAME PUSH SESSION
+ * ===================================
+ */
+
+/**
+ * @brief Renders frames handed over from memory one at a time, for callers
+ * embedding the compiler instead of writing a data binary (see svganim.h).
+ *
+ * The bytes are the ones the exporter writes to a data binary. Open takes the
+ * file header (version 2 followed by manim_file_header_v2_t, version 3 padded
+ * to MANIM_COLUMN_ALIGN) and every push exactly one frame. Delta frames apply
+ * to the frames pushed before them. Frames are rendered on the calling thread
+ * as they are pushed, input_mode, num_threads, pipeline and the frame range
+ * of opts do not apply.
+ *
+ * The worker holds a pointer to gradient_table, a session must not be moved
+ * while open.
+ */
+typedef struct manim_fe_session_t {
+  manim_fe_opts_t opts;
+  manim_fe_sink_t sink;
+  manim_reader_t reader;
+  manim_gradient_table_t gradient_table;
+  manim_fe_worker_t worker;
+
+  /** Bytes the reader's FILE serves, the header then each pushed frame **/
+  const unsigned char *input;
+  size_t input_size;
+  size_t input_pos;
+
+  /** Frames passed to the sink **/
+  size_t num_frames;
+  /** Last status of the sink **/
+  SvgAnimStatus sink_status;
+  bool open;
+  bool finished;
+  /** A frame was malformed or the sink failed, no more frames are taken **/
+  bool failed;
+} manim_fe_session_t;
+
+/**
+ * @param header File header, only read during the call.
+ * @return 1 on success, 0 if the header is malformed or truncated, or the
+ * platform has no FILE over callbacks (see common/cookie.h).
+ */
+int manim_fe_session_open(manim_fe_session_t *session, const void *header,
+                          size_t header_size, const manim_fe_opts_t *opts,
+                          const manim_fe_sink_t *sink);
+
+/**
+ * @brief Decodes and renders one frame and passes it to the sink.
+ *
+ * @param frame One frame record, only read during the call.
+ * @return 1 on success, 0 if the frame is malformed, has trailing bytes, the
+ * sink failed (see sink_status), or an earlier push failed or finish was
+ * called.
+ */
+int manim_fe_session_push(manim_fe_session_t *session, const void *frame,
+                          size_t frame_size);
+
+/**
+ * @brief Ends the frames and passes the gradient <defs> to the sink.
+ *
+ * @return 1 on success, 0 if the sink failed or the session already finished.
+ */
+int manim_fe_session_finish(manim_fe_session_t *session);
+void manim_fe_session_close(manim_fe_session_t *session);
 
 /**
  *  @brief Ingests a data binary from the manim-fast-svg plugin and emits a
- *  sequence of svg frames with data-tag ids appended to each <path>.
+ *  sequence of svg frames with data-tag ids appended to each <path>. Gradients
+ *  referenced by the frames are emitted once, into out_svg_frames->defs.
  *
  * @param svg_frames_blob_arena Arena for svg blobs.
  * @param svg_frames_record_arena Arena for svg records.
  * @param file_path Input manim data binary to process.
+ * @param opts Frontend options.
  * @param out_svg_frames Output tagged svg frames.
- * @return
+ * @return 0 on success.
+ * @note Holds every frame until the run ends, see manim_fe_stream for a run
+ * whose memory does not grow with the frame count.
  */
 int manim_fe_driver(arena_t *svg_frames_blob_arena, arena_t *svg_frames_record_arena, const char *file_path,
-                    svg_frames_t **out_svg_frames);
+                    const manim_fe_opts_t *opts, svg_frames_t **out_svg_frames);
 
 #endif // MANIM_FE_H
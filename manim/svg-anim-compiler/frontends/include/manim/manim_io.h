@@ -0,0 +1,78 @@
+#ifndef MANIM_IO_H
+#define MANIM_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * ===================================
+ *          ASYNC FILE I/O
+ * ===================================
+ */
+
+/**
+ * File input and output through Linux io_uring, so reads and writes are in
+ * flight while the compiler decodes and renders.
+ *
+ * The reader keeps MANIM_IO_READ_AHEAD chunks of the file in flight ahead of
+ * the read position. A read waits only for the chunk it needs, and a chunk
+ * that has been read past is resubmitted for the next window position. A seek
+ * within the window keeps it, any other seek drains it and starts over.
+ *
+ * The writer copies output into MANIM_IO_WRITE_BUFFERS buffers and submits
+ * each as one write once it is full, so many small outputs go to the kernel
+ * as a few large writes while the next buffer fills.
+ *
+ * Where io_uring is unavailable (not Linux, kernel without it, seccomp) both
+ * fall back to stdio, with the same interface.
+ */
+
+#define MANIM_IO_CHUNK_SIZE (1u << 20)
+#define MANIM_IO_READ_AHEAD 4
+
+#define MANIM_IO_WRITE_BUFFER_SIZE (1u << 20)
+#define MANIM_IO_WRITE_BUFFERS 4
+
+/**
+ * @return Whether io_uring works in this process, probed once.
+ */
+bool manim_io_uring_available(void);
+
+/**
+ * @brief Opens a regular file as a read-only FILE read ahead through
+ * io_uring. Falls back to fopen if io_uring is unavailable or the path is
+ * not a regular file. fclose releases everything.
+ *
+ * @return The FILE, or NULL if the file could not be opened.
+ */
+FILE *manim_io_fopen_read(const char *path);
+
+typedef struct manim_io_writer_t manim_io_writer_t;
+
+/**
+ * @brief Creates or truncates path for writing.
+ *
+ * @param use_uring Write through io_uring if available, stdio otherwise.
+ * @return The writer, or NULL if the file could not be created.
+ */
+manim_io_writer_t *manim_io_writer_open(const char *path, bool use_uring);
+
+/**
+ * @brief Appends size bytes. They may reach the file only when the writer is
+ * closed.
+ *
+ * @return 1 on success, 0 once a write has failed.
+ */
+int manim_io_writer_write(manim_io_writer_t *writer, const void *data,
+                          size_t size);
+
+/**
+ * @brief Writes what is buffered, waits for all writes and closes the file.
+ *
+ * @return 1 if every write succeeded, 0 otherwise.
+ */
+int manim_io_writer_close(manim_io_writer_t *writer);
+
+#endif // MANIM_IO_H
@@ -0,0 +1,134 @@
+#ifndef MANIM_RING_H
+#define MANIM_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * ===================================
+ *          LIVE INGEST RING
+ * ===================================
+ */
+
+/**
+ * A single producer, single consumer byte ring in shared memory. The exporter
+ * writes the exact bytes it would otherwise write to the data file, and the
+ * frontend decodes them while manim is still rendering, so the two stages
+ * overlap and memory stays bounded by the ring's capacity.
+ *
+ * Layout of the shared object:
+ *
+ *   manim_ring_header_t, padded to MANIM_RING_DATA_OFFSET bytes
+ *   capacity bytes of data, capacity a power of two
+ *
+ * head and tail count the bytes written and read since the ring was created,
+ * byte n of the stream lives at data[n & (capacity - 1)]. Only the writer
+ * stores head and closed, only the reader stores tail. The writer copies data
+ * in before storing head, and sets closed after its last head. The magic is
+ * written last when the ring is created, a reader waits for it.
+ *
+ * Each side records its pid so the other can stop waiting once it is gone:
+ * the reader gives up on an empty ring whose writer exited, the writer on a
+ * full ring whose reader exited or detached.
+ *
+ * A name of the form "/name" is a POSIX shared memory object (shm_open), any
+ * other name is a path to a regular file used the same way, e.g. for tests.
+ */
+
+#define MANIM_RING_DATA_OFFSET 192
+
+/** Default capacity of a ring created by the exporter **/
+#define MANIM_RING_DEFAULT_CAPACITY (64u << 20)
+
+/** How long a reader waits for the writer to create the ring **/
+#define MANIM_RING_OPEN_TIMEOUT_SEC 30.0
+
+/** reader_pid once the reader has closed its side **/
+#define MANIM_RING_READER_DETACHED UINT32_MAX
+
+typedef struct manim_ring_header_t {
+  char magic[4]; /** RING **/
+  _Atomic uint32_t closed;
+  uint64_t capacity;
+  /** The reader stops waiting if the writer exits without closing **/
+  uint32_t writer_pid;
+  /** 0 until a reader attaches, the writer stops waiting if it goes away **/
+  _Atomic uint32_t reader_pid;
+  uint8_t pad0[40];
+
+  /** On their own cache lines, each is stored by one side only **/
+  _Atomic uint64_t head;
+  uint8_t pad1[56];
+  _Atomic uint64_t tail;
+  uint8_t pad2[56];
+} manim_ring_header_t;
+
+_Static_assert(sizeof(manim_ring_header_t) == MANIM_RING_DATA_OFFSET,
+               "ring header layout is shared with the exporter");
+
+typedef struct manim_ring_t {
+  manim_ring_header_t *header;
+  unsigned char *data;
+  uint64_t mask;
+  size_t map_size;
+
+  /** Own copy of the position this side stores **/
+  uint64_t pos;
+  /** Times this side found the ring empty (reader) or full (writer) **/
+  size_t stalls;
+  /** Opened with manim_ring_open, detaches from the header on close **/
+  bool reader;
+} manim_ring_t;
+
+/**
+ * @brief Creates a ring, replacing any existing one of the same name.
+ *
+ * @param capacity Data bytes, rounded up to a power of two.
+ * @return 1 on success, 0 on failure.
+ */
+int manim_ring_create(manim_ring_t *ring, const char *name, size_t capacity);
+
+/**
+ * @brief Copies size bytes into the ring, waiting for the reader whenever it
+ * is full.
+ *
+ * @return 1 on success, 0 if the ring is full and its reader exited or
+ * detached, in which case only part of src was written.
+ */
+int manim_ring_write(manim_ring_t *ring, const void *src, size_t size);
+
+/**
+ * @brief Marks the end of the stream and unmaps the ring.
+ */
+void manim_ring_finish(manim_ring_t *ring);
+
+/**
+ * @brief Attaches to a ring, waiting up to timeout_sec for the writer to
+ * create it. A shared memory name is unlinked once attached.
+ *
+ * @return 1 on success, 0 if the ring did not appear or is malformed.
+ */
+int manim_ring_open(manim_ring_t *ring, const char *name, double timeout_sec);
+
+/**
+ * @brief Reads up to size bytes, waiting until at least one is available.
+ *
+ * @return Bytes read, 0 once the writer has finished and the ring is drained.
+ */
+size_t manim_ring_read(manim_ring_t *ring, void *dst, size_t size);
+
+void manim_ring_close(manim_ring_t *ring);
+
+/**
+ * @brief Opens a ring as a read-only, unbuffered FILE so the stream reader
+ * can decode from it. Only forward seeks are supported. fclose detaches.
+ *
+ * @return The FILE, or NULL if the ring could not be opened or the platform
+ * has no FILE over callbacks, see common/cookie.h.
+ */
+FILE *manim_ring_fopen(const char *name, double timeout_sec);
+
+#endif // MANIM_RING_H
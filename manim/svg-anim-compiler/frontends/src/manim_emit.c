@@ -0,0 +1,240 @@
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "common/fmt.h"
+#include "manim/manim_emit.h"
+#include "manim/manim_fe.h"
+
+/** Digits after the decimal point of emitted coordinates and widths **/
+#define EMIT_PRECISION 3
+
+static void emit_bytes(arena_t *out_arena, size_t *length, const char *bytes,
+                       const size_t count) {
+  memcpy(arena_push(out_arena, count), bytes, count);
+  *length += count;
+}
+
+static void emit_str(arena_t *out_arena, size_t *length, const char *str) {
+  emit_bytes(out_arena, length, str, strlen(str));
+}
+
+/**
+ * Emits a number with EMIT_PRECISION decimals, trailing zeros (and a trailing
+ * '.') stripped, see common/fmt.h.
+ */
+static void emit_num(arena_t *out_arena, size_t *length, const double value) {
+  char buf[FMT_FIXED_MAX_LENGTH];
+  emit_bytes(out_arena, length, buf, fmt_fixed(buf, value, EMIT_PRECISION));
+}
+
+/**
+ * Emits " C x1 y1 x2 y2 x3 y3" for the mapped coordinates of a quad, formatted
+ * in one fmt_fixed_array call.
+ */
+static void emit_quad(arena_t *out_arena, size_t *length,
+                      const double coords[MANIM_XFORM_QUAD_COORDS]) {
+  char buf[3 + MANIM_XFORM_QUAD_COORDS * (FMT_FIXED_MAX_LENGTH + 1)];
+  memcpy(buf, " C ", 3);
+  const size_t count =
+      3 + fmt_fixed_array(buf + 3, coords, MANIM_XFORM_QUAD_COORDS,
+                          EMIT_PRECISION, ' ');
+  emit_bytes(out_arena, length, buf, count);
+}
+
+static void emit_point(arena_t *out_arena, size_t *length, const double x,
+                       const double y) {
+  emit_num(out_arena, length, x);
+  emit_bytes(out_arena, length, " ", 1);
+  emit_num(out_arena, length, y);
+}
+
+static int color_channel(const float value) {
+  const float clamped = value < 0 ? 0 : value > 1 ? 1 : value;
+  return (int)lrintf(clamped * 255.0f);
+}
+
+/**
+ * Emits ` <attr>="rgb(r,g,b)"` and, when not opaque, ` <opacity_attr>="a"`.
+ */
+static void emit_paint(arena_t *out_arena, size_t *length, const char *attr,
+                       const char *opacity_attr, const manim_rgba_t *rgba) {
+  char buf[96];
+  const int count =
+      snprintf(buf, sizeof(buf), " %s=\"rgb(%d,%d,%d)\"", attr,
+               color_channel(rgba->vals[0]), color_channel(rgba->vals[1]),
+               color_channel(rgba->vals[2]));
+  emit_bytes(out_arena, length, buf, (size_t)count);
+
+  if (rgba->vals[3] < 1.0f) {
+    emit_bytes(out_arena, length, " ", 1);
+    emit_str(out_arena, length, opacity_attr);
+    emit_str(out_arena, length, "=\"");
+    emit_num(out_arena, length, rgba->vals[3]);
+    emit_bytes(out_arena, length, "\"", 1);
+  }
+}
+
+/**
+ * Emits a multi-stop paint as a reference to its gradient, and a single stop
+ * paint (or any paint without a gradient cache) as its first stop.
+ */
+static void emit_vmo_paint(arena_t *out_arena, size_t *length,
+                           const char *attr, const char *opacity_attr,
+                           const manim_vmo_t *vmo,
+                           const context_color_t paint,
+                           manim_gradient_cache_t *gradients) {
+  uint32_t rgbas_count;
+  const manim_rgba_t *rgbas = manim_vmo_paint(vmo, paint, &rgbas_count);
+  if (rgbas_count < 2 || !gradients) {
+    emit_paint(out_arena, length, attr, opacity_attr, &rgbas[0]);
+    return;
+  }
+
+  char id[MANIM_GRADIENT_ID_SIZE];
+  manim_gradient_cache_ref(gradients, vmo, paint, id);
+
+  char buf[64];
+  const int count = snprintf(buf, sizeof(buf), " %s=\"url(#%s)\"", attr, id);
+  emit_bytes(out_arena, length, buf, (size_t)count);
+}
+
+static bool paint_visible(const manim_rgba_t *rgbas, const uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    if (rgbas[i].vals[3] > 0)
+      return true;
+  }
+  return false;
+}
+
+/** Emits the d attribute of the subpaths of a vmo **/
+static void emit_vmo_d(arena_t *out_arena, size_t *length,
+                       const manim_vmo_t *vmo, const double *coords) {
+  emit_str(out_arena, length, " d=\"");
+  for (uint32_t j = 0; j < vmo->subpath_count; j++) {
+    const manim_subpath_t *subpath = &vmo->subpaths[j];
+
+    emit_bytes(out_arena, length, j == 0 ? "M " : " M ", j == 0 ? 2 : 3);
+    emit_point(out_arena, length, coords[0], coords[1]);
+    coords += 2;
+
+    for (uint32_t k = 0; k < subpath->quad_count; k++) {
+      emit_quad(out_arena, length, coords);
+      coords += MANIM_XFORM_QUAD_COORDS;
+    }
+
+    if (manim_subpath_is_closed(subpath))
+      emit_bytes(out_arena, length, " Z", 2);
+  }
+  emit_bytes(out_arena, length, "\"", 1);
+}
+
+/**
+ * Emits the stroke paint and width. The width is apply_stroke's 0.01 multiple
+ * of the line width, scaled to pixel space by the square root of the
+ * determinant of the transform, the factor Cairo scales the area of a pen by.
+ */
+static void emit_vmo_stroke(arena_t *out_arena, size_t *length,
+                            const manim_xform_t *xform, const manim_vmo_t *vmo,
+                            const context_color_t paint, const float width,
+                            manim_gradient_cache_t *gradients) {
+  emit_vmo_paint(out_arena, length, "stroke", "stroke-opacity", vmo, paint,
+                 gradients);
+  emit_str(out_arena, length, " stroke-width=\"");
+  emit_num(out_arena, length,
+           width * 0.01 * sqrt(fabs(xform->sx * xform->sy)));
+  emit_bytes(out_arena, length, "\"", 1);
+}
+
+static void emit_vmo_tag(arena_t *out_arena, size_t *length,
+                         const manim_vmo_t *vmo) {
+  char tag[32];
+  const int count =
+      snprintf(tag, sizeof(tag), " data-tag=\"%u\"/>\n", vmo->id);
+  emit_bytes(out_arena, length, tag, (size_t)count);
+}
+
+size_t emit_vmo_path(arena_t *out_arena, const manim_xform_t *xform,
+                     const manim_vmo_t *vmo, const double *coords,
+                     manim_gradient_cache_t *gradients) {
+  if (vmo->subpath_count == 0)
+    return 0;
+
+  /** The paints render_vmo draws, in its order **/
+  const bool has_stroke_bg =
+      vmo->stroke_bg_width != 0 &&
+      paint_visible(vmo->stroke_bg_rgbas, vmo->stroke_bg_rgbas_count);
+  const bool has_fill = paint_visible(vmo->fill_rgbas, vmo->fill_rgbas_count);
+  const bool has_stroke =
+      vmo->stroke_width != 0 &&
+      paint_visible(vmo->stroke_rgbas, vmo->stroke_rgbas_count);
+
+  size_t length = 0;
+
+  /** Background stroke, underneath the fill **/
+  if (has_stroke_bg) {
+    emit_str(out_arena, &length, "<path");
+    emit_vmo_d(out_arena, &length, vmo, coords);
+    emit_str(out_arena, &length, " fill=\"none\"");
+    emit_vmo_stroke(out_arena, &length, xform, vmo, C_STROKE_BG,
+                    vmo->stroke_bg_width, gradients);
+    emit_vmo_tag(out_arena, &length, vmo);
+  }
+
+  if (!has_fill && !has_stroke)
+    return length;
+
+  /** Fill and foreground stroke, which Cairo writes as one element **/
+  emit_str(out_arena, &length, "<path");
+  emit_vmo_d(out_arena, &length, vmo, coords);
+
+  if (has_fill)
+    emit_vmo_paint(out_arena, &length, "fill", "fill-opacity", vmo, C_FILL,
+                   gradients);
+  else
+    emit_str(out_arena, &length, " fill=\"none\"");
+
+  if (has_stroke)
+    emit_vmo_stroke(out_arena, &length, xform, vmo, C_STROKE,
+                    vmo->stroke_width, gradients);
+
+  emit_vmo_tag(out_arena, &length, vmo);
+  return length;
+}
+
+size_t emit_gradient_def(arena_t *out_arena, const manim_xform_t *xform,
+                         const manim_vmo_t *vmo, const context_color_t paint,
+                         const char *id) {
+  uint32_t rgbas_count;
+  const manim_rgba_t *rgbas = manim_vmo_paint(vmo, paint, &rgbas_count);
+
+  size_t length = 0;
+  emit_str(out_arena, &length, "<linearGradient id=\"");
+  emit_str(out_arena, &length, id);
+  emit_str(out_arena, &length, "\" gradientUnits=\"userSpaceOnUse\" x1=\"");
+  emit_num(out_arena, &length, vmo->gradient_x0 * xform->sx + xform->tx);
+  emit_str(out_arena, &length, "\" y1=\"");
+  emit_num(out_arena, &length, vmo->gradient_y0 * xform->sy + xform->ty);
+  emit_str(out_arena, &length, "\" x2=\"");
+  emit_num(out_arena, &length, vmo->gradient_x1 * xform->sx + xform->tx);
+  emit_str(out_arena, &length, "\" y2=\"");
+  emit_num(out_arena, &length, vmo->gradient_y1 * xform->sy + xform->ty);
+  emit_str(out_arena, &length, "\">");
+
+  for (uint32_t i = 0; i < rgbas_count; i++) {
+    emit_str(out_arena, &length, "<stop offset=\"");
+    emit_num(out_arena, &length,
+             rgbas_count > 1 ? (double)i / (rgbas_count - 1) : 0);
+    emit_bytes(out_arena, &length, "\"", 1);
+    emit_paint(out_arena, &length, "stop-color", "stop-opacity",
+               &rgbas[i]);
+    emit_str(out_arena, &length, "/>");
+  }
+
+  emit_str(out_arena, &length, "</linearGradient>\n");
+  return length;
+}
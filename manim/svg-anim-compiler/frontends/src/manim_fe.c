@@ -1,16 +1,29 @@
+#define _GNU_SOURCE // memmem, fopencookie, see common/cookie.h
 #include <cairo-svg.h>
 #include <cairo.h>
+#include <fcntl.h>
 #include <math.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "ctrs/map.h"
+#include "ctrs/spsc.h"
 
 #include "common/arena.h"
+#include "common/cookie.h"
 #include "common/core.h"
+#include "common/pool.h"
+#include "manim/manim_emit.h"
 #include "manim/manim_fe.h"
+#include "manim/manim_io.h"
+#include "manim/manim_ring.h"
 
 /**
  * ===================================
@@ -18,9 +31,8 @@
  * ===================================
  */
 int read_header(FILE *fp, manim_file_header_t *file_header) {
-  fread(file_header, sizeof(*file_header), 1, fp);
-
-  if (memcmp(file_header->magic, "CTXT", 4) != 0) {
+  if (fread(file_header, sizeof(*file_header), 1, fp) != 1 ||
+      memcmp(file_header->magic, "CTXT", 4) != 0) {
     printf("File header magic malformed.");
     return 0;
   }
@@ -29,7 +41,8 @@ int read_header(FILE *fp, manim_file_header_t *file_header) {
 }
 
 int read_frame(arena_t *frame_arena, FILE *fp, manim_frame_t *frame) {
-  fread(&frame->magic, sizeof(frame->magic), 1, fp);
+  if (fread(&frame->magic, sizeof(frame->magic), 1, fp) != 1)
+    return 0;
 
   if (unlikely(memcmp(frame->magic, "FRAM", 4) != 0)) {
     printf("Frame header magic malformed.");
@@ -41,41 +54,123 @@ int read_frame(arena_t *frame_arena, FILE *fp, manim_frame_t *frame) {
 
   frame->vmos = arena_push_array(frame_arena, manim_vmo_t, frame->vmo_count);
 
-  for (uint32_t i = 0; i < frame->vmo_count; i++) {
+  // Any short read means the frame is truncated
+  bool complete = true;
+  for (uint32_t i = 0; i < frame->vmo_count && complete; i++) {
     manim_vmo_t *vmo = &frame->vmos[i];
 
     // Read up to first pointer
-    fread(vmo, offsetof(manim_vmo_t, stroke_bg_rgbas), 1, fp);
+    if (fread(vmo, offsetof(manim_vmo_t, stroke_bg_rgbas), 1, fp) != 1)
+      return 0;
 
     // Stroke background RGBAs
     vmo->stroke_bg_rgbas =
         arena_push_array(frame_arena, manim_rgba_t, vmo->stroke_bg_rgbas_count);
-    fread(vmo->stroke_bg_rgbas, sizeof(manim_rgba_t),
-          vmo->stroke_bg_rgbas_count, fp);
+    complete &= fread(vmo->stroke_bg_rgbas, sizeof(manim_rgba_t),
+                      vmo->stroke_bg_rgbas_count,
+                      fp) == vmo->stroke_bg_rgbas_count;
 
     // Stroke RGBAs
     vmo->stroke_rgbas =
         arena_push_array(frame_arena, manim_rgba_t, vmo->stroke_rgbas_count);
-    fread(vmo->stroke_rgbas, sizeof(manim_rgba_t), vmo->stroke_rgbas_count, fp);
+    complete &= fread(vmo->stroke_rgbas, sizeof(manim_rgba_t),
+                      vmo->stroke_rgbas_count, fp) == vmo->stroke_rgbas_count;
 
     // Fill RGBAs
     vmo->fill_rgbas =
         arena_push_array(frame_arena, manim_rgba_t, vmo->fill_rgbas_count);
-    fread(vmo->fill_rgbas, sizeof(manim_rgba_t), vmo->fill_rgbas_count, fp);
+    complete &= fread(vmo->fill_rgbas, sizeof(manim_rgba_t),
+                      vmo->fill_rgbas_count, fp) == vmo->fill_rgbas_count;
 
     // Subpaths
     vmo->subpaths =
         arena_push_array(frame_arena, manim_subpath_t, vmo->subpath_count);
-    for (uint32_t j = 0; j < vmo->subpath_count; j++) {
+    for (uint32_t j = 0; j < vmo->subpath_count && complete; j++) {
       manim_subpath_t *subpath = &vmo->subpaths[j];
 
       // Read up to first pointer
-      fread(subpath, offsetof(manim_subpath_t, quads), 1, fp);
+      if (fread(subpath, offsetof(manim_subpath_t, quads), 1, fp) != 1)
+        return 0;
 
       // Quads
       subpath->quads =
           arena_push_array(frame_arena, manim_quad_t, subpath->quad_count);
-      fread(subpath->quads, sizeof(manim_quad_t), subpath->quad_count, fp);
+      complete &= fread(subpath->quads, sizeof(manim_quad_t),
+                        subpath->quad_count, fp) == subpath->quad_count;
+    }
+  }
+
+  return complete;
+}
+
+/**
+ * Returns a pointer to the next size bytes of the mapping and advances pos, or
+ * NULL if the mapping is truncated.
+ */
+static const unsigned char *mapped_take(const unsigned char *base,
+                                        const size_t size, size_t *pos,
+                                        const size_t count) {
+  if (unlikely(count > size - *pos))
+    return NULL;
+  const unsigned char *ptr = base + *pos;
+  *pos += count;
+  return ptr;
+}
+
+int read_frame_mapped(arena_t *frame_arena, const unsigned char *base,
+                      const size_t size, size_t *pos, manim_frame_t *frame) {
+  const unsigned char *frame_header =
+      mapped_take(base, size, pos, offsetof(manim_frame_t, vmos));
+  if (!frame_header)
+    return 0;
+
+  memcpy(frame, frame_header, offsetof(manim_frame_t, vmos));
+
+  if (unlikely(memcmp(frame->magic, "FRAM", 4) != 0)) {
+    fprintf(stderr, "Frame header magic malformed.\n");
+    return 0;
+  }
+
+  frame->vmos = arena_push_array(frame_arena, manim_vmo_t, frame->vmo_count);
+
+  for (uint32_t i = 0; i < frame->vmo_count; i++) {
+    manim_vmo_t *vmo = &frame->vmos[i];
+
+    // Header up to first pointer
+    const unsigned char *vmo_header =
+        mapped_take(base, size, pos, offsetof(manim_vmo_t, stroke_bg_rgbas));
+    if (unlikely(!vmo_header))
+      return 0;
+    memcpy(vmo, vmo_header, offsetof(manim_vmo_t, stroke_bg_rgbas));
+
+    // RGBAs are views into the mapping
+    vmo->stroke_bg_rgbas = (manim_rgba_t *)mapped_take(
+        base, size, pos, sizeof(manim_rgba_t) * vmo->stroke_bg_rgbas_count);
+    vmo->stroke_rgbas = (manim_rgba_t *)mapped_take(
+        base, size, pos, sizeof(manim_rgba_t) * vmo->stroke_rgbas_count);
+    vmo->fill_rgbas = (manim_rgba_t *)mapped_take(
+        base, size, pos, sizeof(manim_rgba_t) * vmo->fill_rgbas_count);
+    if (unlikely(!vmo->stroke_bg_rgbas || !vmo->stroke_rgbas ||
+                 !vmo->fill_rgbas))
+      return 0;
+
+    // Subpaths
+    vmo->subpaths =
+        arena_push_array(frame_arena, manim_subpath_t, vmo->subpath_count);
+    for (uint32_t j = 0; j < vmo->subpath_count; j++) {
+      manim_subpath_t *subpath = &vmo->subpaths[j];
+
+      const unsigned char *subpath_header =
+          mapped_take(base, size, pos, offsetof(manim_subpath_t, quads));
+      if (unlikely(!subpath_header))
+        return 0;
+      memcpy(subpath, subpath_header, offsetof(manim_subpath_t, quads));
+
+      // Quads are views into the mapping
+      subpath->quads = (manim_quad_t *)mapped_take(
+          base, size, pos, sizeof(manim_quad_t) * subpath->quad_count);
+      if (unlikely(!subpath->quads))
+        return 0;
     }
   }
 
@@ -84,313 +179,2675 @@ int read_frame(arena_t *frame_arena, FILE *fp, manim_frame_t *frame) {
 
 /**
  * ===================================
- *             SVG RENDERING
+ *         VERSION 2 DECODING
  * ===================================
  */
 
-int init_cairo_ctx(cairo_t *ctx, const manim_file_header_t *file_header) {
-  const double fw = file_header->frame_width;
-  const double fh = file_header->frame_height;
+/** Reads one LEB128 varint, 0 if it runs past end or over 64 bits **/
+static inline int varint_take(const unsigned char **p,
+                              const unsigned char *end, uint64_t *out) {
+  const unsigned char *q = *p;
 
-  const double pw = file_header->pixel_width;
-  const double ph = file_header->pixel_height;
+  // Most deltas fit in one byte
+  if (likely(q < end && *q < 0x80)) {
+    *out = *q;
+    *p = q + 1;
+    return 1;
+  }
 
-  cairo_scale(ctx, pw, ph);
-  cairo_matrix_t matrix;
-  cairo_matrix_init(&matrix, pw / fw, 0, 0, -(ph / fh), (pw / 2), (ph / 2));
+  uint64_t v = 0;
+  for (unsigned shift = 0; shift < 64 && q < end; shift += 7) {
+    const unsigned char b = *q++;
+    v |= (uint64_t)(b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      *out = v;
+      *p = q;
+      return 1;
+    }
+  }
+  return 0;
+}
 
-  cairo_set_matrix(ctx, &matrix);
+static inline int varint_take_u32(const unsigned char **p,
+                                  const unsigned char *end, uint32_t *out) {
+  uint64_t v;
+  if (unlikely(!varint_take(p, end, &v) || v > UINT32_MAX))
+    return 0;
+  *out = (uint32_t)v;
   return 1;
 }
 
-int render_vmo(cairo_t *ctx, const manim_vmo_t *vmo) {
+static inline int64_t zigzag_decode(const uint64_t v) {
+  return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
 
-  cairo_new_path(ctx);
+/** Adds the next zigzag delta to a quantized coordinate and returns it in
+ * frame units **/
+static inline int coord_take(const unsigned char **p, const unsigned char *end,
+                             int64_t *quantized, const double coord_unit,
+                             float *out) {
+  uint64_t delta;
+  if (unlikely(!varint_take(p, end, &delta)))
+    return 0;
+  *quantized += zigzag_decode(delta);
+  *out = (float)((double)*quantized * coord_unit);
+  return 1;
+}
+
+static int decode_rgbas_v2(arena_t *frame_arena, const unsigned char **p,
+                           const unsigned char *end, const uint32_t count,
+                           manim_rgba_t **out) {
+  const size_t vals_size = sizeof(((manim_rgba_t *)0)->vals);
+  if (unlikely((size_t)(end - *p) / vals_size < count))
+    return 0;
+
+  manim_rgba_t *rgbas = arena_push_array(frame_arena, manim_rgba_t, count);
+  for (uint32_t i = 0; i < count; i++) {
+    memcpy(rgbas[i].magic, "RGBA", 4);
+    memcpy(rgbas[i].vals, *p, vals_size);
+    *p += vals_size;
+  }
+  *out = rgbas;
+  return 1;
+}
+
+/** Fixed floats at the start of every vmo record **/
+#define VMO_V2_FIXED_SIZE (6 * sizeof(float))
+
+/** Decodes one vmo record, its arrays are pushed to arena **/
+static int decode_vmo_v2(arena_t *arena, const unsigned char **cursor,
+                         const unsigned char *end, const double coord_unit,
+                         manim_vmo_t *vmo) {
+  const unsigned char *p = *cursor;
+  memcpy(vmo->magic, "VMOB", 4);
+
+  if (unlikely((size_t)(end - p) < VMO_V2_FIXED_SIZE))
+    return 0;
+  memcpy(&vmo->stroke_bg_width, p, sizeof(float));
+  memcpy(&vmo->stroke_width, p + 4, sizeof(float));
+  memcpy(&vmo->gradient_x0, p + 8, sizeof(float));
+  memcpy(&vmo->gradient_y0, p + 12, sizeof(float));
+  memcpy(&vmo->gradient_x1, p + 16, sizeof(float));
+  memcpy(&vmo->gradient_y1, p + 20, sizeof(float));
+  p += VMO_V2_FIXED_SIZE;
+
+  if (unlikely(!varint_take_u32(&p, end, &vmo->id) ||
+               !varint_take_u32(&p, end, &vmo->stroke_bg_rgbas_count) ||
+               !varint_take_u32(&p, end, &vmo->stroke_rgbas_count) ||
+               !varint_take_u32(&p, end, &vmo->fill_rgbas_count) ||
+               !varint_take_u32(&p, end, &vmo->subpath_count)))
+    return 0;
+
+  if (unlikely(!decode_rgbas_v2(arena, &p, end, vmo->stroke_bg_rgbas_count,
+                                &vmo->stroke_bg_rgbas) ||
+               !decode_rgbas_v2(arena, &p, end, vmo->stroke_rgbas_count,
+                                &vmo->stroke_rgbas) ||
+               !decode_rgbas_v2(arena, &p, end, vmo->fill_rgbas_count,
+                                &vmo->fill_rgbas)))
+    return 0;
+
+  // Every subpath takes at least 3 bytes, every quad at least 6
+  if (unlikely((size_t)(end - p) / 3 < vmo->subpath_count))
+    return 0;
+  vmo->subpaths = arena_push_array(arena, manim_subpath_t, vmo->subpath_count);
+
+  int64_t qx = 0, qy = 0;
   for (uint32_t j = 0; j < vmo->subpath_count; j++) {
     manim_subpath_t *subpath = &vmo->subpaths[j];
-    cairo_new_sub_path(ctx);
-    cairo_move_to(ctx, subpath->x, subpath->y);
+    memcpy(subpath->magic, "SUBP", 4);
+
+    if (unlikely(!varint_take_u32(&p, end, &subpath->quad_count) ||
+                 !coord_take(&p, end, &qx, coord_unit, &subpath->x) ||
+                 !coord_take(&p, end, &qy, coord_unit, &subpath->y)))
+      return 0;
+
+    if (unlikely((size_t)(end - p) / 6 < subpath->quad_count))
+      return 0;
+    subpath->quads =
+        arena_push_array(arena, manim_quad_t, subpath->quad_count);
+
     for (uint32_t k = 0; k < subpath->quad_count; k++) {
-      const manim_quad_t *quad = &subpath->quads[k];
-      cairo_curve_to(ctx, quad->x1, quad->y1, quad->x2, quad->y2, quad->x3,
-                     quad->y3);
+      manim_quad_t *quad = &subpath->quads[k];
+      memcpy(quad->magic, "QUAD", 4);
+      if (unlikely(!coord_take(&p, end, &qx, coord_unit, &quad->x1) ||
+                   !coord_take(&p, end, &qy, coord_unit, &quad->y1) ||
+                   !coord_take(&p, end, &qx, coord_unit, &quad->x2) ||
+                   !coord_take(&p, end, &qy, coord_unit, &quad->y2) ||
+                   !coord_take(&p, end, &qx, coord_unit, &quad->x3) ||
+                   !coord_take(&p, end, &qy, coord_unit, &quad->y3)))
+        return 0;
     }
+  }
+
+  *cursor = p;
+  return 1;
+}
 
-    manim_subpath_t *first = &subpath[0];
-    manim_subpath_t *last = &subpath[vmo->subpath_count - 1];
+/**
+ * ===================================
+ *             VMO TABLE
+ * ===================================
+ */
 
-    // TODO: Shitty.
-    if (fabsf(first->x - last->x) < 1e-6 && fabsf(first->y - last->y) < 1e-6) {
-      cairo_close_path(ctx);
-    }
+/** Bytes of a vmo's arrays, what replacing it leaves behind as garbage **/
+static size_t vmo_data_size(const manim_vmo_t *vmo) {
+  size_t size = sizeof(manim_rgba_t) *
+                    ((size_t)vmo->stroke_bg_rgbas_count +
+                     vmo->stroke_rgbas_count + vmo->fill_rgbas_count) +
+                sizeof(manim_subpath_t) * vmo->subpath_count;
+  for (uint32_t i = 0; i < vmo->subpath_count; i++)
+    size += sizeof(manim_quad_t) * vmo->subpaths[i].quad_count;
+  return size;
+}
+
+/** Moves a vmo's arrays to arena **/
+static void vmo_copy_data(arena_t *arena, manim_vmo_t *vmo) {
+#define COPY_ARRAY(field, type, count)                                         \
+  do {                                                                         \
+    type *copy = arena_push_array(arena, type, (count));                       \
+    if ((count) > 0)                                                           \
+      memcpy(copy, vmo->field, sizeof(type) * (count));                        \
+    vmo->field = copy;                                                         \
+  } while (0)
+
+  COPY_ARRAY(stroke_bg_rgbas, manim_rgba_t, vmo->stroke_bg_rgbas_count);
+  COPY_ARRAY(stroke_rgbas, manim_rgba_t, vmo->stroke_rgbas_count);
+  COPY_ARRAY(fill_rgbas, manim_rgba_t, vmo->fill_rgbas_count);
+  COPY_ARRAY(subpaths, manim_subpath_t, vmo->subpath_count);
+  for (uint32_t i = 0; i < vmo->subpath_count; i++) {
+    manim_subpath_t *subpath = &vmo->subpaths[i];
+    manim_quad_t *quads =
+        arena_push_array(arena, manim_quad_t, subpath->quad_count);
+    if (subpath->quad_count > 0)
+      memcpy(quads, subpath->quads, sizeof(manim_quad_t) * subpath->quad_count);
+    subpath->quads = quads;
   }
 
-  apply_stroke(ctx, vmo, true);
-  apply_fill(ctx, vmo);
-  apply_stroke(ctx, vmo, false);
+#undef COPY_ARRAY
+}
 
-  return 1;
+int manim_vmo_table_init(manim_vmo_table_t *table) {
+  memset(table, 0, sizeof(*table));
+  table->index = map_create(sizeof(uint32_t), alignof(uint32_t));
+  table->vmo_arena = arena_alloc();
+  table->serial_arena = arena_alloc();
+  table->data_arena = arena_alloc();
+  table->spare_arena = arena_alloc();
+  table->ids_unique = true;
+  return table->index && table->vmo_arena && table->serial_arena &&
+         table->data_arena && table->spare_arena;
 }
 
-cairo_status_t cairo_buffer_writer(void *closure, const unsigned char *data,
-                                   const unsigned int length) {
-  arena_t *arena = closure;
-  void *dest = arena_push(arena, length);
-  if (!dest)
-    return CAIRO_STATUS_NO_MEMORY;
-  memcpy(dest, data, length);
-  return CAIRO_STATUS_SUCCESS;
+void manim_vmo_table_release(manim_vmo_table_t *table) {
+  if (table->index)
+    map_destroy(table->index);
+  if (table->vmo_arena)
+    arena_release(table->vmo_arena);
+  if (table->serial_arena)
+    arena_release(table->serial_arena);
+  if (table->data_arena)
+    arena_release(table->data_arena);
+  if (table->spare_arena)
+    arena_release(table->spare_arena);
+  memset(table, 0, sizeof(*table));
 }
 
-void set_cairo_context_color(cairo_t *ctx, const manim_vmo_t *vmo,
-                             const context_color_t context_color_type) {
+static manim_vmo_t *vmo_table_vmos(const manim_vmo_table_t *table) {
+  return (manim_vmo_t *)table->vmo_arena->base;
+}
 
-  uint32_t rgba_count = 0;
-  manim_rgba_t *rgbas = NULL;
-  if (context_color_type == C_FILL) {
-    rgba_count = vmo->fill_rgbas_count;
-    rgbas = vmo->fill_rgbas;
-  } else if (context_color_type == C_STROKE) {
-    rgba_count = vmo->stroke_rgbas_count;
-    rgbas = vmo->stroke_rgbas;
-  } else if (context_color_type == C_STROKE_BG) {
-    rgba_count = vmo->stroke_bg_rgbas_count;
-    rgbas = vmo->stroke_bg_rgbas;
-  }
+static uint64_t *vmo_table_serials(const manim_vmo_table_t *table) {
+  return (uint64_t *)table->serial_arena->base;
+}
 
-  if (rgba_count == 1) {
-    manim_rgba_t *rgba = &rgbas[0];
-    cairo_set_source_rgba(ctx, rgba->vals[0], rgba->vals[1], rgba->vals[2],
-                          rgba->vals[3]);
+static void vmo_table_append(manim_vmo_table_t *table,
+                             const manim_vmo_t *vmo) {
+  const uint32_t index = table->vmo_count++;
+  *arena_push_struct(table->vmo_arena, manim_vmo_t) = *vmo;
+  *arena_push_struct(table->serial_arena, uint64_t) = table->serial;
+  // Deltas cannot address repeated ids, or the id the map reserves
+  uint32_t existing;
+  if (vmo->id == MAP_EMPTY_KEY || map_get(table->index, vmo->id, &existing))
+    table->ids_unique = false;
+  else
+    map_put(table->index, vmo->id, &index);
+}
+
+/** Copies the live arrays to the spare arena once most of the data arena is
+ * garbage **/
+static void vmo_table_compact(manim_vmo_table_t *table) {
+  const size_t used = table->data_arena->pos;
+  if (table->garbage_bytes < MANIM_VMO_TABLE_COMPACT_MIN ||
+      table->garbage_bytes < used / 2)
     return;
+
+  manim_vmo_t *vmos = vmo_table_vmos(table);
+  for (uint32_t i = 0; i < table->vmo_count; i++)
+    vmo_copy_data(table->spare_arena, &vmos[i]);
+
+  arena_t *old = table->data_arena;
+  table->data_arena = table->spare_arena;
+  table->spare_arena = old;
+  arena_clear(table->spare_arena);
+  table->garbage_bytes = 0;
+}
+
+static int vmo_table_load_key_frame(manim_vmo_table_t *table,
+                                    const unsigned char *payload,
+                                    const size_t payload_size,
+                                    const uint32_t vmo_count,
+                                    const double coord_unit) {
+  map_clear(table->index);
+  arena_clear(table->vmo_arena);
+  arena_clear(table->serial_arena);
+  arena_clear(table->data_arena);
+  table->vmo_count = 0;
+  table->garbage_bytes = 0;
+  table->ids_unique = true;
+  ++table->serial;
+
+  const unsigned char *p = payload;
+  const unsigned char *end = payload + payload_size;
+  if (unlikely(payload_size / VMO_V2_FIXED_SIZE < vmo_count))
+    return 0;
+
+  for (uint32_t i = 0; i < vmo_count; i++) {
+    manim_vmo_t vmo;
+    if (unlikely(!decode_vmo_v2(table->data_arena, &p, end, coord_unit, &vmo)))
+      return 0;
+    vmo_table_append(table, &vmo);
   }
 
-  cairo_pattern_t *pat = cairo_pattern_create_linear(
-      vmo->gradient_x0, vmo->gradient_y0, vmo->gradient_x1, vmo->gradient_y1);
-  double step = 1.0 / (rgba_count - 1);
+  return p == end;
+}
 
-  double val = 0;
-  for (uint32_t i = 0; i < rgba_count; i++) {
-    manim_rgba_t *rgba = &rgbas[i];
-    cairo_pattern_add_color_stop_rgba(pat, val, rgba->vals[0], rgba->vals[1],
-                                      rgba->vals[2], rgba->vals[3]);
-    val += step;
+/**
+ * Delta payload: varint removed count, the removed ids as varints, then
+ * vmo_count vmo records. A record replaces the vmo with its id, or is
+ * appended after the remaining vmos if the id is new.
+ */
+static int vmo_table_apply_delta(manim_vmo_table_t *table,
+                                 const unsigned char *payload,
+                                 const size_t payload_size,
+                                 const uint32_t vmo_count,
+                                 const double coord_unit) {
+  if (unlikely(!table->ids_unique)) {
+    fprintf(stderr, "Delta frame after a key frame with repeated vmo ids.\n");
+    return 0;
   }
-  cairo_set_source(ctx, pat);
+  ++table->serial;
+
+  const unsigned char *p = payload;
+  const unsigned char *end = payload + payload_size;
+  manim_vmo_t *vmos = vmo_table_vmos(table);
+  uint64_t *serials = vmo_table_serials(table);
+
+  /** Removed ids are tagged, then dropped in one pass keeping the order **/
+  uint32_t removed_count;
+  if (unlikely(!varint_take_u32(&p, end, &removed_count)))
+    return 0;
+  for (uint32_t i = 0; i < removed_count; i++) {
+    uint32_t id, index;
+    if (unlikely(!varint_take_u32(&p, end, &id) ||
+                 !map_get(table->index, id, &index)))
+      return 0;
+    map_remove(table->index, id);
+    table->garbage_bytes += vmo_data_size(&vmos[index]);
+    serials[index] = UINT64_MAX;
+  }
+
+  if (removed_count > 0) {
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < table->vmo_count; i++) {
+      if (serials[i] == UINT64_MAX)
+        continue;
+      if (kept != i) {
+        vmos[kept] = vmos[i];
+        serials[kept] = serials[i];
+        map_put(table->index, vmos[kept].id, &kept);
+      }
+      ++kept;
+    }
+    table->vmo_count = kept;
+    table->vmo_arena->pos = sizeof(manim_vmo_t) * kept;
+    table->serial_arena->pos = sizeof(uint64_t) * kept;
+  }
+
+  /** Changed and new vmos **/
+  if (unlikely((size_t)(end - p) / VMO_V2_FIXED_SIZE < vmo_count))
+    return 0;
+  for (uint32_t i = 0; i < vmo_count; i++) {
+    manim_vmo_t vmo;
+    if (unlikely(!decode_vmo_v2(table->data_arena, &p, end, coord_unit, &vmo)))
+      return 0;
+
+    uint32_t index;
+    if (map_get(table->index, vmo.id, &index)) {
+      table->garbage_bytes += vmo_data_size(&vmos[index]);
+      vmos[index] = vmo;
+      serials[index] = table->serial;
+    } else {
+      vmo_table_append(table, &vmo);
+    }
+  }
+
+  vmo_table_compact(table);
+  return p == end;
 }
 
-void apply_stroke(cairo_t *ctx, const manim_vmo_t *vmo, bool background) {
-  double width = background ? vmo->stroke_bg_width : vmo->stroke_width;
-  if (width == 0)
-    return;
+/**
+ * Returns the payload of the next version 2 frame, read into frame_arena in
+ * stream mode. NULL at end of input or on a malformed frame.
+ */
+static const unsigned char *
+next_frame_v2_payload(manim_reader_t *reader, arena_t *frame_arena,
+                      manim_frame_v2_header_t *frame_header) {
+  const unsigned char *header;
+  if (reader->mode != MANIM_INPUT_MMAP) {
+    if (fread(frame_header, sizeof(*frame_header), 1, reader->fp) != 1)
+      return NULL;
+  } else {
+    header = mapped_take(reader->map_base, reader->map_size, &reader->map_pos,
+                         sizeof(*frame_header));
+    if (!header)
+      return NULL;
+    memcpy(frame_header, header, sizeof(*frame_header));
+  }
 
-  set_cairo_context_color(ctx, vmo, background ? C_STROKE_BG : C_STROKE);
-  cairo_set_line_width(ctx, width * 0.01); // 0.01?
-  cairo_stroke_preserve(ctx);
+  if (unlikely(memcmp(frame_header->magic, "FRAM", 4) != 0 &&
+               memcmp(frame_header->magic, "FDLT", 4) != 0)) {
+    fprintf(stderr, "Frame header magic malformed.\n");
+    return NULL;
+  }
+
+  if (reader->mode == MANIM_INPUT_MMAP)
+    return mapped_take(reader->map_base, reader->map_size, &reader->map_pos,
+                       frame_header->payload_size);
+
+  unsigned char *payload = arena_push(frame_arena, frame_header->payload_size);
+  if (fread(payload, 1, frame_header->payload_size, reader->fp) !=
+      frame_header->payload_size)
+    return NULL;
+  return payload;
 }
 
-void apply_fill(cairo_t *ctx, const manim_vmo_t *vmo) {
-  set_cairo_context_color(ctx, vmo, C_FILL);
-  cairo_fill_preserve(ctx);
+/**
+ * Applies version 2 frames to the reader's vmo table, replaying the frames a
+ * seek skipped, and returns the table's vmos as the frame.
+ */
+static int read_frame_v2(manim_reader_t *reader, arena_t *frame_arena,
+                         manim_frame_t *frame) {
+  manim_vmo_table_t *table = &reader->vmo_table;
+
+  bool delta;
+  do {
+    manim_frame_v2_header_t frame_header;
+    const unsigned char *payload =
+        next_frame_v2_payload(reader, frame_arena, &frame_header);
+    if (!payload)
+      return 0;
+
+    delta = memcmp(frame_header.magic, "FDLT", 4) == 0;
+    const int ok =
+        delta ? vmo_table_apply_delta(table, payload,
+                                      frame_header.payload_size,
+                                      frame_header.vmo_count,
+                                      reader->coord_unit)
+              : vmo_table_load_key_frame(table, payload,
+                                         frame_header.payload_size,
+                                         frame_header.vmo_count,
+                                         reader->coord_unit);
+    if (!ok)
+      return 0;
+  } while (reader->replay_frames > 0 && reader->replay_frames--);
+
+  memcpy(frame->magic, "FRAM", 4);
+  frame->vmo_count = table->vmo_count;
+  frame->vmos = arena_push_array(frame_arena, manim_vmo_t, table->vmo_count);
+  memcpy(frame->vmos, vmo_table_vmos(table),
+         sizeof(manim_vmo_t) * table->vmo_count);
+
+  // Dirty flags are relative to the frame the reader returned before
+  frame->vmo_dirty = NULL;
+  if (delta && reader->frame_returned) {
+    const uint64_t *serials = vmo_table_serials(table);
+    frame->vmo_dirty = arena_push_array(frame_arena, bool, table->vmo_count);
+    for (uint32_t i = 0; i < table->vmo_count; i++)
+      frame->vmo_dirty[i] = serials[i] == table->serial;
+  }
+
+  return 1;
 }
 
-int manim_fe_driver(arena_t *svg_frames_blob_arena,
-                    arena_t *svg_frames_record_arena,
-                    const char *file_path,
-                    svg_frames_t **out_svg_frames) {
-  printf("Starting Manim frontend driver..\n");
+/**
+ * Takes one version 2 frame of the mapping. Returns the payload, or NULL at
+ * end of input or on a malformed frame.
+ */
+static const unsigned char *
+take_frame_v2_mapped(const unsigned char *base, const size_t size, size_t *pos,
+                     manim_frame_v2_header_t *frame_header) {
+  const unsigned char *header =
+      mapped_take(base, size, pos, sizeof(*frame_header));
+  if (!header)
+    return NULL;
+  memcpy(frame_header, header, sizeof(*frame_header));
+  if (unlikely(memcmp(frame_header->magic, "FRAM", 4) != 0 &&
+               memcmp(frame_header->magic, "FDLT", 4) != 0))
+    return NULL;
+  return mapped_take(base, size, pos, frame_header->payload_size);
+}
 
-  timespec_t perf_total_start_time = ts_now();
-  double perf_surface_destroy_cum_time = 0;
+/**
+ * ===================================
+ *          VERSION 3 COLUMNS
+ * ===================================
+ */
 
-  printf("Reading from: %s\n", file_path);
+#define COLUMN_COUNT 12
+
+typedef struct frame_column_t {
+  const void **data;
+  size_t size;
+} frame_column_t;
+
+/** Columns of a frame in file order, pointing at the fields they fill **/
+static void frame_columns_describe(manim_frame_columns_t *columns,
+                                   const manim_frame_v3_header_t *header,
+                                   frame_column_t out[COLUMN_COUNT]) {
+  columns->vmo_count = header->vmo_count;
+  columns->rgba_count = header->rgba_count;
+  columns->subpath_count = header->subpath_count;
+  columns->point_count = header->point_count;
+
+  const size_t v = header->vmo_count;
+  const size_t u32 = sizeof(uint32_t);
+  const size_t f32 = sizeof(float);
+  const frame_column_t described[COLUMN_COUNT] = {
+      {(const void **)&columns->ids, u32 * v},
+      {(const void **)&columns->stroke_bg_widths, f32 * v},
+      {(const void **)&columns->stroke_widths, f32 * v},
+      {(const void **)&columns->gradients, f32 * 4 * v},
+      {(const void **)&columns->stroke_bg_rgbas_counts, u32 * v},
+      {(const void **)&columns->stroke_rgbas_counts, u32 * v},
+      {(const void **)&columns->fill_rgbas_counts, u32 * v},
+      {(const void **)&columns->subpath_counts, u32 * v},
+      {(const void **)&columns->rgbas, f32 * 4 * header->rgba_count},
+      {(const void **)&columns->quad_counts, u32 * header->subpath_count},
+      {(const void **)&columns->xs, f32 * header->point_count},
+      {(const void **)&columns->ys, f32 * header->point_count},
+  };
+  memcpy(out, described, sizeof(described));
+}
 
-  /** File handling **/
-  FILE *fp = fopen(file_path, "rb");
-  if (!fp) {
-    perror("fopen failed");
-    return 1;
+static size_t column_padded_size(const size_t size) {
+  return ALIGN_UP(size, (size_t)MANIM_COLUMN_ALIGN);
+}
+
+static int frame_columns_check_payload(const frame_column_t *described,
+                                       const uint32_t payload_size) {
+  size_t total = 0;
+  for (size_t i = 0; i < COLUMN_COUNT; i++)
+    total += column_padded_size(described[i].size);
+  return total == payload_size;
+}
+
+/** The per vmo and per subpath counts must add up to the frame's totals **/
+static int frame_columns_check_counts(const manim_frame_columns_t *columns) {
+  uint64_t rgbas = 0, subpaths = 0, quads = 0;
+  for (uint32_t i = 0; i < columns->vmo_count; i++) {
+    rgbas += (uint64_t)columns->stroke_bg_rgbas_counts[i] +
+             columns->stroke_rgbas_counts[i] + columns->fill_rgbas_counts[i];
+    subpaths += columns->subpath_counts[i];
   }
+  for (uint32_t i = 0; i < columns->subpath_count; i++)
+    quads += columns->quad_counts[i];
 
-  /** Scratch Arenas **/
-  arena_t *scratch_manim_frame_arena = arena_alloc();
-  arena_t *scratch_string_arena = arena_alloc();
-  arena_t *scratch_cairo_svg_arena = arena_alloc();
+  return rgbas == columns->rgba_count &&
+         subpaths == columns->subpath_count &&
+         subpaths + 3 * quads == columns->point_count;
+}
 
-  /** Set up out_svg_frames header at the beginning of the blob **/
-  *out_svg_frames = arena_push_struct(svg_frames_blob_arena, svg_frames_t);
-  // Point frames to the svg slices/records in the meta arena
-  (*out_svg_frames)->frames = (void *)svg_frames_record_arena->base;
-  // Point the blob to where we are now in the blob arena, all svgs will follow
-  (*out_svg_frames)->blob = (void *)svg_frames_blob_arena->base;
+static int read_frame_columns_stream(arena_t *frame_arena, FILE *fp,
+                                     manim_frame_columns_t *columns) {
+  unsigned char header_block[MANIM_COLUMN_ALIGN];
+  if (fread(header_block, sizeof(header_block), 1, fp) != 1)
+    return 0;
+  manim_frame_v3_header_t header;
+  memcpy(&header, header_block, sizeof(header));
+  if (unlikely(memcmp(header.magic, "FRAM", 4) != 0)) {
+    fprintf(stderr, "Frame header magic malformed.\n");
+    return 0;
+  }
 
-  /** Read manim file header **/
-  manim_file_header_t file_header;
-  read_header(fp, &file_header);
+  frame_column_t described[COLUMN_COUNT];
+  frame_columns_describe(columns, &header, described);
+  if (unlikely(!frame_columns_check_payload(described, header.payload_size)))
+    return 0;
 
-  /** Build svg frames **/
-  int frame_index = 0;
-  manim_frame_t manim_frame;
-  while (read_frame(scratch_manim_frame_arena, fp, &manim_frame)) {
-
-    /**
-     * Build the SVG for the current animation frame
-     *
-     * 1. Read the next manim_frame_t from the input file.
-     * 2. For every VMO in the frame:
-     *      - Render the VMO to an in-memory Cairo SVG surface.
-     *      - Extract the single <path .../> element generated by Cairo,
-     *        discarding the surrounding <svg> prologue/epilogue.
-     *      - Inject a data-tag="<vmo-id>" attribute given the vmo id.
-     *      - Append the tagged path to the frame’s accumulating SVG buffer.
-     * 3. After all VMOs are handled, append the closing </svg> tag.
-     *
-     * The result is one self-contained SVG document per frame.
-     */
-
-    /** Set up svg slice record **/
-    svg_record_t *svg_record =
-        arena_push_struct(svg_frames_record_arena, svg_record_t);
-    // Update svg_length as we go
-    svg_record->length = 0;
-    size_t *svg_length = &svg_record->length;
-    svg_record->offset = svg_frames_blob_arena->pos;
-
-    /** Append svg header to svg blob **/
-    char svg_header[256];
-    snprintf(svg_header, sizeof(svg_header),
-             "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
-             "<svg xmlns=\"http://www.w3.org/2000/svg\" "
-             "xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
-             "width=\"%f\" height=\"%f\" viewBox=\"0 0 %f %f\" "
-             "style=\"background: black\">",
-             file_header.pixel_width, file_header.pixel_height,
-             file_header.pixel_width, file_header.pixel_height);
-
-    size_t copy_bytes = strlen(svg_header);
-    strncpy(arena_push(svg_frames_blob_arena, copy_bytes), svg_header,
-            copy_bytes);
-    *svg_length += copy_bytes;
-
-    /** Append each svg path (1 per vmo) to svg blob **/
-    for (uint32_t i = 0; i < manim_frame.vmo_count; i++) {
-
-      /** Setup cairo surface and context **/
-      cairo_surface_t *surface = cairo_svg_surface_create_for_stream(
-          cairo_buffer_writer, scratch_cairo_svg_arena, file_header.pixel_width,
-          file_header.pixel_height);
-      cairo_t *ctx = cairo_create(surface);
-      init_cairo_ctx(ctx, &file_header);
-
-      /** Render the vmo to a <path> object **/
-      const manim_vmo_t *vmo = &manim_frame.vmos[i];
-      render_vmo(ctx, vmo);
-
-      cairo_destroy(ctx);
-
-      const timespec_t perf_surface_destroy_start_time = ts_now();
-      // cairo flushes svg text to stream here
-      cairo_surface_destroy(surface);
-      const timespec_t perf_surface_destroy_end_time = ts_now();
-
-      // Just in case, ensure cairo svg data is null terminated
-      strncpy(arena_push(scratch_cairo_svg_arena, 1), "\0", 1);
-
-      double perf_surface_destroy_total_time = ts_elapsed_sec(
-          perf_surface_destroy_start_time, perf_surface_destroy_end_time);
-      perf_surface_destroy_cum_time += perf_surface_destroy_total_time;
-
-      /**
-       * Now scratch_cairo_svg_arena contains a full svg, with the header and
-       * closing tags included. We need to extract only the <path> object
-       * from this, append the data-tag=<id> attribute to it, then append the
-       * new tagged <path> object to our working svg frame.
-       *
-       * Note that sometimes cairo does not emit a <path> for the given vmo we
-       * are processing. Cairo either thinks it's hidden, culled or unrenderable
-       * for whatever reason. In this case, we bail and move on to the next vmo.
-       */
-
-      /** Extract <path> object **/
-      const char *svg_str = (const char *)scratch_cairo_svg_arena->base;
-      const char *path_str_begin = strstr(svg_str, "<path ");
-
-      if (path_str_begin == NULL) {
-        // Cairo did not emit a <path> for this vmo, bail.
-        arena_clear(scratch_cairo_svg_arena);
-        continue;
-      }
+  // One read per column, straight into its aligned buffer
+  for (size_t i = 0; i < COLUMN_COUNT; i++) {
+    const size_t padded = column_padded_size(described[i].size);
+    arena_push(frame_arena,
+               ALIGN_UP(frame_arena->pos, (size_t)MANIM_COLUMN_ALIGN) -
+                   frame_arena->pos);
+    void *data = arena_push(frame_arena, padded);
+    if (padded > 0 && fread(data, padded, 1, fp) != 1)
+      return 0;
+    *described[i].data = data;
+  }
+
+  return frame_columns_check_counts(columns);
+}
+
+/** Takes a version 3 frame header block, NULL at end of input **/
+static const unsigned char *
+take_frame_v3_header_mapped(const unsigned char *base, const size_t size,
+                            size_t *pos, manim_frame_v3_header_t *header) {
+  const unsigned char *header_block =
+      mapped_take(base, size, pos, MANIM_COLUMN_ALIGN);
+  if (!header_block)
+    return NULL;
+  memcpy(header, header_block, sizeof(*header));
+  if (unlikely(memcmp(header->magic, "FRAM", 4) != 0))
+    return NULL;
+  return header_block;
+}
+
+static int read_frame_columns_mapped(const unsigned char *base,
+                                     const size_t size, size_t *pos,
+                                     manim_frame_columns_t *columns) {
+  manim_frame_v3_header_t header;
+  if (!take_frame_v3_header_mapped(base, size, pos, &header)) {
+    fprintf(stderr, "Frame header malformed.\n");
+    return 0;
+  }
 
-      const char *path_str_end = strstr(path_str_begin, "/>");
+  frame_column_t described[COLUMN_COUNT];
+  frame_columns_describe(columns, &header, described);
+  if (unlikely(!frame_columns_check_payload(described, header.payload_size)))
+    return 0;
+
+  // Columns are aligned in the file and the mapping is page aligned
+  for (size_t i = 0; i < COLUMN_COUNT; i++) {
+    const unsigned char *data =
+        mapped_take(base, size, pos, column_padded_size(described[i].size));
+    if (unlikely(!data || (uintptr_t)data % MANIM_COLUMN_ALIGN != 0))
+      return 0;
+    *described[i].data = data;
+  }
+
+  return frame_columns_check_counts(columns);
+}
+
+static int skip_frame_v3_stream(FILE *fp) {
+  unsigned char header_block[MANIM_COLUMN_ALIGN];
+  if (fread(header_block, sizeof(header_block), 1, fp) != 1)
+    return 0;
+  manim_frame_v3_header_t header;
+  memcpy(&header, header_block, sizeof(header));
+  if (unlikely(memcmp(header.magic, "FRAM", 4) != 0))
+    return 0;
+  return fseeko(fp, (off_t)header.payload_size, SEEK_CUR) == 0;
+}
+
+static int skip_frame_v3_mapped(const unsigned char *base, const size_t size,
+                                size_t *pos) {
+  manim_frame_v3_header_t header;
+  return take_frame_v3_header_mapped(base, size, pos, &header) &&
+         mapped_take(base, size, pos, header.payload_size);
+}
+
+static manim_rgba_t *rgbas_from_columns(arena_t *frame_arena,
+                                        const float *vals,
+                                        const uint32_t count) {
+  manim_rgba_t *rgbas = arena_push_array(frame_arena, manim_rgba_t, count);
+  for (uint32_t i = 0; i < count; i++) {
+    memcpy(rgbas[i].magic, "RGBA", 4);
+    memcpy(rgbas[i].vals, &vals[4 * i], sizeof(rgbas[i].vals));
+  }
+  return rgbas;
+}
 
-      size_t count = (size_t)(path_str_end - path_str_begin);
+void manim_frame_from_columns(arena_t *frame_arena,
+                              const manim_frame_columns_t *columns,
+                              manim_frame_t *frame) {
+  memcpy(frame->magic, "FRAM", 4);
+  frame->vmo_count = columns->vmo_count;
+  frame->vmos =
+      arena_push_array(frame_arena, manim_vmo_t, columns->vmo_count);
 
-      char *path_str = arena_push(scratch_string_arena, count + 1);
-      memcpy(path_str, path_str_begin, count);
-      path_str[count] = '\0';
+  const float *rgba_vals = columns->rgbas;
+  const uint32_t *quad_counts = columns->quad_counts;
+  const float *xs = columns->xs;
+  const float *ys = columns->ys;
 
-      /** Append data-tag=<id> as an attribute at the end of the path **/
-      copy_bytes = strlen(path_str) + snprintf(NULL, 0, "%u", vmo->id) + 32;
-      char *tagged_path = arena_push(scratch_string_arena, copy_bytes);
-      snprintf(tagged_path, copy_bytes, "%s data-tag=\"%u\"/>\n", path_str,
-               vmo->id);
+  for (uint32_t i = 0; i < columns->vmo_count; i++) {
+    manim_vmo_t *vmo = &frame->vmos[i];
+    memcpy(vmo->magic, "VMOB", 4);
+    vmo->id = columns->ids[i];
+    vmo->stroke_bg_width = columns->stroke_bg_widths[i];
+    vmo->stroke_width = columns->stroke_widths[i];
+    vmo->stroke_bg_rgbas_count = columns->stroke_bg_rgbas_counts[i];
+    vmo->stroke_rgbas_count = columns->stroke_rgbas_counts[i];
+    vmo->fill_rgbas_count = columns->fill_rgbas_counts[i];
+    vmo->gradient_x0 = columns->gradients[4 * i];
+    vmo->gradient_y0 = columns->gradients[4 * i + 1];
+    vmo->gradient_x1 = columns->gradients[4 * i + 2];
+    vmo->gradient_y1 = columns->gradients[4 * i + 3];
+    vmo->subpath_count = columns->subpath_counts[i];
+
+    vmo->stroke_bg_rgbas = rgbas_from_columns(frame_arena, rgba_vals,
+                                              vmo->stroke_bg_rgbas_count);
+    rgba_vals += 4 * vmo->stroke_bg_rgbas_count;
+    vmo->stroke_rgbas =
+        rgbas_from_columns(frame_arena, rgba_vals, vmo->stroke_rgbas_count);
+    rgba_vals += 4 * vmo->stroke_rgbas_count;
+    vmo->fill_rgbas =
+        rgbas_from_columns(frame_arena, rgba_vals, vmo->fill_rgbas_count);
+    rgba_vals += 4 * vmo->fill_rgbas_count;
 
-      /** Copy final tagged <path> path into blob arena **/
-      copy_bytes = strlen(tagged_path);
-      strncpy(arena_push(svg_frames_blob_arena, copy_bytes), tagged_path, copy_bytes);
-      *svg_length += copy_bytes;
+    vmo->subpaths =
+        arena_push_array(frame_arena, manim_subpath_t, vmo->subpath_count);
+    for (uint32_t j = 0; j < vmo->subpath_count; j++) {
+      manim_subpath_t *subpath = &vmo->subpaths[j];
+      memcpy(subpath->magic, "SUBP", 4);
+      subpath->x = *xs++;
+      subpath->y = *ys++;
+      subpath->quad_count = *quad_counts++;
 
-      arena_clear(scratch_cairo_svg_arena);
+      subpath->quads =
+          arena_push_array(frame_arena, manim_quad_t, subpath->quad_count);
+      for (uint32_t k = 0; k < subpath->quad_count; k++) {
+        manim_quad_t *quad = &subpath->quads[k];
+        memcpy(quad->magic, "QUAD", 4);
+        quad->x1 = xs[0];
+        quad->y1 = ys[0];
+        quad->x2 = xs[1];
+        quad->y2 = ys[1];
+        quad->x3 = xs[2];
+        quad->y3 = ys[2];
+        xs += 3;
+        ys += 3;
+      }
     }
+  }
+}
+
+int manim_reader_next_frame_columns(manim_reader_t *reader,
+                                    arena_t *frame_arena,
+                                    manim_frame_columns_t *columns) {
+  if (reader->header.version != MANIM_DATA_VERSION_3)
+    return 0;
+  if (reader->mode != MANIM_INPUT_MMAP)
+    return read_frame_columns_stream(frame_arena, reader->fp, columns);
+
+  if (reader->map_pos == reader->map_size)
+    return 0;
+  return read_frame_columns_mapped(reader->map_base, reader->map_size,
+                                   &reader->map_pos, columns);
+}
+
+/** Checks the file version and takes in the version 2 header fields **/
+static int reader_init_version(manim_reader_t *reader,
+                               const manim_file_header_v2_t *header_v2) {
+  if (reader->header.version == MANIM_DATA_VERSION_1 ||
+      reader->header.version == MANIM_DATA_VERSION_3)
+    return 1;
 
-    /** Append closing svg tag **/
-    const char svg_close_tag[] = "</svg>";
-    copy_bytes = strlen(svg_close_tag);
-    strncpy(arena_push(svg_frames_blob_arena, copy_bytes), svg_close_tag, copy_bytes);
-    *svg_length += copy_bytes;
-
-    // printf("%s", svg_frame_buffer->data);
-    // Dump SVG data to a file named <frame_index>.svg
-    // {
-    //   char filename[512];
-    //   snprintf(filename, sizeof(filename),
-    //            "/Users/will/Documents/APP/website-content/manim/"
-    //            "newtons-fractal/test/%d.svg",
-    //            frame_index);
-    //   FILE *fout = fopen(filename, "wb");
-    //   if (fout) {
-    //     const void *src = svg_get_data(*out_svg_frames, frame_index);
-    //     fwrite(src, 1, svg_record->length,
-    //            fout);
-    //     fclose(fout);
-    //   } else {
-    //     perror("fopen SVG output failed");
-    //   }
-    // }
-
-    ++frame_index;
-    arena_clear(scratch_cairo_svg_arena);
-    arena_clear(scratch_string_arena);
-    arena_clear(scratch_manim_frame_arena);
+  if (reader->header.version != MANIM_DATA_VERSION_2) {
+    fprintf(stderr, "Unsupported file version %u.\n", reader->header.version);
+    return 0;
+  }
+  if (!header_v2 || !(header_v2->coord_scale > 0) ||
+      !isfinite(header_v2->coord_scale)) {
+    fprintf(stderr, "Version 2 file header malformed.\n");
+    return 0;
   }
+  reader->coord_unit = 1.0 / header_v2->coord_scale;
+  return manim_vmo_table_init(&reader->vmo_table);
+}
 
-  /** Release arenas **/
-  arena_release(scratch_manim_frame_arena);
-  arena_release(scratch_cairo_svg_arena);
-  arena_release(scratch_string_arena);
+/** Reads the file header from reader->fp **/
+static int reader_read_stream_header(manim_reader_t *reader) {
+  if (!read_header(reader->fp, &reader->header))
+    return 0;
 
-  /** Finalize frame count in the blob header **/
-  (*out_svg_frames)->num_frames = frame_index;
+  // Version 3 pads the file header so the first frame starts aligned
+  if (reader->header.version == MANIM_DATA_VERSION_3 &&
+      fseeko(reader->fp, MANIM_COLUMN_ALIGN, SEEK_SET) != 0)
+    return 0;
 
-  fclose(fp);
+  manim_file_header_v2_t header_v2;
+  const bool has_v2 =
+      reader->header.version == MANIM_DATA_VERSION_2 &&
+      fread(&header_v2, sizeof(header_v2), 1, reader->fp) == 1;
+  return reader_init_version(reader, has_v2 ? &header_v2 : NULL);
+}
 
-  timespec_t perf_total_end_time = ts_now();
-  double perf_total_time =
-      ts_elapsed_sec(perf_total_start_time, perf_total_end_time);
-  printf("Manim frontend completed. Total elapsed: %.4f seconds\n",
-         perf_total_time);
-  printf("Cum surface destroy time: %.4f seconds\n",
-         perf_surface_destroy_cum_time);
+int manim_reader_open_stream(manim_reader_t *reader, FILE *fp) {
+  memset(reader, 0, sizeof(*reader));
+  reader->mode = MANIM_INPUT_STREAM;
+  reader->fp = fp;
+  return reader_read_stream_header(reader);
+}
 
-  return 0;
+int manim_reader_open(manim_reader_t *reader, const char *file_path,
+                      const manim_input_mode_e mode) {
+  memset(reader, 0, sizeof(*reader));
+  reader->mode = mode;
+
+  if (mode == MANIM_INPUT_RING) {
+    reader->fp = manim_ring_fopen(file_path, MANIM_RING_OPEN_TIMEOUT_SEC);
+    if (!reader->fp)
+      return 0;
+  } else if (mode != MANIM_INPUT_MMAP) {
+    reader->fp = mode == MANIM_INPUT_URING ? manim_io_fopen_read(file_path)
+                                           : fopen(file_path, "rb");
+    if (!reader->fp) {
+      perror("fopen failed");
+      return 0;
+    }
+  }
+
+  if (mode != MANIM_INPUT_MMAP)
+    return reader_read_stream_header(reader);
+
+  const int fd = open(file_path, O_RDONLY);
+  if (fd < 0) {
+    perror("open failed");
+    return 0;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    perror("fstat failed");
+    close(fd);
+    return 0;
+  }
+  // An empty file cannot be mapped, and has no header to read either
+  if (st.st_size == 0) {
+    fprintf(stderr, "Input %s is empty.\n", file_path);
+    close(fd);
+    return 0;
+  }
+
+  void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file
+  close(fd);
+  if (map == MAP_FAILED) {
+    perror("mmap failed");
+    return 0;
+  }
+  madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+  reader->map_base = map;
+  reader->map_size = (size_t)st.st_size;
+  reader->map_pos = 0;
+
+  const unsigned char *file_header = mapped_take(
+      reader->map_base, reader->map_size, &reader->map_pos,
+      sizeof(reader->header));
+  if (!file_header) {
+    fprintf(stderr, "File header truncated.\n");
+    return 0;
+  }
+  memcpy(&reader->header, file_header, sizeof(reader->header));
+
+  if (memcmp(reader->header.magic, "CTXT", 4) != 0) {
+    fprintf(stderr, "File header magic malformed.\n");
+    return 0;
+  }
+
+  if (reader->header.version == MANIM_DATA_VERSION_3 &&
+      !mapped_take(reader->map_base, reader->map_size, &reader->map_pos,
+                   MANIM_COLUMN_ALIGN - sizeof(reader->header))) {
+    fprintf(stderr, "File header truncated.\n");
+    return 0;
+  }
+
+  manim_file_header_v2_t header_v2;
+  const unsigned char *header_v2_data = NULL;
+  if (reader->header.version == MANIM_DATA_VERSION_2) {
+    header_v2_data = mapped_take(reader->map_base, reader->map_size,
+                                 &reader->map_pos, sizeof(header_v2));
+    if (header_v2_data)
+      memcpy(&header_v2, header_v2_data, sizeof(header_v2));
+  }
+  return reader_init_version(reader, header_v2_data ? &header_v2 : NULL);
+}
+
+static int reader_next_frame(manim_reader_t *reader, arena_t *frame_arena,
+                             manim_frame_t *frame) {
+  if (reader->header.version == MANIM_DATA_VERSION_3) {
+    arena_push(frame_arena, ALIGN_UP(frame_arena->pos, 8) - frame_arena->pos);
+    manim_frame_columns_t *columns =
+        arena_push_struct(frame_arena, manim_frame_columns_t);
+    if (!columns ||
+        !manim_reader_next_frame_columns(reader, frame_arena, columns))
+      return 0;
+    manim_frame_from_columns(frame_arena, columns, frame);
+    frame->columns = columns;
+    return 1;
+  }
+
+  if (reader->header.version == MANIM_DATA_VERSION_2)
+    return read_frame_v2(reader, frame_arena, frame);
+
+  if (reader->mode != MANIM_INPUT_MMAP)
+    return read_frame(frame_arena, reader->fp, frame);
+
+  if (reader->map_pos == reader->map_size)
+    return 0;
+  return read_frame_mapped(frame_arena, reader->map_base, reader->map_size,
+                           &reader->map_pos, frame);
+}
+
+/**
+ * Whether the input ends before the next frame. A stream is peeked by one
+ * byte, so a frame cut short or a read error count as malformed.
+ */
+static bool reader_at_end(manim_reader_t *reader) {
+  if (reader->mode == MANIM_INPUT_MMAP)
+    return reader->map_pos == reader->map_size;
+
+  const int c = getc(reader->fp);
+  if (c == EOF)
+    return !ferror(reader->fp);
+  ungetc(c, reader->fp);
+  return false;
+}
+
+int manim_reader_next_frame(manim_reader_t *reader, arena_t *frame_arena,
+                            manim_frame_t *frame) {
+  frame->vmo_dirty = NULL;
+  frame->columns = NULL;
+  reader->at_end = reader_at_end(reader);
+  if (reader->at_end || !reader_next_frame(reader, frame_arena, frame))
+    return 0;
+  reader->frame_returned = true;
+  return 1;
+}
+
+/**
+ * Skips over one frame, reading only the record headers. Returns 1 if a whole
+ * frame was skipped, 0 at end of input or on a malformed frame.
+ */
+static int skip_frame_mapped(const unsigned char *base, const size_t size,
+                             size_t *pos) {
+  manim_frame_t frame;
+  const unsigned char *frame_header =
+      mapped_take(base, size, pos, offsetof(manim_frame_t, vmos));
+  if (!frame_header)
+    return 0;
+  memcpy(&frame, frame_header, offsetof(manim_frame_t, vmos));
+  if (unlikely(memcmp(frame.magic, "FRAM", 4) != 0))
+    return 0;
+
+  for (uint32_t i = 0; i < frame.vmo_count; i++) {
+    manim_vmo_t vmo;
+    const unsigned char *vmo_header =
+        mapped_take(base, size, pos, offsetof(manim_vmo_t, stroke_bg_rgbas));
+    if (unlikely(!vmo_header))
+      return 0;
+    memcpy(&vmo, vmo_header, offsetof(manim_vmo_t, stroke_bg_rgbas));
+
+    const size_t rgbas_count = (size_t)vmo.stroke_bg_rgbas_count +
+                               vmo.stroke_rgbas_count + vmo.fill_rgbas_count;
+    if (unlikely(!mapped_take(base, size, pos,
+                              sizeof(manim_rgba_t) * rgbas_count)))
+      return 0;
+
+    for (uint32_t j = 0; j < vmo.subpath_count; j++) {
+      manim_subpath_t subpath;
+      const unsigned char *subpath_header =
+          mapped_take(base, size, pos, offsetof(manim_subpath_t, quads));
+      if (unlikely(!subpath_header))
+        return 0;
+      memcpy(&subpath, subpath_header, offsetof(manim_subpath_t, quads));
+
+      if (unlikely(!mapped_take(base, size, pos,
+                                sizeof(manim_quad_t) * subpath.quad_count)))
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
+static int skip_frame_v2_stream(FILE *fp,
+                                manim_frame_v2_header_t *frame_header) {
+  if (fread(frame_header, sizeof(*frame_header), 1, fp) != 1)
+    return 0;
+  if (unlikely(memcmp(frame_header->magic, "FRAM", 4) != 0 &&
+               memcmp(frame_header->magic, "FDLT", 4) != 0))
+    return 0;
+  return fseeko(fp, (off_t)frame_header->payload_size, SEEK_CUR) == 0;
+}
+
+static int skip_frame_stream(FILE *fp) {
+  manim_frame_t frame;
+  if (fread(&frame, offsetof(manim_frame_t, vmos), 1, fp) != 1)
+    return 0;
+  if (unlikely(memcmp(frame.magic, "FRAM", 4) != 0))
+    return 0;
+
+  for (uint32_t i = 0; i < frame.vmo_count; i++) {
+    manim_vmo_t vmo;
+    if (fread(&vmo, offsetof(manim_vmo_t, stroke_bg_rgbas), 1, fp) != 1)
+      return 0;
+
+    const size_t rgbas_count = (size_t)vmo.stroke_bg_rgbas_count +
+                               vmo.stroke_rgbas_count + vmo.fill_rgbas_count;
+    if (fseeko(fp, (off_t)(sizeof(manim_rgba_t) * rgbas_count), SEEK_CUR) != 0)
+      return 0;
+
+    for (uint32_t j = 0; j < vmo.subpath_count; j++) {
+      manim_subpath_t subpath;
+      if (fread(&subpath, offsetof(manim_subpath_t, quads), 1, fp) != 1)
+        return 0;
+      if (fseeko(fp, (off_t)(sizeof(manim_quad_t) * subpath.quad_count),
+                 SEEK_CUR) != 0)
+        return 0;
+    }
+  }
+
+  return 1;
+}
+
+/** Marks an offset as a delta frame's while the index is built **/
+#define INDEX_DELTA_BIT (1ULL << 63)
+
+/** Frame offsets found by the scan, grown by doubling **/
+typedef struct index_offsets_t {
+  uint64_t *data;
+  size_t count;
+  size_t capacity;
+} index_offsets_t;
+
+static bool index_offsets_push(index_offsets_t *offsets, const uint64_t offset,
+                               const bool delta) {
+  if (offsets->count == offsets->capacity) {
+    const size_t capacity = offsets->capacity ? offsets->capacity * 2 : 1024;
+    uint64_t *data = realloc(offsets->data, capacity * sizeof(uint64_t));
+    if (!data)
+      return false;
+    offsets->data = data;
+    offsets->capacity = capacity;
+  }
+  offsets->data[offsets->count++] = offset | (delta ? INDEX_DELTA_BIT : 0);
+  return true;
+}
+
+/**
+ * Copies the offsets into the index arena and resolves the delta marks left
+ * in them to key frame numbers.
+ */
+static int index_finish(arena_t *index_arena, const index_offsets_t *offsets,
+                        manim_frame_index_t *index) {
+  const size_t count = offsets->count;
+  arena_push(index_arena, ALIGN_UP(index_arena->pos, 8) - index_arena->pos);
+  index->offsets = arena_push_array(index_arena, uint64_t, count);
+  index->key_frames = arena_push_array(index_arena, uint64_t, count);
+  if (!index->offsets || !index->key_frames) {
+    fprintf(stderr, "Frame index of %zu frames does not fit.\n", count);
+    return 0;
+  }
+
+  uint64_t key_frame = 0;
+  for (size_t i = 0; i < count; i++) {
+    const uint64_t offset = offsets->data[i];
+    if (!(offset & INDEX_DELTA_BIT))
+      key_frame = i;
+    index->offsets[i] = offset & ~INDEX_DELTA_BIT;
+    index->key_frames[i] = key_frame;
+  }
+  index->num_frames = count;
+  return 1;
+}
+
+int manim_reader_build_index(manim_reader_t *reader, arena_t *index_arena,
+                             manim_frame_index_t *index) {
+  index->num_frames = 0;
+  index_offsets_t offsets = {0};
+  bool pushed = true;
+
+  const uint32_t version = reader->header.version;
+  // Only version 2 frames set the magic, other versions index as key frames
+  manim_frame_v2_header_t frame_header;
+  memset(&frame_header, 0, sizeof(frame_header));
+
+  int ok;
+  bool malformed;
+  if (reader->mode != MANIM_INPUT_MMAP) {
+    const off_t start = ftello(reader->fp);
+    off_t offset = start;
+    while (pushed &&
+           (version == MANIM_DATA_VERSION_3 ? skip_frame_v3_stream(reader->fp)
+            : version == MANIM_DATA_VERSION_2
+                ? skip_frame_v2_stream(reader->fp, &frame_header)
+                : skip_frame_stream(reader->fp))) {
+      pushed = index_offsets_push(&offsets, (uint64_t)offset,
+                                  memcmp(frame_header.magic, "FDLT", 4) == 0);
+      offset = ftello(reader->fp);
+    }
+    // Skips seek, so a last frame cut short ends past the end of the file
+    // and is malformed like anything left before the end
+    clearerr(reader->fp);
+    const off_t end =
+        fseeko(reader->fp, 0, SEEK_END) == 0 ? ftello(reader->fp) : -1;
+    malformed = pushed && end != offset;
+    if (malformed && end < offset && offsets.count > 0)
+      --offsets.count;
+    ok = pushed && !malformed &&
+         index_finish(index_arena, &offsets, index) &&
+         fseeko(reader->fp, start, SEEK_SET) == 0;
+  } else {
+    size_t pos = reader->map_pos;
+    size_t offset = pos;
+    const unsigned char *base = reader->map_base;
+    const size_t size = reader->map_size;
+    while (pushed &&
+           (version == MANIM_DATA_VERSION_3
+                ? skip_frame_v3_mapped(base, size, &pos)
+            : version == MANIM_DATA_VERSION_2
+                ? take_frame_v2_mapped(base, size, &pos, &frame_header) != NULL
+                : skip_frame_mapped(base, size, &pos))) {
+      pushed = index_offsets_push(&offsets, (uint64_t)offset,
+                                  memcmp(frame_header.magic, "FDLT", 4) == 0);
+      offset = pos;
+    }
+    malformed = pushed && offset != size;
+    ok = pushed && !malformed && index_finish(index_arena, &offsets, index);
+  }
+
+  if (!pushed)
+    fprintf(stderr, "Out of memory indexing frame %zu.\n", offsets.count);
+  if (malformed)
+    fprintf(stderr, "Frame %zu is malformed.\n", offsets.count);
+  free(offsets.data);
+  return ok;
+}
+
+int manim_reader_seek_frame(manim_reader_t *reader,
+                            const manim_frame_index_t *index,
+                            const size_t frame_num) {
+  if (frame_num >= index->num_frames)
+    return 0;
+
+  // Deltas apply to the frame before, decode from the key frame on
+  const size_t key_frame = (size_t)index->key_frames[frame_num];
+  reader->replay_frames = frame_num - key_frame;
+  reader->frame_returned = false;
+
+  if (reader->mode != MANIM_INPUT_MMAP)
+    return fseeko(reader->fp, (off_t)index->offsets[key_frame], SEEK_SET) == 0;
+
+  reader->map_pos = (size_t)index->offsets[key_frame];
+  return 1;
+}
+
+void manim_reader_close(manim_reader_t *reader) {
+  manim_vmo_table_release(&reader->vmo_table);
+  if (reader->fp)
+    fclose(reader->fp);
+  if (reader->map_base)
+    munmap((void *)reader->map_base, reader->map_size);
+  memset(reader, 0, sizeof(*reader));
+}
+
+/**
+ * ===================================
+ *             SVG RENDERING
+ * ===================================
+ */
+
+int init_cairo_ctx(cairo_t *ctx, const manim_file_header_t *file_header) {
+  const double fw = file_header->frame_width;
+  const double fh = file_header->frame_height;
+
+  const double pw = file_header->pixel_width;
+  const double ph = file_header->pixel_height;
+
+  cairo_scale(ctx, pw, ph);
+  cairo_matrix_t matrix;
+  cairo_matrix_init(&matrix, pw / fw, 0, 0, -(ph / fh), (pw / 2), (ph / 2));
+
+  cairo_set_matrix(ctx, &matrix);
+  return 1;
+}
+
+int render_vmo(cairo_t *ctx, const manim_vmo_t *vmo,
+               manim_gradient_cache_t *gradients) {
+
+  cairo_new_path(ctx);
+  for (uint32_t j = 0; j < vmo->subpath_count; j++) {
+    manim_subpath_t *subpath = &vmo->subpaths[j];
+    cairo_new_sub_path(ctx);
+    cairo_move_to(ctx, subpath->x, subpath->y);
+    for (uint32_t k = 0; k < subpath->quad_count; k++) {
+      const manim_quad_t *quad = &subpath->quads[k];
+      cairo_curve_to(ctx, quad->x1, quad->y1, quad->x2, quad->y2, quad->x3,
+                     quad->y3);
+    }
+
+    if (manim_subpath_is_closed(subpath)) {
+      cairo_close_path(ctx);
+    }
+  }
+
+  apply_stroke(ctx, vmo, true, gradients);
+  apply_fill(ctx, vmo, gradients);
+  apply_stroke(ctx, vmo, false, gradients);
+
+  return 1;
+}
+
+cairo_status_t cairo_buffer_writer(void *closure, const unsigned char *data,
+                                   const unsigned int length) {
+  arena_t *arena = closure;
+  void *dest = arena_push(arena, length);
+  if (!dest)
+    return CAIRO_STATUS_NO_MEMORY;
+  memcpy(dest, data, length);
+  return CAIRO_STATUS_SUCCESS;
+}
+
+void cairo_path_stream_init(cairo_path_stream_t *stream,
+                            arena_t *svg_out_arena, const manim_vmo_t *vmos,
+                            const uint32_t vmo_count, const char *marker,
+                            const size_t marker_length) {
+  memset(stream, 0, sizeof(*stream));
+  stream->svg_out_arena = svg_out_arena;
+  stream->vmos = vmos;
+  stream->vmo_count = vmo_count;
+  stream->marker = marker;
+  stream->marker_length = marker_length;
+}
+
+/**
+ * Matches a fill or stroke paint at element[i], either as an attribute
+ * (fill="...") or as a style property (fill:...).
+ *
+ * @return The length of the name and its separator, 0 if there is none.
+ */
+static size_t cairo_path_stream_paint_at(const char *element,
+                                         const size_t count, const size_t i,
+                                         bool *out_fill) {
+  if (i == 0 || (element[i - 1] != ' ' && element[i - 1] != '"' &&
+                 element[i - 1] != ';'))
+    return 0;
+
+  size_t name_length;
+  if (count - i > 4 && memcmp(element + i, "fill", 4) == 0)
+    name_length = 4;
+  else if (count - i > 6 && memcmp(element + i, "stroke", 6) == 0)
+    name_length = 6;
+  else
+    return 0;
+
+  const size_t rest = count - i - name_length;
+  const char *sep = element + i + name_length;
+  *out_fill = name_length == 4;
+  if (rest >= 2 && sep[0] == '=' && sep[1] == '"')
+    return name_length + 2;
+  if (rest >= 1 && sep[0] == ':')
+    return name_length + 1;
+  return 0;
+}
+
+static bool cairo_path_stream_copy(arena_t *arena, const char *src,
+                                   const size_t length) {
+  void *dest = arena_push(arena, length);
+  if (!dest)
+    return false;
+  memcpy(dest, src, length);
+  return true;
+}
+
+/**
+ * Cairo names the gradients of a surface itself and writes them to <defs> the
+ * stream discards. Points every url(#...) paint of a kept element, at
+ * [element_offset, pos), to the gradient id of the paint instead.
+ *
+ * Which paint a reference belongs to follows from the attribute: fill is the
+ * fill, and a stroke is the foreground stroke unless the element is the bare
+ * background stroke Cairo emits first.
+ *
+ * The rewritten element is built past the end of the arena and then moved
+ * down over the original.
+ */
+static void cairo_path_stream_rewrite_gradients(cairo_path_stream_t *stream,
+                                                const manim_vmo_t *vmo) {
+  static const char url[] = "url(#";
+  const size_t url_length = sizeof(url) - 1;
+
+  arena_t *arena = stream->svg_out_arena;
+  const size_t element_offset = stream->element_offset;
+  const size_t count = arena->pos - element_offset;
+  const char *element = (const char *)arena->base + element_offset;
+
+  bool has_ref = false;
+  bool has_fill = false;
+  for (size_t i = 0; i < count; i++) {
+    bool fill;
+    const size_t skip = cairo_path_stream_paint_at(element, count, i, &fill);
+    if (skip == 0 || count - i - skip < 4)
+      continue;
+    const char *value = element + i + skip;
+    const bool is_url = memcmp(value, "url(", 4) == 0;
+    has_ref |= is_url && count - i - skip >= url_length && value[4] == '#';
+    has_fill |= fill && (is_url || memcmp(value, "rgb(", 4) == 0);
+  }
+  if (!has_ref)
+    return;
+
+  const context_color_t stroke_paint =
+      has_fill || vmo->stroke_bg_width == 0 ? C_STROKE : C_STROKE_BG;
+
+  const size_t out_offset = arena->pos;
+  size_t copied = 0;
+  size_t i = 0;
+  while (i < count) {
+    bool fill;
+    const size_t skip = cairo_path_stream_paint_at(element, count, i, &fill);
+    const size_t value = i + skip;
+    if (skip == 0 || count - value < url_length ||
+        memcmp(element + value, url, url_length) != 0) {
+      ++i;
+      continue;
+    }
+
+    size_t ref_end = value + url_length;
+    while (ref_end < count && element[ref_end] != ')')
+      ++ref_end;
+    if (ref_end == count)
+      break;
+
+    /** Everything up to and including "url(#" **/
+    char id[MANIM_GRADIENT_ID_SIZE];
+    manim_gradient_cache_ref(stream->gradients, vmo,
+                             fill ? C_FILL : stroke_paint, id);
+    if (!cairo_path_stream_copy(arena, element + copied,
+                                value + url_length - copied) ||
+        !cairo_path_stream_copy(arena, id, strlen(id))) {
+      arena_set_pos_back(arena, out_offset);
+      return;
+    }
+    copied = ref_end;
+    i = ref_end;
+  }
+  if (!cairo_path_stream_copy(arena, element + copied, count - copied)) {
+    arena_set_pos_back(arena, out_offset);
+    return;
+  }
+
+  const size_t out_length = arena->pos - out_offset;
+  memmove(arena->base + element_offset, arena->base + out_offset, out_length);
+  arena_set_pos_back(arena, element_offset + out_length);
+}
+
+/**
+ * Called once the closing '/>' of a path element has been copied. Keeps it,
+ * tagged, if it is the first path of the current vmo, otherwise pops it back
+ * off the arena.
+ */
+static void cairo_path_stream_end_element(cairo_path_stream_t *stream) {
+  arena_t *arena = stream->svg_out_arena;
+  const size_t count = arena->pos - stream->element_offset;
+  const char *element = (const char *)arena->base + stream->element_offset;
+
+  if (stream->marker && count == stream->marker_length &&
+      memcmp(element, stream->marker, count) == 0) {
+    arena_pop(arena, count);
+    ++stream->vmo_index;
+    stream->vmo_emitted = false;
+    return;
+  }
+
+  if (stream->vmo_emitted || stream->vmo_index >= stream->vmo_count) {
+    arena_pop(arena, count);
+    return;
+  }
+
+  const manim_vmo_t *vmo = &stream->vmos[stream->vmo_index];
+  if (stream->gradients)
+    cairo_path_stream_rewrite_gradients(stream, vmo);
+
+  /** Swap the closing '/>' for the data-tag attribute **/
+  arena_pop(arena, 2);
+  char tag[32];
+  const int tag_length =
+      snprintf(tag, sizeof(tag), " data-tag=\"%u\"/>\n", vmo->id);
+  memcpy(arena_push(arena, (size_t)tag_length), tag, (size_t)tag_length);
+
+  const size_t element_length = arena->pos - stream->element_offset;
+  if (stream->vmo_records) {
+    svg_record_t *vmo_record = &stream->vmo_records[stream->vmo_index];
+    vmo_record->offset = stream->element_offset;
+    vmo_record->length = element_length;
+  }
+
+  stream->svg_length += element_length;
+  stream->vmo_emitted = true;
+}
+
+cairo_status_t cairo_path_stream_writer(void *closure,
+                                        const unsigned char *data,
+                                        const unsigned int length) {
+  static const char open_tag[] = "<path ";
+  const size_t open_tag_length = sizeof(open_tag) - 1;
+
+  cairo_path_stream_t *stream = closure;
+  arena_t *arena = stream->svg_out_arena;
+
+  // Without markers, everything after the first path is discarded
+  if (!stream->marker && stream->vmo_emitted)
+    return CAIRO_STATUS_SUCCESS;
+
+  size_t i = 0;
+  while (i < length) {
+    if (!stream->in_element) {
+      /** Look for the next "<path " **/
+      if (stream->open_matched == 0) {
+        const unsigned char *lt = memchr(data + i, '<', length - i);
+        if (!lt)
+          break;
+        i = (size_t)(lt - data) + 1;
+        stream->open_matched = 1;
+        continue;
+      }
+
+      const unsigned char c = data[i++];
+      if (c == (unsigned char)open_tag[stream->open_matched]) {
+        if (++stream->open_matched == open_tag_length) {
+          stream->open_matched = 0;
+          stream->in_element = true;
+          stream->element_offset = arena->pos;
+          char *dest = arena_push(arena, open_tag_length);
+          if (!dest)
+            return CAIRO_STATUS_NO_MEMORY;
+          memcpy(dest, open_tag, open_tag_length);
+        }
+      } else {
+        stream->open_matched = c == '<' ? 1 : 0;
+      }
+      continue;
+    }
+
+    /** Copy up to and including the next '>' straight into the arena **/
+    const unsigned char *gt = memchr(data + i, '>', length - i);
+    const size_t take = gt ? (size_t)(gt - (data + i)) + 1 : length - i;
+    char *dest = arena_push(arena, take);
+    if (!dest)
+      return CAIRO_STATUS_NO_MEMORY;
+    memcpy(dest, data + i, take);
+    i += take;
+
+    if (gt && arena->pos - stream->element_offset > open_tag_length &&
+        arena->base[arena->pos - 2] == '/') {
+      stream->in_element = false;
+      cairo_path_stream_end_element(stream);
+      if (!stream->marker && stream->vmo_emitted)
+        break;
+    }
+  }
+
+  return CAIRO_STATUS_SUCCESS;
+}
+
+void set_cairo_context_color(cairo_t *ctx, const manim_vmo_t *vmo,
+                             const context_color_t context_color_type,
+                             manim_gradient_cache_t *gradients) {
+
+  uint32_t rgba_count;
+  const manim_rgba_t *rgbas =
+      manim_vmo_paint(vmo, context_color_type, &rgba_count);
+
+  if (rgba_count == 1) {
+    const manim_rgba_t *rgba = &rgbas[0];
+    cairo_set_source_rgba(ctx, rgba->vals[0], rgba->vals[1], rgba->vals[2],
+                          rgba->vals[3]);
+    return;
+  }
+
+  cairo_pattern_t *cached =
+      gradients ? manim_gradient_cache_pattern(gradients, vmo,
+                                               context_color_type)
+                : NULL;
+  if (cached) {
+    // The cache keeps its reference, the context takes its own
+    cairo_set_source(ctx, cached);
+    return;
+  }
+
+  cairo_pattern_t *pat = manim_gradient_create_pattern(vmo, context_color_type);
+  cairo_set_source(ctx, pat);
+  cairo_pattern_destroy(pat);
+}
+
+void apply_stroke(cairo_t *ctx, const manim_vmo_t *vmo, bool background,
+                  manim_gradient_cache_t *gradients) {
+  double width = background ? vmo->stroke_bg_width : vmo->stroke_width;
+  if (width == 0)
+    return;
+
+  set_cairo_context_color(ctx, vmo, background ? C_STROKE_BG : C_STROKE,
+                          gradients);
+  cairo_set_line_width(ctx, width * 0.01); // 0.01?
+  cairo_stroke_preserve(ctx);
+}
+
+void apply_fill(cairo_t *ctx, const manim_vmo_t *vmo,
+                manim_gradient_cache_t *gradients) {
+  set_cairo_context_color(ctx, vmo, C_FILL, gradients);
+  cairo_fill_preserve(ctx);
+}
+
+/**
+ * ===================================
+ *          FRAME RENDERING
+ * ===================================
+ */
+
+int manim_fe_worker_init(manim_fe_worker_t *worker,
+                         manim_gradient_table_t *gradient_table) {
+  worker->scratch_manim_frame_arena = arena_alloc();
+  worker->scratch_cairo_svg_arena = arena_alloc();
+  worker->perf_surface_destroy_cum_time = 0;
+  worker->renderer = MANIM_RENDERER_CAIRO;
+  worker->cairo_surface_mode = MANIM_CAIRO_SURFACE_PER_VMO;
+  worker->cairo_marker = NULL;
+  worker->cairo_marker_length = 0;
+  worker->use_render_cache = false;
+  worker->next_frame_num = 0;
+  const int gradients_ok =
+      manim_gradient_cache_init(&worker->gradients, gradient_table);
+  const int render_cache_ok = manim_render_cache_init(&worker->render_cache);
+  worker->vmo_keys =
+      map_create(sizeof(manim_vmo_key_t), alignof(manim_vmo_key_t));
+
+  return worker->scratch_manim_frame_arena &&
+         worker->scratch_cairo_svg_arena && gradients_ok && render_cache_ok &&
+         worker->vmo_keys;
+}
+
+void manim_fe_worker_release(manim_fe_worker_t *worker) {
+  if (worker->scratch_manim_frame_arena)
+    arena_release(worker->scratch_manim_frame_arena);
+  if (worker->scratch_cairo_svg_arena)
+    arena_release(worker->scratch_cairo_svg_arena);
+  free(worker->cairo_marker);
+  manim_gradient_cache_release(&worker->gradients);
+  manim_render_cache_release(&worker->render_cache);
+  if (worker->vmo_keys)
+    map_destroy(worker->vmo_keys);
+  memset(worker, 0, sizeof(*worker));
+}
+
+/**
+ * Draws the separator that follows every vmo on a per-frame surface: a 1x1
+ * device space square in a color no manim scene uses. It must stay on the
+ * page, Cairo culls anything outside of it.
+ */
+static void draw_vmo_marker(cairo_t *ctx) {
+  cairo_save(ctx);
+  cairo_identity_matrix(ctx);
+  cairo_new_path(ctx);
+  cairo_rectangle(ctx, 0, 0, 1, 1);
+  cairo_set_source_rgba(ctx, 1.0, 0.0, 1.0, 0.0123);
+  cairo_fill(ctx);
+  cairo_restore(ctx);
+}
+
+/**
+ * Finds the next <path .../> element in a null terminated svg document.
+ * Returns its start, or NULL, and sets *out_end one past its closing '/>'.
+ */
+static const char *next_path_element(const char *svg_str,
+                                     const char **out_end) {
+  const char *begin = strstr(svg_str, "<path ");
+  if (!begin)
+    return NULL;
+  const char *end = strstr(begin, "/>");
+  if (!end)
+    return NULL;
+  *out_end = end + 2;
+  return begin;
+}
+
+/**
+ * Renders the marker on its own surface and keeps the exact <path/> Cairo
+ * emits for it, so separators are recognised without depending on how Cairo
+ * formats numbers and colors. Returns 0 if Cairo emitted nothing or memory
+ * ran out, frames then fall back to a surface per vmo.
+ */
+static int calibrate_vmo_marker(manim_fe_worker_t *worker,
+                                const manim_file_header_t *file_header) {
+  arena_t *scratch_cairo_svg_arena = worker->scratch_cairo_svg_arena;
+
+  cairo_surface_t *surface = cairo_svg_surface_create_for_stream(
+      cairo_buffer_writer, scratch_cairo_svg_arena, file_header->pixel_width,
+      file_header->pixel_height);
+  cairo_t *ctx = cairo_create(surface);
+  init_cairo_ctx(ctx, file_header);
+  draw_vmo_marker(ctx);
+  cairo_destroy(ctx);
+  cairo_surface_destroy(surface);
+  strncpy(arena_push(scratch_cairo_svg_arena, 1), "\0", 1);
+
+  const char *end;
+  const char *begin =
+      next_path_element((const char *)scratch_cairo_svg_arena->base, &end);
+  if (begin) {
+    worker->cairo_marker = malloc((size_t)(end - begin));
+    if (worker->cairo_marker) {
+      worker->cairo_marker_length = (size_t)(end - begin);
+      memcpy(worker->cairo_marker, begin, worker->cairo_marker_length);
+    }
+  }
+
+  arena_clear(scratch_cairo_svg_arena);
+  return worker->cairo_marker != NULL;
+}
+
+/**
+ * Renders vmos onto a single Cairo surface, separated by markers. The path
+ * stream splits the output back into one tagged path per vmo as Cairo flushes
+ * it. Like the per-vmo mode, only the first <path> of each vmo is kept and vmos
+ * Cairo emits nothing for are skipped.
+ *
+ * vmo_nums holds the index of every vmo in its frame, NULL when vmos is the
+ * whole frame. vmo_records, when given, receives the range of each path.
+ */
+static size_t render_vmos_frame_surface(manim_fe_worker_t *worker,
+                                        const manim_file_header_t *file_header,
+                                        const size_t frame_num,
+                                        const manim_vmo_t *vmos,
+                                        const uint32_t *vmo_nums,
+                                        const uint32_t vmo_count,
+                                        arena_t *svg_out_arena,
+                                        svg_record_t *vmo_records) {
+  cairo_path_stream_t stream;
+  cairo_path_stream_init(&stream, svg_out_arena, vmos, vmo_count,
+                         worker->cairo_marker, worker->cairo_marker_length);
+  stream.gradients = &worker->gradients;
+  stream.vmo_records = vmo_records;
+
+  /** One surface and context for the whole frame **/
+  cairo_surface_t *surface = cairo_svg_surface_create_for_stream(
+      cairo_path_stream_writer, &stream, file_header->pixel_width,
+      file_header->pixel_height);
+  cairo_t *ctx = cairo_create(surface);
+  init_cairo_ctx(ctx, file_header);
+
+  for (uint32_t i = 0; i < vmo_count; i++) {
+    worker->gradients.use =
+        manim_gradient_use(frame_num, vmo_nums ? vmo_nums[i] : i);
+    render_vmo(ctx, &vmos[i], &worker->gradients);
+    draw_vmo_marker(ctx);
+  }
+
+  cairo_destroy(ctx);
+
+  const timespec_t perf_surface_destroy_start_time = ts_now();
+  // cairo flushes svg text to stream here
+  cairo_surface_destroy(surface);
+  worker->perf_surface_destroy_cum_time +=
+      ts_elapsed_sec(perf_surface_destroy_start_time, ts_now());
+
+  return stream.svg_length;
+}
+
+/**
+ * Render cache key of the i-th vmo of the frame. The reader marks the vmos a
+ * delta frame left unchanged, their key is the one taken the frame before.
+ */
+static manim_vmo_key_t manim_fe_vmo_key(manim_fe_worker_t *worker,
+                                        const manim_frame_t *manim_frame,
+                                        const uint32_t i) {
+  const manim_vmo_t *vmo = &manim_frame->vmos[i];
+  manim_vmo_key_t key;
+  if (manim_frame->vmo_dirty && !manim_frame->vmo_dirty[i] &&
+      map_get(worker->vmo_keys, vmo->id, &key))
+    return key;
+
+  key = manim_vmo_key(vmo);
+  map_put(worker->vmo_keys, vmo->id, &key);
+  return key;
+}
+
+/**
+ * Per-frame surface with the render cache. Cached paths and, on one surface,
+ * the paths of the vmos that missed are gathered in the scratch svg arena, then
+ * appended to svg_out_arena in vmo order.
+ */
+static size_t render_vmos_frame_surface_cached(
+    manim_fe_worker_t *worker, const manim_file_header_t *file_header,
+    const size_t frame_num, const manim_frame_t *manim_frame,
+    arena_t *svg_out_arena) {
+  // Both scratch arenas are cleared once the frame is done
+  arena_t *frame_arena = worker->scratch_manim_frame_arena;
+  arena_t *scratch_svg_arena = worker->scratch_cairo_svg_arena;
+  const uint32_t vmo_count = manim_frame->vmo_count;
+
+  /** The frame arena holds packed records, realign before the 8 byte arrays **/
+  arena_push(frame_arena, ALIGN_UP(frame_arena->pos, 8) - frame_arena->pos);
+  manim_vmo_key_t *keys =
+      arena_push_array(frame_arena, manim_vmo_key_t, vmo_count);
+  svg_record_t *records = arena_push_array(frame_arena, svg_record_t, vmo_count);
+  svg_record_t *miss_records =
+      arena_push_array_zero(frame_arena, svg_record_t, vmo_count);
+  uint32_t *miss_nums = arena_push_array(frame_arena, uint32_t, vmo_count);
+  manim_vmo_t *misses = arena_push_array(frame_arena, manim_vmo_t, vmo_count);
+  bool *hits = arena_push_array(frame_arena, bool, vmo_count);
+
+  /** Cached paths **/
+  uint32_t miss_count = 0;
+  for (uint32_t i = 0; i < vmo_count; i++) {
+    keys[i] = manim_fe_vmo_key(worker, manim_frame, i);
+    records[i].offset = scratch_svg_arena->pos;
+    hits[i] = manim_render_cache_get(&worker->render_cache, &keys[i],
+                                     scratch_svg_arena, &records[i].length);
+    if (!hits[i]) {
+      misses[miss_count] = manim_frame->vmos[i];
+      miss_nums[miss_count] = i;
+      ++miss_count;
+    }
+  }
+
+  /** Rendered paths **/
+  if (miss_count > 0) {
+    render_vmos_frame_surface(worker, file_header, frame_num, misses,
+                              miss_nums, miss_count, scratch_svg_arena,
+                              miss_records);
+    for (uint32_t j = 0; j < miss_count; j++)
+      records[miss_nums[j]] = miss_records[j];
+  }
+
+  /** Assemble in vmo order **/
+  size_t svg_length = 0;
+  for (uint32_t i = 0; i < vmo_count; i++) {
+    const svg_record_t *record = &records[i];
+    const void *svg = scratch_svg_arena->base + record->offset;
+    if (record->length > 0)
+      memcpy(arena_push(svg_out_arena, record->length), svg, record->length);
+    if (!hits[i])
+      manim_render_cache_put(&worker->render_cache, &keys[i], svg,
+                             record->length);
+    svg_length += record->length;
+  }
+
+  arena_clear(scratch_svg_arena);
+  return svg_length;
+}
+
+/**
+ * Renders a single vmo on its own Cairo surface and appends its tagged path.
+ */
+static size_t render_vmo_surface(manim_fe_worker_t *worker,
+                                 const manim_file_header_t *file_header,
+                                 const manim_vmo_t *vmo,
+                                 arena_t *svg_out_arena) {
+  /**
+   * Note that sometimes cairo does not emit a <path> for the given vmo we
+   * are processing. Cairo either thinks it's hidden, culled or unrenderable
+   * for whatever reason. In this case the stream appends nothing.
+   */
+  cairo_path_stream_t stream;
+  cairo_path_stream_init(&stream, svg_out_arena, vmo, 1, NULL, 0);
+  stream.gradients = &worker->gradients;
+
+  /** Setup cairo surface and context **/
+  cairo_surface_t *surface = cairo_svg_surface_create_for_stream(
+      cairo_path_stream_writer, &stream, file_header->pixel_width,
+      file_header->pixel_height);
+  cairo_t *ctx = cairo_create(surface);
+  init_cairo_ctx(ctx, file_header);
+
+  /** Render the vmo to a <path> object **/
+  render_vmo(ctx, vmo, &worker->gradients);
+
+  cairo_destroy(ctx);
+
+  const timespec_t perf_surface_destroy_start_time = ts_now();
+  // cairo flushes svg text to stream here
+  cairo_surface_destroy(surface);
+  const timespec_t perf_surface_destroy_end_time = ts_now();
+
+  double perf_surface_destroy_total_time = ts_elapsed_sec(
+      perf_surface_destroy_start_time, perf_surface_destroy_end_time);
+  worker->perf_surface_destroy_cum_time += perf_surface_destroy_total_time;
+
+  return stream.svg_length;
+}
+
+size_t manim_fe_render_frame(manim_fe_worker_t *worker,
+                             const manim_file_header_t *file_header,
+                             const size_t frame_num,
+                             const manim_frame_t *manim_frame,
+                             arena_t *svg_out_arena) {
+  /**
+   * Build the SVG for the current animation frame
+   *
+   * 1. For every VMO in the frame:
+   *      - With the render cache, copy the path of a VMO unchanged since the
+   *        previous frame and move on.
+   *      - With MANIM_RENDERER_DIRECT, map the VMO's coordinates to pixel
+   *        space in bulk, straight from the x and y columns of a version 3
+   *        frame, emit the tagged <path> and move on.
+   *      - With MANIM_CAIRO_SURFACE_PER_FRAME, see render_vmos_frame_surface.
+   *        Otherwise:
+   *      - Render the VMO to an in-memory Cairo SVG surface.
+   *      - As Cairo flushes the svg, the path stream picks out the single
+   *        <path .../> element, discarding the surrounding <svg>
+   *        prologue/epilogue, and appends it to the frame’s accumulating SVG
+   *        buffer with a data-tag="<vmo-id>" attribute injected.
+   *      - Gradients are registered with the worker's gradient cache and
+   *        referenced by their gradient table id.
+   * 2. After all VMOs are handled, append the closing </svg> tag.
+   *
+   * The result is one SVG document per frame. Gradients it references are
+   * defined once for all frames, see manim_gradient_table_emit_defs.
+   */
+  size_t svg_length = 0;
+
+  /** Append svg header to svg blob **/
+  char svg_header[256];
+  snprintf(svg_header, sizeof(svg_header),
+           "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+           "<svg xmlns=\"http://www.w3.org/2000/svg\" "
+           "xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+           "width=\"%f\" height=\"%f\" viewBox=\"0 0 %f %f\" "
+           "style=\"background: black\">",
+           file_header->pixel_width, file_header->pixel_height,
+           file_header->pixel_width, file_header->pixel_height);
+
+  size_t copy_bytes = strlen(svg_header);
+  memcpy(arena_push(svg_out_arena, copy_bytes), svg_header, copy_bytes);
+  svg_length += copy_bytes;
+
+  // A hit does not register the gradients of the vmo. That keeps their
+  // earliest use only while the cache holds the frame right before, so a
+  // worker that moves elsewhere, like a thread stealing a range, starts over.
+  if (worker->use_render_cache && frame_num != worker->next_frame_num)
+    manim_render_cache_clear(&worker->render_cache);
+  worker->next_frame_num = frame_num + 1;
+
+  // Keys of vmos the frame does not mark are reused, so they have to be
+  // from the frame before. Without marks the stale ids are dropped.
+  if (worker->use_render_cache && !manim_frame->vmo_dirty)
+    map_clear(worker->vmo_keys);
+
+  /** Append each svg path (1 per vmo) to svg blob **/
+  const bool frame_surface =
+      worker->renderer == MANIM_RENDERER_CAIRO &&
+      worker->cairo_surface_mode == MANIM_CAIRO_SURFACE_PER_FRAME &&
+      (worker->cairo_marker || calibrate_vmo_marker(worker, file_header));
+  if (frame_surface && worker->use_render_cache) {
+    svg_length += render_vmos_frame_surface_cached(
+        worker, file_header, frame_num, manim_frame, svg_out_arena);
+  } else if (frame_surface) {
+    svg_length += render_vmos_frame_surface(
+        worker, file_header, frame_num, manim_frame->vmos, NULL,
+        manim_frame->vmo_count, svg_out_arena, NULL);
+  }
+
+  const manim_xform_t xform = manim_xform_from_header(file_header);
+  manim_xform_kernel_t xform_kernel;
+  if (worker->renderer == MANIM_RENDERER_DIRECT)
+    manim_xform_kernel_init(&xform_kernel, &xform);
+
+  /** First point of the current vmo in the version 3 columns **/
+  const manim_frame_columns_t *columns = manim_frame->columns;
+  size_t column_point = 0;
+
+  for (uint32_t i = 0; !frame_surface && i < manim_frame->vmo_count; i++) {
+    const manim_vmo_t *vmo = &manim_frame->vmos[i];
+    worker->gradients.use = manim_gradient_use(frame_num, i);
+
+    const size_t vmo_point = column_point;
+    if (columns && worker->renderer == MANIM_RENDERER_DIRECT)
+      column_point += manim_xform_vmo_coord_count(vmo) / 2;
+
+    manim_vmo_key_t vmo_key = {0};
+    if (worker->use_render_cache) {
+      vmo_key = manim_fe_vmo_key(worker, manim_frame, i);
+      size_t cached_length;
+      if (manim_render_cache_get(&worker->render_cache, &vmo_key,
+                                 svg_out_arena, &cached_length)) {
+        svg_length += cached_length;
+        continue;
+      }
+    }
+
+    const size_t vmo_offset = svg_out_arena->pos;
+    size_t vmo_length;
+    if (worker->renderer == MANIM_RENDERER_DIRECT) {
+      /** Mapped coordinates only live until the vmo is emitted **/
+      arena_t *coord_arena = worker->scratch_manim_frame_arena;
+      const size_t coord_pos = arena_get_pos(coord_arena);
+      const double *coords =
+          columns ? manim_xform_points(&xform_kernel, columns->xs + vmo_point,
+                                       columns->ys + vmo_point,
+                                       manim_xform_vmo_coord_count(vmo) / 2,
+                                       coord_arena)
+                  : manim_xform_vmo(&xform_kernel, vmo, coord_arena);
+      vmo_length = coords ? emit_vmo_path(svg_out_arena, &xform, vmo, coords,
+                                          &worker->gradients)
+                          : 0;
+      arena_set_pos_back(coord_arena, coord_pos);
+    } else {
+      vmo_length = render_vmo_surface(worker, file_header, vmo, svg_out_arena);
+    }
+    svg_length += vmo_length;
+
+    if (worker->use_render_cache)
+      manim_render_cache_put(&worker->render_cache, &vmo_key,
+                             svg_out_arena->base + vmo_offset, vmo_length);
+  }
+
+  /** Append closing svg tag **/
+  const char svg_close_tag[] = "</svg>";
+  copy_bytes = strlen(svg_close_tag);
+  memcpy(arena_push(svg_out_arena, copy_bytes), svg_close_tag, copy_bytes);
+  svg_length += copy_bytes;
+
+  if (worker->use_render_cache)
+    manim_render_cache_next_frame(&worker->render_cache);
+
+  return svg_length;
+}
+
+/**
+ * ===================================
+ *         THREADED RENDERING
+ * ===================================
+ */
+
+static void manim_fe_worker_apply_opts(manim_fe_worker_t *worker,
+                                       const manim_fe_opts_t *opts) {
+  worker->renderer = opts->renderer;
+  worker->cairo_surface_mode = opts->cairo_surface_mode;
+  worker->use_render_cache = opts->render_cache;
+}
+
+/**
+ * Counters summed over all workers of a run.
+ */
+typedef struct manim_fe_stats_t {
+  double perf_surface_destroy_cum_time;
+  size_t render_cache_hits;
+  size_t render_cache_lookups;
+} manim_fe_stats_t;
+
+static void manim_fe_stats_add(manim_fe_stats_t *stats,
+                               const manim_fe_worker_t *worker) {
+  stats->perf_surface_destroy_cum_time += worker->perf_surface_destroy_cum_time;
+  stats->render_cache_hits += worker->render_cache.hits;
+  stats->render_cache_lookups += worker->render_cache.lookups;
+}
+
+/**
+ * Per-worker state of the threaded driver. Every pool worker owns a reader,
+ * its scratch arenas and an output arena, so nothing is shared while a batch
+ * is rendered.
+ */
+typedef struct manim_fe_thread_t {
+  manim_fe_worker_t worker;
+  manim_reader_t reader;
+  /** Frame the reader decodes next, a range starting there needs no seek **/
+  size_t next_frame;
+
+  /** Rendered frames of the batch, offsets are into svg_out_arena **/
+  arena_t *svg_out_arena;
+} manim_fe_thread_t;
+
+/**
+ * A batch of the threaded driver. Workers render ranges of it and record each
+ * frame by its position in the batch.
+ */
+typedef struct manim_fe_batch_t {
+  manim_fe_thread_t *threads;
+  const manim_file_header_t *file_header;
+  const manim_frame_index_t *frame_index;
+  size_t frame_begin;
+
+  svg_record_t *svg_records;
+  /** Worker whose svg_out_arena holds the frame, SIZE_MAX if it failed **/
+  size_t *svg_threads;
+} manim_fe_batch_t;
+
+static void manim_fe_render_range(void *ctx, const size_t begin,
+                                  const size_t end, pool_worker_t *pool_worker) {
+  manim_fe_batch_t *batch = ctx;
+  manim_fe_thread_t *thread = &batch->threads[pool_worker->index];
+  manim_fe_worker_t *worker = &thread->worker;
+
+  for (size_t i = begin; i < end; i++)
+    batch->svg_threads[i] = SIZE_MAX;
+
+  const size_t frame_begin = batch->frame_begin + begin;
+  const bool positioned = thread->next_frame == frame_begin;
+  thread->next_frame = SIZE_MAX;
+  if (!positioned && !manim_reader_seek_frame(&thread->reader,
+                                              batch->frame_index, frame_begin))
+    return;
+
+  manim_frame_t manim_frame;
+  for (size_t i = begin; i < end; i++) {
+    if (!manim_reader_next_frame(&thread->reader,
+                                 worker->scratch_manim_frame_arena,
+                                 &manim_frame))
+      return;
+
+    svg_record_t *svg_record = &batch->svg_records[i];
+    svg_record->offset = thread->svg_out_arena->pos;
+    svg_record->length = manim_fe_render_frame(
+        worker, batch->file_header, batch->frame_begin + i, &manim_frame,
+        thread->svg_out_arena);
+    batch->svg_threads[i] = pool_worker->index;
+
+    arena_clear(worker->scratch_manim_frame_arena);
+  }
+  thread->next_frame = batch->frame_begin + end;
+}
+
+/**
+ * Renders frames [frame_begin, frame_end] on a pool of num_threads workers in
+ * batches and commits them to the sink in frame order, so the output is
+ * identical to the single-threaded driver. A failed setup or frame stops the
+ * run with its status in sink_status, like a failed sink.
+ */
+static size_t manim_fe_render_threaded(const manim_fe_sink_t *sink,
+                                       const char *file_path,
+                                       const manim_fe_opts_t *opts,
+                                       const manim_file_header_t *file_header,
+                                       const manim_frame_index_t *frame_index,
+                                       manim_gradient_table_t *gradient_table,
+                                       manim_fe_stats_t *stats,
+                                       SvgAnimStatus *sink_status) {
+  const size_t num_threads = opts->num_threads;
+  const size_t batch_size = num_threads * MANIM_FE_THREAD_BATCH_FRAMES;
+  if (opts->frame_begin >= frame_index->num_frames)
+    return 0;
+
+  size_t frame_end = opts->frame_end;
+  if (frame_end >= frame_index->num_frames)
+    frame_end = frame_index->num_frames - 1;
+
+  manim_fe_batch_t batch = {
+      .threads = calloc(num_threads, sizeof(manim_fe_thread_t)),
+      .file_header = file_header,
+      .frame_index = frame_index,
+      .svg_records = malloc(sizeof(svg_record_t) * batch_size),
+      .svg_threads = malloc(sizeof(size_t) * batch_size)};
+  pool_t *pool = pool_create(num_threads);
+
+  size_t threads_ready = 0;
+  SvgAnimStatus setup_status = SVG_ANIM_STATUS_NO_MEMORY;
+  for (; batch.threads && threads_ready < num_threads; threads_ready++) {
+    manim_fe_thread_t *thread = &batch.threads[threads_ready];
+    thread->next_frame = SIZE_MAX;
+    thread->svg_out_arena = arena_alloc();
+    if (!manim_fe_worker_init(&thread->worker, gradient_table) ||
+        !thread->svg_out_arena)
+      break;
+    if (!manim_reader_open(&thread->reader, file_path, opts->input_mode)) {
+      setup_status = SVG_ANIM_STATUS_IO_ERROR;
+      break;
+    }
+    manim_fe_worker_apply_opts(&thread->worker, opts);
+  }
+
+  size_t frames_committed = 0;
+  size_t frame_num = opts->frame_begin;
+  bool ok = pool && batch.svg_records && batch.svg_threads &&
+            threads_ready == num_threads;
+  if (!ok)
+    *sink_status = setup_status;
+  while (ok && frame_num <= frame_end) {
+    const size_t batch_frames = frame_end - frame_num + 1 < batch_size
+                                    ? frame_end - frame_num + 1
+                                    : batch_size;
+
+    /** Render the batch, a contiguous run of frames per worker unless one
+     * finishes early and steals **/
+    batch.frame_begin = frame_num;
+    pool_parallel_for(pool, 0, batch_frames,
+                      (batch_frames + num_threads - 1) / num_threads,
+                      manim_fe_render_range, &batch);
+
+    /** Commit the batch in frame order **/
+    for (size_t i = 0; i < batch_frames && ok; i++) {
+      // The frame was indexed but did not decode
+      ok = batch.svg_threads[i] != SIZE_MAX;
+      if (!ok) {
+        *sink_status = SVG_ANIM_STATUS_MALFORMED_SVG;
+        break;
+      }
+      const svg_record_t *src = &batch.svg_records[i];
+      const arena_t *svg_out_arena =
+          batch.threads[batch.svg_threads[i]].svg_out_arena;
+      const size_t offset = sink->svg_arena->pos;
+      memcpy(arena_push(sink->svg_arena, src->length),
+             svg_out_arena->base + src->offset, src->length);
+      *sink_status =
+          sink->frame(sink->ctx, frames_committed, offset, src->length);
+      ok = *sink_status == SVG_ANIM_STATUS_SUCCESS;
+      ++frames_committed;
+    }
+    for (size_t t = 0; t < num_threads; t++)
+      arena_clear(batch.threads[t].svg_out_arena);
+
+    frame_num += batch_frames;
+  }
+
+  if (pool)
+    pool_destroy(pool);
+  for (size_t t = 0; batch.threads && t < num_threads; t++) {
+    manim_fe_thread_t *thread = &batch.threads[t];
+    manim_fe_stats_add(stats, &thread->worker);
+    manim_fe_worker_release(&thread->worker);
+    manim_reader_close(&thread->reader);
+    if (thread->svg_out_arena)
+      arena_release(thread->svg_out_arena);
+  }
+  free(batch.threads);
+  free(batch.svg_records);
+  free(batch.svg_threads);
+
+  return frames_committed;
+}
+
+/**
+ * ===================================
+ *        PIPELINED RENDERING
+ * ===================================
+ */
+
+/**
+ * State of the pipelined driver. Decoding, rendering and the sink run on their
+ * own threads and pass slot numbers through spsc rings:
+ *
+ *   decode --decoded--> render --rendered--> sink
+ *     ^                  |  ^                  |
+ *     +---free_frames----+  +-----free_svgs----+
+ *
+ * A frame slot owns the arena a frame is decoded into until it is rendered,
+ * an svg slot the arena a frame is rendered into until the sink has it.
+ */
+typedef struct manim_fe_pipeline_t {
+  manim_reader_t *reader;
+  const manim_file_header_t *file_header;
+  manim_fe_worker_t worker;
+  size_t frame_begin;
+  size_t frame_count;
+  /** Version 2 frames point into the reader's vmo table, which decoding the
+   * next frame may compact, so their arrays are copied into the slot **/
+  bool copy_views;
+
+  arena_t *frame_arenas[MANIM_FE_PIPELINE_SLOTS];
+  manim_frame_t frames[MANIM_FE_PIPELINE_SLOTS];
+  arena_t *svg_arenas[MANIM_FE_PIPELINE_SLOTS];
+  size_t svg_lengths[MANIM_FE_PIPELINE_SLOTS];
+
+  spsc_t *free_frames;
+  spsc_t *decoded;
+  spsc_t *free_svgs;
+  spsc_t *rendered;
+
+  /** Set by the sink stage, decoding stops at the next frame **/
+  _Atomic bool stop;
+  /** Set by the decode stage when a frame did not decode, read once it is
+   * joined **/
+  SvgAnimStatus decode_status;
+} manim_fe_pipeline_t;
+
+static void *manim_fe_pipeline_decode(void *arg) {
+  manim_fe_pipeline_t *pipeline = arg;
+
+  for (size_t i = 0; i < pipeline->frame_count; i++) {
+    if (atomic_load_explicit(&pipeline->stop, memory_order_relaxed))
+      break;
+
+    uint32_t slot;
+    spsc_pop_wait(pipeline->free_frames, &slot, 1);
+    arena_t *frame_arena = pipeline->frame_arenas[slot];
+    manim_frame_t *frame = &pipeline->frames[slot];
+    arena_clear(frame_arena);
+    if (!manim_reader_next_frame(pipeline->reader, frame_arena, frame)) {
+      // The end of the input, unless the frame did not decode
+      if (!pipeline->reader->at_end) {
+        pipeline->decode_status = SVG_ANIM_STATUS_MALFORMED_SVG;
+        atomic_store_explicit(&pipeline->stop, true, memory_order_relaxed);
+      }
+      break;
+    }
+    if (pipeline->copy_views)
+      for (uint32_t v = 0; v < frame->vmo_count; v++)
+        vmo_copy_data(frame_arena, &frame->vmos[v]);
+
+    spsc_push_wait(pipeline->decoded, &slot, 1);
+  }
+
+  spsc_close(pipeline->decoded);
+  return NULL;
+}
+
+static void *manim_fe_pipeline_render(void *arg) {
+  manim_fe_pipeline_t *pipeline = arg;
+  manim_fe_worker_t *worker = &pipeline->worker;
+
+  size_t frame_num = pipeline->frame_begin;
+  uint32_t frame_slot;
+  while (spsc_pop_wait(pipeline->decoded, &frame_slot, 1)) {
+    uint32_t svg_slot;
+    spsc_pop_wait(pipeline->free_svgs, &svg_slot, 1);
+    arena_t *svg_arena = pipeline->svg_arenas[svg_slot];
+    arena_clear(svg_arena);
+    pipeline->svg_lengths[svg_slot] = manim_fe_render_frame(
+        worker, pipeline->file_header, frame_num++,
+        &pipeline->frames[frame_slot], svg_arena);
+    arena_clear(worker->scratch_manim_frame_arena);
+
+    spsc_push_wait(pipeline->free_frames, &frame_slot, 1);
+    spsc_push_wait(pipeline->rendered, &svg_slot, 1);
+  }
+
+  spsc_close(pipeline->rendered);
+  return NULL;
+}
+
+static void manim_fe_pipeline_release(manim_fe_pipeline_t *pipeline) {
+  for (size_t i = 0; i < MANIM_FE_PIPELINE_SLOTS; i++) {
+    if (pipeline->frame_arenas[i])
+      arena_release(pipeline->frame_arenas[i]);
+    if (pipeline->svg_arenas[i])
+      arena_release(pipeline->svg_arenas[i]);
+  }
+  spsc_t *rings[] = {pipeline->free_frames, pipeline->decoded,
+                     pipeline->free_svgs, pipeline->rendered};
+  for (size_t i = 0; i < sizeof(rings) / sizeof(rings[0]); i++)
+    if (rings[i])
+      spsc_destroy(rings[i]);
+  manim_fe_worker_release(&pipeline->worker);
+}
+
+/**
+ * Decodes frame_count frames from reader and renders them, each stage on its
+ * own thread, while the calling thread hands the frames to the sink in order.
+ * Prints how often each stage waited on its neighbours, the stage the others
+ * wait on is the bottleneck. A failed setup, frame or sink stops the run with
+ * its status in sink_status, like the threaded driver.
+ */
+static size_t manim_fe_render_pipelined(const manim_fe_sink_t *sink,
+                                        manim_reader_t *reader,
+                                        const manim_fe_opts_t *opts,
+                                        const size_t frame_count,
+                                        manim_gradient_table_t *gradient_table,
+                                        manim_fe_stats_t *stats,
+                                        SvgAnimStatus *sink_status) {
+  manim_fe_pipeline_t *pipeline = calloc(1, sizeof(*pipeline));
+  if (!pipeline) {
+    *sink_status = SVG_ANIM_STATUS_NO_MEMORY;
+    return 0;
+  }
+  pipeline->reader = reader;
+  pipeline->file_header = &reader->header;
+  pipeline->frame_begin = opts->frame_begin;
+  pipeline->frame_count = frame_count;
+  pipeline->copy_views = reader->header.version == MANIM_DATA_VERSION_2;
+  atomic_init(&pipeline->stop, false);
+  pipeline->decode_status = SVG_ANIM_STATUS_SUCCESS;
+
+  bool ok = manim_fe_worker_init(&pipeline->worker, gradient_table);
+  manim_fe_worker_apply_opts(&pipeline->worker, opts);
+
+  pipeline->free_frames = spsc_create(MANIM_FE_PIPELINE_SLOTS, sizeof(uint32_t));
+  pipeline->decoded = spsc_create(MANIM_FE_PIPELINE_SLOTS, sizeof(uint32_t));
+  pipeline->free_svgs = spsc_create(MANIM_FE_PIPELINE_SLOTS, sizeof(uint32_t));
+  pipeline->rendered = spsc_create(MANIM_FE_PIPELINE_SLOTS, sizeof(uint32_t));
+  ok = ok && pipeline->free_frames && pipeline->decoded &&
+       pipeline->free_svgs && pipeline->rendered;
+  for (uint32_t slot = 0; ok && slot < MANIM_FE_PIPELINE_SLOTS; slot++) {
+    pipeline->frame_arenas[slot] = arena_alloc();
+    pipeline->svg_arenas[slot] = arena_alloc();
+    ok = pipeline->frame_arenas[slot] && pipeline->svg_arenas[slot];
+    if (ok) {
+      spsc_push_n(pipeline->free_frames, &slot, 1);
+      spsc_push_n(pipeline->free_svgs, &slot, 1);
+    }
+  }
+
+  pthread_t decode_thread, render_thread;
+  if (!ok ||
+      pthread_create(&decode_thread, NULL, manim_fe_pipeline_decode,
+                     pipeline) != 0) {
+    manim_fe_pipeline_release(pipeline);
+    free(pipeline);
+    *sink_status = SVG_ANIM_STATUS_NO_MEMORY;
+    return 0;
+  }
+  if (pthread_create(&render_thread, NULL, manim_fe_pipeline_render,
+                     pipeline) != 0) {
+    // Stand in for the render stage until decoding sees stop
+    atomic_store_explicit(&pipeline->stop, true, memory_order_relaxed);
+    uint32_t slot;
+    while (spsc_pop_wait(pipeline->decoded, &slot, 1))
+      spsc_push_wait(pipeline->free_frames, &slot, 1);
+    pthread_join(decode_thread, NULL);
+    manim_fe_pipeline_release(pipeline);
+    free(pipeline);
+    *sink_status = SVG_ANIM_STATUS_NO_MEMORY;
+    return 0;
+  }
+
+  /** Sink stage, hands the rendered frames over in order **/
+  size_t frames_passed = 0;
+  uint32_t slots[MANIM_FE_PIPELINE_SLOTS];
+  size_t popped;
+  while ((popped = spsc_pop_wait(pipeline->rendered, slots,
+                                 MANIM_FE_PIPELINE_SLOTS)) > 0) {
+    for (size_t i = 0; i < popped; i++) {
+      if (*sink_status != SVG_ANIM_STATUS_SUCCESS)
+        continue;
+      const size_t length = pipeline->svg_lengths[slots[i]];
+      const size_t offset = sink->svg_arena->pos;
+      memcpy(arena_push(sink->svg_arena, length),
+             pipeline->svg_arenas[slots[i]]->base, length);
+      *sink_status = sink->frame(sink->ctx, frames_passed++, offset, length);
+      if (*sink_status != SVG_ANIM_STATUS_SUCCESS)
+        atomic_store_explicit(&pipeline->stop, true, memory_order_relaxed);
+    }
+    spsc_push_wait(pipeline->free_svgs, slots, popped);
+  }
+
+  pthread_join(decode_thread, NULL);
+  pthread_join(render_thread, NULL);
+  // Every frame before the one that did not decode went to the sink
+  if (*sink_status == SVG_ANIM_STATUS_SUCCESS)
+    *sink_status = pipeline->decode_status;
+
+  printf("Pipeline stalls: decode %zu (no free frame), render %zu (no frame) "
+         "%zu (no free svg), sink %zu (no svg)\n",
+         pipeline->free_frames->pop_stalls, pipeline->decoded->pop_stalls,
+         pipeline->free_svgs->pop_stalls, pipeline->rendered->pop_stalls);
+
+  manim_fe_stats_add(stats, &pipeline->worker);
+  manim_fe_pipeline_release(pipeline);
+  free(pipeline);
+  return frames_passed;
+}
+
+/**
+ * ===================================
+ *        FRAME PUSH SESSION
+ * ===================================
+ */
+
+/** The session reader's FILE, serving the bytes of the current push **/
+static ssize_t manim_fe_session_read(void *cookie, char *buf,
+                                     const size_t size) {
+  manim_fe_session_t *session = cookie;
+  size_t count = session->input_size - session->input_pos;
+  if (count > size)
+    count = size;
+  memcpy(buf, session->input + session->input_pos, count);
+  session->input_pos += count;
+  return (ssize_t)count;
+}
+
+static int manim_fe_session_seek(void *cookie, int64_t *offset,
+                                 const int whence) {
+  manim_fe_session_t *session = cookie;
+  const int64_t base = whence == SEEK_SET   ? 0
+                       : whence == SEEK_CUR ? (int64_t)session->input_pos
+                                            : (int64_t)session->input_size;
+  const int64_t target = base + *offset;
+  if (target < 0 || target > (int64_t)session->input_size)
+    return -1;
+  session->input_pos = (size_t)target;
+  *offset = target;
+  return 0;
+}
+
+/** Points the reader at bytes, which must be consumed exactly **/
+static void manim_fe_session_input(manim_fe_session_t *session,
+                                   const void *bytes, const size_t size) {
+  session->input = bytes;
+  session->input_size = size;
+  session->input_pos = 0;
+  clearerr(session->reader.fp);
+}
+
+int manim_fe_session_open(manim_fe_session_t *session, const void *header,
+                          const size_t header_size,
+                          const manim_fe_opts_t *opts,
+                          const manim_fe_sink_t *sink) {
+  memset(session, 0, sizeof(*session));
+  session->opts = *opts;
+  session->sink = *sink;
+  session->sink_status = SVG_ANIM_STATUS_SUCCESS;
+
+  const cookie_io_t io = {.read = manim_fe_session_read,
+                          .seek = manim_fe_session_seek,
+                          .close = NULL};
+  FILE *fp = cookie_fopen(session, &io);
+  if (!fp)
+    return 0;
+  // Unbuffered, so input_pos is exactly what the reader consumed
+  setvbuf(fp, NULL, _IONBF, 0);
+
+  session->input = header;
+  session->input_size = header_size;
+  if (!manim_reader_open_stream(&session->reader, fp) ||
+      session->input_pos != header_size) {
+    manim_reader_close(&session->reader);
+    return 0;
+  }
+  session->input = NULL;
+  session->input_size = 0;
+  session->input_pos = 0;
+
+  if (!manim_gradient_table_init(&session->gradient_table,
+                                 &session->reader.header)) {
+    manim_gradient_table_release(&session->gradient_table);
+    manim_reader_close(&session->reader);
+    return 0;
+  }
+  if (!manim_fe_worker_init(&session->worker, &session->gradient_table)) {
+    manim_fe_worker_release(&session->worker);
+    manim_gradient_table_release(&session->gradient_table);
+    manim_reader_close(&session->reader);
+    return 0;
+  }
+  manim_fe_worker_apply_opts(&session->worker, opts);
+  session->open = true;
+  return 1;
+}
+
+int manim_fe_session_push(manim_fe_session_t *session, const void *frame,
+                          const size_t frame_size) {
+  if (!session->open || session->finished || session->failed)
+    return 0;
+
+  manim_fe_session_input(session, frame, frame_size);
+  manim_frame_t manim_frame;
+  const int decoded =
+      manim_reader_next_frame(&session->reader,
+                              session->worker.scratch_manim_frame_arena,
+                              &manim_frame) &&
+      session->input_pos == frame_size;
+  manim_fe_session_input(session, NULL, 0);
+  if (!decoded) {
+    // A version 2 frame may have been applied to the vmo table in part
+    arena_clear(session->worker.scratch_manim_frame_arena);
+    session->failed = true;
+    return 0;
+  }
+
+  const size_t offset = session->sink.svg_arena->pos;
+  const size_t length = manim_fe_render_frame(
+      &session->worker, &session->reader.header, session->num_frames,
+      &manim_frame, session->sink.svg_arena);
+  arena_clear(session->worker.scratch_manim_frame_arena);
+
+  session->sink_status = session->sink.frame(
+      session->sink.ctx, session->num_frames, offset, length);
+  ++session->num_frames;
+  session->failed = session->sink_status != SVG_ANIM_STATUS_SUCCESS;
+  return !session->failed;
+}
+
+int manim_fe_session_finish(manim_fe_session_t *session) {
+  if (!session->open || session->finished || session->failed)
+    return 0;
+  session->finished = true;
+
+  if (session->sink.defs) {
+    const size_t offset = session->sink.svg_arena->pos;
+    const size_t length = manim_gradient_table_emit_defs(
+        &session->gradient_table, session->sink.svg_arena);
+    session->sink_status =
+        session->sink.defs(session->sink.ctx, offset, length);
+    session->failed = session->sink_status != SVG_ANIM_STATUS_SUCCESS;
+  }
+  return !session->failed;
+}
+
+void manim_fe_session_close(manim_fe_session_t *session) {
+  if (session->open) {
+    manim_fe_worker_release(&session->worker);
+    manim_gradient_table_release(&session->gradient_table);
+    manim_reader_close(&session->reader);
+  }
+  memset(session, 0, sizeof(*session));
+}
+
+/**
+ * ===================================
+ *              DRIVER
+ * ===================================
+ */
+
+int manim_fe_stream(const char *file_path, const manim_fe_opts_t *opts,
+                    const manim_fe_sink_t *sink, size_t *out_num_frames) {
+  printf("Starting Manim frontend driver..\n");
+
+  timespec_t perf_total_start_time = ts_now();
+  manim_fe_stats_t stats = {0};
+
+  printf("Reading from: %s (%s, %s renderer, %zu thread%s%s)\n", file_path,
+         opts->input_mode == MANIM_INPUT_MMAP   ? "mmap"
+         : opts->input_mode == MANIM_INPUT_RING ? "ring"
+         : opts->input_mode == MANIM_INPUT_URING
+             ? manim_io_uring_available() ? "io_uring" : "stream, no io_uring"
+             : "stream",
+         opts->renderer == MANIM_RENDERER_DIRECT ? "direct"
+         : opts->cairo_surface_mode == MANIM_CAIRO_SURFACE_PER_FRAME
+             ? "cairo frame surface"
+             : "cairo",
+         opts->num_threads, opts->num_threads == 1 ? "" : "s",
+         opts->pipeline ? ", pipelined" : "");
+
+  if (opts->pipeline && opts->num_threads > 1) {
+    printf("The pipeline renders on one thread, it cannot be combined with "
+           "--threads.\n");
+    return 1;
+  }
+
+  // Threads and frame ranges seek through a frame index
+  if (opts->input_mode == MANIM_INPUT_RING &&
+      (opts->num_threads > 1 || opts->frame_begin != 0 ||
+       opts->frame_end != MANIM_FE_FRAME_END)) {
+    printf("Ring input is read in order on one thread, without --threads or "
+           "--frames.\n");
+    return 1;
+  }
+
+  /** File handling, reads the manim file header **/
+  manim_reader_t reader;
+  if (!manim_reader_open(&reader, file_path, opts->input_mode)) {
+    manim_reader_close(&reader);
+    return 1;
+  }
+  const manim_file_header_t file_header = reader.header;
+
+  /** Index frames and seek to the first requested frame **/
+  const bool threaded = opts->num_threads > 1;
+  arena_t *frame_index_arena = NULL;
+  manim_frame_index_t frame_index_table;
+  if (threaded || opts->frame_begin != 0 ||
+      opts->frame_end != MANIM_FE_FRAME_END) {
+    frame_index_arena = arena_alloc();
+    const timespec_t perf_index_start_time = ts_now();
+    const bool indexed = manim_reader_build_index(&reader, frame_index_arena,
+                                                  &frame_index_table);
+    // An empty file has no frame 0 to seek to, but is an empty result
+    if (!indexed ||
+        (!(frame_index_table.num_frames == 0 && opts->frame_begin == 0) &&
+         !manim_reader_seek_frame(&reader, &frame_index_table,
+                                  opts->frame_begin))) {
+      if (indexed)
+        printf("Frame %zu is out of range.\n", opts->frame_begin);
+      arena_release(frame_index_arena);
+      manim_reader_close(&reader);
+      return 1;
+    }
+    printf("Indexed %zu frames in %.4f seconds\n",
+           frame_index_table.num_frames,
+           ts_elapsed_sec(perf_index_start_time, ts_now()));
+  }
+  size_t frames_remaining = opts->frame_end == MANIM_FE_FRAME_END
+                                ? SIZE_MAX
+                                : opts->frame_end - opts->frame_begin + 1;
+
+  /** Gradients shared by all frames **/
+  manim_gradient_table_t gradient_table;
+  if (!manim_gradient_table_init(&gradient_table, &file_header)) {
+    manim_gradient_table_release(&gradient_table);
+    if (frame_index_arena)
+      arena_release(frame_index_arena);
+    manim_reader_close(&reader);
+    return 1;
+  }
+
+  /** Build svg frames **/
+  size_t frame_index = 0;
+  SvgAnimStatus sink_status = SVG_ANIM_STATUS_SUCCESS;
+  if (threaded) {
+    frame_index = manim_fe_render_threaded(sink, file_path, opts, &file_header,
+                                           &frame_index_table, &gradient_table,
+                                           &stats, &sink_status);
+  } else if (opts->pipeline) {
+    frame_index = manim_fe_render_pipelined(sink, &reader, opts,
+                                            frames_remaining, &gradient_table,
+                                            &stats, &sink_status);
+  } else {
+    manim_fe_worker_t worker;
+    if (!manim_fe_worker_init(&worker, &gradient_table)) {
+      manim_fe_worker_release(&worker);
+      manim_gradient_table_release(&gradient_table);
+      if (frame_index_arena)
+        arena_release(frame_index_arena);
+      manim_reader_close(&reader);
+      return 1;
+    }
+    manim_fe_worker_apply_opts(&worker, opts);
+
+    manim_frame_t manim_frame;
+    while (sink_status == SVG_ANIM_STATUS_SUCCESS && frames_remaining-- > 0) {
+      if (!manim_reader_next_frame(&reader, worker.scratch_manim_frame_arena,
+                                   &manim_frame)) {
+        // The end of the input, unless the frame did not decode
+        if (!reader.at_end)
+          sink_status = SVG_ANIM_STATUS_MALFORMED_SVG;
+        break;
+      }
+
+      const size_t offset = sink->svg_arena->pos;
+      const size_t length =
+          manim_fe_render_frame(&worker, &file_header,
+                                opts->frame_begin + frame_index, &manim_frame,
+                                sink->svg_arena);
+      arena_clear(worker.scratch_manim_frame_arena);
+
+      sink_status = sink->frame(sink->ctx, frame_index, offset, length);
+      ++frame_index;
+    }
+
+    manim_fe_stats_add(&stats, &worker);
+    manim_fe_worker_release(&worker);
+  }
+
+  /** Shared gradient defs follow the frames **/
+  if (sink->defs && sink_status == SVG_ANIM_STATUS_SUCCESS) {
+    const size_t offset = sink->svg_arena->pos;
+    const size_t length =
+        manim_gradient_table_emit_defs(&gradient_table, sink->svg_arena);
+    sink_status = sink->defs(sink->ctx, offset, length);
+  }
+  const size_t gradient_count = gradient_table.entry_count;
+  manim_gradient_table_release(&gradient_table);
+
+  /** Release arenas **/
+  if (frame_index_arena)
+    arena_release(frame_index_arena);
+
+  *out_num_frames = frame_index;
+
+  manim_reader_close(&reader);
+
+  timespec_t perf_total_end_time = ts_now();
+  double perf_total_time =
+      ts_elapsed_sec(perf_total_start_time, perf_total_end_time);
+  printf("Manim frontend completed. Total elapsed: %.4f seconds\n",
+         perf_total_time);
+  printf("Cum surface destroy time: %.4f seconds\n",
+         stats.perf_surface_destroy_cum_time);
+  if (opts->render_cache)
+    printf("Render cache: %zu/%zu hits (%.1f%%)\n", stats.render_cache_hits,
+           stats.render_cache_lookups,
+           stats.render_cache_lookups
+               ? 100.0 * stats.render_cache_hits / stats.render_cache_lookups
+               : 0.0);
+  printf("Unique gradients: %zu\n", gradient_count);
+
+  if (sink_status != SVG_ANIM_STATUS_SUCCESS) {
+    printf("Frames stopped after %zu frames.\n", frame_index);
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Keeps every frame, recording where it lies in the blob.
+ */
+typedef struct manim_fe_collect_t {
+  arena_t *svg_frames_record_arena;
+  svg_frames_t *svg_frames;
+} manim_fe_collect_t;
+
+static SvgAnimStatus manim_fe_collect_frame(void *ctx, const size_t frame_num,
+                                            const size_t offset,
+                                            const size_t length) {
+  manim_fe_collect_t *collect = ctx;
+  svg_record_t *svg_record =
+      arena_push_struct(collect->svg_frames_record_arena, svg_record_t);
+  if (!svg_record)
+    return SVG_ANIM_STATUS_NO_MEMORY;
+  svg_record->offset = offset;
+  svg_record->length = length;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static SvgAnimStatus manim_fe_collect_defs(void *ctx, const size_t offset,
+                                           const size_t length) {
+  manim_fe_collect_t *collect = ctx;
+  collect->svg_frames->defs.offset = offset;
+  collect->svg_frames->defs.length = length;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+int manim_fe_driver(arena_t *svg_frames_blob_arena,
+                    arena_t *svg_frames_record_arena,
+                    const char *file_path,
+                    const manim_fe_opts_t *opts,
+                    svg_frames_t **out_svg_frames) {
+  /** Set up out_svg_frames header at the beginning of the blob **/
+  *out_svg_frames = arena_push_struct_zero(svg_frames_blob_arena, svg_frames_t);
+  // Point frames to the svg slices/records in the meta arena
+  (*out_svg_frames)->frames = (void *)svg_frames_record_arena->base;
+  // Point the blob to where we are now in the blob arena, all svgs will follow
+  (*out_svg_frames)->blob = (void *)svg_frames_blob_arena->base;
+
+  manim_fe_collect_t collect = {.svg_frames_record_arena =
+                                    svg_frames_record_arena,
+                                .svg_frames = *out_svg_frames};
+  const manim_fe_sink_t sink = {.svg_arena = svg_frames_blob_arena,
+                                .ctx = &collect,
+                                .frame = manim_fe_collect_frame,
+                                .defs = manim_fe_collect_defs};
+  return manim_fe_stream(file_path, opts, &sink,
+                         &(*out_svg_frames)->num_frames);
 }
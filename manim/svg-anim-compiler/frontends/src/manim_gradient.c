@@ -0,0 +1,404 @@
+#include <cairo.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ctrs/map.h"
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "common/hash.h"
+#include "manim/manim_emit.h"
+#include "manim/manim_fe.h"
+
+#define GRADIENT_CHAIN_END UINT32_MAX
+
+/**
+ * ===================================
+ *              GRADIENTS
+ * ===================================
+ */
+
+/** Seed of manim_gradient_tag, any other than HASH_SEED **/
+#define GRADIENT_TAG_SEED 0xc2b2ae3d27d4eb4fULL
+
+static uint64_t gradient_hash_seeded(const manim_vmo_t *vmo,
+                                     const context_color_t paint,
+                                     const uint64_t seed) {
+  uint32_t rgbas_count;
+  const manim_rgba_t *rgbas = manim_vmo_paint(vmo, paint, &rgbas_count);
+
+  const float endpoints[4] = {vmo->gradient_x0, vmo->gradient_y0,
+                              vmo->gradient_x1, vmo->gradient_y1};
+  uint64_t hash = hash_bytes(endpoints, sizeof(endpoints), seed);
+  for (uint32_t i = 0; i < rgbas_count; i++)
+    hash = hash_bytes(rgbas[i].vals, sizeof(rgbas[i].vals), hash);
+  return hash;
+}
+
+uint64_t manim_gradient_hash(const manim_vmo_t *vmo,
+                             const context_color_t paint) {
+  return gradient_hash_seeded(vmo, paint, HASH_SEED);
+}
+
+uint64_t manim_gradient_tag(const manim_vmo_t *vmo,
+                            const context_color_t paint) {
+  return gradient_hash_seeded(vmo, paint, GRADIENT_TAG_SEED);
+}
+
+void manim_gradient_id(const uint64_t hash, const uint64_t tag,
+                       char id[MANIM_GRADIENT_ID_SIZE]) {
+  snprintf(id, MANIM_GRADIENT_ID_SIZE, "mg%016" PRIx64 "%016" PRIx64, hash,
+           tag);
+}
+
+cairo_pattern_t *manim_gradient_create_pattern(const manim_vmo_t *vmo,
+                                               const context_color_t paint) {
+  uint32_t rgbas_count;
+  const manim_rgba_t *rgbas = manim_vmo_paint(vmo, paint, &rgbas_count);
+
+  cairo_pattern_t *pat = cairo_pattern_create_linear(
+      vmo->gradient_x0, vmo->gradient_y0, vmo->gradient_x1, vmo->gradient_y1);
+  const double step = 1.0 / (rgbas_count - 1);
+
+  double val = 0;
+  for (uint32_t i = 0; i < rgbas_count; i++) {
+    const manim_rgba_t *rgba = &rgbas[i];
+    cairo_pattern_add_color_stop_rgba(pat, val, rgba->vals[0], rgba->vals[1],
+                                      rgba->vals[2], rgba->vals[3]);
+    val += step;
+  }
+  return pat;
+}
+
+/**
+ * Both the table and the caches index 64-bit hashes with a map_t on their low
+ * 32 bits. The map holds the first element of a chain, elements sharing the
+ * low bits are linked through their next index.
+ */
+static uint32_t gradient_chain_key(const uint64_t hash) {
+  const uint32_t key = (uint32_t)hash;
+  return key == MAP_EMPTY_KEY ? 0 : key;
+}
+
+/**
+ * Copies the stops and endpoints of a paint into key, the stops to the end of
+ * stop_arena.
+ *
+ * @return 0 if the stop arena is full.
+ */
+static int gradient_key_store(manim_gradient_key_t *key, arena_t *stop_arena,
+                              const manim_vmo_t *vmo,
+                              const context_color_t paint) {
+  uint32_t rgbas_count;
+  const manim_rgba_t *rgbas = manim_vmo_paint(vmo, paint, &rgbas_count);
+
+  manim_rgba_t *stops =
+      arena_push_array(stop_arena, manim_rgba_t, rgbas_count);
+  if (!stops)
+    return 0;
+  memcpy(stops, rgbas, sizeof(manim_rgba_t) * rgbas_count);
+
+  key->endpoints[0] = vmo->gradient_x0;
+  key->endpoints[1] = vmo->gradient_y0;
+  key->endpoints[2] = vmo->gradient_x1;
+  key->endpoints[3] = vmo->gradient_y1;
+  key->stop_count = rgbas_count;
+  key->stop_offset = (size_t)(stops - (manim_rgba_t *)stop_arena->base);
+  return 1;
+}
+
+/**
+ * @return Whether key holds the stops and endpoints of a paint. Compared
+ * bitwise, like they are hashed.
+ */
+static bool gradient_key_equal(const manim_gradient_key_t *key,
+                               const arena_t *stop_arena,
+                               const manim_vmo_t *vmo,
+                               const context_color_t paint) {
+  uint32_t rgbas_count;
+  const manim_rgba_t *rgbas = manim_vmo_paint(vmo, paint, &rgbas_count);
+  const float endpoints[4] = {vmo->gradient_x0, vmo->gradient_y0,
+                              vmo->gradient_x1, vmo->gradient_y1};
+
+  const manim_rgba_t *stops =
+      (const manim_rgba_t *)stop_arena->base + key->stop_offset;
+  return key->stop_count == rgbas_count &&
+         memcmp(key->endpoints, endpoints, sizeof(endpoints)) == 0 &&
+         memcmp(stops, rgbas, sizeof(manim_rgba_t) * rgbas_count) == 0;
+}
+
+/**
+ * ===================================
+ *           GRADIENT TABLE
+ * ===================================
+ */
+
+int manim_gradient_table_init(manim_gradient_table_t *table,
+                              const manim_file_header_t *file_header) {
+  memset(table, 0, sizeof(*table));
+  table->file_header = *file_header;
+  table->heads = map_create(sizeof(uint32_t), alignof(uint32_t));
+  table->entry_arena = arena_alloc();
+  table->stop_arena = arena_alloc();
+  table->def_arena = arena_alloc();
+  if (pthread_mutex_init(&table->lock, NULL) != 0) {
+    if (table->heads)
+      map_destroy(table->heads);
+    if (table->entry_arena)
+      arena_release(table->entry_arena);
+    if (table->stop_arena)
+      arena_release(table->stop_arena);
+    if (table->def_arena)
+      arena_release(table->def_arena);
+    memset(table, 0, sizeof(*table));
+    return 0;
+  }
+
+  return table->heads && table->entry_arena && table->stop_arena &&
+         table->def_arena;
+}
+
+void manim_gradient_table_release(manim_gradient_table_t *table) {
+  if (table->heads)
+    map_destroy(table->heads);
+  if (table->entry_arena)
+    arena_release(table->entry_arena);
+  if (table->stop_arena)
+    arena_release(table->stop_arena);
+  if (table->def_arena)
+    arena_release(table->def_arena);
+  pthread_mutex_destroy(&table->lock);
+  memset(table, 0, sizeof(*table));
+}
+
+/**
+ * Records a use of a gradient. The first registration renders its
+ * <linearGradient>, later ones only keep the earliest use so the defs order
+ * does not depend on which thread got there first.
+ *
+ * Entries are chained by hash. Gradients sharing a hash are told apart by
+ * their tag, which only depends on their content. Only when the tag collides
+ * too is it probed upwards until it is either found or free.
+ *
+ * @return The tag of the gradient.
+ */
+static uint64_t manim_gradient_table_register(manim_gradient_table_t *table,
+                                              const manim_vmo_t *vmo,
+                                              const context_color_t paint,
+                                              const uint64_t hash,
+                                              const uint64_t tag,
+                                              const uint64_t use) {
+  pthread_mutex_lock(&table->lock);
+
+  manim_gradient_entry_t *entries =
+      (manim_gradient_entry_t *)table->entry_arena->base;
+
+  const uint32_t key = gradient_chain_key(hash);
+  uint32_t head = GRADIENT_CHAIN_END;
+  map_get(table->heads, key, &head);
+
+  uint64_t id_tag = tag;
+  for (;;) {
+    uint32_t i = head;
+    while (i != GRADIENT_CHAIN_END &&
+           (entries[i].hash != hash || entries[i].tag != id_tag))
+      i = entries[i].next;
+    if (i == GRADIENT_CHAIN_END)
+      break;
+
+    if (gradient_key_equal(&entries[i].key, table->stop_arena, vmo, paint)) {
+      if (use < entries[i].first_use)
+        entries[i].first_use = use;
+      pthread_mutex_unlock(&table->lock);
+      return id_tag;
+    }
+    ++id_tag;
+  }
+
+  manim_gradient_key_t gradient_key;
+  if (!gradient_key_store(&gradient_key, table->stop_arena, vmo, paint)) {
+    pthread_mutex_unlock(&table->lock);
+    return id_tag;
+  }
+
+  char id_str[MANIM_GRADIENT_ID_SIZE];
+  manim_gradient_id(hash, id_tag, id_str);
+  const manim_xform_t xform = manim_xform_from_header(&table->file_header);
+
+  const uint32_t index = (uint32_t)table->entry_count++;
+  manim_gradient_entry_t *entry =
+      arena_push_struct(table->entry_arena, manim_gradient_entry_t);
+  entry->hash = hash;
+  entry->tag = id_tag;
+  entry->key = gradient_key;
+  entry->first_use = use;
+  entry->next = head;
+  entry->def_offset = table->def_arena->pos;
+  entry->def_length =
+      emit_gradient_def(table->def_arena, &xform, vmo, paint, id_str);
+  map_put(table->heads, key, &index);
+
+  pthread_mutex_unlock(&table->lock);
+  return id_tag;
+}
+
+static int compare_first_use(const void *a, const void *b) {
+  const uint64_t use_a = ((const manim_gradient_entry_t *)a)->first_use;
+  const uint64_t use_b = ((const manim_gradient_entry_t *)b)->first_use;
+  return use_a < use_b ? -1 : use_a > use_b;
+}
+
+size_t manim_gradient_table_emit_defs(manim_gradient_table_t *table,
+                                      arena_t *out_arena) {
+  if (table->entry_count == 0)
+    return 0;
+
+  manim_gradient_entry_t *sorted =
+      malloc(sizeof(manim_gradient_entry_t) * table->entry_count);
+  if (!sorted)
+    return 0;
+  memcpy(sorted, table->entry_arena->base,
+         sizeof(manim_gradient_entry_t) * table->entry_count);
+  qsort(sorted, table->entry_count, sizeof(manim_gradient_entry_t),
+        compare_first_use);
+
+  const char open_tag[] = "<defs>\n";
+  const char close_tag[] = "</defs>";
+  size_t length = 0;
+
+  memcpy(arena_push(out_arena, sizeof(open_tag) - 1), open_tag,
+         sizeof(open_tag) - 1);
+  length += sizeof(open_tag) - 1;
+
+  for (size_t i = 0; i < table->entry_count; i++) {
+    memcpy(arena_push(out_arena, sorted[i].def_length),
+           table->def_arena->base + sorted[i].def_offset,
+           sorted[i].def_length);
+    length += sorted[i].def_length;
+  }
+
+  memcpy(arena_push(out_arena, sizeof(close_tag) - 1), close_tag,
+         sizeof(close_tag) - 1);
+  length += sizeof(close_tag) - 1;
+
+  free(sorted);
+  return length;
+}
+
+/**
+ * ===================================
+ *           GRADIENT CACHE
+ * ===================================
+ */
+
+int manim_gradient_cache_init(manim_gradient_cache_t *cache,
+                              manim_gradient_table_t *table) {
+  memset(cache, 0, sizeof(*cache));
+  cache->table = table;
+  cache->heads = map_create(sizeof(uint32_t), alignof(uint32_t));
+  cache->slot_arena = arena_alloc();
+  cache->stop_arena = arena_alloc();
+
+  return cache->heads && cache->slot_arena && cache->stop_arena;
+}
+
+void manim_gradient_cache_release(manim_gradient_cache_t *cache) {
+  if (cache->slot_arena) {
+    const manim_gradient_slot_t *slots =
+        (const manim_gradient_slot_t *)cache->slot_arena->base;
+    for (size_t i = 0; i < cache->slot_count; i++) {
+      if (slots[i].pattern)
+        cairo_pattern_destroy(slots[i].pattern);
+    }
+    arena_release(cache->slot_arena);
+  }
+  if (cache->stop_arena)
+    arena_release(cache->stop_arena);
+  if (cache->heads)
+    map_destroy(cache->heads);
+  memset(cache, 0, sizeof(*cache));
+}
+
+/**
+ * Finds the slot of a gradient, registering the gradient with the table the
+ * first time this cache sees it. A worker that steals frames may render them
+ * out of order, so a use earlier than the one the slot registered is
+ * registered again for the table to keep the earliest.
+ *
+ * @return The slot, or NULL if memory ran out.
+ */
+static manim_gradient_slot_t *
+manim_gradient_cache_lookup(manim_gradient_cache_t *cache,
+                            const manim_vmo_t *vmo,
+                            const context_color_t paint) {
+  const uint64_t hash = manim_gradient_hash(vmo, paint);
+  const uint32_t key = gradient_chain_key(hash);
+  manim_gradient_slot_t *slots =
+      (manim_gradient_slot_t *)cache->slot_arena->base;
+
+  uint32_t head = GRADIENT_CHAIN_END;
+  map_get(cache->heads, key, &head);
+  const uint64_t use = cache->use | paint;
+  for (uint32_t i = head; i != GRADIENT_CHAIN_END; i = slots[i].next) {
+    if (slots[i].hash != hash ||
+        !gradient_key_equal(&slots[i].key, cache->stop_arena, vmo, paint))
+      continue;
+    if (cache->table && use < slots[i].first_use) {
+      manim_gradient_table_register(cache->table, vmo, paint, hash,
+                                    slots[i].tag, use);
+      slots[i].first_use = use;
+    }
+    return &slots[i];
+  }
+
+  manim_gradient_key_t gradient_key;
+  if (!gradient_key_store(&gradient_key, cache->stop_arena, vmo, paint))
+    return NULL;
+
+  const uint32_t index = (uint32_t)cache->slot_count;
+  manim_gradient_slot_t *slot =
+      arena_push_struct(cache->slot_arena, manim_gradient_slot_t);
+  if (!slot)
+    return NULL;
+  ++cache->slot_count;
+  slot->hash = hash;
+  const uint64_t tag = manim_gradient_tag(vmo, paint);
+  slot->tag = cache->table ? manim_gradient_table_register(
+                                 cache->table, vmo, paint, hash, tag, use)
+                           : tag;
+  slot->first_use = use;
+  slot->key = gradient_key;
+  slot->pattern = NULL;
+  slot->next = head;
+  map_put(cache->heads, key, &index);
+  return slot;
+}
+
+void manim_gradient_cache_ref(manim_gradient_cache_t *cache,
+                              const manim_vmo_t *vmo,
+                              const context_color_t paint,
+                              char id[MANIM_GRADIENT_ID_SIZE]) {
+  const manim_gradient_slot_t *slot =
+      manim_gradient_cache_lookup(cache, vmo, paint);
+  if (slot)
+    manim_gradient_id(slot->hash, slot->tag, id);
+  else
+    manim_gradient_id(manim_gradient_hash(vmo, paint),
+                      manim_gradient_tag(vmo, paint), id);
+}
+
+cairo_pattern_t *manim_gradient_cache_pattern(manim_gradient_cache_t *cache,
+                                              const manim_vmo_t *vmo,
+                                              const context_color_t paint) {
+  manim_gradient_slot_t *slot = manim_gradient_cache_lookup(cache, vmo, paint);
+  if (!slot)
+    return NULL;
+  if (!slot->pattern)
+    slot->pattern = manim_gradient_create_pattern(vmo, paint);
+  return slot->pattern;
+}
@@ -0,0 +1,614 @@
+#define _GNU_SOURCE // fopencookie, see common/cookie.h
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "manim/manim_io.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define MANIM_IO_HAVE_URING 1
+#endif
+#endif
+
+#ifdef MANIM_IO_HAVE_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "common/cookie.h"
+
+/** Submission queue entries, at least the reads or writes in flight **/
+#define IO_RING_ENTRIES 8
+
+/**
+ * ===================================
+ *             IO_URING
+ * ===================================
+ */
+
+/**
+ * A submission and completion queue pair, driven through the raw system calls
+ * so nothing beyond the kernel headers is needed. The queues live in memory
+ * shared with the kernel, the indices the kernel writes are read with acquire
+ * and the ones this side writes are stored with release.
+ */
+typedef struct io_ring_t {
+  int fd;
+  unsigned *sq_head;
+  unsigned *sq_tail;
+  unsigned sq_mask;
+  unsigned sq_entries;
+  unsigned *sq_array;
+  struct io_uring_sqe *sqes;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned cq_mask;
+  struct io_uring_cqe *cqes;
+
+  void *sq_map;
+  size_t sq_map_size;
+  void *cq_map;
+  size_t cq_map_size;
+  size_t sqes_size;
+
+  /** Entries queued since the last io_uring_enter **/
+  unsigned to_submit;
+} io_ring_t;
+
+static void io_ring_release(io_ring_t *ring) {
+  if (ring->sqes)
+    munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_map && ring->cq_map != ring->sq_map)
+    munmap(ring->cq_map, ring->cq_map_size);
+  if (ring->sq_map)
+    munmap(ring->sq_map, ring->sq_map_size);
+  if (ring->fd >= 0)
+    close(ring->fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+static int io_ring_init(io_ring_t *ring, const unsigned entries) {
+  memset(ring, 0, sizeof(*ring));
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (ring->fd < 0)
+    return 0;
+
+  ring->sq_map_size =
+      params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_map_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_map) {
+    if (ring->cq_map_size > ring->sq_map_size)
+      ring->sq_map_size = ring->cq_map_size;
+    ring->cq_map_size = ring->sq_map_size;
+  }
+
+  ring->sq_map = mmap(NULL, ring->sq_map_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+  if (ring->sq_map == MAP_FAILED) {
+    ring->sq_map = NULL;
+    io_ring_release(ring);
+    return 0;
+  }
+  ring->cq_map =
+      single_map ? ring->sq_map
+                 : mmap(NULL, ring->cq_map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+  if (ring->cq_map == MAP_FAILED || ring->sqes == MAP_FAILED) {
+    if (ring->cq_map == MAP_FAILED)
+      ring->cq_map = NULL;
+    if (ring->sqes == MAP_FAILED)
+      ring->sqes = NULL;
+    io_ring_release(ring);
+    return 0;
+  }
+
+  unsigned char *sq = ring->sq_map;
+  ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+  ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+  ring->sq_mask = *(unsigned *)(sq + params.sq_off.ring_mask);
+  ring->sq_entries = params.sq_entries;
+  ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+
+  unsigned char *cq = ring->cq_map;
+  ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+  ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+  ring->cq_mask = *(unsigned *)(cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+  return 1;
+}
+
+/**
+ * Submits the queued entries and, with wait_nr > 0, waits until that many
+ * completions are available.
+ */
+static int io_ring_enter(io_ring_t *ring, const unsigned wait_nr) {
+  for (;;) {
+    const int submitted = (int)syscall(
+        __NR_io_uring_enter, ring->fd, ring->to_submit, wait_nr,
+        wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    if (submitted >= 0) {
+      ring->to_submit -= (unsigned)submitted;
+      return 1;
+    }
+    if (errno != EINTR)
+      return 0;
+  }
+}
+
+/** Queues a read or write of len bytes at offset, tagged with user_data **/
+static int io_ring_queue(io_ring_t *ring, const uint8_t opcode, const int fd,
+                         void *buf, const unsigned len, const uint64_t offset,
+                         const uint64_t user_data) {
+  const unsigned tail = *ring->sq_tail;
+  if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >=
+      ring->sq_entries) {
+    if (!io_ring_enter(ring, 0))
+      return 0;
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) >=
+        ring->sq_entries)
+      return 0;
+  }
+
+  const unsigned index = tail & ring->sq_mask;
+  struct io_uring_sqe *sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)buf;
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+  ++ring->to_submit;
+  return 1;
+}
+
+/** Takes the next completion, waiting for one **/
+static int io_ring_complete(io_ring_t *ring, uint64_t *user_data,
+                            int32_t *result) {
+  for (;;) {
+    const unsigned head = *ring->cq_head;
+    if (head != __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+      const struct io_uring_cqe *cqe = &ring->cqes[head & ring->cq_mask];
+      *user_data = cqe->user_data;
+      *result = cqe->res;
+      __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+      return 1;
+    }
+    if (!io_ring_enter(ring, 1))
+      return 0;
+  }
+}
+
+bool manim_io_uring_available(void) {
+  static int available = -1;
+  if (available < 0) {
+    io_ring_t ring;
+    available = io_ring_init(&ring, IO_RING_ENTRIES);
+    if (available)
+      io_ring_release(&ring);
+  }
+  return available;
+}
+
+/**
+ * Finishes a transfer the ring did only part of, or could not do at all
+ * (opcode unsupported by an older kernel), with plain pread/pwrite.
+ *
+ * @return Bytes transferred in total, or -errno.
+ */
+static ssize_t io_finish_sync(const int fd, unsigned char *buf,
+                              const size_t len, const uint64_t offset,
+                              const int32_t result, const bool write) {
+  if (result < 0 && result != -EINVAL && result != -EOPNOTSUPP)
+    return result;
+
+  size_t done = result > 0 ? (size_t)result : 0;
+  while (done < len) {
+    const ssize_t n =
+        write ? pwrite(fd, buf + done, len - done, (off_t)(offset + done))
+              : pread(fd, buf + done, len - done, (off_t)(offset + done));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return -errno;
+    if (n == 0)
+      break;
+    done += (size_t)n;
+  }
+  return (ssize_t)done;
+}
+
+/**
+ * ===================================
+ *           READ-AHEAD
+ * ===================================
+ */
+
+typedef struct io_chunk_t {
+  unsigned char *data;
+  uint64_t offset;
+  /** Bytes requested, then bytes read once complete **/
+  size_t length;
+  int error;
+  bool pending;
+} io_chunk_t;
+
+/**
+ * Chunk (head + k) % MANIM_IO_READ_AHEAD holds the file at
+ * window_start + k * MANIM_IO_CHUNK_SIZE.
+ */
+typedef struct io_reader_t {
+  io_ring_t ring;
+  int fd;
+  uint64_t file_size;
+  uint64_t pos;
+  uint64_t window_start;
+  size_t head;
+  unsigned char *buffers;
+  io_chunk_t chunks[MANIM_IO_READ_AHEAD];
+} io_reader_t;
+
+static void io_reader_submit(io_reader_t *reader, const size_t index,
+                             const uint64_t offset) {
+  io_chunk_t *chunk = &reader->chunks[index];
+  chunk->offset = offset;
+  chunk->error = 0;
+  chunk->length = 0;
+  if (offset >= reader->file_size)
+    return;
+
+  const uint64_t remaining = reader->file_size - offset;
+  chunk->length =
+      remaining < MANIM_IO_CHUNK_SIZE ? (size_t)remaining : MANIM_IO_CHUNK_SIZE;
+  chunk->pending = io_ring_queue(&reader->ring, IORING_OP_READ, reader->fd,
+                                 chunk->data, (unsigned)chunk->length, offset,
+                                 index);
+  if (!chunk->pending) {
+    const ssize_t n = io_finish_sync(reader->fd, chunk->data, chunk->length,
+                                     offset, -EINVAL, false);
+    chunk->error = n < 0 ? (int)-n : 0;
+    chunk->length = n < 0 ? 0 : (size_t)n;
+  }
+}
+
+/** Reaps completions until chunk index has completed **/
+static void io_reader_wait(io_reader_t *reader, const size_t index) {
+  while (reader->chunks[index].pending) {
+    uint64_t user_data;
+    int32_t result;
+    if (!io_ring_complete(&reader->ring, &user_data, &result)) {
+      // The ring is broken, nothing completes any more
+      for (size_t i = 0; i < MANIM_IO_READ_AHEAD; i++)
+        if (reader->chunks[i].pending) {
+          reader->chunks[i].pending = false;
+          reader->chunks[i].error = errno ? errno : EIO;
+        }
+      return;
+    }
+
+    io_chunk_t *chunk = &reader->chunks[user_data];
+    const ssize_t n = io_finish_sync(reader->fd, chunk->data, chunk->length,
+                                     chunk->offset, result, false);
+    chunk->pending = false;
+    chunk->error = n < 0 ? (int)-n : 0;
+    chunk->length = n < 0 ? 0 : (size_t)n;
+  }
+}
+
+/** Restarts the window at the chunk holding pos **/
+static void io_reader_reset(io_reader_t *reader, const uint64_t pos) {
+  for (size_t i = 0; i < MANIM_IO_READ_AHEAD; i++)
+    io_reader_wait(reader, i);
+
+  reader->window_start = pos - pos % MANIM_IO_CHUNK_SIZE;
+  reader->head = 0;
+  for (size_t k = 0; k < MANIM_IO_READ_AHEAD; k++)
+    io_reader_submit(reader, k,
+                     reader->window_start + k * MANIM_IO_CHUNK_SIZE);
+  io_ring_enter(&reader->ring, 0);
+}
+
+/** Moves the window one chunk on, reusing the head chunk's buffer **/
+static void io_reader_advance(io_reader_t *reader) {
+  io_reader_wait(reader, reader->head);
+  io_reader_submit(reader, reader->head,
+                   reader->window_start +
+                       MANIM_IO_READ_AHEAD * (uint64_t)MANIM_IO_CHUNK_SIZE);
+  io_ring_enter(&reader->ring, 0);
+  reader->head = (reader->head + 1) % MANIM_IO_READ_AHEAD;
+  reader->window_start += MANIM_IO_CHUNK_SIZE;
+}
+
+static ssize_t io_cookie_read(void *cookie, char *buf, const size_t size) {
+  io_reader_t *reader = cookie;
+  const uint64_t window_size =
+      MANIM_IO_READ_AHEAD * (uint64_t)MANIM_IO_CHUNK_SIZE;
+
+  size_t done = 0;
+  while (done < size && reader->pos < reader->file_size) {
+    if (reader->pos < reader->window_start ||
+        reader->pos >= reader->window_start + window_size)
+      io_reader_reset(reader, reader->pos);
+    while (reader->pos >= reader->window_start + MANIM_IO_CHUNK_SIZE)
+      io_reader_advance(reader);
+
+    io_chunk_t *chunk = &reader->chunks[reader->head];
+    io_reader_wait(reader, reader->head);
+    if (chunk->error) {
+      errno = chunk->error;
+      return done > 0 ? (ssize_t)done : -1;
+    }
+
+    const size_t chunk_pos = (size_t)(reader->pos - reader->window_start);
+    if (chunk_pos >= chunk->length)
+      break; // the file shrank since it was opened
+    size_t count = chunk->length - chunk_pos;
+    if (count > size - done)
+      count = size - done;
+    memcpy(buf + done, chunk->data + chunk_pos, count);
+    reader->pos += count;
+    done += count;
+  }
+  return (ssize_t)done;
+}
+
+static int io_cookie_seek(void *cookie, int64_t *offset, const int whence) {
+  io_reader_t *reader = cookie;
+  int64_t target;
+  if (whence == SEEK_SET)
+    target = *offset;
+  else if (whence == SEEK_CUR)
+    target = (int64_t)reader->pos + *offset;
+  else if (whence == SEEK_END)
+    target = (int64_t)reader->file_size + *offset;
+  else
+    return -1;
+  if (target < 0)
+    return -1;
+
+  // The window follows on the next read
+  reader->pos = (uint64_t)target;
+  *offset = target;
+  return 0;
+}
+
+static int io_cookie_close(void *cookie) {
+  io_reader_t *reader = cookie;
+  for (size_t i = 0; i < MANIM_IO_READ_AHEAD; i++)
+    io_reader_wait(reader, i);
+  io_ring_release(&reader->ring);
+  close(reader->fd);
+  free(reader->buffers);
+  free(reader);
+  return 0;
+}
+
+static FILE *io_uring_fopen_read(const char *path) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return fopen(path, "rb");
+  }
+
+  io_reader_t *reader = calloc(1, sizeof(*reader));
+  unsigned char *buffers =
+      aligned_alloc(4096, MANIM_IO_READ_AHEAD * (size_t)MANIM_IO_CHUNK_SIZE);
+  if (!reader || !buffers || !io_ring_init(&reader->ring, IO_RING_ENTRIES)) {
+    free(reader);
+    free(buffers);
+    close(fd);
+    return fopen(path, "rb");
+  }
+  reader->fd = fd;
+  reader->file_size = (uint64_t)st.st_size;
+  reader->buffers = buffers;
+  for (size_t i = 0; i < MANIM_IO_READ_AHEAD; i++)
+    reader->chunks[i].data = buffers + i * MANIM_IO_CHUNK_SIZE;
+  // The kernel reads the file sequentially ahead of the window too
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  io_reader_reset(reader, 0);
+
+  const cookie_io_t io = {.read = io_cookie_read,
+                          .seek = io_cookie_seek,
+                          .close = io_cookie_close};
+  FILE *fp = cookie_fopen(reader, &io);
+  if (!fp) {
+    io_cookie_close(reader);
+    return fopen(path, "rb");
+  }
+  return fp;
+}
+
+/**
+ * ===================================
+ *         BATCHED WRITES
+ * ===================================
+ */
+
+typedef struct io_write_buffer_t {
+  unsigned char *data;
+  uint64_t offset;
+  size_t length;
+  bool pending;
+} io_write_buffer_t;
+
+#endif // MANIM_IO_HAVE_URING
+
+struct manim_io_writer_t {
+  /** stdio fallback, NULL when writing through io_uring **/
+  FILE *fp;
+  bool failed;
+
+#ifdef MANIM_IO_HAVE_URING
+  io_ring_t ring;
+  int fd;
+  unsigned char *buffers;
+  io_write_buffer_t writes[MANIM_IO_WRITE_BUFFERS];
+  /** Buffer being filled, and the file offset it starts at **/
+  size_t current;
+  uint64_t offset;
+#endif
+};
+
+#ifdef MANIM_IO_HAVE_URING
+
+static int io_writer_wait(manim_io_writer_t *writer, const size_t index) {
+  while (writer->writes[index].pending) {
+    uint64_t user_data;
+    int32_t result;
+    if (!io_ring_complete(&writer->ring, &user_data, &result)) {
+      for (size_t i = 0; i < MANIM_IO_WRITE_BUFFERS; i++)
+        writer->writes[i].pending = false;
+      writer->failed = true;
+      return 0;
+    }
+
+    io_write_buffer_t *write = &writer->writes[user_data];
+    const ssize_t n = io_finish_sync(writer->fd, write->data, write->length,
+                                     write->offset, result, true);
+    write->pending = false;
+    if (n < 0 || (size_t)n != write->length)
+      writer->failed = true;
+  }
+  return !writer->failed;
+}
+
+/** Submits the current buffer and moves on to the next one **/
+static void io_writer_submit(manim_io_writer_t *writer) {
+  io_write_buffer_t *write = &writer->writes[writer->current];
+  if (write->length == 0)
+    return;
+
+  write->offset = writer->offset;
+  writer->offset += write->length;
+  write->pending =
+      io_ring_queue(&writer->ring, IORING_OP_WRITE, writer->fd, write->data,
+                    (unsigned)write->length, write->offset, writer->current);
+  if (write->pending) {
+    // The write stays queued, waiting on it finds the ring broken too
+    if (!io_ring_enter(&writer->ring, 0))
+      writer->failed = true;
+  } else if (io_finish_sync(writer->fd, write->data, write->length,
+                            write->offset, -EINVAL,
+                            true) != (ssize_t)write->length) {
+    writer->failed = true;
+  }
+
+  writer->current = (writer->current + 1) % MANIM_IO_WRITE_BUFFERS;
+  io_writer_wait(writer, writer->current);
+  writer->writes[writer->current].length = 0;
+}
+
+#endif // MANIM_IO_HAVE_URING
+
+FILE *manim_io_fopen_read(const char *path) {
+#ifdef MANIM_IO_HAVE_URING
+  if (manim_io_uring_available())
+    return io_uring_fopen_read(path);
+#endif
+  return fopen(path, "rb");
+}
+
+manim_io_writer_t *manim_io_writer_open(const char *path,
+                                        const bool use_uring) {
+  manim_io_writer_t *writer = calloc(1, sizeof(*writer));
+  if (!writer)
+    return NULL;
+
+#ifdef MANIM_IO_HAVE_URING
+  writer->fd = -1;
+  if (use_uring && manim_io_uring_available()) {
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    writer->buffers = aligned_alloc(
+        4096, MANIM_IO_WRITE_BUFFERS * (size_t)MANIM_IO_WRITE_BUFFER_SIZE);
+    if (writer->fd >= 0 && writer->buffers &&
+        io_ring_init(&writer->ring, IO_RING_ENTRIES)) {
+      for (size_t i = 0; i < MANIM_IO_WRITE_BUFFERS; i++)
+        writer->writes[i].data =
+            writer->buffers + i * MANIM_IO_WRITE_BUFFER_SIZE;
+      return writer;
+    }
+    if (writer->fd >= 0)
+      close(writer->fd);
+    free(writer->buffers);
+    writer->buffers = NULL;
+  }
+#endif
+
+  writer->fp = fopen(path, "wb");
+  if (!writer->fp) {
+    free(writer);
+    return NULL;
+  }
+  return writer;
+}
+
+int manim_io_writer_write(manim_io_writer_t *writer, const void *data,
+                          size_t size) {
+  if (writer->fp) {
+    writer->failed |= fwrite(data, 1, size, writer->fp) != size;
+    return !writer->failed;
+  }
+
+#ifdef MANIM_IO_HAVE_URING
+  const unsigned char *bytes = data;
+  while (size > 0 && !writer->failed) {
+    io_write_buffer_t *write = &writer->writes[writer->current];
+    size_t count = MANIM_IO_WRITE_BUFFER_SIZE - write->length;
+    if (count > size)
+      count = size;
+    memcpy(write->data + write->length, bytes, count);
+    write->length += count;
+    bytes += count;
+    size -= count;
+    if (write->length == MANIM_IO_WRITE_BUFFER_SIZE)
+      io_writer_submit(writer);
+  }
+#endif
+  return !writer->failed;
+}
+
+int manim_io_writer_close(manim_io_writer_t *writer) {
+  bool ok;
+  if (writer->fp) {
+    ok = fclose(writer->fp) == 0 && !writer->failed;
+  } else {
+#ifdef MANIM_IO_HAVE_URING
+    io_writer_submit(writer);
+    for (size_t i = 0; i < MANIM_IO_WRITE_BUFFERS; i++)
+      io_writer_wait(writer, i);
+    io_ring_release(&writer->ring);
+    ok = close(writer->fd) == 0 && !writer->failed;
+    free(writer->buffers);
+#else
+    ok = false;
+#endif
+  }
+  free(writer);
+  return ok;
+}
+
+#ifndef MANIM_IO_HAVE_URING
+bool manim_io_uring_available(void) { return false; }
+#endif
@@ -0,0 +1,182 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ctrs/map.h"
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "common/hash.h"
+#include "manim/manim_fe.h"
+
+#define RENDER_CACHE_CHAIN_END UINT32_MAX
+
+/**
+ * ===================================
+ *            RENDER CACHE
+ * ===================================
+ */
+
+/** Seed of the check hash, unrelated to HASH_SEED **/
+#define RENDER_CACHE_CHECK_SEED 0xc2b2ae3d27d4eb4fULL
+
+static void vmo_key_add(manim_vmo_key_t *key, const void *data,
+                        const size_t length) {
+  key->hash = hash_bytes(data, length, key->hash);
+  key->check = hash_bytes(data, length, key->check);
+  key->length += length;
+}
+
+manim_vmo_key_t manim_vmo_key(const manim_vmo_t *vmo) {
+  manim_vmo_key_t key = {HASH_SEED, RENDER_CACHE_CHECK_SEED, 0};
+
+  /** Magic, id and style, everything up to the first pointer **/
+  vmo_key_add(&key, vmo, offsetof(manim_vmo_t, stroke_bg_rgbas));
+
+  vmo_key_add(&key, vmo->stroke_bg_rgbas,
+              sizeof(manim_rgba_t) * vmo->stroke_bg_rgbas_count);
+  vmo_key_add(&key, vmo->stroke_rgbas,
+              sizeof(manim_rgba_t) * vmo->stroke_rgbas_count);
+  vmo_key_add(&key, vmo->fill_rgbas,
+              sizeof(manim_rgba_t) * vmo->fill_rgbas_count);
+
+  for (uint32_t i = 0; i < vmo->subpath_count; i++) {
+    const manim_subpath_t *subpath = &vmo->subpaths[i];
+    vmo_key_add(&key, subpath, offsetof(manim_subpath_t, quads));
+    vmo_key_add(&key, subpath->quads,
+                sizeof(manim_quad_t) * subpath->quad_count);
+  }
+
+  return key;
+}
+
+/** Same chaining over map_t as the gradient table, see manim_gradient.c **/
+static uint32_t render_cache_chain_key(const uint64_t hash) {
+  const uint32_t key = (uint32_t)hash;
+  return key == MAP_EMPTY_KEY ? 0 : key;
+}
+
+static int render_cache_gen_init(manim_render_cache_gen_t *gen) {
+  gen->heads = map_create(sizeof(uint32_t), alignof(uint32_t));
+  gen->entry_arena = arena_alloc();
+  gen->svg_arena = arena_alloc();
+  gen->entry_count = 0;
+  return gen->heads && gen->entry_arena && gen->svg_arena;
+}
+
+static void render_cache_gen_release(manim_render_cache_gen_t *gen) {
+  if (gen->heads)
+    map_destroy(gen->heads);
+  if (gen->entry_arena)
+    arena_release(gen->entry_arena);
+  if (gen->svg_arena)
+    arena_release(gen->svg_arena);
+  memset(gen, 0, sizeof(*gen));
+}
+
+static void render_cache_gen_clear(manim_render_cache_gen_t *gen) {
+  map_clear(gen->heads);
+  arena_clear(gen->entry_arena);
+  arena_clear(gen->svg_arena);
+  gen->entry_count = 0;
+}
+
+static bool vmo_key_equal(const manim_vmo_key_t *a, const manim_vmo_key_t *b) {
+  return a->hash == b->hash && a->check == b->check && a->length == b->length;
+}
+
+static const manim_render_cache_entry_t *
+render_cache_gen_find(const manim_render_cache_gen_t *gen,
+                      const manim_vmo_key_t *key) {
+  const manim_render_cache_entry_t *entries =
+      (const manim_render_cache_entry_t *)gen->entry_arena->base;
+
+  uint32_t head = RENDER_CACHE_CHAIN_END;
+  map_get(gen->heads, render_cache_chain_key(key->hash), &head);
+  for (uint32_t i = head; i != RENDER_CACHE_CHAIN_END; i = entries[i].next) {
+    if (vmo_key_equal(&entries[i].key, key))
+      return &entries[i];
+  }
+  return NULL;
+}
+
+static void render_cache_gen_put(manim_render_cache_gen_t *gen,
+                                 const manim_vmo_key_t *key, const void *svg,
+                                 const size_t length) {
+  if (render_cache_gen_find(gen, key))
+    return;
+
+  const uint32_t chain_key = render_cache_chain_key(key->hash);
+  uint32_t head = RENDER_CACHE_CHAIN_END;
+  map_get(gen->heads, chain_key, &head);
+
+  const uint32_t index = (uint32_t)gen->entry_count++;
+  manim_render_cache_entry_t *entry =
+      arena_push_struct(gen->entry_arena, manim_render_cache_entry_t);
+  entry->key = *key;
+  entry->offset = gen->svg_arena->pos;
+  entry->length = length;
+  entry->next = head;
+  if (length > 0)
+    memcpy(arena_push(gen->svg_arena, length), svg, length);
+  map_put(gen->heads, chain_key, &index);
+}
+
+int manim_render_cache_init(manim_render_cache_t *cache) {
+  memset(cache, 0, sizeof(*cache));
+  const int current_ok = render_cache_gen_init(&cache->current);
+  const int previous_ok = render_cache_gen_init(&cache->previous);
+  return current_ok && previous_ok;
+}
+
+void manim_render_cache_release(manim_render_cache_t *cache) {
+  render_cache_gen_release(&cache->current);
+  render_cache_gen_release(&cache->previous);
+  memset(cache, 0, sizeof(*cache));
+}
+
+bool manim_render_cache_get(manim_render_cache_t *cache,
+                            const manim_vmo_key_t *key, arena_t *svg_out_arena,
+                            size_t *out_length) {
+  ++cache->lookups;
+
+  const manim_render_cache_entry_t *entry =
+      render_cache_gen_find(&cache->current, key);
+  const manim_render_cache_gen_t *gen = &cache->current;
+  if (!entry) {
+    entry = render_cache_gen_find(&cache->previous, key);
+    gen = &cache->previous;
+  }
+  if (!entry)
+    return false;
+
+  const void *svg = gen->svg_arena->base + entry->offset;
+  if (entry->length > 0)
+    memcpy(arena_push(svg_out_arena, entry->length), svg, entry->length);
+  *out_length = entry->length;
+
+  /** Keep the vmo for the next frame **/
+  if (gen == &cache->previous)
+    render_cache_gen_put(&cache->current, key, svg, entry->length);
+
+  ++cache->hits;
+  return true;
+}
+
+void manim_render_cache_put(manim_render_cache_t *cache,
+                            const manim_vmo_key_t *key, const void *svg,
+                            const size_t length) {
+  render_cache_gen_put(&cache->current, key, svg, length);
+}
+
+void manim_render_cache_next_frame(manim_render_cache_t *cache) {
+  const manim_render_cache_gen_t previous = cache->previous;
+  cache->previous = cache->current;
+  cache->current = previous;
+  render_cache_gen_clear(&cache->current);
+}
+
+void manim_render_cache_clear(manim_render_cache_t *cache) {
+  render_cache_gen_clear(&cache->current);
+  render_cache_gen_clear(&cache->previous);
+}
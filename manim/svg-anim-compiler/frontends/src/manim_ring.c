@@ -0,0 +1,329 @@
+#define _GNU_SOURCE // fopencookie, see common/cookie.h
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/cookie.h"
+#include "common/core.h"
+#include "manim/manim_ring.h"
+
+/** Empty or full polls before sleeping, and the sleep between polls **/
+#define RING_SPIN_POLLS 256
+#define RING_SLEEP_NS 50000L
+/** Sleeps between checks that the other side is still alive **/
+#define RING_PEER_CHECK_SLEEPS 2000
+
+/**
+ * ===================================
+ *          LIVE INGEST RING
+ * ===================================
+ */
+
+static bool ring_is_shm(const char *name) {
+  return name[0] == '/' && strchr(name + 1, '/') == NULL;
+}
+
+static int ring_open_fd(const char *name, const int flags) {
+  return ring_is_shm(name) ? shm_open(name, flags, 0600)
+                           : open(name, flags, 0600);
+}
+
+static void ring_unlink(const char *name) {
+  if (ring_is_shm(name))
+    shm_unlink(name);
+  else
+    unlink(name);
+}
+
+static void ring_sleep(void) {
+  const struct timespec ts = {.tv_sec = 0, .tv_nsec = RING_SLEEP_NS};
+  nanosleep(&ts, NULL);
+}
+
+/** pid exited, 0 is a side that has not attached yet **/
+static bool ring_pid_gone(const uint32_t pid) {
+  return pid > 0 && kill((pid_t)pid, 0) != 0 && errno == ESRCH;
+}
+
+/** Whether a side waiting polls times should check on the other side **/
+static bool ring_check_peer(const uint32_t polls) {
+  return polls > RING_SPIN_POLLS && polls % RING_PEER_CHECK_SLEEPS == 0;
+}
+
+/** The reader exited or closed its side without draining the ring **/
+static bool ring_reader_gone(const manim_ring_t *ring) {
+  const uint32_t pid =
+      atomic_load_explicit(&ring->header->reader_pid, memory_order_relaxed);
+  return pid == MANIM_RING_READER_DETACHED || ring_pid_gone(pid);
+}
+
+/** Spins, then sleeps, while the ring is empty or full **/
+static void ring_wait(manim_ring_t *ring, const uint32_t polls) {
+  if (polls == 0)
+    ++ring->stalls;
+  if (polls < RING_SPIN_POLLS)
+    return;
+  ring_sleep();
+}
+
+static int ring_map(manim_ring_t *ring, const int fd, const size_t map_size) {
+  void *map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    perror("mmap failed");
+    return 0;
+  }
+  ring->header = map;
+  ring->data = (unsigned char *)map + MANIM_RING_DATA_OFFSET;
+  ring->map_size = map_size;
+  return 1;
+}
+
+int manim_ring_create(manim_ring_t *ring, const char *name, size_t capacity) {
+  memset(ring, 0, sizeof(*ring));
+
+  size_t rounded = 1;
+  while (rounded < capacity)
+    rounded <<= 1;
+  capacity = rounded;
+
+  // A stale ring of a previous run would otherwise be read as this one
+  ring_unlink(name);
+  const int fd = ring_open_fd(name, O_RDWR | O_CREAT | O_EXCL);
+  if (fd < 0) {
+    perror("ring create failed");
+    return 0;
+  }
+
+  const size_t map_size = MANIM_RING_DATA_OFFSET + capacity;
+  const int ok = ftruncate(fd, (off_t)map_size) == 0 &&
+                 ring_map(ring, fd, map_size);
+  close(fd);
+  if (!ok) {
+    ring_unlink(name);
+    return 0;
+  }
+
+  ring->mask = capacity - 1;
+  ring->header->capacity = capacity;
+  ring->header->writer_pid = (uint32_t)getpid();
+  atomic_store_explicit(&ring->header->closed, 0, memory_order_relaxed);
+  atomic_store_explicit(&ring->header->reader_pid, 0, memory_order_relaxed);
+  atomic_store_explicit(&ring->header->head, 0, memory_order_relaxed);
+  atomic_store_explicit(&ring->header->tail, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  memcpy(ring->header->magic, "RING", 4);
+  return 1;
+}
+
+int manim_ring_write(manim_ring_t *ring, const void *src, size_t size) {
+  const unsigned char *bytes = src;
+  const uint64_t capacity = ring->mask + 1;
+  uint32_t polls = 0;
+
+  while (size > 0) {
+    const uint64_t tail =
+        atomic_load_explicit(&ring->header->tail, memory_order_acquire);
+    const uint64_t space = capacity - (ring->pos - tail);
+    if (space == 0) {
+      if (ring_check_peer(polls) && ring_reader_gone(ring)) {
+        fprintf(stderr, "Ring reader exited before draining the stream.\n");
+        return 0;
+      }
+      ring_wait(ring, polls++);
+      continue;
+    }
+    polls = 0;
+
+    const size_t count = space < size ? (size_t)space : size;
+    const size_t start = (size_t)(ring->pos & ring->mask);
+    const size_t first = count < capacity - start ? count : capacity - start;
+    memcpy(ring->data + start, bytes, first);
+    memcpy(ring->data, bytes + first, count - first);
+
+    ring->pos += count;
+    atomic_store_explicit(&ring->header->head, ring->pos,
+                          memory_order_release);
+    bytes += count;
+    size -= count;
+  }
+  return 1;
+}
+
+void manim_ring_finish(manim_ring_t *ring) {
+  if (ring->header)
+    atomic_store_explicit(&ring->header->closed, 1, memory_order_release);
+  manim_ring_close(ring);
+}
+
+int manim_ring_open(manim_ring_t *ring, const char *name,
+                    const double timeout_sec) {
+  memset(ring, 0, sizeof(*ring));
+  const timespec_t start = ts_now();
+
+  /** Wait for the writer to create and initialize the ring **/
+  for (;;) {
+    const int fd = ring_open_fd(name, O_RDWR);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 &&
+        (size_t)st.st_size > MANIM_RING_DATA_OFFSET) {
+      const int ok = ring_map(ring, fd, (size_t)st.st_size);
+      close(fd);
+      if (!ok)
+        return 0;
+      if (memcmp(ring->header->magic, "RING", 4) == 0)
+        break;
+      manim_ring_close(ring);
+    } else if (fd >= 0) {
+      close(fd);
+    }
+
+    if (ts_elapsed_sec(start, ts_now()) > timeout_sec) {
+      fprintf(stderr, "Ring %s did not appear.\n", name);
+      return 0;
+    }
+    ring_sleep();
+  }
+  atomic_thread_fence(memory_order_acquire);
+
+  const uint64_t capacity = ring->header->capacity;
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+      capacity > ring->map_size - MANIM_RING_DATA_OFFSET) {
+    fprintf(stderr, "Ring header malformed.\n");
+    manim_ring_close(ring);
+    return 0;
+  }
+  ring->mask = capacity - 1;
+  ring->pos = atomic_load_explicit(&ring->header->tail, memory_order_relaxed);
+  ring->reader = true;
+  atomic_store_explicit(&ring->header->reader_pid, (uint32_t)getpid(),
+                        memory_order_relaxed);
+
+  // Both sides hold the mapping now, nothing else needs the name
+  if (ring_is_shm(name))
+    shm_unlink(name);
+  return 1;
+}
+
+size_t manim_ring_read(manim_ring_t *ring, void *dst, const size_t size) {
+  const uint64_t capacity = ring->mask + 1;
+  uint32_t polls = 0;
+
+  uint64_t available;
+  for (;;) {
+    const uint64_t head =
+        atomic_load_explicit(&ring->header->head, memory_order_acquire);
+    available = head - ring->pos;
+    if (available > 0 || size == 0)
+      break;
+
+    // closed is stored after the last head, so the head above may be stale
+    if (atomic_load_explicit(&ring->header->closed, memory_order_acquire)) {
+      if (atomic_load_explicit(&ring->header->head, memory_order_acquire) ==
+          ring->pos)
+        return 0;
+      continue;
+    }
+    if (ring_check_peer(polls) && ring_pid_gone(ring->header->writer_pid)) {
+      fprintf(stderr, "Ring writer exited before finishing the stream.\n");
+      return 0;
+    }
+    ring_wait(ring, polls++);
+  }
+
+  const size_t count = available < size ? (size_t)available : size;
+  const size_t start = (size_t)(ring->pos & ring->mask);
+  const size_t first = count < capacity - start ? count : capacity - start;
+  memcpy(dst, ring->data + start, first);
+  memcpy((unsigned char *)dst + first, ring->data, count - first);
+
+  ring->pos += count;
+  atomic_store_explicit(&ring->header->tail, ring->pos, memory_order_release);
+  return count;
+}
+
+void manim_ring_close(manim_ring_t *ring) {
+  if (ring->header && ring->reader)
+    atomic_store_explicit(&ring->header->reader_pid,
+                          MANIM_RING_READER_DETACHED, memory_order_relaxed);
+  if (ring->header)
+    munmap(ring->header, ring->map_size);
+  memset(ring, 0, sizeof(*ring));
+}
+
+/**
+ * ===================================
+ *          FILE ADAPTER
+ * ===================================
+ */
+
+static ssize_t ring_cookie_read(void *cookie, char *buf, const size_t size) {
+  return (ssize_t)manim_ring_read(cookie, buf, size);
+}
+
+/** Seeks forward by reading, there is no going back in a ring **/
+static int ring_cookie_seek(void *cookie, int64_t *offset, const int whence) {
+  manim_ring_t *ring = cookie;
+  int64_t target;
+  if (whence == SEEK_SET)
+    target = *offset;
+  else if (whence == SEEK_CUR)
+    target = (int64_t)ring->pos + *offset;
+  else
+    return -1;
+  if (target < (int64_t)ring->pos)
+    return -1;
+
+  unsigned char skip[4096];
+  while ((int64_t)ring->pos < target) {
+    const int64_t remaining = target - (int64_t)ring->pos;
+    const size_t count =
+        remaining < (int64_t)sizeof(skip) ? (size_t)remaining : sizeof(skip);
+    if (manim_ring_read(ring, skip, count) == 0)
+      return -1;
+  }
+  *offset = target;
+  return 0;
+}
+
+static int ring_cookie_close(void *cookie) {
+  manim_ring_close(cookie);
+  free(cookie);
+  return 0;
+}
+
+FILE *manim_ring_fopen(const char *name, const double timeout_sec) {
+  if (!COOKIE_SUPPORTED) {
+    fprintf(stderr, "Ring input is not supported on this platform.\n");
+    return NULL;
+  }
+
+  manim_ring_t *ring = malloc(sizeof(*ring));
+  if (!ring)
+    return NULL;
+  if (!manim_ring_open(ring, name, timeout_sec)) {
+    free(ring);
+    return NULL;
+  }
+
+  const cookie_io_t io = {.read = ring_cookie_read,
+                          .seek = ring_cookie_seek,
+                          .close = ring_cookie_close};
+  FILE *fp = cookie_fopen(ring, &io);
+  if (!fp) {
+    ring_cookie_close(ring);
+    return NULL;
+  }
+  // Unbuffered, so a seek never has to move back over read-ahead
+  setvbuf(fp, NULL, _IONBF, 0);
+  return fp;
+}
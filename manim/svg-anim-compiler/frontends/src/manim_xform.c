@@ -0,0 +1,186 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "manim/manim_emit.h"
+#include "manim/manim_fe.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/**
+ * ===================================
+ *           BULK TRANSFORM
+ * ===================================
+ */
+
+/**
+ * The six coordinates of a manim_quad_t follow its QUAD magic as packed
+ * floats: three (x, y) pairs. Each pair is widened to a vector of two doubles
+ * and mapped against (sx, sy) and (tx, ty) with a separate multiply and add,
+ * exactly the scalar expression. AVX maps the first two pairs as one vector
+ * of four.
+ *
+ * Version 3 columns hold x and y apart. There a vector of xs and one of ys are
+ * mapped against splatted factors and zipped into (x, y) pairs on the way
+ * out.
+ */
+
+#if defined(__AVX__) || defined(__SSE2__)
+typedef __m128d xform_pair_t;
+#define xform_pair_set(x, y) _mm_set_pd((y), (x))
+#define xform_pair_map(v, scale, offset)                                       \
+  _mm_add_pd(_mm_mul_pd((v), (scale)), (offset))
+#define xform_pair_store(p, v) _mm_storeu_pd((p), (v))
+#define xform_pair_splat(a) _mm_set1_pd(a)
+#define xform_pair_zip_lo(a, b) _mm_unpacklo_pd((a), (b))
+#define xform_pair_zip_hi(a, b) _mm_unpackhi_pd((a), (b))
+static xform_pair_t xform_pair_load(const float *p) {
+  double bits;
+  memcpy(&bits, p, sizeof(bits));
+  return _mm_cvtps_pd(_mm_castpd_ps(_mm_set_sd(bits)));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+typedef float64x2_t xform_pair_t;
+#define xform_pair_set(x, y) ((float64x2_t){(x), (y)})
+#define xform_pair_map(v, scale, offset)                                       \
+  vaddq_f64(vmulq_f64((v), (scale)), (offset))
+#define xform_pair_store(p, v) vst1q_f64((p), (v))
+#define xform_pair_splat(a) vdupq_n_f64(a)
+#define xform_pair_zip_lo(a, b) vzip1q_f64((a), (b))
+#define xform_pair_zip_hi(a, b) vzip2q_f64((a), (b))
+#define xform_pair_load(p) vcvt_f64_f32(vld1_f32(p))
+#endif
+
+void manim_xform_kernel_init(manim_xform_kernel_t *kernel,
+                             const manim_xform_t *xform) {
+  kernel->sx = xform->sx;
+  kernel->sy = xform->sy;
+  kernel->tx = xform->tx;
+  kernel->ty = xform->ty;
+}
+
+static void xform_quad_scalar(const manim_xform_kernel_t *kernel, double *dst,
+                              const manim_quad_t *src) {
+  dst[0] = src->x1 * kernel->sx + kernel->tx;
+  dst[1] = src->y1 * kernel->sy + kernel->ty;
+  dst[2] = src->x2 * kernel->sx + kernel->tx;
+  dst[3] = src->y2 * kernel->sy + kernel->ty;
+  dst[4] = src->x3 * kernel->sx + kernel->tx;
+  dst[5] = src->y3 * kernel->sy + kernel->ty;
+}
+
+void manim_xform_quads(const manim_xform_kernel_t *kernel, double *dst,
+                       const manim_quad_t *src, const size_t count) {
+  size_t i = 0;
+
+#ifdef xform_pair_map
+  _Static_assert(offsetof(manim_quad_t, y3) - offsetof(manim_quad_t, x1) ==
+                     5 * sizeof(float),
+                 "quad coordinates must be 6 packed floats");
+
+  const xform_pair_t scale = xform_pair_set(kernel->sx, kernel->sy);
+  const xform_pair_t offset = xform_pair_set(kernel->tx, kernel->ty);
+#if defined(__AVX__)
+  const __m256d scale4 =
+      _mm256_set_pd(kernel->sy, kernel->sx, kernel->sy, kernel->sx);
+  const __m256d offset4 =
+      _mm256_set_pd(kernel->ty, kernel->tx, kernel->ty, kernel->tx);
+#endif
+
+  for (; i < count; i++) {
+    const float *in = &src[i].x1;
+    double *out = dst + i * MANIM_XFORM_QUAD_COORDS;
+#if defined(__AVX__)
+    const __m256d coords = _mm256_cvtps_pd(_mm_loadu_ps(in));
+    _mm256_storeu_pd(
+        out, _mm256_add_pd(_mm256_mul_pd(coords, scale4), offset4));
+#else
+    xform_pair_store(out, xform_pair_map(xform_pair_load(in), scale, offset));
+    xform_pair_store(out + 2,
+                     xform_pair_map(xform_pair_load(in + 2), scale, offset));
+#endif
+    xform_pair_store(out + 4,
+                     xform_pair_map(xform_pair_load(in + 4), scale, offset));
+  }
+#endif
+
+  for (; i < count; i++)
+    xform_quad_scalar(kernel, dst + i * MANIM_XFORM_QUAD_COORDS, &src[i]);
+}
+
+const double *manim_xform_vmo(const manim_xform_kernel_t *kernel,
+                              const manim_vmo_t *vmo, arena_t *arena) {
+  arena_push(arena, ALIGN_UP(arena->pos, 8) - arena->pos);
+  double *coords =
+      arena_push_array(arena, double, manim_xform_vmo_coord_count(vmo));
+  if (!coords)
+    return NULL;
+
+  double *out = coords;
+  for (uint32_t i = 0; i < vmo->subpath_count; i++) {
+    const manim_subpath_t *subpath = &vmo->subpaths[i];
+    out[0] = subpath->x * kernel->sx + kernel->tx;
+    out[1] = subpath->y * kernel->sy + kernel->ty;
+    out += 2;
+
+    manim_xform_quads(kernel, out, subpath->quads, subpath->quad_count);
+    out += MANIM_XFORM_QUAD_COORDS * (size_t)subpath->quad_count;
+  }
+  return coords;
+}
+
+const double *manim_xform_points(const manim_xform_kernel_t *kernel,
+                                 const float *xs, const float *ys,
+                                 const size_t count, arena_t *arena) {
+  arena_push(arena, ALIGN_UP(arena->pos, 8) - arena->pos);
+  double *coords = arena_push_array(arena, double, 2 * count);
+  if (!coords)
+    return NULL;
+
+  size_t i = 0;
+
+#ifdef xform_pair_map
+#if defined(__AVX__)
+  const __m256d sx4 = _mm256_set1_pd(kernel->sx);
+  const __m256d sy4 = _mm256_set1_pd(kernel->sy);
+  const __m256d tx4 = _mm256_set1_pd(kernel->tx);
+  const __m256d ty4 = _mm256_set1_pd(kernel->ty);
+  for (; i + 4 <= count; i += 4) {
+    const __m256d x = _mm256_add_pd(
+        _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(xs + i)), sx4), tx4);
+    const __m256d y = _mm256_add_pd(
+        _mm256_mul_pd(_mm256_cvtps_pd(_mm_loadu_ps(ys + i)), sy4), ty4);
+    /** (x0 y0 x2 y2) and (x1 y1 x3 y3), then swap the middle halves **/
+    const __m256d lo = _mm256_unpacklo_pd(x, y);
+    const __m256d hi = _mm256_unpackhi_pd(x, y);
+    _mm256_storeu_pd(coords + 2 * i, _mm256_permute2f128_pd(lo, hi, 0x20));
+    _mm256_storeu_pd(coords + 2 * i + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+  }
+#endif
+
+  const xform_pair_t sx = xform_pair_splat(kernel->sx);
+  const xform_pair_t sy = xform_pair_splat(kernel->sy);
+  const xform_pair_t tx = xform_pair_splat(kernel->tx);
+  const xform_pair_t ty = xform_pair_splat(kernel->ty);
+  for (; i + 2 <= count; i += 2) {
+    const xform_pair_t x = xform_pair_map(xform_pair_load(xs + i), sx, tx);
+    const xform_pair_t y = xform_pair_map(xform_pair_load(ys + i), sy, ty);
+    xform_pair_store(coords + 2 * i, xform_pair_zip_lo(x, y));
+    xform_pair_store(coords + 2 * i + 2, xform_pair_zip_hi(x, y));
+  }
+#endif
+
+  for (; i < count; i++) {
+    coords[2 * i] = xs[i] * kernel->sx + kernel->tx;
+    coords[2 * i + 1] = ys[i] * kernel->sy + kernel->ty;
+  }
+  return coords;
+}
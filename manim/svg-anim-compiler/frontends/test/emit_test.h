@@ -0,0 +1,218 @@
+/*=============================================================================
+  emit_test.h — the direct emitter against the Cairo renderer
+  ---------------------------------------------------------------------------
+  Usage:
+      #define EMIT_TEST_MAIN       // <- optional: gives you a main() driver
+      #include "emit_test.h"
+
+      $ cc -O2 -std=gnu17 -pthread emit_test.c frontends/src/manim_*.c \
+           -lcairo -lm -o emit_test
+      $ ./emit_test
+
+  A vmo with a background stroke, a fill and a foreground stroke is drawn
+  under a non-uniform scale, once by emit_vmo_path and once by render_vmo.
+=============================================================================*/
+#ifndef EMIT_TEST_H
+#define EMIT_TEST_H
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "manim/manim_emit.h"
+#include "manim/manim_fe.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cairo-svg.h>
+#include <cairo.h>
+
+/* ---------------------------------------------------------------------------
+   Fixture: a closed square, red background stroke, green fill, blue stroke
+   ------------------------------------------------------------------------ */
+
+/* 120 pixels per unit across, 135 down                                  */
+static const manim_file_header_t emit_test_header = {
+    .magic = {'C', 'T', 'X', 'T'},
+    .version = MANIM_DATA_VERSION_1,
+    .pixel_width = 1920,
+    .pixel_height = 1080,
+    .frame_width = 16.0,
+    .frame_height = 8.0};
+
+static manim_rgba_t emit_test_red = {.vals = {1, 0, 0, 1}};
+static manim_rgba_t emit_test_green = {.vals = {0, 1, 0, 1}};
+static manim_rgba_t emit_test_blue = {.vals = {0, 0, 1, 1}};
+
+static manim_quad_t emit_test_quads[4] = {
+    {.x1 = 1, .y1 = -1, .x2 = 1, .y2 = -1, .x3 = 1, .y3 = -1},
+    {.x1 = 1, .y1 = 1, .x2 = 1, .y2 = 1, .x3 = 1, .y3 = 1},
+    {.x1 = -1, .y1 = 1, .x2 = -1, .y2 = 1, .x3 = -1, .y3 = 1},
+    {.x1 = -1, .y1 = -1, .x2 = -1, .y2 = -1, .x3 = -1, .y3 = -1}};
+
+static manim_subpath_t emit_test_subpath = {
+    .x = -1, .y = -1, .quad_count = 4, .quads = emit_test_quads};
+
+static const manim_vmo_t emit_test_vmo = {
+    .id = 7,
+    .stroke_bg_width = 8.0f,
+    .stroke_width = 4.0f,
+    .stroke_bg_rgbas_count = 1,
+    .stroke_rgbas_count = 1,
+    .fill_rgbas_count = 1,
+    .subpath_count = 1,
+    .stroke_bg_rgbas = &emit_test_red,
+    .stroke_rgbas = &emit_test_blue,
+    .fill_rgbas = &emit_test_green,
+    .subpaths = &emit_test_subpath};
+
+/* Copies svg without spaces, Cairo versions differ in "rgb(a%, b%, c%)"   */
+static char *emit_test_squeeze(const char *svg, const size_t length) {
+  char *out = malloc(length + 1);
+  assert(out);
+  size_t n = 0;
+  for (size_t i = 0; i < length; ++i) {
+    if (svg[i] != ' ')
+      out[n++] = svg[i];
+  }
+  out[n] = '\0';
+  return out;
+}
+
+/* Value of the stroke-width attribute of the element at element           */
+static double emit_test_stroke_width(const char *element) {
+  const char *attr = strstr(element, "stroke-width=\"");
+  const char *end = strstr(element, "/>");
+  assert(attr && end && attr < end);
+  return strtod(attr + strlen("stroke-width=\""), NULL);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: both strokes come out, in the order and at the width of Cairo
+   ------------------------------------------------------------------------ */
+static void emit_test_strokes(void) {
+  puts("[strokes]");
+  const manim_vmo_t *vmo = &emit_test_vmo;
+
+  /** Direct **/
+  const manim_xform_t xform = manim_xform_from_header(&emit_test_header);
+  manim_xform_kernel_t kernel;
+  manim_xform_kernel_init(&kernel, &xform);
+  arena_t *direct_arena = arena_alloc();
+  arena_t *coord_arena = arena_alloc();
+  assert(direct_arena && coord_arena);
+  const double *coords = manim_xform_vmo(&kernel, vmo, coord_arena);
+  assert(coords);
+  const size_t direct_length =
+      emit_vmo_path(direct_arena, &xform, vmo, coords, NULL);
+  assert(direct_length == direct_arena->pos);
+  char *direct =
+      emit_test_squeeze((const char *)direct_arena->base, direct_length);
+
+  /** Cairo **/
+  arena_t *cairo_arena = arena_alloc();
+  assert(cairo_arena);
+  cairo_surface_t *surface = cairo_svg_surface_create_for_stream(
+      cairo_buffer_writer, cairo_arena, emit_test_header.pixel_width,
+      emit_test_header.pixel_height);
+  cairo_t *ctx = cairo_create(surface);
+  init_cairo_ctx(ctx, &emit_test_header);
+  cairo_matrix_t matrix;
+  cairo_get_matrix(ctx, &matrix);
+  render_vmo(ctx, vmo, NULL);
+  cairo_destroy(ctx);
+  cairo_surface_destroy(surface);
+  char *cairo = emit_test_squeeze((const char *)cairo_arena->base,
+                                  cairo_arena->pos);
+
+  /* Cairo strokes the background first and then the foreground on top    */
+  const char *cairo_bg = strstr(cairo, "rgb(100%,0%,0%)");
+  const char *cairo_fg = strstr(cairo, "rgb(0%,0%,100%)");
+  assert(cairo_bg && cairo_fg && cairo_bg < cairo_fg);
+
+  /* and so does the direct emitter, the background on its own path        */
+  const char *first = strstr(direct, "<path");
+  assert(first);
+  const char *second = strstr(first + 1, "<path");
+  assert(second && !strstr(second + 1, "<path"));
+  const char *direct_bg = strstr(direct, "stroke=\"rgb(255,0,0)\"");
+  const char *direct_fg = strstr(direct, "stroke=\"rgb(0,0,255)\"");
+  assert(direct_bg && direct_bg < second);
+  assert(direct_fg && direct_fg > second);
+  const char *no_fill = strstr(first, "fill=\"none\"");
+  assert(no_fill && no_fill < second);
+  assert(strstr(second, "fill=\"rgb(0,255,0)\""));
+  assert(strstr(second, "data-tag=\"7\""));
+
+  /* Cairo's line width, through the determinant of the user to device   */
+  /* matrix, matches the emitted one to its precision                    */
+  const double scale =
+      sqrt(fabs(matrix.xx * matrix.yy - matrix.xy * matrix.yx));
+  assert(fabs(emit_test_stroke_width(first) -
+              vmo->stroke_bg_width * 0.01 * scale) < 1e-3);
+  assert(fabs(emit_test_stroke_width(second) -
+              vmo->stroke_width * 0.01 * scale) < 1e-3);
+
+  free(direct);
+  free(cairo);
+  arena_release(direct_arena);
+  arena_release(coord_arena);
+  arena_release(cairo_arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: an invisible foreground leaves only the background path
+   ------------------------------------------------------------------------ */
+static void emit_test_background_only(void) {
+  puts("[background only]");
+  manim_rgba_t clear = {.vals = {0, 0, 0, 0}};
+  manim_vmo_t vmo = emit_test_vmo;
+  vmo.stroke_rgbas = &clear;
+  vmo.fill_rgbas = &clear;
+
+  const manim_xform_t xform = manim_xform_from_header(&emit_test_header);
+  manim_xform_kernel_t kernel;
+  manim_xform_kernel_init(&kernel, &xform);
+  arena_t *arena = arena_alloc();
+  arena_t *coord_arena = arena_alloc();
+  assert(arena && coord_arena);
+  const double *coords = manim_xform_vmo(&kernel, &vmo, coord_arena);
+  assert(coords);
+  const size_t length = emit_vmo_path(arena, &xform, &vmo, coords, NULL);
+  char *svg = emit_test_squeeze((const char *)arena->base, length);
+  const char *first = strstr(svg, "<path");
+  assert(first && !strstr(first + 1, "<path"));
+  assert(strstr(first, "stroke=\"rgb(255,0,0)\""));
+
+  /* with nothing left at all, nothing is emitted                        */
+  vmo.stroke_bg_rgbas = &clear;
+  assert(emit_vmo_path(arena, &xform, &vmo, coords, NULL) == 0);
+
+  free(svg);
+  arena_release(arena);
+  arena_release(coord_arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   EMIT_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void emit_tests_run_all(void) {
+  emit_test_strokes();
+  emit_test_background_only();
+  puts("all emit tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef EMIT_TEST_MAIN
+int main(void) {
+  emit_tests_run_all();
+  return 0;
+}
+#endif /* EMIT_TEST_MAIN */
+
+#endif /* EMIT_TEST_H */
@@ -0,0 +1,258 @@
+/*=============================================================================
+  io_test.h — validation & cold-cache benchmark of manim_io.h
+  ---------------------------------------------------------------------------
+  Usage:
+      #define IO_TEST_MAIN         // <- optional: gives you a main() driver
+      #include "io_test.h"
+
+      $ cc -O3 -std=gnu17 io_test.c frontends/src/manim_io.c -o io_test
+      $ ./io_test [dir]
+
+  Test files go to dir (default /tmp). The benchmark drops the file's pages
+  from the page cache (posix_fadvise DONTNEED after fsync) before every run,
+  so reads come from the device. Point dir at the disk the compiler reads
+  from, a tmpfs never goes cold.
+=============================================================================*/
+#ifndef IO_TEST_H
+#define IO_TEST_H
+
+#include "common/core.h"
+#include "manim/manim_io.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef IO_TEST_BENCH_BYTES /* file size read and written per bench run */
+#define IO_TEST_BENCH_BYTES (256u << 20) /* 256 MiB */
+#endif
+
+#ifndef IO_TEST_WORK /* cpu passes per byte read, stands in for decoding */
+#define IO_TEST_WORK 1u
+#endif
+
+static char io_test_path[4096];
+
+static uint8_t io_test_byte(const uint64_t pos) {
+  return (uint8_t)(pos * 2654435761u >> 13);
+}
+
+static void io_test_make_file(const char *path, const size_t size) {
+  FILE *fp = fopen(path, "wb");
+  assert(fp);
+  uint8_t block[1 << 16];
+  for (size_t pos = 0; pos < size; pos += sizeof(block)) {
+    const size_t n = size - pos < sizeof(block) ? size - pos : sizeof(block);
+    for (size_t i = 0; i < n; ++i)
+      block[i] = io_test_byte(pos + i);
+    const size_t written = fwrite(block, 1, n, fp);
+    assert(written == n);
+    (void)written;
+  }
+  fflush(fp);
+  fsync(fileno(fp));
+  fclose(fp);
+}
+
+static void io_test_drop_cache(const char *path) {
+  const int fd = open(path, O_RDONLY);
+  assert(fd >= 0);
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+static void io_test_expect(FILE *fp, const uint64_t pos, const size_t count,
+                           const size_t expected) {
+  uint8_t *buf = malloc(count + 1);
+  assert(buf);
+  const size_t got = fread(buf, 1, count, fp);
+  assert(got == expected);
+  (void)got;
+  for (size_t i = 0; i < expected; ++i)
+    assert(buf[i] == io_test_byte(pos + i));
+  assert((uint64_t)ftello(fp) == pos + expected);
+  free(buf);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: reads and seeks across chunk and window boundaries match the file
+   ------------------------------------------------------------------------ */
+static void io_test_read(void) {
+  puts("[read]");
+  const size_t window = MANIM_IO_READ_AHEAD * (size_t)MANIM_IO_CHUNK_SIZE;
+  const size_t size = window * 3 + MANIM_IO_CHUNK_SIZE / 2 + 12345;
+  io_test_make_file(io_test_path, size);
+
+  FILE *fp = manim_io_fopen_read(io_test_path);
+  assert(fp);
+
+  /* sequential, odd sizes straddling every chunk boundary */
+  uint64_t pos = 0;
+  for (size_t step = 1; pos + step * 7919 < window + MANIM_IO_CHUNK_SIZE;
+       ++step) {
+    io_test_expect(fp, pos, step * 7919, step * 7919);
+    pos += step * 7919;
+  }
+
+  /* forward within the window, past it, back before it, and to the end */
+  const uint64_t seeks[] = {pos + 100,
+                            pos + MANIM_IO_CHUNK_SIZE * 2 + 3,
+                            pos + window + MANIM_IO_CHUNK_SIZE,
+                            5,
+                            MANIM_IO_CHUNK_SIZE - 1,
+                            size - 10};
+  for (size_t i = 0; i < sizeof(seeks) / sizeof(seeks[0]); ++i) {
+    assert(fseeko(fp, (off_t)seeks[i], SEEK_SET) == 0);
+    const size_t left = size - seeks[i];
+    const size_t count = MANIM_IO_CHUNK_SIZE + 17;
+    io_test_expect(fp, seeks[i], count, left < count ? left : count);
+  }
+
+  /* at the end fread comes up empty and sets eof */
+  uint8_t byte;
+  assert(fread(&byte, 1, 1, fp) == 0 && feof(fp));
+  assert(fseeko(fp, -3, SEEK_END) == 0);
+  io_test_expect(fp, size - 3, 3, 3);
+
+  fclose(fp);
+  unlink(io_test_path);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: small writes of every size come back byte for byte
+   ------------------------------------------------------------------------ */
+static void io_test_write(const bool use_uring) {
+  printf("[write %s]\n", use_uring ? "io_uring" : "stdio");
+  manim_io_writer_t *writer = manim_io_writer_open(io_test_path, use_uring);
+  assert(writer);
+
+  const size_t size =
+      MANIM_IO_WRITE_BUFFERS * (size_t)MANIM_IO_WRITE_BUFFER_SIZE * 2 + 777;
+  uint8_t *buf = malloc(size);
+  assert(buf);
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = io_test_byte(i);
+
+  int ok = 1;
+  size_t pos = 0;
+  for (size_t step = 1; pos < size; step = step * 3 % 70001) {
+    const size_t n = size - pos < step ? size - pos : step;
+    ok &= manim_io_writer_write(writer, buf + pos, n);
+    pos += n;
+  }
+  ok &= manim_io_writer_close(writer);
+  assert(ok);
+  (void)ok;
+
+  FILE *fp = fopen(io_test_path, "rb");
+  assert(fp);
+  io_test_expect(fp, 0, size + 1, size);
+  fclose(fp);
+  free(buf);
+  unlink(io_test_path);
+}
+
+/* ---------------------------------------------------------------------------
+   Benchmark: cold-cache reads with decode-like work, and many small writes
+   ------------------------------------------------------------------------ */
+static double io_test_bench_read(const bool use_uring, const uint32_t work,
+                                 uint64_t *out_sum) {
+  io_test_drop_cache(io_test_path);
+  const timespec_t t0 = ts_now();
+
+  FILE *fp = use_uring ? manim_io_fopen_read(io_test_path)
+                       : fopen(io_test_path, "rb");
+  assert(fp);
+  static uint8_t buf[1 << 16];
+  uint64_t sum = 0;
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    for (uint32_t pass = 0; pass < work; ++pass)
+      for (size_t i = 0; i < n; ++i)
+        sum = sum * 31 + buf[i] + pass;
+  }
+  fclose(fp);
+
+  *out_sum = sum;
+  return ts_elapsed_sec(t0, ts_now());
+}
+
+static double io_test_bench_write(const bool use_uring) {
+  const timespec_t t0 = ts_now();
+  manim_io_writer_t *writer = manim_io_writer_open(io_test_path, use_uring);
+  assert(writer);
+
+  /* frame sized pieces, like --svg-out */
+  static uint8_t piece[3001];
+  memset(piece, 'x', sizeof(piece));
+  int ok = 1;
+  for (size_t pos = 0; pos < IO_TEST_BENCH_BYTES; pos += sizeof(piece))
+    ok &= manim_io_writer_write(writer, piece, sizeof(piece));
+  ok &= manim_io_writer_close(writer);
+  assert(ok);
+  (void)ok;
+
+  /* count the device, not just the page cache */
+  io_test_drop_cache(io_test_path);
+  return ts_elapsed_sec(t0, ts_now());
+}
+
+static void io_test_bench(void) {
+  const double mib = (double)IO_TEST_BENCH_BYTES / (1 << 20);
+  printf("[bench] %.0f MiB, io_uring %s\n", mib,
+         manim_io_uring_available() ? "available" : "unavailable (fallback)");
+
+  io_test_make_file(io_test_path, IO_TEST_BENCH_BYTES);
+  /* without work reads are device bound, with it read-ahead overlaps them */
+  const uint32_t works[] = {0, IO_TEST_WORK};
+  for (size_t w = 0; w < sizeof(works) / sizeof(works[0]); ++w) {
+    uint64_t sums[2];
+    const double read_stdio = io_test_bench_read(false, works[w], &sums[0]);
+    const double read_uring = io_test_bench_read(true, works[w], &sums[1]);
+    assert(sums[0] == sums[1]);
+    (void)sums;
+    printf("  cold read, %u work passes  stdio %7.1f MiB/s  io_uring %7.1f "
+           "MiB/s  (%.2fx)\n",
+           works[w], mib / read_stdio, mib / read_uring,
+           read_stdio / read_uring);
+  }
+
+  const double write_stdio = io_test_bench_write(false);
+  const double write_uring = io_test_bench_write(true);
+  printf("  write, 3001 byte pieces   stdio %7.1f MiB/s  io_uring %7.1f "
+         "MiB/s  (%.2fx)\n",
+         mib / write_stdio, mib / write_uring, write_stdio / write_uring);
+  unlink(io_test_path);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   IO_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void io_tests_run_all(const char *dir) {
+  snprintf(io_test_path, sizeof(io_test_path), "%s/manim_io_test", dir);
+  io_test_read();
+  io_test_write(false);
+  io_test_write(true);
+  io_test_bench();
+  puts("all io tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef IO_TEST_MAIN
+int main(const int argc, const char **argv) {
+  io_tests_run_all(argc > 1 ? argv[1] : "/tmp");
+  return 0;
+}
+#endif /* IO_TEST_MAIN */
+
+#endif /* IO_TEST_H */
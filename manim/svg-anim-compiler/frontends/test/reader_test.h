@@ -0,0 +1,293 @@
+/*=============================================================================
+  reader_test.h — the data reader, mapped input against buffered reads
+  ---------------------------------------------------------------------------
+  Usage:
+      #define READER_TEST_MAIN     // <- optional: gives you a main() driver
+      #include "reader_test.h"
+
+      $ cc -O2 -std=gnu17 -pthread reader_test.c frontends/src/manim_*.c \
+           -lcairo -lm -o reader_test
+      $ ./reader_test
+
+  A small version 1 file is written to READER_TEST_PATH and decoded once per
+  input mode, every frame has to come out the same.
+=============================================================================*/
+#ifndef READER_TEST_H
+#define READER_TEST_H
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "manim/manim_fe.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef READER_TEST_PATH
+#define READER_TEST_PATH "/tmp/manim_reader_test.dat"
+#endif
+
+#ifndef READER_TEST_FRAMES
+#define READER_TEST_FRAMES 24
+#endif
+
+/* ---------------------------------------------------------------------------
+   Lightweight RNG (xorshift32)
+   ------------------------------------------------------------------------ */
+static inline uint32_t reader_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static inline float reader_prng_float(uint32_t *state) {
+  return (float)(reader_prng_next(state) / (double)UINT32_MAX * 16.0 - 8.0);
+}
+
+/* ---------------------------------------------------------------------------
+   Fixture: version 1 records written as the exporter packs them
+   ------------------------------------------------------------------------ */
+static void reader_test_write_rgbas(FILE *fp, const uint32_t count,
+                                    uint32_t *rng) {
+  for (uint32_t i = 0; i < count; ++i) {
+    manim_rgba_t rgba = {.magic = {'R', 'G', 'B', 'A'}};
+    for (int c = 0; c < 4; ++c)
+      rgba.vals[c] = (float)(reader_prng_next(rng) % 256) / 255.0f;
+    assert(fwrite(&rgba, sizeof(rgba), 1, fp) == 1);
+  }
+}
+
+static void reader_test_write_v1(const char *path, const size_t num_frames) {
+  FILE *fp = fopen(path, "wb");
+  assert(fp);
+  const manim_file_header_t header = {.magic = {'C', 'T', 'X', 'T'},
+                                      .version = MANIM_DATA_VERSION_1,
+                                      .pixel_width = 1920,
+                                      .pixel_height = 1080,
+                                      .frame_width = 14.222222222222221,
+                                      .frame_height = 8.0};
+  assert(fwrite(&header, sizeof(header), 1, fp) == 1);
+
+  uint32_t rng = 5u;
+  for (size_t f = 0; f < num_frames; ++f) {
+    /* now and then an empty frame */
+    const uint32_t vmo_count = f % 7 == 3 ? 0 : 1 + reader_prng_next(&rng) % 4;
+    assert(fwrite("FRAM", 4, 1, fp) == 1);
+    assert(fwrite(&vmo_count, sizeof(vmo_count), 1, fp) == 1);
+
+    for (uint32_t v = 0; v < vmo_count; ++v) {
+      manim_vmo_t vmo = {.magic = {'V', 'M', 'O', 'B'}};
+      vmo.id = v;
+      vmo.stroke_bg_width = 6.0f;
+      vmo.stroke_width = 4.0f;
+      vmo.stroke_bg_rgbas_count = reader_prng_next(&rng) % 2;
+      vmo.stroke_rgbas_count = 1 + reader_prng_next(&rng) % 3;
+      vmo.fill_rgbas_count = reader_prng_next(&rng) % 3;
+      vmo.gradient_x0 = reader_prng_float(&rng);
+      vmo.gradient_y0 = reader_prng_float(&rng);
+      vmo.gradient_x1 = reader_prng_float(&rng);
+      vmo.gradient_y1 = reader_prng_float(&rng);
+      vmo.subpath_count = reader_prng_next(&rng) % 3;
+      assert(fwrite(&vmo, offsetof(manim_vmo_t, stroke_bg_rgbas), 1, fp) == 1);
+
+      reader_test_write_rgbas(fp, vmo.stroke_bg_rgbas_count, &rng);
+      reader_test_write_rgbas(fp, vmo.stroke_rgbas_count, &rng);
+      reader_test_write_rgbas(fp, vmo.fill_rgbas_count, &rng);
+
+      for (uint32_t s = 0; s < vmo.subpath_count; ++s) {
+        manim_subpath_t subpath = {.magic = {'S', 'U', 'B', 'P'}};
+        subpath.x = reader_prng_float(&rng);
+        subpath.y = reader_prng_float(&rng);
+        subpath.quad_count = reader_prng_next(&rng) % 5;
+        assert(fwrite(&subpath, offsetof(manim_subpath_t, quads), 1, fp) == 1);
+        for (uint32_t q = 0; q < subpath.quad_count; ++q) {
+          manim_quad_t quad = {.magic = {'Q', 'U', 'A', 'D'}};
+          quad.x1 = reader_prng_float(&rng);
+          quad.y1 = reader_prng_float(&rng);
+          quad.x2 = reader_prng_float(&rng);
+          quad.y2 = reader_prng_float(&rng);
+          quad.x3 = reader_prng_float(&rng);
+          quad.y3 = reader_prng_float(&rng);
+          assert(fwrite(&quad, sizeof(quad), 1, fp) == 1);
+        }
+      }
+    }
+  }
+  assert(fclose(fp) == 0);
+}
+
+static void reader_test_same_vmo(const manim_vmo_t *a, const manim_vmo_t *b) {
+  assert(memcmp(a, b, offsetof(manim_vmo_t, stroke_bg_rgbas)) == 0);
+  assert(memcmp(a->stroke_bg_rgbas, b->stroke_bg_rgbas,
+                a->stroke_bg_rgbas_count * sizeof(manim_rgba_t)) == 0);
+  assert(memcmp(a->stroke_rgbas, b->stroke_rgbas,
+                a->stroke_rgbas_count * sizeof(manim_rgba_t)) == 0);
+  assert(memcmp(a->fill_rgbas, b->fill_rgbas,
+                a->fill_rgbas_count * sizeof(manim_rgba_t)) == 0);
+  for (uint32_t s = 0; s < a->subpath_count; ++s) {
+    const manim_subpath_t *sa = &a->subpaths[s];
+    const manim_subpath_t *sb = &b->subpaths[s];
+    assert(memcmp(sa, sb, offsetof(manim_subpath_t, quads)) == 0);
+    assert(memcmp(sa->quads, sb->quads,
+                  sa->quad_count * sizeof(manim_quad_t)) == 0);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: mapped frames match the buffered ones, then both end
+   ------------------------------------------------------------------------ */
+static void reader_test_mmap_matches_stream(void) {
+  puts("[mmap matches stream]");
+  reader_test_write_v1(READER_TEST_PATH, READER_TEST_FRAMES);
+
+  manim_reader_t stream, mapped;
+  int ok = manim_reader_open(&stream, READER_TEST_PATH, MANIM_INPUT_STREAM);
+  assert(ok);
+  ok = manim_reader_open(&mapped, READER_TEST_PATH, MANIM_INPUT_MMAP);
+  assert(ok);
+  assert(memcmp(&stream.header, &mapped.header, sizeof(stream.header)) == 0);
+
+  arena_t *stream_arena = arena_alloc();
+  arena_t *mapped_arena = arena_alloc();
+  assert(stream_arena && mapped_arena);
+  size_t frames = 0;
+  for (;;) {
+    manim_frame_t a, b;
+    const int got_a = manim_reader_next_frame(&stream, stream_arena, &a);
+    const int got_b = manim_reader_next_frame(&mapped, mapped_arena, &b);
+    assert(got_a == got_b);
+    if (!got_a)
+      break;
+    assert(a.vmo_count == b.vmo_count);
+    for (uint32_t v = 0; v < a.vmo_count; ++v)
+      reader_test_same_vmo(&a.vmos[v], &b.vmos[v]);
+    arena_clear(stream_arena);
+    arena_clear(mapped_arena);
+    ++frames;
+  }
+  assert(frames == READER_TEST_FRAMES);
+
+  /* the index of the mapping agrees with the one of the stream */
+  manim_reader_close(&stream);
+  manim_reader_close(&mapped);
+  ok = manim_reader_open(&stream, READER_TEST_PATH, MANIM_INPUT_STREAM);
+  assert(ok);
+  ok = manim_reader_open(&mapped, READER_TEST_PATH, MANIM_INPUT_MMAP);
+  assert(ok);
+  manim_frame_index_t index_a, index_b;
+  ok = manim_reader_build_index(&stream, stream_arena, &index_a);
+  assert(ok);
+  ok = manim_reader_build_index(&mapped, mapped_arena, &index_b);
+  assert(ok);
+  assert(index_a.num_frames == READER_TEST_FRAMES &&
+         index_b.num_frames == READER_TEST_FRAMES);
+  assert(memcmp(index_a.offsets, index_b.offsets,
+                READER_TEST_FRAMES * sizeof(uint64_t)) == 0);
+
+  manim_reader_close(&stream);
+  manim_reader_close(&mapped);
+  arena_release(stream_arena);
+  arena_release(mapped_arena);
+  unlink(READER_TEST_PATH);
+  (void)ok;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: an empty file is refused by every mode instead of mapped
+   ------------------------------------------------------------------------ */
+static void reader_test_empty(void) {
+  puts("[empty]");
+  FILE *fp = fopen(READER_TEST_PATH, "wb");
+  assert(fp);
+  fclose(fp);
+
+  manim_reader_t reader;
+  assert(!manim_reader_open(&reader, READER_TEST_PATH, MANIM_INPUT_MMAP));
+  assert(!manim_reader_open(&reader, READER_TEST_PATH, MANIM_INPUT_STREAM));
+  unlink(READER_TEST_PATH);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: a frame cut short is told apart from the end of the input
+   ------------------------------------------------------------------------ */
+static void reader_test_truncated(void) {
+  puts("[truncated]");
+  reader_test_write_v1(READER_TEST_PATH, READER_TEST_FRAMES);
+  FILE *fp = fopen(READER_TEST_PATH, "rb+");
+  assert(fp && fseek(fp, 0, SEEK_END) == 0);
+  const long size = ftell(fp);
+  assert(fclose(fp) == 0);
+
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  const manim_input_mode_e modes[] = {MANIM_INPUT_STREAM, MANIM_INPUT_MMAP};
+  for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); ++m) {
+    /* whole: every frame, then the end */
+    assert(truncate(READER_TEST_PATH, size) == 0);
+    manim_reader_t reader;
+    int ok = manim_reader_open(&reader, READER_TEST_PATH, modes[m]);
+    assert(ok);
+    manim_frame_t frame;
+    size_t frames = 0;
+    while (manim_reader_next_frame(&reader, arena, &frame)) {
+      arena_clear(arena);
+      ++frames;
+    }
+    assert(frames == READER_TEST_FRAMES && reader.at_end);
+    manim_reader_close(&reader);
+
+    /* cut into the last frame: malformed, and not indexed either */
+    assert(truncate(READER_TEST_PATH, size - 3) == 0);
+    ok = manim_reader_open(&reader, READER_TEST_PATH, modes[m]);
+    assert(ok);
+    frames = 0;
+    while (manim_reader_next_frame(&reader, arena, &frame)) {
+      arena_clear(arena);
+      ++frames;
+    }
+    assert(frames == READER_TEST_FRAMES - 1 && !reader.at_end);
+    manim_reader_close(&reader);
+
+    ok = manim_reader_open(&reader, READER_TEST_PATH, modes[m]);
+    assert(ok);
+    manim_frame_index_t index;
+    assert(!manim_reader_build_index(&reader, arena, &index));
+    manim_reader_close(&reader);
+    arena_clear(arena);
+    (void)ok;
+  }
+
+  arena_release(arena);
+  unlink(READER_TEST_PATH);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   READER_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void reader_tests_run_all(void) {
+  reader_test_mmap_matches_stream();
+  reader_test_empty();
+  reader_test_truncated();
+  puts("all reader tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef READER_TEST_MAIN
+int main(void) {
+  reader_tests_run_all();
+  return 0;
+}
+#endif /* READER_TEST_MAIN */
+
+#endif /* READER_TEST_H */
@@ -0,0 +1,284 @@
+/*=============================================================================
+  render_test.h — frames rendered out of order against frames in order
+  ---------------------------------------------------------------------------
+  Usage:
+      #define RENDER_TEST_MAIN     // <- optional: gives you a main() driver
+      #include "render_test.h"
+
+      $ cc -O2 -std=gnu17 -pthread render_test.c frontends/src/manim_*.c \
+           -lcairo -lm -o render_test
+      $ ./render_test
+
+  A thread that steals a range renders it with a render cache warm from some
+  other frame. The svg of every frame and the order of the shared gradient
+  <defs> have to come out as if a single thread rendered them in order.
+=============================================================================*/
+#ifndef RENDER_TEST_H
+#define RENDER_TEST_H
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "manim/manim_fe.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef RENDER_TEST_PATH
+#define RENDER_TEST_PATH "/tmp/manim_render_test.dat"
+#endif
+
+#ifndef RENDER_TEST_FRAMES /* even, the second half is rendered first */
+#define RENDER_TEST_FRAMES 32
+#endif
+
+#define RENDER_TEST_VMOS 3
+
+/* ---------------------------------------------------------------------------
+   Fixture: per frame, a vmo that takes on a gradient half way, one that never
+   changes, and one that moves and changes its gradient now and then
+   ------------------------------------------------------------------------ */
+static const manim_file_header_t render_test_header = {
+    .magic = {'C', 'T', 'X', 'T'},
+    .version = MANIM_DATA_VERSION_1,
+    .pixel_width = 1920,
+    .pixel_height = 1080,
+    .frame_width = 14.222222222222221,
+    .frame_height = 8.0};
+
+typedef struct render_test_frame_t {
+  manim_vmo_t vmos[RENDER_TEST_VMOS];
+  manim_rgba_t fills[RENDER_TEST_VMOS][2];
+  manim_rgba_t strokes[RENDER_TEST_VMOS][1];
+  manim_subpath_t subpaths[RENDER_TEST_VMOS];
+  manim_quad_t quads[RENDER_TEST_VMOS][2];
+  manim_frame_t frame;
+} render_test_frame_t;
+
+static void render_test_build(render_test_frame_t *f, const size_t frame_num) {
+  memset(f, 0, sizeof(*f));
+  for (uint32_t v = 0; v < RENDER_TEST_VMOS; ++v) {
+    manim_vmo_t *vmo = &f->vmos[v];
+    memcpy(vmo->magic, "VMOB", 4);
+    vmo->id = v;
+    vmo->stroke_width = 4.0f;
+    vmo->gradient_x0 = -1.0f;
+    vmo->gradient_x1 = 1.0f;
+
+    const float shift = v == 2 ? 0.125f * (float)frame_num : 0.0f;
+    const float tint =
+        v == 0 ? 0.25f : v == 1 ? 0.5f : 0.75f + 0.0625f * (float)(frame_num / 8);
+    f->fills[v][0] = (manim_rgba_t){.magic = {'R', 'G', 'B', 'A'},
+                                    .vals = {tint, 0.0f, 1.0f, 1.0f}};
+    f->fills[v][1] = (manim_rgba_t){.magic = {'R', 'G', 'B', 'A'},
+                                    .vals = {0.0f, tint, 0.0f, 1.0f}};
+    f->strokes[v][0] = (manim_rgba_t){.magic = {'R', 'G', 'B', 'A'},
+                                      .vals = {1.0f, 1.0f, 1.0f, 1.0f}};
+    vmo->fill_rgbas = f->fills[v];
+    vmo->fill_rgbas_count = v == 0 && frame_num < RENDER_TEST_FRAMES / 2 ? 1 : 2;
+    vmo->stroke_rgbas = f->strokes[v];
+    vmo->stroke_rgbas_count = 1;
+
+    manim_subpath_t *subpath = &f->subpaths[v];
+    memcpy(subpath->magic, "SUBP", 4);
+    subpath->x = (float)v + shift;
+    subpath->y = 0.0f;
+    subpath->quad_count = 2;
+    subpath->quads = f->quads[v];
+    for (uint32_t q = 0; q < 2; ++q) {
+      manim_quad_t *quad = &f->quads[v][q];
+      memcpy(quad->magic, "QUAD", 4);
+      quad->x1 = subpath->x + 0.5f;
+      quad->y1 = q ? -0.5f : 0.5f;
+      quad->x2 = subpath->x + 1.0f;
+      quad->y2 = q ? -1.0f : 1.0f;
+      quad->x3 = q ? subpath->x : subpath->x + 1.0f;
+      quad->y3 = q ? 0.0f : 0.25f;
+    }
+    vmo->subpath_count = 1;
+    vmo->subpaths = subpath;
+  }
+  memcpy(f->frame.magic, "FRAM", 4);
+  f->frame.vmo_count = RENDER_TEST_VMOS;
+  f->frame.vmos = f->vmos;
+}
+
+/* Renders the frames in order, one svg per frame, then the defs            */
+typedef struct render_test_run_t {
+  arena_t *svg;
+  size_t offsets[RENDER_TEST_FRAMES + 1];
+  size_t lengths[RENDER_TEST_FRAMES + 1];
+} render_test_run_t;
+
+static void render_test_run(render_test_run_t *run, const size_t *order,
+                            const manim_renderer_e renderer) {
+  manim_gradient_table_t table;
+  int ok = manim_gradient_table_init(&table, &render_test_header);
+  assert(ok);
+  manim_fe_worker_t worker;
+  ok = manim_fe_worker_init(&worker, &table);
+  assert(ok);
+  worker.renderer = renderer;
+  worker.use_render_cache = true;
+
+  run->svg = arena_alloc();
+  assert(run->svg);
+  render_test_frame_t f;
+  for (size_t i = 0; i < RENDER_TEST_FRAMES; ++i) {
+    const size_t frame_num = order[i];
+    render_test_build(&f, frame_num);
+    run->offsets[frame_num] = run->svg->pos;
+    run->lengths[frame_num] = manim_fe_render_frame(
+        &worker, &render_test_header, frame_num, &f.frame, run->svg);
+    arena_clear(worker.scratch_manim_frame_arena);
+  }
+  run->offsets[RENDER_TEST_FRAMES] = run->svg->pos;
+  run->lengths[RENDER_TEST_FRAMES] =
+      manim_gradient_table_emit_defs(&table, run->svg);
+  assert(run->lengths[RENDER_TEST_FRAMES] > 0);
+
+  manim_fe_worker_release(&worker);
+  manim_gradient_table_release(&table);
+  (void)ok;
+}
+
+static void render_test_same(const render_test_run_t *a,
+                             const render_test_run_t *b) {
+  for (size_t i = 0; i <= RENDER_TEST_FRAMES; ++i) {
+    assert(a->lengths[i] == b->lengths[i]);
+    assert(memcmp(a->svg->base + a->offsets[i], b->svg->base + b->offsets[i],
+                  a->lengths[i]) == 0);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: a worker renders the second half first, like a thread stealing
+   the upper half of a batch and then going back to the lower one
+   ------------------------------------------------------------------------ */
+static void render_test_stolen_range(const manim_renderer_e renderer) {
+  printf("[stolen range, %s]\n",
+         renderer == MANIM_RENDERER_DIRECT ? "direct" : "cairo");
+
+  size_t in_order[RENDER_TEST_FRAMES], stolen[RENDER_TEST_FRAMES];
+  for (size_t i = 0; i < RENDER_TEST_FRAMES; ++i) {
+    in_order[i] = i;
+    stolen[i] = (i + RENDER_TEST_FRAMES / 2) % RENDER_TEST_FRAMES;
+  }
+
+  render_test_run_t a, b;
+  render_test_run(&a, in_order, renderer);
+  render_test_run(&b, stolen, renderer);
+  render_test_same(&a, &b);
+  arena_release(a.svg);
+  arena_release(b.svg);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: the threaded driver writes what --threads 1 writes
+   ------------------------------------------------------------------------ */
+static void render_test_write_rgbas(FILE *fp, const manim_rgba_t *rgbas,
+                                    const uint32_t count) {
+  if (count > 0)
+    assert(fwrite(rgbas, sizeof(manim_rgba_t), count, fp) == count);
+}
+
+static void render_test_write_v1(const char *path) {
+  FILE *fp = fopen(path, "wb");
+  assert(fp);
+  assert(fwrite(&render_test_header, sizeof(render_test_header), 1, fp) == 1);
+
+  render_test_frame_t f;
+  for (size_t n = 0; n < RENDER_TEST_FRAMES; ++n) {
+    render_test_build(&f, n);
+    assert(fwrite(f.frame.magic, 4, 1, fp) == 1);
+    assert(fwrite(&f.frame.vmo_count, sizeof(f.frame.vmo_count), 1, fp) == 1);
+    for (uint32_t v = 0; v < f.frame.vmo_count; ++v) {
+      const manim_vmo_t *vmo = &f.vmos[v];
+      assert(fwrite(vmo, offsetof(manim_vmo_t, stroke_bg_rgbas), 1, fp) == 1);
+      render_test_write_rgbas(fp, vmo->stroke_bg_rgbas,
+                              vmo->stroke_bg_rgbas_count);
+      render_test_write_rgbas(fp, vmo->stroke_rgbas, vmo->stroke_rgbas_count);
+      render_test_write_rgbas(fp, vmo->fill_rgbas, vmo->fill_rgbas_count);
+      for (uint32_t s = 0; s < vmo->subpath_count; ++s) {
+        const manim_subpath_t *subpath = &vmo->subpaths[s];
+        assert(fwrite(subpath, offsetof(manim_subpath_t, quads), 1, fp) == 1);
+        assert(fwrite(subpath->quads, sizeof(manim_quad_t),
+                      subpath->quad_count, fp) == subpath->quad_count);
+      }
+    }
+  }
+  assert(fclose(fp) == 0);
+}
+
+static SvgAnimStatus render_test_keep(void *ctx, const size_t frame_num,
+                                      const size_t offset,
+                                      const size_t length) {
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static SvgAnimStatus render_test_keep_defs(void *ctx, const size_t offset,
+                                           const size_t length) {
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+/* Everything the driver hands the sink, frames and defs, stays in the arena */
+static arena_t *render_test_stream(const size_t num_threads) {
+  manim_fe_opts_t opts = manim_fe_opts_default();
+  opts.renderer = MANIM_RENDERER_DIRECT;
+  opts.num_threads = num_threads;
+  const manim_fe_sink_t sink = {.svg_arena = arena_alloc(),
+                                .frame = render_test_keep,
+                                .defs = render_test_keep_defs};
+  assert(sink.svg_arena);
+  size_t num_frames;
+  const int rc = manim_fe_stream(RENDER_TEST_PATH, &opts, &sink, &num_frames);
+  assert(rc == 0 && num_frames == RENDER_TEST_FRAMES);
+  (void)rc;
+  return sink.svg_arena;
+}
+
+static void render_test_threads(void) {
+  puts("[threads]");
+  render_test_write_v1(RENDER_TEST_PATH);
+
+  arena_t *single = render_test_stream(1);
+  for (size_t threads = 2; threads <= 8; threads *= 2) {
+    for (int round = 0; round < 4; ++round) {
+      arena_t *threaded = render_test_stream(threads);
+      assert(threaded->pos == single->pos);
+      assert(memcmp(threaded->base, single->base, single->pos) == 0);
+      arena_release(threaded);
+    }
+  }
+  arena_release(single);
+  unlink(RENDER_TEST_PATH);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   RENDER_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void render_tests_run_all(void) {
+  render_test_stolen_range(MANIM_RENDERER_DIRECT);
+  render_test_stolen_range(MANIM_RENDERER_CAIRO);
+  render_test_threads();
+  puts("all render tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef RENDER_TEST_MAIN
+int main(void) {
+  render_tests_run_all();
+  return 0;
+}
+#endif /* RENDER_TEST_MAIN */
+
+#endif /* RENDER_TEST_H */
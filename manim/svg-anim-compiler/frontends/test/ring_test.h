@@ -0,0 +1,277 @@
+/*=============================================================================
+  ring_test.h — validation & throughput of the live ingest ring
+  ---------------------------------------------------------------------------
+  Usage:
+      #define RING_TEST_MAIN       // <- optional: gives you a main() driver
+      #include "ring_test.h"
+
+      $ cc -O3 -std=gnu17 -pthread ring_test.c frontends/src/manim_ring.c \
+           -o ring_test
+      $ ./ring_test
+
+  The ring is backed by a regular file (RING_TEST_PATH) instead of a shared
+  memory object, the code path is the same past shm_open.
+=============================================================================*/
+#ifndef RING_TEST_H
+#define RING_TEST_H
+
+#include "common/core.h"
+#include "manim/manim_ring.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef RING_TEST_PATH
+#define RING_TEST_PATH "/tmp/manim_ring_test"
+#endif
+
+#ifndef RING_TEST_BYTES /* streamed per perf pass                    */
+#define RING_TEST_BYTES (256u << 20) /* 256 MiB */
+#endif
+
+/* ---------------------------------------------------------------------------
+   Lightweight RNG (xorshift32)
+   ------------------------------------------------------------------------ */
+static inline uint32_t ring_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/* Byte n of every test stream                                            */
+static inline unsigned char ring_test_byte(const uint64_t n) {
+  return (unsigned char)(n * 2654435761u >> 13);
+}
+
+/* ---------------------------------------------------------------------------
+   Writer thread: streams `bytes` bytes in chunks of 1..max_chunk
+   ------------------------------------------------------------------------ */
+typedef struct ring_test_writer_t {
+  manim_ring_t ring;
+  uint64_t bytes;
+  size_t max_chunk;
+  size_t stalls;
+  /* bytes written before the reader went away, all of them if it stayed   */
+  uint64_t written;
+} ring_test_writer_t;
+
+static void *ring_test_writer_run(void *arg) {
+  ring_test_writer_t *writer = arg;
+  unsigned char *chunk = malloc(writer->max_chunk);
+  assert(chunk);
+  uint32_t rng = 7u;
+
+  for (uint64_t pos = 0; pos < writer->bytes;) {
+    size_t count = 1 + ring_prng_next(&rng) % writer->max_chunk;
+    if (count > writer->bytes - pos)
+      count = (size_t)(writer->bytes - pos);
+    for (size_t i = 0; i < count; ++i)
+      chunk[i] = ring_test_byte(pos + i);
+    if (!manim_ring_write(&writer->ring, chunk, count))
+      break;
+    pos += count;
+    writer->written = pos;
+  }
+
+  writer->stalls = writer->ring.stalls;
+  manim_ring_finish(&writer->ring);
+  free(chunk);
+  return NULL;
+}
+
+static void ring_test_start(ring_test_writer_t *writer, pthread_t *thread,
+                            const size_t capacity, const uint64_t bytes,
+                            const size_t max_chunk) {
+  writer->bytes = bytes;
+  writer->max_chunk = max_chunk;
+  writer->written = 0;
+  int ok = manim_ring_create(&writer->ring, RING_TEST_PATH, capacity);
+  assert(ok);
+  ok = pthread_create(thread, NULL, ring_test_writer_run, writer) == 0;
+  assert(ok);
+  (void)ok;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: a stream larger than the ring arrives intact and then ends
+   ------------------------------------------------------------------------ */
+static void ring_test_roundtrip(void) {
+  puts("[roundtrip]");
+
+  enum { CAPACITY = 4096, BYTES = 1 << 20, MAX_CHUNK = 1500 };
+  ring_test_writer_t writer;
+  pthread_t thread;
+  ring_test_start(&writer, &thread, CAPACITY, BYTES, MAX_CHUNK);
+
+  manim_ring_t ring;
+  int ok = manim_ring_open(&ring, RING_TEST_PATH, 5.0);
+  assert(ok);
+  assert(ring.mask + 1 == CAPACITY);
+
+  unsigned char buf[2000];
+  uint32_t rng = 11u;
+  uint64_t pos = 0;
+  for (;;) {
+    const size_t want = 1 + ring_prng_next(&rng) % sizeof(buf);
+    const size_t got = manim_ring_read(&ring, buf, want);
+    assert(got <= want);
+    if (got == 0)
+      break;
+    for (size_t i = 0; i < got; ++i)
+      assert(buf[i] == ring_test_byte(pos + i));
+    pos += got;
+  }
+  assert(pos == BYTES);
+  assert(manim_ring_read(&ring, buf, sizeof(buf)) == 0);
+
+  pthread_join(thread, NULL);
+  assert(writer.written == BYTES);
+  manim_ring_close(&ring);
+  unlink(RING_TEST_PATH);
+  (void)ok;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: the FILE adapter reads exact sizes and seeks forward only
+   ------------------------------------------------------------------------ */
+static void ring_test_file(void) {
+  puts("[file]");
+
+  enum { CAPACITY = 1024, BYTES = 100000, MAX_CHUNK = 300 };
+  ring_test_writer_t writer;
+  pthread_t thread;
+  ring_test_start(&writer, &thread, CAPACITY, BYTES, MAX_CHUNK);
+
+  FILE *fp = manim_ring_fopen(RING_TEST_PATH, 5.0);
+  assert(fp);
+
+  unsigned char buf[5000];
+  size_t got = fread(buf, 1, 40, fp);
+  assert(got == 40 && buf[39] == ring_test_byte(39));
+
+  /* forward, as the version 3 header padding is skipped */
+  int rc = fseeko(fp, 64, SEEK_SET);
+  assert(rc == 0 && ftello(fp) == 64);
+  got = fread(buf, 1, sizeof(buf), fp);
+  assert(got == sizeof(buf));
+  for (size_t i = 0; i < got; ++i)
+    assert(buf[i] == ring_test_byte(64 + i));
+
+  rc = fseeko(fp, 1000, SEEK_CUR);
+  assert(rc == 0);
+  got = fread(buf, 1, 1, fp);
+  assert(got == 1 && buf[0] == ring_test_byte(64 + sizeof(buf) + 1000));
+
+  /* backward is refused */
+  assert(fseeko(fp, 0, SEEK_SET) != 0);
+  clearerr(fp);
+
+  /* the short read at the end, then EOF */
+  uint64_t pos = (uint64_t)ftello(fp);
+  while ((got = fread(buf, 1, sizeof(buf), fp)) > 0)
+    pos += got;
+  assert(pos == BYTES && feof(fp));
+
+  pthread_join(thread, NULL);
+  fclose(fp);
+  unlink(RING_TEST_PATH);
+  (void)rc;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: a writer blocked on a full ring gives up once the reader detaches
+   ------------------------------------------------------------------------ */
+static void ring_test_reader_detach(void) {
+  puts("[reader detach]");
+
+  enum { CAPACITY = 4096, BYTES = 1 << 20, MAX_CHUNK = 1500 };
+  ring_test_writer_t writer;
+  pthread_t thread;
+  ring_test_start(&writer, &thread, CAPACITY, BYTES, MAX_CHUNK);
+
+  manim_ring_t ring;
+  int ok = manim_ring_open(&ring, RING_TEST_PATH, 5.0);
+  assert(ok);
+  unsigned char buf[100];
+  const size_t got = manim_ring_read(&ring, buf, sizeof(buf));
+  assert(got > 0 && buf[0] == ring_test_byte(0));
+  manim_ring_close(&ring);
+
+  /* returns instead of waiting forever on the ring it filled              */
+  pthread_join(thread, NULL);
+  assert(writer.written < BYTES);
+  assert(writer.written <= got + CAPACITY);
+
+  unlink(RING_TEST_PATH);
+  (void)ok;
+  (void)got;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 4: throughput with the writer on another thread
+   ------------------------------------------------------------------------ */
+static void ring_test_perf(const uint64_t bytes) {
+  const size_t capacity = 4u << 20;
+  printf("[perf] %" PRIu64 " MiB through a %zu MiB ring\n", bytes >> 20,
+         capacity >> 20);
+
+  ring_test_writer_t writer;
+  pthread_t thread;
+  const timespec_t t0 = ts_now();
+  ring_test_start(&writer, &thread, capacity, bytes, 64 << 10);
+
+  manim_ring_t ring;
+  int ok = manim_ring_open(&ring, RING_TEST_PATH, 5.0);
+  assert(ok);
+  unsigned char *buf = malloc(1 << 20);
+  assert(buf);
+  uint64_t total = 0;
+  size_t got;
+  while ((got = manim_ring_read(&ring, buf, 1 << 20)) > 0)
+    total += got;
+  assert(total == bytes);
+  pthread_join(thread, NULL);
+  const double secs = ts_elapsed_sec(t0, ts_now());
+
+  printf("  %.1f MiB/s, reader stalled %zu times, writer %zu times\n",
+         (double)bytes / (1 << 20) / secs, ring.stalls, writer.stalls);
+
+  free(buf);
+  manim_ring_close(&ring);
+  unlink(RING_TEST_PATH);
+  (void)ok;
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   RING_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void ring_tests_run_all(void) {
+  ring_test_roundtrip();
+  ring_test_file();
+  ring_test_reader_detach();
+  ring_test_perf(RING_TEST_BYTES);
+  puts("all ring tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef RING_TEST_MAIN
+int main(void) {
+  ring_tests_run_all();
+  return 0;
+}
+#endif /* RING_TEST_MAIN */
+
+#endif /* RING_TEST_H */
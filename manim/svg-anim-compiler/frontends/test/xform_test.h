@@ -0,0 +1,272 @@
+/*=============================================================================
+  xform_test.h — validation & micro-benchmarks for the bulk transform
+  ---------------------------------------------------------------------------
+  Usage:
+      #define XFORM_TEST_MAIN      // <- optional: gives you a main() driver
+      #include "xform_test.h"
+
+      $ cc -O3 -std=gnu17 -mavx xform_test.c frontends/src/manim_xform.c \
+           -lm -o xform_test
+      $ ./xform_test
+=============================================================================*/
+#ifndef XFORM_TEST_H
+#define XFORM_TEST_H
+
+#include "common/core.h"
+#include "manim/manim_emit.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef XFORM_TEST_QUADS /* quads transformed per perf pass      */
+#define XFORM_TEST_QUADS (1u << 20) /* 1 048 576 */
+#endif
+
+#ifndef XFORM_TEST_PASSES
+#define XFORM_TEST_PASSES 16
+#endif
+
+/* ---------------------------------------------------------------------------
+   Lightweight RNG (xorshift32)
+   ------------------------------------------------------------------------ */
+static inline uint32_t xform_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/* Frame coordinates, a few off the frame                                */
+static inline float xform_prng_coord(uint32_t *state) {
+  return (float)((xform_prng_next(state) / (double)UINT32_MAX) * 20.0 - 10.0);
+}
+
+static void xform_test_fill(manim_quad_t *quads, size_t count,
+                            uint32_t *state) {
+  for (size_t i = 0; i < count; ++i) {
+    memcpy(quads[i].magic, "QUAD", 4);
+    quads[i].x1 = xform_prng_coord(state);
+    quads[i].y1 = xform_prng_coord(state);
+    quads[i].x2 = xform_prng_coord(state);
+    quads[i].y2 = xform_prng_coord(state);
+    quads[i].x3 = xform_prng_coord(state);
+    quads[i].y3 = xform_prng_coord(state);
+  }
+}
+
+static const manim_file_header_t xform_test_header = {
+    .frame_width = 14.2222,
+    .frame_height = 8.0,
+    .pixel_width = 1920.0,
+    .pixel_height = 1080.0,
+};
+
+/* Reference: one quad at a time, the way the emitter used to map them    */
+static void xform_test_reference(const manim_xform_t *xform, double *dst,
+                                 const manim_quad_t *quad) {
+  dst[0] = quad->x1 * xform->sx + xform->tx;
+  dst[1] = quad->y1 * xform->sy + xform->ty;
+  dst[2] = quad->x2 * xform->sx + xform->tx;
+  dst[3] = quad->y2 * xform->sy + xform->ty;
+  dst[4] = quad->x3 * xform->sx + xform->tx;
+  dst[5] = quad->y3 * xform->sy + xform->ty;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: the vector path matches the reference bit for bit
+   ------------------------------------------------------------------------ */
+static void xform_test_match(void) {
+  printf("[match] %d lanes\n", MANIM_XFORM_LANES);
+
+  const manim_xform_t xform = manim_xform_from_header(&xform_test_header);
+  manim_xform_kernel_t kernel;
+  manim_xform_kernel_init(&kernel, &xform);
+
+  enum { MAX_COUNT = 19, COORDS = MANIM_XFORM_QUAD_COORDS };
+  manim_quad_t src[MAX_COUNT];
+  double dst[MAX_COUNT * COORDS], ref[MAX_COUNT * COORDS];
+  uint32_t rng = 1u;
+
+  for (size_t count = 0; count <= MAX_COUNT; ++count) {
+    xform_test_fill(src, count, &rng);
+    for (size_t i = 0; i < count; ++i)
+      xform_test_reference(&xform, &ref[i * COORDS], &src[i]);
+
+    manim_xform_quads(&kernel, dst, src, count);
+    assert(memcmp(dst, ref, sizeof(double) * COORDS * count) == 0);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: manim_xform_vmo lays out starts and quads, the vmo untouched
+   ------------------------------------------------------------------------ */
+static void xform_test_vmo(void) {
+  puts("[vmo]");
+
+  const manim_xform_t xform = manim_xform_from_header(&xform_test_header);
+  manim_xform_kernel_t kernel;
+  manim_xform_kernel_init(&kernel, &xform);
+
+  enum { QUADS = 11, COORDS = MANIM_XFORM_QUAD_COORDS };
+  manim_quad_t quads[QUADS], before[QUADS];
+  uint32_t rng = 3u;
+  xform_test_fill(quads, QUADS, &rng);
+  memcpy(before, quads, sizeof(quads));
+
+  manim_subpath_t subpaths[2] = {
+      {.x = 1.5f, .y = -2.0f, .quad_count = 4, .quads = quads},
+      {.x = -3.25f, .y = 0.5f, .quad_count = QUADS - 4, .quads = quads + 4}};
+  manim_vmo_t vmo = {.subpath_count = 2, .subpaths = subpaths};
+  assert(manim_xform_vmo_coord_count(&vmo) == 2 * 2 + QUADS * COORDS);
+
+  /* an odd start so the alignment of the coordinates is exercised */
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  arena_push(arena, 3);
+  const double *coords = manim_xform_vmo(&kernel, &vmo, arena);
+  assert(coords && (uintptr_t)coords % 8 == 0);
+  assert(memcmp(quads, before, sizeof(quads)) == 0);
+
+  for (uint32_t j = 0; j < vmo.subpath_count; ++j) {
+    const manim_subpath_t *subpath = &subpaths[j];
+    assert(coords[0] == subpath->x * xform.sx + xform.tx);
+    assert(coords[1] == subpath->y * xform.sy + xform.ty);
+    coords += 2;
+    for (uint32_t k = 0; k < subpath->quad_count; ++k) {
+      double ref[COORDS];
+      xform_test_reference(&xform, ref, &subpath->quads[k]);
+      assert(memcmp(coords, ref, sizeof(ref)) == 0);
+      coords += COORDS;
+    }
+  }
+
+  arena_release(arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: mapping version 3 columns lays points out like manim_xform_vmo
+   ------------------------------------------------------------------------ */
+static void xform_test_points(void) {
+  puts("[points]");
+
+  const manim_xform_t xform = manim_xform_from_header(&xform_test_header);
+  manim_xform_kernel_t kernel;
+  manim_xform_kernel_init(&kernel, &xform);
+
+  enum { QUADS = 13 };
+  manim_quad_t quads[QUADS];
+  uint32_t rng = 5u;
+  xform_test_fill(quads, QUADS, &rng);
+
+  manim_subpath_t subpath = {.x = 0.75f, .y = 3.5f, .quad_count = QUADS,
+                             .quads = quads};
+  manim_vmo_t vmo = {.subpath_count = 1, .subpaths = &subpath};
+
+  /* the columns: the start point, then the three points of every quad */
+  enum { POINTS = 1 + 3 * QUADS };
+  float xs[POINTS], ys[POINTS];
+  xs[0] = subpath.x;
+  ys[0] = subpath.y;
+  for (size_t i = 0; i < QUADS; ++i) {
+    const float quad_xs[3] = {quads[i].x1, quads[i].x2, quads[i].x3};
+    const float quad_ys[3] = {quads[i].y1, quads[i].y2, quads[i].y3};
+    memcpy(&xs[1 + 3 * i], quad_xs, sizeof(quad_xs));
+    memcpy(&ys[1 + 3 * i], quad_ys, sizeof(quad_ys));
+  }
+
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  const double *ref = manim_xform_vmo(&kernel, &vmo, arena);
+  assert(ref && manim_xform_vmo_coord_count(&vmo) == 2 * POINTS);
+
+  /* every length, so the vector blocks and the scalar tail are all hit */
+  for (size_t count = 0; count <= POINTS; ++count) {
+    const double *coords = manim_xform_points(&kernel, xs, ys, count, arena);
+    assert(coords && (uintptr_t)coords % 8 == 0);
+    assert(memcmp(coords, ref, sizeof(double) * 2 * count) == 0);
+  }
+
+  arena_release(arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 4: micro-benchmark against the per-quad reference loop
+   ------------------------------------------------------------------------ */
+static void xform_test_perf(size_t count) {
+  printf("[perf] %zu quads x %d passes\n", count, XFORM_TEST_PASSES);
+
+  manim_quad_t *quads = malloc(count * sizeof(manim_quad_t));
+  double *coords = malloc(count * MANIM_XFORM_QUAD_COORDS * sizeof(double));
+  if (!quads || !coords) {
+    fputs("out of memory\n", stderr);
+    exit(EXIT_FAILURE);
+  }
+  uint32_t rng = 1u;
+  xform_test_fill(quads, count, &rng);
+
+  const manim_xform_t xform = manim_xform_from_header(&xform_test_header);
+  manim_xform_kernel_t kernel;
+  manim_xform_kernel_init(&kernel, &xform);
+
+  /* passes write the same output, the nudge keeps them from being merged */
+  static volatile double nudge = 0;
+
+  /* 1) per quad -------------------------------------------------------- */
+  timespec_t t0 = ts_now();
+  for (int pass = 0; pass < XFORM_TEST_PASSES; ++pass) {
+    manim_xform_t pass_xform = xform;
+    pass_xform.tx += nudge;
+    for (size_t i = 0; i < count; ++i)
+      xform_test_reference(&pass_xform, &coords[i * MANIM_XFORM_QUAD_COORDS],
+                           &quads[i]);
+  }
+  timespec_t t1 = ts_now();
+
+  /* 2) manim_xform_quads ----------------------------------------------- */
+  for (int pass = 0; pass < XFORM_TEST_PASSES; ++pass) {
+    kernel.tx = xform.tx + nudge;
+    manim_xform_quads(&kernel, coords, quads, count);
+  }
+  timespec_t t2 = ts_now();
+
+  const double total = (double)count * XFORM_TEST_PASSES;
+  const double s_ref = ts_elapsed_sec(t0, t1);
+  const double s_bulk = ts_elapsed_sec(t1, t2);
+  printf("  per quad         : %.1f Mquads/s  (%.2f ns/quad)\n",
+         total / s_ref / 1e6, s_ref * 1e9 / total);
+  printf("  manim_xform_quads: %.1f Mquads/s  (%.2f ns/quad)\n",
+         total / s_bulk / 1e6, s_bulk * 1e9 / total);
+
+  free(coords);
+  free(quads);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   XFORM_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void xform_tests_run_all(void) {
+  xform_test_match();
+  xform_test_vmo();
+  xform_test_points();
+  xform_test_perf(XFORM_TEST_QUADS);
+  puts("all xform tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef XFORM_TEST_MAIN
+int main(void) {
+  xform_tests_run_all();
+  return 0;
+}
+#endif /* XFORM_TEST_MAIN */
+
+#endif /* XFORM_TEST_H */
@@ -1,6 +1,47 @@
 #ifndef GEN_IR_H
 #define GEN_IR_H
 #include "common/core.h"
+#include "ctrs/intern.h"
 #include "ir/ir.h"
+#include "ir/ir_path.h"
+
+/**
+ * @brief State of IR generation carried from one frame to the next. Scratch
+ * space is cleared after every frame and path data after the frame following
+ * it, so both are bounded by the largest frames.
+ */
+typedef struct gen_ir_t {
+  arena_t *ir_arena;
+  arena_t *scratch_arena;
+  /** Token pairs of the path being generated **/
+  arena_t *token_arena;
+  /**
+   * Attribute values of every frame so far that are kept as text, the
+   * string_id of an ir_value_t.
+   */
+  intern_pool_t *values;
+  /** Parsed path data of the current frame, the path_id of an ir_value_t **/
+  ir_path_store_t *paths;
+  /** Parsed path data of the frame before, its values' path_ids stay valid
+   * for one more frame to be compared against **/
+  ir_path_store_t *last_paths;
+  size_t num_frames;
+} gen_ir_t;
+
+/**
+ * @param gen State to initialize.
+ * @param ir_arena Arena the ir ops of every frame are appended to.
+ */
+SvgAnimStatus gen_ir_init(gen_ir_t *gen, arena_t *ir_arena);
+void gen_ir_release(gen_ir_t *gen);
+
+/**
+ * @brief Generates the ir ops of the next frame.
+ *
+ * @param svg Tagged svg document of the frame, only read during the call.
+ * @param length Length in bytes of svg.
+ */
+SvgAnimStatus gen_ir_frame(gen_ir_t *gen, const char *svg, size_t length);
+
 SvgAnimStatus gen_ir_driver(arena_t *ir_arena, const svg_frames_t *svg_frames, ir_op_frames_t **ir_op_frames);
 #endif // GEN_IR_H
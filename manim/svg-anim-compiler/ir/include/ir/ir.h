@@ -25,8 +25,10 @@ range
 SET_ATTR_LIST             (attrId, valueId, nIds, elementId[ nIds ])
                           - Same attr/value applied to an arbitrary element list
 
-REWRITE_PATH              (elementId, pathLiteralId)
+REWRITE_PATH              (elementId, pathId)
                           - Replace the path’s ‘d’ data
+                          - pathId: a binary path (command bytes + f32
+                            coordinates), written as text only on emit
 
 SET_TRANSFORM             (elementId, m00,m01,m02, m10,m11,m12)
                           - Overwrite full transform matrix
@@ -77,68 +79,162 @@ NOP_FRAME                 (none)
 
 typedef enum shape_type_e { PATH, CIRCLE, ELLIPSE, RECT } shape_type_e;
 
+/**
+ * @brief How the value of an attribute is to be read
+ */
+typedef enum attribute_value_kind_e {
+  ATTR_VALUE_STRING,  // kept as written
+  ATTR_VALUE_NUMBER,  // a number, opacities, widths, offsets
+  ATTR_VALUE_COLOR,   // a paint, color, none or url(#id)
+  ATTR_VALUE_KEYWORD, // one of a fixed set of keywords
+  ATTR_VALUE_PATH,    // path data
+  ATTR_VALUE_TAG      // the emitter's data-tag, identifies the element
+} attribute_value_kind_e;
+
+/**
+ * X-macro of every attribute the ir knows, X(enum, svg name, value kind).
+ * attribute_type_e and the tables of ir_attr.h are generated from it.
+ */
+#define IR_ATTRIBUTES(X)                                                              \
+  X(ALIGNMENT_BASELINE,           "alignment-baseline",           ATTR_VALUE_KEYWORD) \
+  X(WRITING_MODE,                 "writing-mode",                 ATTR_VALUE_KEYWORD) \
+  X(CLIP,                         "clip",                         ATTR_VALUE_STRING)  \
+  X(CLIP_PATH,                    "clip-path",                    ATTR_VALUE_STRING)  \
+  X(CLIP_RULE,                    "clip-rule",                    ATTR_VALUE_KEYWORD) \
+  X(COLOR,                        "color",                        ATTR_VALUE_COLOR)   \
+  X(COLOR_INTERPOLATION,          "color-interpolation",          ATTR_VALUE_KEYWORD) \
+  X(COLOR_INTERPOLATION_FILTERS,  "color-interpolation-filters",  ATTR_VALUE_KEYWORD) \
+  X(COLOR_RENDERING,              "color-rendering",              ATTR_VALUE_KEYWORD) \
+  X(CURSOR,                       "cursor",                       ATTR_VALUE_STRING)  \
+  X(DIRECTION,                    "direction",                    ATTR_VALUE_KEYWORD) \
+  X(DISPLAY,                      "display",                      ATTR_VALUE_KEYWORD) \
+  X(DOMINANT_BASELINE,            "dominant-baseline",            ATTR_VALUE_KEYWORD) \
+  X(FILL,                         "fill",                         ATTR_VALUE_COLOR)   \
+  X(FILL_OPACITY,                 "fill-opacity",                 ATTR_VALUE_NUMBER)  \
+  X(FILL_RULE,                    "fill-rule",                    ATTR_VALUE_KEYWORD) \
+  X(FILTER,                       "filter",                       ATTR_VALUE_STRING)  \
+  X(FLOOD_COLOR,                  "flood-color",                  ATTR_VALUE_COLOR)   \
+  X(FLOOD_OPACITY,                "flood-opacity",                ATTR_VALUE_NUMBER)  \
+  X(FONT_FAMILY,                  "font-family",                  ATTR_VALUE_STRING)  \
+  X(FONT_SIZE,                    "font-size",                    ATTR_VALUE_NUMBER)  \
+  X(FONT_SIZE_ADJUST,             "font-size-adjust",             ATTR_VALUE_NUMBER)  \
+  X(FONT_STRETCH,                 "font-stretch",                 ATTR_VALUE_KEYWORD) \
+  X(FONT_STYLE,                   "font-style",                   ATTR_VALUE_KEYWORD) \
+  X(FONT_VARIANT,                 "font-variant",                 ATTR_VALUE_KEYWORD) \
+  X(FONT_WEIGHT,                  "font-weight",                  ATTR_VALUE_KEYWORD) \
+  X(GLYPH_ORIENTATION_HORIZONTAL, "glyph-orientation-horizontal", ATTR_VALUE_STRING)  \
+  X(GLYPH_ORIENTATION_VERTICAL,   "glyph-orientation-vertical",   ATTR_VALUE_STRING)  \
+  X(IMAGE_RENDERING,              "image-rendering",              ATTR_VALUE_KEYWORD) \
+  X(BASELINE_SHIFT,               "baseline-shift",               ATTR_VALUE_STRING)  \
+  X(LIGHTING_COLOR,               "lighting-color",               ATTR_VALUE_COLOR)   \
+  X(MARKER_END,                   "marker-end",                   ATTR_VALUE_STRING)  \
+  X(MARKER_MID,                   "marker-mid",                   ATTR_VALUE_STRING)  \
+  X(MARKER_START,                 "marker-start",                 ATTR_VALUE_STRING)  \
+  X(MASK,                         "mask",                         ATTR_VALUE_STRING)  \
+  X(OPACITY,                      "opacity",                      ATTR_VALUE_NUMBER)  \
+  X(OVERFLOW,                     "overflow",                     ATTR_VALUE_KEYWORD) \
+  X(PAINT_ORDER,                  "paint-order",                  ATTR_VALUE_STRING)  \
+  X(POINTER_EVENTS,               "pointer-events",               ATTR_VALUE_KEYWORD) \
+  X(SHAPE_RENDERING,              "shape-rendering",              ATTR_VALUE_KEYWORD) \
+  X(STOP_COLOR,                   "stop-color",                   ATTR_VALUE_COLOR)   \
+  X(STOP_OPACITY,                 "stop-opacity",                 ATTR_VALUE_NUMBER)  \
+  X(STROKE,                       "stroke",                       ATTR_VALUE_COLOR)   \
+  X(STROKE_DASHARRAY,             "stroke-dasharray",             ATTR_VALUE_STRING)  \
+  X(STROKE_DASHOFFSET,            "stroke-dashoffset",            ATTR_VALUE_NUMBER)  \
+  X(STROKE_LINECAP,               "stroke-linecap",               ATTR_VALUE_KEYWORD) \
+  X(STROKE_LINEJOIN,              "stroke-linejoin",              ATTR_VALUE_KEYWORD) \
+  X(STROKE_MITERLIMIT,            "stroke-miterlimit",            ATTR_VALUE_NUMBER)  \
+  X(STROKE_OPACITY,               "stroke-opacity",               ATTR_VALUE_NUMBER)  \
+  X(STROKE_WIDTH,                 "stroke-width",                 ATTR_VALUE_NUMBER)  \
+  X(TEXT_ANCHOR,                  "text-anchor",                  ATTR_VALUE_KEYWORD) \
+  X(TEXT_DECORATION,              "text-decoration",              ATTR_VALUE_STRING)  \
+  X(TEXT_RENDERING,               "text-rendering",               ATTR_VALUE_KEYWORD) \
+  X(TRANSFORM,                    "transform",                    ATTR_VALUE_STRING)  \
+  X(UNICODE_BIDI,                 "unicode-bidi",                 ATTR_VALUE_KEYWORD) \
+  X(VECTOR_EFFECT,                "vector-effect",                ATTR_VALUE_KEYWORD) \
+  X(VISIBILITY,                   "visibility",                   ATTR_VALUE_KEYWORD) \
+  X(WORD_SPACING,                 "word-spacing",                 ATTR_VALUE_NUMBER)  \
+  X(LETTER_SPACING,               "letter-spacing",               ATTR_VALUE_NUMBER)  \
+  X(PATH_DATA,                    "d",                            ATTR_VALUE_PATH)    \
+  X(DATA_TAG,                     "data-tag",                     ATTR_VALUE_TAG)
+
 typedef enum attribute_type_e {
-    ALIGNMENT_BASELINE,
-    WRITING_MODE,
-    CLIP,
-    CLIP_PATH,
-    CLIP_RULE,
-    COLOR,
-    COLOR_INTERPOLATION,
-    COLOR_INTERPOLATION_FILTERS,
-    COLOR_RENDERING,
-    CURSOR,
-    DIRECTION,
-    DISPLAY,
-    DOMINANT_BASELINE,
-    FILL,
-    FILL_OPACITY,
-    FILL_RULE,
-    FILTER,
-    FLOOD_COLOR,
-    FLOOD_OPACITY,
-    FONT_FAMILY,
-    FONT_SIZE,
-    FONT_SIZE_ADJUST,
-    FONT_STRETCH,
-    FONT_STYLE,
-    FONT_VARIANT,
-    FONT_WEIGHT,
-    GLYPH_ORIENTATION_HORIZONTAL,
-    GLYPH_ORIENTATION_VERTICAL,
-    IMAGE_RENDERING,
-    BASELINE_SHIFT,
-    LIGHTING_COLOR,
-    MARKER_END,
-    MARKER_MID,
-    MARKER_START,
-    MASK,
-    OPACITY,
-    OVERFLOW,
-    PAINT_ORDER,
-    POINTER_EVENTS,
-    SHAPE_RENDERING,
-    STOP_COLOR,
-    STOP_OPACITY,
-    STROKE,
-    STROKE_DASHARRAY,
-    STROKE_DASHOFFSET,
-    STROKE_LINECAP,
-    STROKE_LINEJOIN,
-    STROKE_MITERLIMIT,
-    STROKE_OPACITY,
-    STROKE_WIDTH,
-    TEXT_ANCHOR,
-    TEXT_DECORATION,
-    TEXT_RENDERING,
-    TRANSFORM,
-    UNICODE_BIDI,
-    VECTOR_EFFECT,
-    VISIBILITY,
-    WORD_SPACING,
-    LETTER_SPACING
+#define IR_ATTRIBUTE_ENUM(type, name, kind) type,
+  IR_ATTRIBUTES(IR_ATTRIBUTE_ENUM)
+#undef IR_ATTRIBUTE_ENUM
+  NUM_ATTRIBUTE_TYPES
 } attribute_type_e;
 
+/**
+ * X-macro of the keywords of ATTR_VALUE_KEYWORD attributes (and "none" of
+ * ATTR_VALUE_COLOR ones), X(enum, svg spelling).
+ */
+#define IR_KEYWORDS(X)                                 \
+  X(KEYWORD_NONE,                "none")               \
+  X(KEYWORD_INHERIT,             "inherit")            \
+  X(KEYWORD_AUTO,                "auto")               \
+  X(KEYWORD_NORMAL,              "normal")             \
+  X(KEYWORD_NONZERO,             "nonzero")            \
+  X(KEYWORD_EVENODD,             "evenodd")            \
+  X(KEYWORD_BUTT,                "butt")               \
+  X(KEYWORD_ROUND,               "round")              \
+  X(KEYWORD_SQUARE,              "square")             \
+  X(KEYWORD_MITER,               "miter")              \
+  X(KEYWORD_MITER_CLIP,          "miter-clip")         \
+  X(KEYWORD_ARCS,                "arcs")               \
+  X(KEYWORD_BEVEL,               "bevel")              \
+  X(KEYWORD_VISIBLE,             "visible")            \
+  X(KEYWORD_HIDDEN,              "hidden")             \
+  X(KEYWORD_COLLAPSE,            "collapse")           \
+  X(KEYWORD_INLINE,              "inline")             \
+  X(KEYWORD_BLOCK,               "block")              \
+  X(KEYWORD_BOLD,                "bold")               \
+  X(KEYWORD_BOLDER,              "bolder")             \
+  X(KEYWORD_LIGHTER,             "lighter")            \
+  X(KEYWORD_ITALIC,              "italic")             \
+  X(KEYWORD_OBLIQUE,             "oblique")            \
+  X(KEYWORD_START,               "start")              \
+  X(KEYWORD_MIDDLE,              "middle")             \
+  X(KEYWORD_END,                 "end")                \
+  X(KEYWORD_OPTIMIZE_SPEED,      "optimizeSpeed")      \
+  X(KEYWORD_OPTIMIZE_QUALITY,    "optimizeQuality")    \
+  X(KEYWORD_CRISP_EDGES,         "crispEdges")         \
+  X(KEYWORD_GEOMETRIC_PRECISION, "geometricPrecision") \
+  X(KEYWORD_OPTIMIZE_LEGIBILITY, "optimizeLegibility") \
+  X(KEYWORD_NON_SCALING_STROKE,  "non-scaling-stroke") \
+  X(KEYWORD_S_RGB,               "sRGB")               \
+  X(KEYWORD_LINEAR_RGB,          "linearRGB")
+
+typedef enum ir_keyword_e {
+#define IR_KEYWORD_ENUM(keyword, name) keyword,
+  IR_KEYWORDS(IR_KEYWORD_ENUM)
+#undef IR_KEYWORD_ENUM
+  NUM_KEYWORDS
+} ir_keyword_e;
+
+/**
+ * @brief What an ir_value_t holds
+ */
+typedef enum ir_value_type_e {
+  IR_VALUE_STRING,  // string_id, the text in gen_ir_t values
+  IR_VALUE_NUMBER,  // number
+  IR_VALUE_COLOR,   // rgba, packed by IR_RGBA
+  IR_VALUE_KEYWORD, // keyword
+  IR_VALUE_PATH     // path_id, parsed into the frame's gen_ir_t paths
+} ir_value_type_e;
+
+typedef struct ir_value_t {
+  ir_value_type_e type;
+  __extension__ union {
+    uint32_t string_id;
+    float number;
+    uint32_t rgba;
+    ir_keyword_e keyword;
+    /** Id in the path store of the frame the value was read in **/
+    uint32_t path_id;
+  };
+} ir_value_t;
+
 typedef enum ir_opcode_e {
   IR_OP_INS,
   IR_OP_DEL,
@@ -157,7 +253,7 @@ typedef struct ir_op_del_t {
 typedef struct ir_op_set_attr_t {
   uint32_t element_id;
   attribute_type_e attribute_type;
-  char *attribute_value_str;
+  ir_value_t value;
 } ir_op_set_attr_t;
 
 typedef struct {
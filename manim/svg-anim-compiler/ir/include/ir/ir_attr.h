@@ -0,0 +1,93 @@
+#ifndef IR_ATTR_H
+#define IR_ATTR_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ir/ir.h"
+
+/**
+ * ===================================
+ *          ATTRIBUTE TABLE
+ * ===================================
+ */
+
+/**
+ * Name and value kind of every attribute_type_e, generated from
+ * IR_ATTRIBUTES, and the lookup from an svg attribute name to its type.
+ *
+ * The lookup is a perfect hash: the first and last 8 bytes of the name and
+ * its length are folded into one word, multiplied by a seed and the top
+ * IR_ATTR_HASH_BITS bits pick a slot. The seed is chosen so that no two
+ * names share a slot, a lookup is then one multiply, one table load and a
+ * compare of the same words to reject names that are not attributes.
+ *
+ * The seed and slot table are constants in ir_attr.c. attr_test.h checks
+ * them against IR_ATTRIBUTES and prints new ones when an attribute is added.
+ */
+
+#define IR_ATTR_HASH_BITS 9
+#define IR_ATTR_HASH_SLOTS (1u << IR_ATTR_HASH_BITS)
+
+/** Longest name, longer keys are rejected before hashing **/
+#define IR_ATTR_MAX_NAME_LENGTH 32
+
+/**
+ * Up to 16 bytes of the name, its first and last 8. Together with the length
+ * they are the whole name for names of up to 16 bytes.
+ */
+static inline void ir_attribute_words(const char *name, const size_t length,
+                                      uint64_t *head, uint64_t *tail) {
+  *head = 0;
+  *tail = 0;
+  if (length >= 8) {
+    memcpy(head, name, 8);
+    memcpy(tail, name + length - 8, 8);
+  } else if (length >= 4) {
+    uint32_t h, t;
+    memcpy(&h, name, 4);
+    memcpy(&t, name + length - 4, 4);
+    *head = h;
+    *tail = t;
+  } else if (length > 0) {
+    *head = (uint64_t)(uint8_t)name[0] |
+            (uint64_t)(uint8_t)name[length / 2] << 8 |
+            (uint64_t)(uint8_t)name[length - 1] << 16;
+  }
+}
+
+static inline uint64_t ir_attribute_fold(const uint64_t head,
+                                         const uint64_t tail,
+                                         const size_t length) {
+  return (head ^ length) * 0x9fb21c651e98df25ULL ^ tail;
+}
+
+static inline size_t ir_attribute_slot(const uint64_t fold,
+                                       const uint64_t seed) {
+  return (size_t)((fold * seed) >> (64 - IR_ATTR_HASH_BITS));
+}
+
+/** @return The seed the slot table was generated with **/
+uint64_t ir_attribute_hash_seed(void);
+
+/** @return type + 1 of the name hashing to each slot, 0 if none does **/
+const uint8_t *ir_attribute_hash_slots(void);
+
+/**
+ * @brief Finds the attribute named name[0..length).
+ *
+ * @param name Not NUL terminated, e.g. a token key within the svg.
+ * @return true and its type in out_type, false if name is not an attribute.
+ */
+bool ir_attribute_lookup(const char *name, size_t length,
+                         attribute_type_e *out_type);
+
+/** @return The svg name of type, NUL terminated **/
+const char *ir_attribute_name(attribute_type_e type);
+
+size_t ir_attribute_name_length(attribute_type_e type);
+
+attribute_value_kind_e ir_attribute_value_kind(attribute_type_e type);
+
+#endif // IR_ATTR_H
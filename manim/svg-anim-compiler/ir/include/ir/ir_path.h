@@ -0,0 +1,114 @@
+#ifndef IR_PATH_H
+#define IR_PATH_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/arena.h"
+#include "common/core.h"
+
+/**
+ * ===================================
+ *          BINARY PATHS
+ * ===================================
+ */
+
+/**
+ * Path data is parsed once into a command byte stream and an array of f32
+ * coordinates, so passes over geometry (diffing, fitting, instancing,
+ * simplification) work on numbers and text is only written back at emit time.
+ *
+ * Every command is made absolute on parsing: relative commands are resolved
+ * against the current point, H and V become lines, and S and T become curves
+ * with their reflected control point written out. Two paths with the same
+ * geometry therefore have the same commands and coordinates however they
+ * were spelled.
+ */
+
+typedef enum ir_path_command_e {
+  IR_PATH_MOVE,  // x y
+  IR_PATH_LINE,  // x y
+  IR_PATH_CUBIC, // x1 y1 x2 y2 x y
+  IR_PATH_QUAD,  // x1 y1 x y
+  IR_PATH_ARC,   // rx ry rotation large-arc sweep x y, flags as 0 or 1
+  IR_PATH_CLOSE, // none
+  NUM_IR_PATH_COMMANDS
+} ir_path_command_e;
+
+/** Most decimal places ir_path_write keeps **/
+#define IR_PATH_MAX_DECIMALS 9
+
+typedef struct ir_path_t {
+  uint32_t num_commands;
+  uint32_t num_coords;
+  /** ir_path_command_e per command **/
+  const uint8_t *commands;
+  /** ir_path_command_arity(command) coordinates per command, in order **/
+  const float *coords;
+} ir_path_t;
+
+/** @return The coordinates command takes from the coordinate array **/
+uint32_t ir_path_command_arity(ir_path_command_e command);
+
+/**
+ * @brief Parses the path data d[0..length) into arena. An empty d is an
+ * empty path.
+ *
+ * @return SVG_ANIM_STATUS_MALFORMED_SVG if d is not path data,
+ * SVG_ANIM_STATUS_NO_MEMORY if the arena is full. The arena is left as it
+ * was on failure.
+ */
+SvgAnimStatus ir_path_parse(arena_t *arena, const char *d, size_t length,
+                            ir_path_t *out_path);
+
+/**
+ * @brief Writes path back as path data, e.g. "M 1 2 L 3.5 4 Z", coordinates
+ * rounded to decimals places (at most IR_PATH_MAX_DECIMALS) with trailing
+ * zeros dropped.
+ *
+ * @return The NUL terminated text in arena, or NULL if the arena is full.
+ */
+char *ir_path_write(arena_t *arena, const ir_path_t *path, uint32_t decimals,
+                    size_t *out_length);
+
+/**
+ * @brief Equality of geometry: the same commands, every coordinate within
+ * tolerance of the other path's. Arc flags are coordinates too, so a
+ * tolerance below 1 keeps them exact.
+ */
+bool ir_path_equal(const ir_path_t *a, const ir_path_t *b, float tolerance);
+
+/**
+ * @brief Paths of a frame, indexed by dense ids
+ */
+typedef struct ir_path_store_t {
+  uint32_t count;
+  /** Commands and coordinates of every path **/
+  arena_t *data_arena;
+  /** ir_path_t per id **/
+  arena_t *path_arena;
+} ir_path_store_t;
+
+/**
+ * @return The store, or NULL if memory ran out.
+ */
+ir_path_store_t *ir_path_store_create(void);
+
+void ir_path_store_destroy(ir_path_store_t *store);
+
+/**
+ * @brief Parses d[0..length) as the next path of the store.
+ *
+ * @return As ir_path_parse.
+ */
+SvgAnimStatus ir_path_store_put(ir_path_store_t *store, const char *d,
+                                size_t length, uint32_t *out_id);
+
+/**
+ * @return The path of id, valid until the store is cleared or destroyed.
+ */
+const ir_path_t *ir_path_store_get(const ir_path_store_t *store, uint32_t id);
+
+void ir_path_store_clear(ir_path_store_t *store);
+
+#endif // IR_PATH_H
@@ -0,0 +1,88 @@
+#ifndef IR_VALUE_H
+#define IR_VALUE_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common/core.h"
+#include "ctrs/intern.h"
+#include "ir/ir.h"
+#include "ir/ir_path.h"
+
+/**
+ * ===================================
+ *          TYPED VALUES
+ * ===================================
+ */
+
+/**
+ * Attribute values are parsed once, as their attribute's value kind says,
+ * right after the path is tokenized. Later passes compare and fit numbers
+ * and colors without going back to text. A value that does not parse as its
+ * kind (a length with a unit, a url() paint, a keyword the ir does not know)
+ * is kept as an interned string, so nothing is lost.
+ */
+
+/** Packed RGBA, 8 bits per channel, red in the top byte **/
+#define IR_RGBA(r, g, b, a)                                                    \
+  ((uint32_t)(r) << 24 | (uint32_t)(g) << 16 | (uint32_t)(b) << 8 |           \
+   (uint32_t)(a))
+
+/**
+ * @brief Reads the number at text[*pos..length), e.g. "-1.25e3", and leaves
+ * *pos after it. Nothing around it is skipped, so "1.5.5" reads as 1.5 and
+ * leaves *pos at the second '.', as path data wants it.
+ *
+ * @return false, with *pos unchanged, if no number starts at *pos.
+ */
+bool ir_scan_number(const char *text, size_t length, size_t *pos,
+                    double *out_number);
+
+/**
+ * @brief Parses a number, e.g. "-1.25e3". Spaces around it are allowed, a
+ * unit is not.
+ *
+ * @return false if text is not a number or is out of range of a float.
+ */
+bool ir_parse_number(const char *text, size_t length, float *out_number);
+
+/**
+ * @brief Parses "rgb(r, g, b)" with channels as 0-255 or as percentages, as
+ * cairo writes them, and "#rgb" / "#rrggbb". The result is opaque, opacity
+ * is an attribute of its own.
+ */
+bool ir_parse_color(const char *text, size_t length, uint32_t *out_rgba);
+
+bool ir_keyword_lookup(const char *text, size_t length,
+                       ir_keyword_e *out_keyword);
+
+/** @return The svg spelling of keyword, NUL terminated **/
+const char *ir_keyword_name(ir_keyword_e keyword);
+
+/**
+ * @brief Reads the value of an attribute of the given kind.
+ *
+ * @param strings Pool of values kept as text.
+ * @param paths Store path data is parsed into.
+ * @return SVG_ANIM_STATUS_NO_MEMORY if a pool is full,
+ * SVG_ANIM_STATUS_MALFORMED_SVG if path data does not parse, success
+ * otherwise.
+ */
+SvgAnimStatus ir_value_parse(attribute_value_kind_e kind, const char *text,
+                             size_t length, intern_pool_t *strings,
+                             ir_path_store_t *paths, ir_value_t *out_value);
+
+/**
+ * @brief Equality of two values, numbers and path coordinates within
+ * tolerance of each other. Paths are compared by geometry, so paths from
+ * different frames' stores compare too. Values of different types are never
+ * equal.
+ *
+ * @param a_paths Store a was parsed into, only read if a is a path.
+ * @param b_paths Store b was parsed into, only read if b is a path.
+ */
+bool ir_value_equal(const ir_value_t *a, const ir_path_store_t *a_paths,
+                    const ir_value_t *b, const ir_path_store_t *b_paths,
+                    float tolerance);
+
+#endif // IR_VALUE_H
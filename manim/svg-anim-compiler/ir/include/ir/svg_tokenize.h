@@ -0,0 +1,96 @@
+#ifndef SVG_TOKENIZE_H
+#define SVG_TOKENIZE_H
+#include "common/arena.h"
+#include "common/core.h"
+
+/**
+ * ===================================
+ *          SVG TOKENIZER
+ * ===================================
+ */
+
+/**
+ * Splits the <path> elements of a frame's svg into key="value" pairs without
+ * copying anything, every pair is a pair of offsets into the svg.
+ *
+ * The svg is scanned in blocks of SVG_TOKENIZE_BLOCK bytes. A block is
+ * reduced to a bitmask of its structural bytes '<', '=', '"' and '>' with
+ * vector compares (AVX2, SSE2 or NEON, picked at compile time), and only
+ * those positions are visited. Path data holds none of them, so the bytes of
+ * a "d" value are never looked at one by one.
+ *
+ * Values are double quoted, as cairo writes them. Other elements (<?xml>,
+ * <svg>, </svg>) are skipped.
+ */
+
+#define SVG_TOKENIZE_BLOCK 64
+
+#if defined(__AVX2__)
+#define SVG_TOKENIZE_KERNEL "avx2"
+#elif defined(__SSE2__)
+#define SVG_TOKENIZE_KERNEL "sse2"
+#elif defined(__ARM_NEON)
+#define SVG_TOKENIZE_KERNEL "neon"
+#else
+#define SVG_TOKENIZE_KERNEL "scalar"
+#endif
+
+/**
+ * @brief Descriptor for an token within a blob
+ */
+typedef struct token_pair_record_t {
+  size_t key_length;
+  size_t key_offset;
+  size_t value_length;
+  size_t value_offset;
+} token_pair_record_t;
+
+/**
+ * @brief The attributes of one element, offsets are into blob
+ * @note To read a key, use \n@code token_get_key(buffer, i)@endcode for
+ * convenience
+ */
+typedef struct token_pair_buffer_t {
+  size_t num_pairs;
+  token_pair_record_t *token_pairs;
+  const void *blob;
+
+  /** The whole element, from '<' to '>' **/
+  size_t offset;
+  size_t length;
+} token_pair_buffer_t;
+
+static const void *token_get_key(const token_pair_buffer_t *buffer,
+                                 const size_t i) {
+  return (const unsigned char *)buffer->blob + buffer->token_pairs[i].key_offset;
+}
+
+static const void *token_get_value(const token_pair_buffer_t *buffer,
+                                   const size_t i) {
+  return (const unsigned char *)buffer->blob +
+         buffer->token_pairs[i].value_offset;
+}
+
+/**
+ * @brief Called with each <path> element in order. The buffer is only valid
+ * during the call.
+ */
+typedef SvgAnimStatus (*svg_tokenize_path_fn)(void *ctx,
+                                              const token_pair_buffer_t *path);
+
+/**
+ * @brief Tokenizes every <path> element of svg.
+ *
+ * @param token_arena Holds the token pairs of the current element, rewound to
+ * where it was on return.
+ * @param svg Tagged svg document of a frame.
+ * @param length Length in bytes of svg.
+ * @return The first status other than success returned by on_path,
+ * SVG_ANIM_STATUS_MALFORMED_SVG if a path is cut short or an attribute is not
+ * key="value", SVG_ANIM_STATUS_NO_MEMORY if token_arena is full.
+ */
+SvgAnimStatus svg_tokenize_paths(arena_t *token_arena, const char *svg,
+                                 size_t length, svg_tokenize_path_fn on_path,
+                                 void *ctx);
+
+#endif // SVG_TOKENIZE_H
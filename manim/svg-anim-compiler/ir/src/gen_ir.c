@@ -3,132 +3,121 @@
 #include "common/arena.h"
 #include "common/core.h"
 #include "ctrs/map.h"
+#include "ir/gen_ir.h"
 #include "ir/ir.h"
+#include "ir/ir_attr.h"
+#include "ir/ir_value.h"
+#include "ir/svg_tokenize.h"
 
 #include <stdio.h>
 
-typedef struct range_t {
-  char *start;
-  char *end;
-  size_t length;
-} range_t;
-
-
-/**
- * @brief Descriptor for an token within a blob
- */
-typedef struct token_pair_record_t {
-  size_t key_length;
-  size_t key_offset;
-  size_t value_length;
-  size_t value_offset;
-} token_pair_record_t;
-
-/**
- * @brief Sequence of svgs contained within a blob
- * @note To read an svg, use \n@code svg_get_data(svg_frames, i)@endcode for
- * convenience
- */
-typedef struct token_pair_buffer_t {
-  size_t num_pairs;
-  token_pair_record_t *token_pairs;
-  void *blob;
-} token_pair_buffer_t;
-
-static const void *token_get_key(const token_pair_buffer_t *buffer, const size_t i)
-{
-  return (const unsigned char *)buffer->blob + buffer->token_pairs[i].key_offset;
-}
+/** Generates the ir of one path from its attributes **/
+static SvgAnimStatus gen_path_ir(void *ctx, const token_pair_buffer_t *path) {
+  gen_ir_t *gen = ctx;
+
+  for (size_t i = 0; i < path->num_pairs; ++i) {
+    attribute_type_e attribute_type;
+    if (!ir_attribute_lookup(token_get_key(path, i),
+                             path->token_pairs[i].key_length, &attribute_type))
+      continue; // Not an attribute the ir knows
+
+    // The data-tag identifies the element, it is not set on it
+    const attribute_value_kind_e kind = ir_attribute_value_kind(attribute_type);
+    if (kind == ATTR_VALUE_TAG)
+      continue;
+
+    ir_value_t value;
+    const SvgAnimStatus status =
+        ir_value_parse(kind, token_get_value(path, i),
+                       path->token_pairs[i].value_length, gen->values,
+                       gen->paths, &value);
+    if (status != SVG_ANIM_STATUS_SUCCESS)
+      return status;
+
+    // ir_op_t op = {
+    //   .op        = IR_OP_SET_ATTR,
+    //   .set_attr  = { .element_id = 1234,
+    //                  .attribute_type = attribute_type,
+    //                  .value = value }
+    // };
+  }
 
-static const void *token_get_value(const token_pair_buffer_t *buffer, const size_t i)
-{
-  return (const unsigned char *)buffer->blob + buffer->token_pairs[i].value_offset;
+  return SVG_ANIM_STATUS_SUCCESS;
 }
 
-void tokenize_path(arena_t token_stack_area, char* svg_path, size_t num_tokens) {
-  /** Each token is of the form "x"="y". Termination is at > */
-  
-  
+SvgAnimStatus gen_ir_init(gen_ir_t *gen, arena_t *ir_arena) {
+  gen->ir_arena = ir_arena;
+  gen->scratch_arena = arena_alloc();
+  gen->token_arena = arena_alloc();
+  gen->values = intern_create();
+  gen->paths = ir_path_store_create();
+  gen->last_paths = ir_path_store_create();
+  gen->num_frames = 0;
+  if (!gen->scratch_arena || !gen->token_arena || !gen->values ||
+      !gen->paths || !gen->last_paths) {
+    gen_ir_release(gen);
+    return SVG_ANIM_STATUS_NO_MEMORY;
+  }
+  return SVG_ANIM_STATUS_SUCCESS;
 }
 
-void gen_path_ir(arena_t *token_record_scratch_arena,
-  arena_t *token_blob_scratch_arena,
-  arena_t *ir_arena, char* svg_path, size_t length) {
-
-  // Initialize the token_pair_buffer
-  // token_pair_buffer_t *token_pair_buffer = arena_push_struct(token_blob_scratch_arena, token_pair_buffer_t);
-  
-  
-  // ir_op_t op = {
-  //   .op        = IR_OP_SET_ATTR,
-  //   .set_attr  = { .element_id = 1234,
-  //                  .attribute_type = FILL,
-  //                  .attribute_value_str = "red" }
-  // };
-  
+void gen_ir_release(gen_ir_t *gen) {
+  if (gen->scratch_arena)
+    arena_release(gen->scratch_arena);
+  if (gen->token_arena)
+    arena_release(gen->token_arena);
+  if (gen->values)
+    intern_destroy(gen->values);
+  if (gen->paths)
+    ir_path_store_destroy(gen->paths);
+  if (gen->last_paths)
+    ir_path_store_destroy(gen->last_paths);
+  gen->scratch_arena = NULL;
+  gen->token_arena = NULL;
+  gen->values = NULL;
+  gen->paths = NULL;
+  gen->last_paths = NULL;
 }
 
-SvgAnimStatus gen_ir_driver(arena_t *ir_arena, const svg_frames_t *svg_frames, ir_op_frames_t **ir_op_frames) {
+SvgAnimStatus gen_ir_frame(gen_ir_t *gen, const char *svg_blob,
+                           const size_t length) {
 
   /**
-   * For each frame:
    * - Check if svg path id already present, if not generate 'INS' ops otherwise
    * generate mutate ops.
    */
 
   // map_t data_tag_to_elem_id_map;
 
-  // arena_t *ir_arena = arena_alloc();
-  arena_t *scratch_arena = arena_alloc();
-
-  
-  arena_t *svg_path_scratch_arena = arena_alloc();
-
-  for (size_t i = 0; i < svg_frames->num_frames; i++) {
-
-    svg_record_t svg_record = svg_frames->frames[i];
-    char *svg_blob = (char *)svg_get_data(svg_frames, i);
-    
-    /**
-     * Poor man's svg parser.
-     * Single pass. Find '<' tokens, if the next char is 'p' walk to matching
-     * '>' token. Record length and copy full <path> obj into scratch svg
-     * buffer. Generate ir for this path, then continue.
-     */
-
-    bool tracking = false;
-    size_t curr_path_len = 0; 
-    for (size_t j = 0; j < svg_record.length; j++) {
-      if (tracking) {
-        ++curr_path_len;
-        if (svg_blob[j] == '>') {
-          /** Full path found, gen ir **/
-
-          // Add null byte for convenience
-          char* dest = arena_push(svg_path_scratch_arena, curr_path_len + 1);
-          memcpy(
-            dest,
-            (void*)&svg_blob[j],
-            curr_path_len);
-          
-          dest[curr_path_len] = '\0';
-          curr_path_len += 1;
-          
-            gen_path_ir(scratch_arena, scratch_arena, ir_arena, dest, curr_path_len);
-
-          curr_path_len = 0;
-          tracking = false;
-        }
-      } else {
-        if (j + 1 < svg_record.length) {
-          if (svg_blob[j] == '<' && (svg_blob[j+1] == 'p' || svg_blob[j+1] == 'P')) {
-            ++curr_path_len;
-            tracking = true;
-          }
-        }
-      }
-    }
-  }
+  /** The paths' attributes are read in place, nothing is copied **/
+  const SvgAnimStatus status = svg_tokenize_paths(gen->token_arena, svg_blob,
+                                                  length, gen_path_ir, gen);
+  if (status != SVG_ANIM_STATUS_SUCCESS)
+    return status;
+
+  /** Nothing of the frame's svg outlives it, but its paths are kept for the
+   * next frame to compare against **/
+  arena_clear(gen->scratch_arena);
+  arena_clear(gen->token_arena);
+  ir_path_store_t *paths = gen->last_paths;
+  gen->last_paths = gen->paths;
+  gen->paths = paths;
+  ir_path_store_clear(gen->paths);
+  ++gen->num_frames;
 
   return SVG_ANIM_STATUS_SUCCESS;
 }
+
+SvgAnimStatus gen_ir_driver(arena_t *ir_arena, const svg_frames_t *svg_frames, ir_op_frames_t **ir_op_frames) {
+
+  gen_ir_t gen;
+  SvgAnimStatus status = gen_ir_init(&gen, ir_arena);
+
+  for (size_t i = 0;
+       status == SVG_ANIM_STATUS_SUCCESS && i < svg_frames->num_frames; i++)
+    status = gen_ir_frame(&gen, svg_get_data(svg_frames, i),
+                          svg_frames->frames[i].length);
+
+  gen_ir_release(&gen);
+  return status;
+}
@@ -0,0 +1,109 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ir/ir.h"
+#include "ir/ir_attr.h"
+
+#define IR_ATTRIBUTE_NAME(type, name, kind) name,
+#define IR_ATTRIBUTE_NAME_LENGTH(type, name, kind) sizeof(name) - 1,
+#define IR_ATTRIBUTE_KIND(type, name, kind) kind,
+
+static const char *const attribute_names[NUM_ATTRIBUTE_TYPES] = {
+    IR_ATTRIBUTES(IR_ATTRIBUTE_NAME)};
+
+static const uint8_t attribute_name_lengths[NUM_ATTRIBUTE_TYPES] = {
+    IR_ATTRIBUTES(IR_ATTRIBUTE_NAME_LENGTH)};
+
+static const uint8_t attribute_value_kinds[NUM_ATTRIBUTE_TYPES] = {
+    IR_ATTRIBUTES(IR_ATTRIBUTE_KIND)};
+
+#undef IR_ATTRIBUTE_NAME
+#undef IR_ATTRIBUTE_NAME_LENGTH
+#undef IR_ATTRIBUTE_KIND
+
+/**
+ * Perfect hash of IR_ATTRIBUTES, generated by attr_test.h. Regenerate both
+ * whenever an attribute is added, removed or reordered.
+ */
+#define ATTR_HASH_SEED 0x118e846ea93bc949ULL
+
+_Static_assert(NUM_ATTRIBUTE_TYPES < UINT8_MAX, "slots hold a type in a byte");
+
+/** type + 1 of the name hashing to the slot, 0 if none does **/
+static const uint8_t attr_hash_slots[IR_ATTR_HASH_SLOTS] = {
+    0, 0, 0, 0, 0, 22, 0, 0, 0, 0, 0, 29, 42, 19, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 31, 0, 0, 0, 0,
+    0, 0, 0, 61, 0, 0, 0, 0, 0, 0, 0, 49, 15, 34, 0, 0,
+    0, 59, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 52, 32,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 25, 0, 0, 0, 0,
+    0, 0, 0, 2, 0, 16, 0, 0, 0, 0, 0, 0, 0, 23, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 53, 0, 0, 0, 0, 0, 47, 0, 0, 0, 0, 0,
+    0, 0, 0, 33, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 30, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 46, 0, 0, 58, 11, 18, 0, 0, 0, 0, 0, 0, 14, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 45, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 24, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 17, 0, 0, 48, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 0, 0, 0, 0, 0, 0,
+    0, 35, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 13, 0,
+    0, 0, 0, 0, 0, 0, 0, 27, 0, 60, 0, 0, 0, 0, 0, 12,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 21, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 50, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 51, 0, 38, 0, 0, 0, 0, 0, 0, 0, 6, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 5, 0, 43,
+    0, 0, 0, 44, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0, 0, 0,
+    0, 0, 0, 36, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 28, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 56, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 20, 0, 0, 0, 0, 0, 0, 0, 0, 39,
+    0, 40, 0, 0, 0, 55, 0, 0, 0, 41, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 37, 0,
+    8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 54, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 57, 1, 26, 0, 0, 0, 9, 0,
+};
+
+uint64_t ir_attribute_hash_seed(void) { return ATTR_HASH_SEED; }
+
+const uint8_t *ir_attribute_hash_slots(void) { return attr_hash_slots; }
+
+bool ir_attribute_lookup(const char *name, const size_t length,
+                         attribute_type_e *out_type) {
+  if (length - 1 >= IR_ATTR_MAX_NAME_LENGTH)
+    return false;
+  uint64_t head, tail;
+  ir_attribute_words(name, length, &head, &tail);
+  const uint8_t entry = attr_hash_slots[ir_attribute_slot(
+      ir_attribute_fold(head, tail, length), ATTR_HASH_SEED)];
+  if (!entry)
+    return false;
+  const size_t type = entry - 1u;
+  if (attribute_name_lengths[type] != length)
+    return false;
+  uint64_t type_head, type_tail;
+  ir_attribute_words(attribute_names[type], length, &type_head, &type_tail);
+  if (type_head != head || type_tail != tail)
+    return false;
+  // Below 4 bytes the words hold 3 of them, above 16 they miss the middle
+  if ((length < 4 || length > 16) &&
+      memcmp(attribute_names[type], name, length) != 0)
+    return false;
+  *out_type = (attribute_type_e)type;
+  return true;
+}
+
+const char *ir_attribute_name(const attribute_type_e type) {
+  return attribute_names[type];
+}
+
+size_t ir_attribute_name_length(const attribute_type_e type) {
+  return attribute_name_lengths[type];
+}
+
+attribute_value_kind_e ir_attribute_value_kind(const attribute_type_e type) {
+  return (attribute_value_kind_e)attribute_value_kinds[type];
+}
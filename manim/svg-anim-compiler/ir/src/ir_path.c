@@ -0,0 +1,442 @@
+#include <float.h>
+#include <math.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "common/defs.h"
+#include "ir/ir_path.h"
+#include "ir/ir_value.h"
+
+static const uint8_t path_arity[NUM_IR_PATH_COMMANDS] = {
+    [IR_PATH_MOVE] = 2, [IR_PATH_LINE] = 2, [IR_PATH_CUBIC] = 6,
+    [IR_PATH_QUAD] = 4, [IR_PATH_ARC] = 7,  [IR_PATH_CLOSE] = 0};
+
+static const char path_letters[NUM_IR_PATH_COMMANDS] = {
+    [IR_PATH_MOVE] = 'M', [IR_PATH_LINE] = 'L', [IR_PATH_CUBIC] = 'C',
+    [IR_PATH_QUAD] = 'Q', [IR_PATH_ARC] = 'A',  [IR_PATH_CLOSE] = 'Z'};
+
+/** Longest number path_write_number writes, sign and point included **/
+#define PATH_MAX_NUMBER_LENGTH 32
+
+/** Above this a coordinate scaled to its decimals no longer fits an int64 **/
+#define PATH_MAX_FIXED 9e15
+
+static const uint64_t path_powers_of_ten[IR_PATH_MAX_DECIMALS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+uint32_t ir_path_command_arity(const ir_path_command_e command) {
+  return path_arity[command];
+}
+
+typedef struct path_parser_t {
+  const char *d;
+  size_t length;
+  size_t pos;
+
+  uint8_t *commands;
+  uint32_t num_commands;
+  uint32_t max_commands;
+  float *coords;
+  uint32_t num_coords;
+  uint32_t max_coords;
+} path_parser_t;
+
+static inline bool path_is_space(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+static inline void path_skip_space(path_parser_t *parser) {
+  while (parser->pos < parser->length &&
+         path_is_space(parser->d[parser->pos]))
+    ++parser->pos;
+}
+
+/** Numbers are separated by spaces with at most one comma among them **/
+static inline void path_skip_separator(path_parser_t *parser) {
+  path_skip_space(parser);
+  if (parser->pos < parser->length && parser->d[parser->pos] == ',') {
+    ++parser->pos;
+    path_skip_space(parser);
+  }
+}
+
+static inline bool path_read_number(path_parser_t *parser, double *out) {
+  if (!ir_scan_number(parser->d, parser->length, &parser->pos, out) ||
+      fabs(*out) > FLT_MAX)
+    return false;
+  path_skip_separator(parser);
+  return true;
+}
+
+/** Arc flags are a single 0 or 1, "a1 1 0 011 1" packs both against x **/
+static inline bool path_read_flag(path_parser_t *parser, double *out) {
+  if (parser->pos >= parser->length)
+    return false;
+  const char c = parser->d[parser->pos];
+  if (c != '0' && c != '1')
+    return false;
+  *out = c - '0';
+  ++parser->pos;
+  path_skip_separator(parser);
+  return true;
+}
+
+static bool path_read_numbers(path_parser_t *parser, double *out,
+                              const size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    if (!path_read_number(parser, &out[i]))
+      return false;
+  return true;
+}
+
+static inline bool path_emit(path_parser_t *parser,
+                             const ir_path_command_e command,
+                             const double *coords) {
+  const uint32_t arity = path_arity[command];
+  if (parser->num_commands == parser->max_commands ||
+      parser->max_coords - parser->num_coords < arity)
+    return false;
+  parser->commands[parser->num_commands++] = (uint8_t)command;
+  for (uint32_t i = 0; i < arity; ++i)
+    parser->coords[parser->num_coords++] = (float)coords[i];
+  return true;
+}
+
+static inline bool path_is_command(const char c) {
+  switch (c | 0x20) {
+  case 'm':
+  case 'z':
+  case 'l':
+  case 'h':
+  case 'v':
+  case 'c':
+  case 's':
+  case 'q':
+  case 't':
+  case 'a':
+    return true;
+  default:
+    return false;
+  }
+}
+
+/**
+ * Parses into the parser's arrays. The current point and the previous curve's
+ * last control point are kept in doubles, so long runs of relative commands
+ * do not drift by a float's rounding per command.
+ */
+static bool path_parse(path_parser_t *parser) {
+  double current_x = 0, current_y = 0;
+  double start_x = 0, start_y = 0;
+  // Control point S and T reflect, and which of C or Q left it
+  double control_x = 0, control_y = 0;
+  char control_of = 0;
+  char command = 0;
+
+  for (;;) {
+    path_skip_space(parser);
+    if (parser->pos == parser->length)
+      return true;
+
+    bool explicit_command = false;
+    if (path_is_command(parser->d[parser->pos])) {
+      command = parser->d[parser->pos++];
+      explicit_command = true;
+      path_skip_space(parser);
+    } else if (!command || (command | 0x20) == 'z') {
+      // A number with no command, or after a close, which takes none
+      return false;
+    }
+    const char lower = command | 0x20;
+    // Path data starts with a move, a relative one is taken from the origin
+    if (!parser->num_commands && lower != 'm')
+      return false;
+
+    const double origin_x = command == lower ? current_x : 0;
+    const double origin_y = command == lower ? current_y : 0;
+    double v[7];
+    char next_control_of = 0;
+    switch (lower) {
+    case 'z':
+      if (!path_emit(parser, IR_PATH_CLOSE, NULL))
+        return false;
+      current_x = start_x;
+      current_y = start_y;
+      break;
+    case 'm':
+    case 'l':
+      if (!path_read_numbers(parser, v, 2))
+        return false;
+      v[0] += origin_x;
+      v[1] += origin_y;
+      // Pairs after the first of a move are lines
+      if (lower == 'm' && explicit_command) {
+        if (!path_emit(parser, IR_PATH_MOVE, v))
+          return false;
+        start_x = v[0];
+        start_y = v[1];
+      } else if (!path_emit(parser, IR_PATH_LINE, v)) {
+        return false;
+      }
+      current_x = v[0];
+      current_y = v[1];
+      break;
+    case 'h':
+    case 'v':
+      if (!path_read_number(parser, &v[0]))
+        return false;
+      if (lower == 'h') {
+        v[0] += origin_x;
+        v[1] = current_y;
+      } else {
+        v[1] = v[0] + origin_y;
+        v[0] = current_x;
+      }
+      if (!path_emit(parser, IR_PATH_LINE, v))
+        return false;
+      current_x = v[0];
+      current_y = v[1];
+      break;
+    case 'c':
+    case 's': {
+      // S leaves the first control point out, it mirrors the last one
+      double *read = lower == 'c' ? v : v + 2;
+      if (!path_read_numbers(parser, read, lower == 'c' ? 6 : 4))
+        return false;
+      for (size_t i = lower == 'c' ? 0 : 2; i < 6; i += 2) {
+        v[i] += origin_x;
+        v[i + 1] += origin_y;
+      }
+      if (lower == 's') {
+        v[0] = control_of == 'c' ? 2 * current_x - control_x : current_x;
+        v[1] = control_of == 'c' ? 2 * current_y - control_y : current_y;
+      }
+      if (!path_emit(parser, IR_PATH_CUBIC, v))
+        return false;
+      control_x = v[2];
+      control_y = v[3];
+      next_control_of = 'c';
+      current_x = v[4];
+      current_y = v[5];
+      break;
+    }
+    case 'q':
+    case 't': {
+      double *read = lower == 'q' ? v : v + 2;
+      if (!path_read_numbers(parser, read, lower == 'q' ? 4 : 2))
+        return false;
+      for (size_t i = lower == 'q' ? 0 : 2; i < 4; i += 2) {
+        v[i] += origin_x;
+        v[i + 1] += origin_y;
+      }
+      if (lower == 't') {
+        v[0] = control_of == 'q' ? 2 * current_x - control_x : current_x;
+        v[1] = control_of == 'q' ? 2 * current_y - control_y : current_y;
+      }
+      if (!path_emit(parser, IR_PATH_QUAD, v))
+        return false;
+      control_x = v[0];
+      control_y = v[1];
+      next_control_of = 'q';
+      current_x = v[2];
+      current_y = v[3];
+      break;
+    }
+    case 'a':
+      if (!path_read_numbers(parser, v, 3) || !path_read_flag(parser, &v[3]) ||
+          !path_read_flag(parser, &v[4]) || !path_read_numbers(parser, v + 5, 2))
+        return false;
+      v[5] += origin_x;
+      v[6] += origin_y;
+      if (!path_emit(parser, IR_PATH_ARC, v))
+        return false;
+      current_x = v[5];
+      current_y = v[6];
+      break;
+    }
+    control_of = next_control_of;
+  }
+}
+
+SvgAnimStatus ir_path_parse(arena_t *arena, const char *d, const size_t length,
+                            ir_path_t *out_path) {
+  // Every command takes a byte of d and every number at most two
+  // coordinates, H, V, S and T fill in the ones they leave out
+  if (length > UINT32_MAX / 2)
+    return SVG_ANIM_STATUS_MALFORMED_SVG;
+  const size_t start = arena_get_pos(arena);
+  const size_t padding = ALIGN_UP(start, alignof(float)) - start;
+  const size_t max_coords = 2 * length;
+  uint8_t *block = arena_push(arena, padding + max_coords * sizeof(float) +
+                                         length);
+  if (!block)
+    return SVG_ANIM_STATUS_NO_MEMORY;
+
+  path_parser_t parser = {
+      .d = d,
+      .length = length,
+      .coords = (float *)(block + padding),
+      .max_coords = (uint32_t)max_coords,
+      .commands = block + padding + max_coords * sizeof(float),
+      .max_commands = (uint32_t)length,
+  };
+  if (!path_parse(&parser)) {
+    arena_set_pos_back(arena, start);
+    return SVG_ANIM_STATUS_MALFORMED_SVG;
+  }
+
+  // Keep what was used, the commands right after the coordinates
+  uint8_t *commands = (uint8_t *)(parser.coords + parser.num_coords);
+  memmove(commands, parser.commands, parser.num_commands);
+  arena_set_pos_back(arena, (size_t)(commands + parser.num_commands -
+                                     arena->base));
+
+  out_path->num_commands = parser.num_commands;
+  out_path->num_coords = parser.num_coords;
+  out_path->commands = commands;
+  out_path->coords = parser.coords;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+/**
+ * Writes value rounded to decimals places as fixed point, through integers
+ * so it is exact and quick. Values too large for that go through printf.
+ * @return The number of chars written, at most PATH_MAX_NUMBER_LENGTH.
+ */
+static size_t path_write_number(char *out, const double value,
+                                const uint32_t decimals) {
+  const uint64_t scale = path_powers_of_ten[decimals];
+  const double scaled = value * (double)scale;
+  if (!(fabs(scaled) < PATH_MAX_FIXED))
+    return (size_t)snprintf(out, PATH_MAX_NUMBER_LENGTH, "%.9g", value);
+
+  const int64_t fixed = llround(scaled);
+  if (fixed == 0) {
+    out[0] = '0';
+    return 1;
+  }
+  size_t n = 0;
+  if (fixed < 0)
+    out[n++] = '-';
+  const uint64_t magnitude = fixed < 0 ? -(uint64_t)fixed : (uint64_t)fixed;
+  uint64_t integer = magnitude / scale;
+  uint64_t fraction = magnitude % scale;
+
+  char digits[20];
+  size_t num_digits = 0;
+  do {
+    digits[num_digits++] = (char)('0' + integer % 10);
+    integer /= 10;
+  } while (integer);
+  while (num_digits)
+    out[n++] = digits[--num_digits];
+
+  if (fraction) {
+    uint32_t places = decimals;
+    for (; fraction % 10 == 0; fraction /= 10)
+      --places;
+    out[n++] = '.';
+    for (uint32_t i = places; i > 0; --i) {
+      out[n + i - 1] = (char)('0' + fraction % 10);
+      fraction /= 10;
+    }
+    n += places;
+  }
+  return n;
+}
+
+char *ir_path_write(arena_t *arena, const ir_path_t *path, uint32_t decimals,
+                    size_t *out_length) {
+  if (decimals > IR_PATH_MAX_DECIMALS)
+    decimals = IR_PATH_MAX_DECIMALS;
+  const size_t bound = (size_t)path->num_commands * 2 +
+                       (size_t)path->num_coords * (PATH_MAX_NUMBER_LENGTH + 1) +
+                       1;
+  char *text = arena_push(arena, bound);
+  if (!text)
+    return NULL;
+
+  size_t n = 0;
+  const float *coords = path->coords;
+  for (uint32_t i = 0; i < path->num_commands; ++i) {
+    const ir_path_command_e command = (ir_path_command_e)path->commands[i];
+    if (n)
+      text[n++] = ' ';
+    text[n++] = path_letters[command];
+    for (uint32_t c = 0; c < path_arity[command]; ++c) {
+      text[n++] = ' ';
+      n += path_write_number(text + n, *coords++, decimals);
+    }
+  }
+  text[n] = '\0';
+  arena_pop(arena, bound - (n + 1));
+  if (out_length)
+    *out_length = n;
+  return text;
+}
+
+bool ir_path_equal(const ir_path_t *a, const ir_path_t *b,
+                   const float tolerance) {
+  if (a->num_commands != b->num_commands || a->num_coords != b->num_coords ||
+      memcmp(a->commands, b->commands, a->num_commands) != 0)
+    return false;
+  for (uint32_t i = 0; i < a->num_coords; ++i)
+    if (!(fabsf(a->coords[i] - b->coords[i]) <= tolerance))
+      return false;
+  return true;
+}
+
+ir_path_store_t *ir_path_store_create(void) {
+  ir_path_store_t *store = calloc(1, sizeof(ir_path_store_t));
+  if (!store)
+    return NULL;
+  store->data_arena = arena_alloc();
+  store->path_arena = arena_alloc();
+  if (!store->data_arena || !store->path_arena) {
+    ir_path_store_destroy(store);
+    return NULL;
+  }
+  return store;
+}
+
+void ir_path_store_destroy(ir_path_store_t *store) {
+  if (store->data_arena)
+    arena_release(store->data_arena);
+  if (store->path_arena)
+    arena_release(store->path_arena);
+  free(store);
+}
+
+SvgAnimStatus ir_path_store_put(ir_path_store_t *store, const char *d,
+                                const size_t length, uint32_t *out_id) {
+  if (store->count == UINT32_MAX)
+    return SVG_ANIM_STATUS_NO_MEMORY;
+  ir_path_t *path = arena_push_struct(store->path_arena, ir_path_t);
+  if (!path)
+    return SVG_ANIM_STATUS_NO_MEMORY;
+  const SvgAnimStatus status = ir_path_parse(store->data_arena, d, length, path);
+  if (status != SVG_ANIM_STATUS_SUCCESS) {
+    arena_pop(store->path_arena, sizeof(ir_path_t));
+    return status;
+  }
+  *out_id = store->count++;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+const ir_path_t *ir_path_store_get(const ir_path_store_t *store,
+                                   const uint32_t id) {
+  return (const ir_path_t *)store->path_arena->base + id;
+}
+
+void ir_path_store_clear(ir_path_store_t *store) {
+  arena_clear(store->data_arena);
+  arena_clear(store->path_arena);
+  store->count = 0;
+}
@@ -0,0 +1,347 @@
+#include <float.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/core.h"
+#include "ctrs/intern.h"
+#include "ir/ir.h"
+#include "ir/ir_path.h"
+#include "ir/ir_value.h"
+
+#define IR_KEYWORD_NAME(keyword, name) name,
+#define IR_KEYWORD_NAME_LENGTH(keyword, name) sizeof(name) - 1,
+
+static const char *const keyword_names[NUM_KEYWORDS] = {
+    IR_KEYWORDS(IR_KEYWORD_NAME)};
+
+static const uint8_t keyword_name_lengths[NUM_KEYWORDS] = {
+    IR_KEYWORDS(IR_KEYWORD_NAME_LENGTH)};
+
+#undef IR_KEYWORD_NAME
+#undef IR_KEYWORD_NAME_LENGTH
+
+/** Mantissa digits kept, the rest only move the exponent **/
+#define NUMBER_MAX_DIGITS 19
+
+static const double powers_of_ten[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                       1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                       1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                       1e18, 1e19, 1e20, 1e21, 1e22};
+
+static inline bool value_is_space(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+static inline bool value_is_digit(const char c) { return c >= '0' && c <= '9'; }
+
+static void value_trim(const char **text, size_t *length) {
+  while (*length && value_is_space((*text)[0])) {
+    ++*text;
+    --*length;
+  }
+  while (*length && value_is_space((*text)[*length - 1]))
+    --*length;
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NUMBER_SWAR 1
+
+/**
+ * Number of leading digits among the 8 bytes at text, 0 to 8. A byte counts
+ * as a digit when its high nibble is 3 and adding 6 keeps it there.
+ */
+static inline size_t value_swar_digit_run(const uint64_t word) {
+  const uint64_t high = 0xF0F0F0F0F0F0F0F0ULL;
+  const uint64_t threes = 0x3030303030303030ULL;
+  // A carry out of a byte >= 0xFA only turns the next digit into a miss
+  const uint64_t misses = ((word & high) ^ threes) |
+                          (((word + 0x0606060606060606ULL) & high) ^ threes);
+  if (!misses)
+    return 8;
+  const uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+  const uint64_t flags = (misses | ((misses & low7) + low7)) & ~low7;
+  return (size_t)__builtin_ctzll(flags) >> 3;
+}
+
+/**
+ * Value of the first run digits of word, the rest of the bytes are shifted
+ * out and stand in as leading zeros.
+ */
+static inline uint32_t value_swar_parse(uint64_t word, const size_t run) {
+  word = (word - 0x3030303030303030ULL) << (64 - 8 * run);
+  word = word * 10 + (word >> 8);
+  word = ((word & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)) +
+          ((word >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32))) >>
+         32;
+  return (uint32_t)word;
+}
+
+static const uint32_t swar_powers_of_ten[] = {1,      10,      100,     1000,
+                                              10000,  100000,  1000000,
+                                              10000000, 100000000};
+#endif
+
+/**
+ * Gathers the digits at text[*i..length) into mantissa, up to 19 significant
+ * ones. Where 8 bytes are left they are classified and combined at once.
+ * @return The number of digits read, *dropped of them did not fit.
+ */
+static inline size_t value_read_digits(const char *text, const size_t length,
+                                       size_t *i, uint64_t *mantissa,
+                                       int *digits, size_t *dropped) {
+  const size_t start = *i;
+#ifdef NUMBER_SWAR
+  while (*i + 8 <= length && *digits + 8 <= NUMBER_MAX_DIGITS) {
+    uint64_t word;
+    memcpy(&word, text + *i, 8);
+    const size_t run = value_swar_digit_run(word);
+    if (!run)
+      return *i - start;
+    const uint32_t chunk = value_swar_parse(word, run);
+    *mantissa = *mantissa * swar_powers_of_ten[run] + chunk;
+    // Leading zeros of the chunk may count too, at worst 7 of 19 digits
+    if (*mantissa)
+      *digits += (int)run;
+    *i += run;
+    if (run < 8)
+      return *i - start;
+  }
+#endif
+  for (; *i < length && value_is_digit(text[*i]); ++*i) {
+    if (*digits < NUMBER_MAX_DIGITS) {
+      *mantissa = *mantissa * 10 + (uint64_t)(text[*i] - '0');
+      *digits += *mantissa != 0;
+    } else {
+      ++*dropped;
+    }
+  }
+  return *i - start;
+}
+
+bool ir_scan_number(const char *text, const size_t length, size_t *pos,
+                    double *out) {
+  size_t i = *pos;
+  bool negative = false;
+  if (i < length && (text[i] == '-' || text[i] == '+'))
+    negative = text[i++] == '-';
+
+  uint64_t mantissa = 0;
+  int digits = 0, exponent = 0;
+  size_t dropped = 0;
+  size_t any = value_read_digits(text, length, &i, &mantissa, &digits,
+                                 &dropped);
+  // Integer digits past the mantissa scale it up
+  exponent += (int)(dropped < 1000 ? dropped : 1000);
+  if (i < length && text[i] == '.') {
+    ++i;
+    dropped = 0;
+    const size_t fraction =
+        value_read_digits(text, length, &i, &mantissa, &digits, &dropped);
+    any += fraction;
+    // Fraction digits past the mantissa are ignored, the rest scale it down
+    const size_t kept = fraction - dropped;
+    exponent -= (int)(kept < 1000 ? kept : 1000);
+  }
+  if (!any)
+    return false;
+
+  if (i < length && (text[i] == 'e' || text[i] == 'E')) {
+    size_t j = i + 1;
+    bool exponent_negative = false;
+    if (j < length && (text[j] == '-' || text[j] == '+'))
+      exponent_negative = text[j++] == '-';
+    if (j >= length || !value_is_digit(text[j]))
+      return false;
+    int e = 0;
+    for (; j < length && value_is_digit(text[j]); ++j)
+      if (e < 1000)
+        e = e * 10 + (text[j] - '0');
+    exponent += exponent_negative ? -e : e;
+    i = j;
+  }
+
+  double value = (double)mantissa;
+  if (mantissa != 0) {
+    // Floats end near 1e38 and 1e-45, larger steps only saturate
+    if (exponent < -400)
+      exponent = -400;
+    if (exponent > 400)
+      exponent = 400;
+    for (; exponent > 22; exponent -= 22)
+      value *= powers_of_ten[22];
+    for (; exponent < -22; exponent += 22)
+      value /= powers_of_ten[22];
+    value = exponent >= 0 ? value * powers_of_ten[exponent]
+                          : value / powers_of_ten[-exponent];
+  }
+  *out = negative ? -value : value;
+  *pos = i;
+  return true;
+}
+
+bool ir_parse_number(const char *text, size_t length, float *out_number) {
+  value_trim(&text, &length);
+  size_t pos = 0;
+  double value;
+  if (!ir_scan_number(text, length, &pos, &value) || pos != length ||
+      fabs(value) > FLT_MAX)
+    return false;
+  *out_number = (float)value;
+  return true;
+}
+
+static inline int value_hex_digit(const char c) {
+  if (value_is_digit(c))
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+static bool value_parse_hex_color(const char *text, const size_t length,
+                                  uint32_t *out_rgba) {
+  if (length != 4 && length != 7)
+    return false;
+  int channels[3];
+  for (size_t c = 0; c < 3; ++c) {
+    if (length == 4) {
+      const int digit = value_hex_digit(text[1 + c]);
+      if (digit < 0)
+        return false;
+      channels[c] = digit * 17;
+    } else {
+      const int high = value_hex_digit(text[1 + 2 * c]);
+      const int low = value_hex_digit(text[2 + 2 * c]);
+      if (high < 0 || low < 0)
+        return false;
+      channels[c] = high * 16 + low;
+    }
+  }
+  *out_rgba = IR_RGBA(channels[0], channels[1], channels[2], 255);
+  return true;
+}
+
+bool ir_parse_color(const char *text, size_t length, uint32_t *out_rgba) {
+  value_trim(&text, &length);
+  if (length && text[0] == '#')
+    return value_parse_hex_color(text, length, out_rgba);
+  if (length < 4 || memcmp(text, "rgb(", 4) != 0)
+    return false;
+
+  int channels[3];
+  size_t pos = 4;
+  for (size_t c = 0; c < 3; ++c) {
+    while (pos < length && value_is_space(text[pos]))
+      ++pos;
+    double value;
+    if (!ir_scan_number(text, length, &pos, &value))
+      return false;
+    if (pos < length && text[pos] == '%') {
+      value *= 255.0 / 100.0;
+      ++pos;
+    }
+    value = value < 0 ? 0 : value > 255 ? 255 : value;
+    channels[c] = (int)(value + 0.5);
+
+    while (pos < length && value_is_space(text[pos]))
+      ++pos;
+    if (pos >= length || text[pos] != (c < 2 ? ',' : ')'))
+      return false;
+    ++pos;
+  }
+  if (pos != length)
+    return false;
+  *out_rgba = IR_RGBA(channels[0], channels[1], channels[2], 255);
+  return true;
+}
+
+bool ir_keyword_lookup(const char *text, size_t length,
+                       ir_keyword_e *out_keyword) {
+  value_trim(&text, &length);
+  // A handful of short words, the length check rejects most of them
+  for (size_t keyword = 0; keyword < NUM_KEYWORDS; ++keyword) {
+    if (keyword_name_lengths[keyword] == length &&
+        memcmp(keyword_names[keyword], text, length) == 0) {
+      *out_keyword = (ir_keyword_e)keyword;
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *ir_keyword_name(const ir_keyword_e keyword) {
+  return keyword_names[keyword];
+}
+
+SvgAnimStatus ir_value_parse(const attribute_value_kind_e kind,
+                             const char *text, const size_t length,
+                             intern_pool_t *strings, ir_path_store_t *paths,
+                             ir_value_t *out_value) {
+  switch (kind) {
+  case ATTR_VALUE_NUMBER:
+    if (ir_parse_number(text, length, &out_value->number)) {
+      out_value->type = IR_VALUE_NUMBER;
+      return SVG_ANIM_STATUS_SUCCESS;
+    }
+    break;
+  case ATTR_VALUE_COLOR:
+    if (ir_parse_color(text, length, &out_value->rgba)) {
+      out_value->type = IR_VALUE_COLOR;
+      return SVG_ANIM_STATUS_SUCCESS;
+    }
+    // none, a paint that is not a color
+    if (ir_keyword_lookup(text, length, &out_value->keyword)) {
+      out_value->type = IR_VALUE_KEYWORD;
+      return SVG_ANIM_STATUS_SUCCESS;
+    }
+    break;
+  case ATTR_VALUE_KEYWORD:
+    if (ir_keyword_lookup(text, length, &out_value->keyword)) {
+      out_value->type = IR_VALUE_KEYWORD;
+      return SVG_ANIM_STATUS_SUCCESS;
+    }
+    break;
+  case ATTR_VALUE_PATH: {
+    const SvgAnimStatus status =
+        ir_path_store_put(paths, text, length, &out_value->path_id);
+    if (status != SVG_ANIM_STATUS_SUCCESS)
+      return status;
+    out_value->type = IR_VALUE_PATH;
+    return SVG_ANIM_STATUS_SUCCESS;
+  }
+  case ATTR_VALUE_STRING:
+  case ATTR_VALUE_TAG:
+    break;
+  }
+
+  out_value->type = IR_VALUE_STRING;
+  return intern_put(strings, text, length, &out_value->string_id)
+             ? SVG_ANIM_STATUS_SUCCESS
+             : SVG_ANIM_STATUS_NO_MEMORY;
+}
+
+bool ir_value_equal(const ir_value_t *a, const ir_path_store_t *a_paths,
+                    const ir_value_t *b, const ir_path_store_t *b_paths,
+                    const float tolerance) {
+  if (a->type != b->type)
+    return false;
+  switch (a->type) {
+  case IR_VALUE_NUMBER:
+    return fabsf(a->number - b->number) <= tolerance;
+  case IR_VALUE_COLOR:
+    return a->rgba == b->rgba;
+  case IR_VALUE_KEYWORD:
+    return a->keyword == b->keyword;
+  case IR_VALUE_STRING:
+    return a->string_id == b->string_id;
+  case IR_VALUE_PATH:
+    return ir_path_equal(ir_path_store_get(a_paths, a->path_id),
+                         ir_path_store_get(b_paths, b->path_id), tolerance);
+  }
+  return false;
+}
@@ -0,0 +1,280 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "ir/svg_tokenize.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+ * ===================================
+ *          STRUCTURAL MASK
+ * ===================================
+ */
+
+/**
+ * Bit i of the mask is set if byte i of the block is '<', '=', '"' or '>'.
+ * '<' '=' '>' are 0x3C..0x3E, so they are found with a single range compare:
+ * (byte - '<') <= 2 as unsigned bytes.
+ */
+
+#if defined(__AVX2__)
+static inline uint32_t tok_mask32(const uint8_t *p) {
+  const __m256i v = _mm256_loadu_si256((const __m256i *)p);
+  const __m256i t = _mm256_sub_epi8(v, _mm256_set1_epi8('<'));
+  const __m256i angle_eq =
+      _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(2)), t);
+  const __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"'));
+  return (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(angle_eq, quote));
+}
+
+static inline uint64_t tok_structural_mask(const uint8_t *block) {
+  return (uint64_t)tok_mask32(block) | (uint64_t)tok_mask32(block + 32) << 32;
+}
+#elif defined(__SSE2__)
+static inline uint32_t tok_mask16(const uint8_t *p) {
+  const __m128i v = _mm_loadu_si128((const __m128i *)p);
+  const __m128i t = _mm_sub_epi8(v, _mm_set1_epi8('<'));
+  const __m128i angle_eq = _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(2)), t);
+  const __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('"'));
+  return (uint32_t)_mm_movemask_epi8(_mm_or_si128(angle_eq, quote));
+}
+
+static inline uint64_t tok_structural_mask(const uint8_t *block) {
+  return (uint64_t)tok_mask16(block) | (uint64_t)tok_mask16(block + 16) << 16 |
+         (uint64_t)tok_mask16(block + 32) << 32 |
+         (uint64_t)tok_mask16(block + 48) << 48;
+}
+#elif defined(__ARM_NEON)
+static inline uint8x16_t tok_match16(const uint8_t *p) {
+  const uint8x16_t v = vld1q_u8(p);
+  const uint8x16_t angle_eq = vcleq_u8(vsubq_u8(v, vdupq_n_u8('<')),
+                                       vdupq_n_u8(2));
+  return vorrq_u8(angle_eq, vceqq_u8(v, vdupq_n_u8('"')));
+}
+
+/** NEON has no movemask, the four compares are folded by pairwise adds **/
+static inline uint64_t tok_structural_mask(const uint8_t *block) {
+  static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                      1, 2, 4, 8, 16, 32, 64, 128};
+  const uint8x16_t w = vld1q_u8(weights);
+  const uint8x16_t m0 = vandq_u8(tok_match16(block), w);
+  const uint8x16_t m1 = vandq_u8(tok_match16(block + 16), w);
+  const uint8x16_t m2 = vandq_u8(tok_match16(block + 32), w);
+  const uint8x16_t m3 = vandq_u8(tok_match16(block + 48), w);
+  uint8x16_t sum = vpaddq_u8(vpaddq_u8(m0, m1), vpaddq_u8(m2, m3));
+  sum = vpaddq_u8(sum, sum);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+#else
+/** Sets the high bit of every byte of the little endian word equal to c **/
+static inline uint64_t tok_eq8(const uint64_t word, const uint8_t c) {
+  const uint64_t low7 = 0x7F7F7F7F7F7F7F7Full;
+  const uint64_t x = word ^ (0x0101010101010101ull * c);
+  return ~(((x & low7) + low7) | x | low7);
+}
+
+/** Eight bytes at a time in a word, the high bits are gathered by a multiply **/
+static inline uint64_t tok_structural_mask(const uint8_t *block) {
+  uint64_t mask = 0;
+  for (size_t i = 0; i < SVG_TOKENIZE_BLOCK; i += 8) {
+    uint64_t word;
+    memcpy(&word, block + i, sizeof(word));
+    const uint64_t m = tok_eq8(word, '<') | tok_eq8(word, '=') |
+                       tok_eq8(word, '>') | tok_eq8(word, '"');
+    mask |= ((m >> 7) * 0x0102040810204080ull >> 56) << i;
+  }
+  return mask;
+}
+#endif
+
+/**
+ * ===================================
+ *             TOKENIZER
+ * ===================================
+ */
+
+typedef enum tok_state_e {
+  TOK_TEXT,       // between elements
+  TOK_TAG,        // inside an element that is not a path
+  TOK_TAG_QUOTED, // inside a value of an element that is not a path
+  TOK_PATH,       // inside a path, between attributes
+  TOK_PATH_EQ,    // after a key's '=', only spaces before its opening '"'
+  TOK_PATH_VALUE, // inside a path's value, only its closing '"' ends it
+} tok_state_e;
+
+typedef struct tok_t {
+  arena_t *token_arena;
+  size_t token_arena_pos;
+  const char *svg;
+  size_t length;
+  svg_tokenize_path_fn on_path;
+  void *ctx;
+
+  tok_state_e state;
+  token_pair_buffer_t path;
+  /** Where the next key may start, after "<path" or the last value. After
+   * a key, where its '=' ends **/
+  size_t key_start;
+  size_t key_offset;
+  size_t key_length;
+} tok_t;
+
+static inline bool tok_is_space(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+/** "<path" followed by a space, '/' or '>' **/
+static bool tok_is_path(const tok_t *tok, const size_t pos) {
+  if (tok->length - pos < 6 || memcmp(tok->svg + pos + 1, "path", 4) != 0)
+    return false;
+  const char next = tok->svg[pos + 5];
+  return tok_is_space(next) || next == '/' || next == '>';
+}
+
+/** The key is the last word before its '=' **/
+static bool tok_key(tok_t *tok, const size_t eq) {
+  size_t end = eq;
+  while (end > tok->key_start && tok_is_space(tok->svg[end - 1]))
+    --end;
+  size_t start = end;
+  while (start > tok->key_start && !tok_is_space(tok->svg[start - 1]))
+    --start;
+  tok->key_offset = start;
+  tok->key_length = end - start;
+  return start != end;
+}
+
+static SvgAnimStatus tok_structural(tok_t *tok, const size_t pos) {
+  const char c = tok->svg[pos];
+  switch (tok->state) {
+  case TOK_TEXT:
+    if (c != '<')
+      return SVG_ANIM_STATUS_SUCCESS;
+    if (tok_is_path(tok, pos)) {
+      tok->state = TOK_PATH;
+      tok->path.num_pairs = 0;
+      tok->path.token_pairs = NULL;
+      tok->path.offset = pos;
+      tok->key_start = pos + 5;
+    } else {
+      tok->state = TOK_TAG;
+    }
+    return SVG_ANIM_STATUS_SUCCESS;
+
+  case TOK_TAG:
+    if (c == '"')
+      tok->state = TOK_TAG_QUOTED;
+    else if (c == '>')
+      tok->state = TOK_TEXT;
+    return SVG_ANIM_STATUS_SUCCESS;
+
+  case TOK_TAG_QUOTED:
+    if (c == '"')
+      tok->state = TOK_TAG;
+    return SVG_ANIM_STATUS_SUCCESS;
+
+  case TOK_PATH:
+    if (c == '=') {
+      if (!tok_key(tok, pos))
+        return SVG_ANIM_STATUS_MALFORMED_SVG;
+      tok->state = TOK_PATH_EQ;
+      tok->key_start = pos + 1;
+      return SVG_ANIM_STATUS_SUCCESS;
+    }
+    if (c != '>')
+      return SVG_ANIM_STATUS_MALFORMED_SVG;
+
+    /** Full path found **/
+    tok->path.length = pos + 1 - tok->path.offset;
+    tok->state = TOK_TEXT;
+    const SvgAnimStatus status = tok->on_path(tok->ctx, &tok->path);
+    arena_set_pos_back(tok->token_arena, tok->token_arena_pos);
+    return status;
+
+  case TOK_PATH_EQ:
+    if (c != '"')
+      return SVG_ANIM_STATUS_MALFORMED_SVG;
+    for (size_t i = tok->key_start; i < pos; ++i)
+      if (!tok_is_space(tok->svg[i]))
+        return SVG_ANIM_STATUS_MALFORMED_SVG;
+    tok->state = TOK_PATH_VALUE;
+    tok->key_start = pos + 1;
+    return SVG_ANIM_STATUS_SUCCESS;
+
+  case TOK_PATH_VALUE: {
+    if (c != '"')
+      return SVG_ANIM_STATUS_SUCCESS;
+    // Pairs of one path are pushed back to back
+    token_pair_record_t *pair =
+        arena_push_struct(tok->token_arena, token_pair_record_t);
+    if (!pair)
+      return SVG_ANIM_STATUS_NO_MEMORY;
+    if (tok->path.num_pairs == 0)
+      tok->path.token_pairs = pair;
+    pair->key_offset = tok->key_offset;
+    pair->key_length = tok->key_length;
+    pair->value_offset = tok->key_start;
+    pair->value_length = pos - tok->key_start;
+    ++tok->path.num_pairs;
+    tok->state = TOK_PATH;
+    tok->key_start = pos + 1;
+    return SVG_ANIM_STATUS_SUCCESS;
+  }
+  }
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static SvgAnimStatus tok_block(tok_t *tok, const size_t base, uint64_t mask) {
+  while (mask) {
+    const size_t pos = base + (size_t)__builtin_ctzll(mask);
+    mask &= mask - 1;
+    const SvgAnimStatus status = tok_structural(tok, pos);
+    if (status != SVG_ANIM_STATUS_SUCCESS)
+      return status;
+  }
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+SvgAnimStatus svg_tokenize_paths(arena_t *token_arena, const char *svg,
+                                 const size_t length,
+                                 const svg_tokenize_path_fn on_path,
+                                 void *ctx) {
+  tok_t tok = {.token_arena = token_arena,
+               .token_arena_pos = arena_get_pos(token_arena),
+               .svg = svg,
+               .length = length,
+               .on_path = on_path,
+               .ctx = ctx,
+               .state = TOK_TEXT,
+               .path = {.blob = svg}};
+
+  const uint8_t *bytes = (const uint8_t *)svg;
+  SvgAnimStatus status = SVG_ANIM_STATUS_SUCCESS;
+  size_t base = 0;
+  for (; status == SVG_ANIM_STATUS_SUCCESS &&
+         base + SVG_TOKENIZE_BLOCK <= length;
+       base += SVG_TOKENIZE_BLOCK)
+    status = tok_block(&tok, base, tok_structural_mask(bytes + base));
+
+  // The last partial block is padded with NUL, which is not structural
+  if (status == SVG_ANIM_STATUS_SUCCESS && base < length) {
+    uint8_t tail[SVG_TOKENIZE_BLOCK] = {0};
+    memcpy(tail, bytes + base, length - base);
+    status = tok_block(&tok, base, tok_structural_mask(tail));
+  }
+
+  arena_set_pos_back(token_arena, tok.token_arena_pos);
+  if (status == SVG_ANIM_STATUS_SUCCESS && tok.state >= TOK_PATH)
+    return SVG_ANIM_STATUS_MALFORMED_SVG;
+  return status;
+}
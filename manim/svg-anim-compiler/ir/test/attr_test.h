@@ -0,0 +1,301 @@
+/*=============================================================================
+  attr_test.h — validation & micro-benchmark of the attribute lookup
+  ---------------------------------------------------------------------------
+  Usage:
+      #define ATTR_TEST_MAIN       // <- optional: gives you a main() driver
+      #include "attr_test.h"
+
+      $ cc -O3 -std=gnu17 -pthread attr_test.c ir/src/ir_attr.c -o attr_test
+      $ ./attr_test
+
+  The benchmark resolves the keys of cairo-like paths with a strcmp chain
+  over every name, with map_t keyed by the name's hash, and with
+  ir_attribute_lookup.
+=============================================================================*/
+#ifndef ATTR_TEST_H
+#define ATTR_TEST_H
+
+#include "common/core.h"
+#include "common/hash.h"
+#include "ctrs/map.h"
+#include "ir/ir_attr.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef ATTR_TEST_LOOKUPS /* lookups per perf pass */
+#define ATTR_TEST_LOOKUPS (1u << 20) /* 1 048 576 */
+#endif
+
+#ifndef ATTR_TEST_PASSES
+#define ATTR_TEST_PASSES 16
+#endif
+
+#ifndef ATTR_TEST_SEED_ATTEMPTS /* seeds tried when regenerating          */
+#define ATTR_TEST_SEED_ATTEMPTS 4096 /* a free one turns up within dozens */
+#endif
+
+/* The table as written, to check what was generated from it */
+#define ATTR_TEST_ENTRY(type, name, kind) {type, name, kind},
+static const struct {
+  attribute_type_e type;
+  const char *name;
+  attribute_value_kind_e kind;
+} attr_test_table[] = {IR_ATTRIBUTES(ATTR_TEST_ENTRY)};
+#undef ATTR_TEST_ENTRY
+
+/* ---------------------------------------------------------------------------
+   Test 1: the seed and slot table in ir_attr.c are generated from the table
+   as written, or printed anew for ir_attr.c if they are not
+   ------------------------------------------------------------------------ */
+static bool attr_test_build_slots(const uint64_t seed,
+                                  uint8_t slots[IR_ATTR_HASH_SLOTS]) {
+  memset(slots, 0, IR_ATTR_HASH_SLOTS);
+  for (size_t i = 0; i < NUM_ATTRIBUTE_TYPES; ++i) {
+    const char *name = attr_test_table[i].name;
+    const size_t length = strlen(name);
+    uint64_t head, tail;
+    ir_attribute_words(name, length, &head, &tail);
+    uint8_t *slot =
+        &slots[ir_attribute_slot(ir_attribute_fold(head, tail, length), seed)];
+    if (*slot)
+      return false;
+    *slot = (uint8_t)(i + 1);
+  }
+  return true;
+}
+
+static void attr_test_print_slots(const uint64_t seed,
+                                  const uint8_t slots[IR_ATTR_HASH_SLOTS]) {
+  printf("#define ATTR_HASH_SEED 0x%016" PRIx64 "ULL\n\n", seed);
+  puts("static const uint8_t attr_hash_slots[IR_ATTR_HASH_SLOTS] = {");
+  for (size_t i = 0; i < IR_ATTR_HASH_SLOTS; i += 16) {
+    printf("   ");
+    for (size_t j = i; j < i + 16; ++j)
+      printf(" %u,", slots[j]);
+    putchar('\n');
+  }
+  puts("};");
+}
+
+static void attr_test_generated(void) {
+  puts("[generated]");
+  for (size_t i = 0; i < NUM_ATTRIBUTE_TYPES; ++i)
+    assert(strlen(attr_test_table[i].name) <= IR_ATTR_MAX_NAME_LENGTH);
+
+  uint8_t slots[IR_ATTR_HASH_SLOTS];
+  if (attr_test_build_slots(ir_attribute_hash_seed(), slots) &&
+      memcmp(slots, ir_attribute_hash_slots(), sizeof(slots)) == 0)
+    return;
+
+  for (uint64_t attempt = 1; attempt <= ATTR_TEST_SEED_ATTEMPTS; ++attempt) {
+    const uint64_t seed = hash_mix64(HASH_SEED + attempt) | 1;
+    if (attr_test_build_slots(seed, slots)) {
+      puts("IR_ATTRIBUTES changed, replace the perfect hash in ir_attr.c "
+           "with:\n");
+      attr_test_print_slots(seed, slots);
+      exit(EXIT_FAILURE);
+    }
+  }
+  /* only if two names fold to the same word, IR_ATTRIBUTES has a duplicate */
+  fputs("no collision free seed for IR_ATTRIBUTES\n", stderr);
+  exit(EXIT_FAILURE);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: every name finds its type, also in the middle of an svg
+   ------------------------------------------------------------------------ */
+static void attr_test_names(void) {
+  puts("[names]");
+  assert(sizeof(attr_test_table) / sizeof(attr_test_table[0]) ==
+         NUM_ATTRIBUTE_TYPES);
+
+  char svg[64];
+  for (size_t i = 0; i < NUM_ATTRIBUTE_TYPES; ++i) {
+    const attribute_type_e type = attr_test_table[i].type;
+    const size_t length = strlen(attr_test_table[i].name);
+    assert(type == i);
+    assert(strcmp(ir_attribute_name(type), attr_test_table[i].name) == 0);
+    assert(ir_attribute_name_length(type) == length);
+    assert(ir_attribute_value_kind(type) == attr_test_table[i].kind);
+
+    /* not NUL terminated, surrounded by more name-like bytes */
+    memset(svg, 'a', sizeof(svg));
+    memcpy(svg + 8, attr_test_table[i].name, length);
+    attribute_type_e found = NUM_ATTRIBUTE_TYPES;
+    assert(ir_attribute_lookup(svg + 8, length, &found));
+    assert(found == type);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: anything else is not an attribute
+   ------------------------------------------------------------------------ */
+static bool attr_test_is_name(const char *name, const size_t length) {
+  for (size_t i = 0; i < NUM_ATTRIBUTE_TYPES; ++i)
+    if (strlen(attr_test_table[i].name) == length &&
+        memcmp(attr_test_table[i].name, name, length) == 0)
+      return true;
+  return false;
+}
+
+static void attr_test_unknown(void) {
+  puts("[unknown]");
+  attribute_type_e found;
+  const char *others[] = {"",       "fil",   "fills",      "FILL",
+                          "Fill",   "id",    "style",      "xmlns",
+                          "x",      "data",  "stroke-",    "stroke-widt",
+                          "dd",     "d-tag", "data-tag2",  "strokewidth",
+                          "glyph-orientation-horizontals",
+                          "a-name-longer-than-every-attribute-name"};
+  for (size_t i = 0; i < sizeof(others) / sizeof(others[0]); ++i)
+    assert(!ir_attribute_lookup(others[i], strlen(others[i]), &found));
+
+  /* every name with any one byte changed, cut short or made longer */
+  char name[64];
+  for (size_t i = 0; i < NUM_ATTRIBUTE_TYPES; ++i) {
+    const size_t length = strlen(attr_test_table[i].name);
+    for (size_t pos = 0; pos < length; ++pos) {
+      for (int c = 1; c < 256; ++c) {
+        memcpy(name, attr_test_table[i].name, length);
+        name[pos] = (char)c;
+        assert(ir_attribute_lookup(name, length, &found) ==
+               attr_test_is_name(name, length));
+      }
+    }
+    memcpy(name, attr_test_table[i].name, length);
+    name[length] = '-';
+    assert(ir_attribute_lookup(name, length + 1, &found) ==
+           attr_test_is_name(name, length + 1));
+    assert(ir_attribute_lookup(name, length - 1, &found) ==
+           attr_test_is_name(name, length - 1));
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Benchmark: strcmp chain and map_t against the perfect hash
+   ------------------------------------------------------------------------ */
+static inline uint32_t attr_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static uint32_t attr_test_map_key(const char *name, const size_t length) {
+  return (uint32_t)hash_bytes(name, length, HASH_SEED);
+}
+
+static void attr_test_perf(const size_t count) {
+  printf("[perf] %zu lookups x %d passes\n", count, ATTR_TEST_PASSES);
+
+  /* mostly what cairo writes on a path, now and then any other name */
+  static const char *const path_keys[] = {
+      "fill",         "fill-opacity",   "d",
+      "data-tag",     "stroke",         "stroke-width",
+      "stroke-opacity", "stroke-linecap", "stroke-linejoin",
+      "stroke-miterlimit", "transform", "fill-rule"};
+  const size_t num_path_keys = sizeof(path_keys) / sizeof(path_keys[0]);
+  const char **keys = malloc(count * sizeof(*keys));
+  size_t *lengths = malloc(count * sizeof(*lengths));
+  if (!keys || !lengths) {
+    fputs("out of memory\n", stderr);
+    exit(EXIT_FAILURE);
+  }
+  uint32_t rng = 1u;
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t r = attr_prng_next(&rng);
+    keys[i] = r % 8 ? path_keys[r / 8 % num_path_keys]
+                    : attr_test_table[r / 8 % NUM_ATTRIBUTE_TYPES].name;
+    lengths[i] = strlen(keys[i]);
+  }
+
+  map_t *map = map_create(sizeof(attribute_type_e), _Alignof(attribute_type_e));
+  assert(map);
+  for (size_t i = 0; i < NUM_ATTRIBUTE_TYPES; ++i) {
+    const char *name = attr_test_table[i].name;
+    assert(map_put(map, attr_test_map_key(name, strlen(name)),
+                   &attr_test_table[i].type));
+  }
+
+  /* 1) strcmp chain ---------------------------------------------------- */
+  size_t sums[3] = {0};
+  timespec_t t0 = ts_now();
+  for (int pass = 0; pass < ATTR_TEST_PASSES; ++pass)
+    for (size_t i = 0; i < count; ++i)
+      for (size_t type = 0; type < NUM_ATTRIBUTE_TYPES; ++type)
+        if (strcmp(keys[i], attr_test_table[type].name) == 0) {
+          sums[0] += type;
+          break;
+        }
+  timespec_t t1 = ts_now();
+
+  /* 2) map_t, the name checked after the hit --------------------------- */
+  for (int pass = 0; pass < ATTR_TEST_PASSES; ++pass)
+    for (size_t i = 0; i < count; ++i) {
+      attribute_type_e type;
+      if (map_get(map, attr_test_map_key(keys[i], lengths[i]), &type) &&
+          memcmp(attr_test_table[type].name, keys[i], lengths[i]) == 0)
+        sums[1] += type;
+    }
+  timespec_t t2 = ts_now();
+
+  /* 3) ir_attribute_lookup --------------------------------------------- */
+  for (int pass = 0; pass < ATTR_TEST_PASSES; ++pass)
+    for (size_t i = 0; i < count; ++i) {
+      attribute_type_e type;
+      if (ir_attribute_lookup(keys[i], lengths[i], &type))
+        sums[2] += type;
+    }
+  timespec_t t3 = ts_now();
+
+  assert(sums[0] == sums[1] && sums[1] == sums[2]);
+  (void)sums;
+
+  const double total = (double)count * ATTR_TEST_PASSES;
+  const double s_strcmp = ts_elapsed_sec(t0, t1);
+  const double s_map = ts_elapsed_sec(t1, t2);
+  const double s_hash = ts_elapsed_sec(t2, t3);
+  printf("  strcmp chain       : %7.1f Mlookups/s  (%.2f ns/lookup)\n",
+         total / s_strcmp / 1e6, s_strcmp * 1e9 / total);
+  printf("  map_t              : %7.1f Mlookups/s  (%.2f ns/lookup)\n",
+         total / s_map / 1e6, s_map * 1e9 / total);
+  printf("  ir_attribute_lookup: %7.1f Mlookups/s  (%.2f ns/lookup)\n",
+         total / s_hash / 1e6, s_hash * 1e9 / total);
+
+  map_destroy(map);
+  free(keys);
+  free(lengths);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   ATTR_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void attr_tests_run_all(void) {
+  attr_test_generated();
+  attr_test_names();
+  attr_test_unknown();
+  attr_test_perf(ATTR_TEST_LOOKUPS);
+  puts("all attr tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef ATTR_TEST_MAIN
+int main(void) {
+  attr_tests_run_all();
+  return 0;
+}
+#endif /* ATTR_TEST_MAIN */
+
+#endif /* ATTR_TEST_H */
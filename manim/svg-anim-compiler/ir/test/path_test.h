@@ -0,0 +1,407 @@
+/*=============================================================================
+  path_test.h — validation & micro-benchmarks for ir_path.h
+  ---------------------------------------------------------------------------
+  Usage:
+      #define PATH_TEST_MAIN       // <- optional: gives you a main() driver
+      #include "path_test.h"
+
+      $ cc -O3 -std=gnu17 path_test.c ir/src/ir_path.c ir/src/ir_value.c \
+            -lm -o path_test
+      $ ./path_test
+=============================================================================*/
+#ifndef PATH_TEST_H
+#define PATH_TEST_H
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "ir/ir_path.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef PATH_TEST_COMMANDS /* curves in the perf test's path */
+#define PATH_TEST_COMMANDS (1u << 17) /* 131 072 */
+#endif
+
+#ifndef PATH_TEST_ROUNDS /* parses of it */
+#define PATH_TEST_ROUNDS 20u
+#endif
+
+#ifndef PATH_TEST_RANDOM_PATHS /* paths in the round trip test */
+#define PATH_TEST_RANDOM_PATHS 2000u
+#endif
+
+static SvgAnimStatus path_test_parse(arena_t *arena, const char *d,
+                                     ir_path_t *out) {
+  return ir_path_parse(arena, d, strlen(d), out);
+}
+
+static bool path_test_equal(const ir_path_t *a, const ir_path_t *b) {
+  return a->num_commands == b->num_commands &&
+         a->num_coords == b->num_coords &&
+         memcmp(a->commands, b->commands, a->num_commands) == 0 &&
+         memcmp(a->coords, b->coords, a->num_coords * sizeof(float)) == 0;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: every command comes out absolute, S/T reflect, H/V are lines
+   ------------------------------------------------------------------------ */
+static void path_test_commands(void) {
+  puts("[commands]");
+  static const char *const cases[][2] = {
+      {"", ""},
+      {" \n\t", ""},
+      {"M 325.5 810 C 312 796.5 298.5 783 285 769.5 Z ",
+       "M 325.5 810 C 312 796.5 298.5 783 285 769.5 Z"},
+      {"m10 20l5 5h10v-5z", "M 10 20 L 15 25 L 25 25 L 25 20 Z"},
+      {"M0,0 10,10 20 , 0", "M 0 0 L 10 10 L 20 0"},
+      {"m1 1 2 2", "M 1 1 L 3 3"},
+      {"M1-2.5.5.25e1", "M 1 -2.5 L 0.5 2.5"},
+      {"M0 0C1 1 2 2 3 3S5 5 6 6", "M 0 0 C 1 1 2 2 3 3 C 4 4 5 5 6 6"},
+      {"M0 0c1 1 2 2 3 3s2 2 3 3", "M 0 0 C 1 1 2 2 3 3 C 4 4 5 5 6 6"},
+      {"M0 0S1 1 2 2", "M 0 0 C 0 0 1 1 2 2"},
+      {"M0 0C1 1 2 2 3 3L4 4S5 5 6 6",
+       "M 0 0 C 1 1 2 2 3 3 L 4 4 C 4 4 5 5 6 6"},
+      {"M0 0Q1 1 2 0T4 0", "M 0 0 Q 1 1 2 0 Q 3 -1 4 0"},
+      {"M0 0Q1 1 2 0T4 0 6 0", "M 0 0 Q 1 1 2 0 Q 3 -1 4 0 Q 5 1 6 0"},
+      {"M0 0L1 1T2 2", "M 0 0 L 1 1 Q 1 1 2 2"},
+      {"M0 0a5 5 30 1 0 10 10", "M 0 0 A 5 5 30 1 0 10 10"},
+      {"M1 1a5,5 0 0110,10", "M 1 1 A 5 5 0 0 1 11 11"},
+      {"M 1 1 z m 1 1 l 1 0", "M 1 1 Z M 2 2 L 3 2"},
+      {"M 1 1 Z L 5 5", "M 1 1 Z L 5 5"},
+      {"M 0.1234567 -0.0000001", "M 0.123457 0"},
+      {"M 1E2 +3e-1", "M 100 0.3"},
+  };
+
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    ir_path_t path;
+    assert(path_test_parse(arena, cases[i][0], &path) ==
+           SVG_ANIM_STATUS_SUCCESS);
+    size_t length;
+    const char *text = ir_path_write(arena, &path, 6, &length);
+    assert(text && length == strlen(text));
+    if (strcmp(text, cases[i][1]) != 0) {
+      fprintf(stderr, "  \"%s\" -> \"%s\", expected \"%s\"\n", cases[i][0],
+              text, cases[i][1]);
+      assert(!"path written back differs");
+    }
+  }
+
+  /* the arity of each command covers the coordinate array */
+  ir_path_t path;
+  assert(path_test_parse(arena, "M0 0L1 1C1 1 2 2 3 3Q1 1 2 2A1 1 0 0 0 1 1Z",
+                         &path) == SVG_ANIM_STATUS_SUCCESS);
+  uint32_t coords = 0;
+  for (uint32_t i = 0; i < path.num_commands; ++i) {
+    assert(path.commands[i] == i);
+    coords += ir_path_command_arity((ir_path_command_e)path.commands[i]);
+  }
+  assert(path.num_commands == NUM_IR_PATH_COMMANDS && path.num_coords == coords);
+
+  /* large coordinates are written in exponent form and read back */
+  assert(path_test_parse(arena, "M 0 -1e30", &path) == SVG_ANIM_STATUS_SUCCESS);
+  ir_path_t again;
+  assert(path_test_parse(arena, ir_path_write(arena, &path, 3, NULL), &again) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(path_test_equal(&path, &again));
+
+  arena_release(arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: malformed data fails and leaves the arena as it was
+   ------------------------------------------------------------------------ */
+static void path_test_malformed(void) {
+  puts("[malformed]");
+  static const char *const broken[] = {
+      "L 1 1",         "1 1",          "M",          "M 1",
+      "M 1 2 Z 3 4",   "M 1 2 X 3 4",  "M 1,,2",     "M 1 2 L L 3 4",
+      "M 0 0 C 1 2 3", "M 1e 2",       "M 1e39 0",   "M 0 0 h",
+      "M 0 0 A 1 1 0 2 0 1 1",         "M 0 0 a1 1 0 0 .5 1 1",
+      "M 1 2 L 3 4 5", "M 1 2 #",      "z",          ", M 1 2"};
+
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  assert(arena_push(arena, 3));
+  const size_t pos = arena_get_pos(arena);
+  for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); ++i) {
+    ir_path_t path;
+    if (path_test_parse(arena, broken[i], &path) !=
+        SVG_ANIM_STATUS_MALFORMED_SVG) {
+      fprintf(stderr, "  \"%s\" parsed\n", broken[i]);
+      assert(!"malformed path data parsed");
+    }
+    assert(arena_get_pos(arena) == pos);
+  }
+  arena_release(arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: random paths, relative and absolute spellings agree and writing
+   back reads back to the same floats
+   ------------------------------------------------------------------------ */
+static inline uint32_t path_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static void path_test_round_trip(void) {
+  puts("[round trip]");
+  const size_t capacity = 1u << 16;
+  char *absolute = malloc(capacity);
+  char *relative = malloc(capacity);
+  if (!absolute || !relative) {
+    fputs("out of memory\n", stderr);
+    exit(EXIT_FAILURE);
+  }
+  arena_t *arena = arena_alloc();
+  assert(arena);
+
+  uint32_t rng = 7u;
+  for (uint32_t p = 0; p < PATH_TEST_RANDOM_PATHS; ++p) {
+    /* integer coordinates keep both spellings exact */
+    size_t a = 0, r = 0;
+    int x = 0, y = 0;
+    const uint32_t num_commands = 1 + path_prng_next(&rng) % 40;
+    for (uint32_t c = 0; c < num_commands; ++c) {
+      static const char letters[] = "MLCQ";
+      const char letter = c ? letters[path_prng_next(&rng) % 4] : 'M';
+      const int points = letter == 'C' ? 3 : letter == 'Q' ? 2 : 1;
+      a += (size_t)snprintf(absolute + a, capacity - a, "%c", letter);
+      r += (size_t)snprintf(relative + r, capacity - r, "%c", letter + 32);
+      for (int i = 0; i < points; ++i) {
+        const int px = (int)(path_prng_next(&rng) % 2001) - 1000;
+        const int py = (int)(path_prng_next(&rng) % 2001) - 1000;
+        a += (size_t)snprintf(absolute + a, capacity - a, "%d,%d ", px, py);
+        r += (size_t)snprintf(relative + r, capacity - r, "%d %d", px - x,
+                              py - y);
+        r += (size_t)snprintf(relative + r, capacity - r, " ");
+        if (i == points - 1) {
+          x = px;
+          y = py;
+        }
+      }
+    }
+
+    ir_path_t from_absolute, from_relative, written;
+    assert(ir_path_parse(arena, absolute, a, &from_absolute) ==
+           SVG_ANIM_STATUS_SUCCESS);
+    assert(ir_path_parse(arena, relative, r, &from_relative) ==
+           SVG_ANIM_STATUS_SUCCESS);
+    assert(from_absolute.num_commands == num_commands);
+    assert(path_test_equal(&from_absolute, &from_relative));
+
+    size_t length;
+    const char *text = ir_path_write(arena, &from_absolute, 6, &length);
+    assert(text);
+    assert(ir_path_parse(arena, text, length, &written) ==
+           SVG_ANIM_STATUS_SUCCESS);
+    assert(path_test_equal(&from_absolute, &written));
+    arena_clear(arena);
+  }
+
+  arena_release(arena);
+  free(absolute);
+  free(relative);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 4: the store hands out dense ids and starts over on clear
+   ------------------------------------------------------------------------ */
+static void path_test_store(void) {
+  puts("[store]");
+  ir_path_store_t *store = ir_path_store_create();
+  assert(store);
+
+  uint32_t id;
+  assert(ir_path_store_put(store, "M 0 0 L 1 1", 11, &id) ==
+             SVG_ANIM_STATUS_SUCCESS &&
+         id == 0);
+  assert(ir_path_store_put(store, "M 0 0 Q", 7, &id) ==
+         SVG_ANIM_STATUS_MALFORMED_SVG);
+  assert(ir_path_store_put(store, "M 5 5 Z", 7, &id) ==
+             SVG_ANIM_STATUS_SUCCESS &&
+         id == 1);
+  assert(store->count == 2);
+  assert(ir_path_store_get(store, 0)->num_commands == 2);
+  assert(ir_path_store_get(store, 1)->num_commands == 2);
+  assert(ir_path_store_get(store, 1)->coords[1] == 5.0f);
+
+  ir_path_store_clear(store);
+  assert(store->count == 0);
+  assert(ir_path_store_put(store, "M 9 9", 5, &id) == SVG_ANIM_STATUS_SUCCESS &&
+         id == 0);
+  assert(ir_path_store_get(store, 0)->coords[0] == 9.0f);
+
+  /* ids are per store: the last frame's path stays readable while the next
+     frame fills and clears the other store, as gen_ir swaps them */
+  ir_path_store_t *next = ir_path_store_create();
+  assert(next);
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 100 == 0)
+      ir_path_store_clear(next);
+    assert(ir_path_store_put(next, "M 1 2 L 3 4 Q 5 6 7 8", 21, &id) ==
+           SVG_ANIM_STATUS_SUCCESS);
+  }
+  assert(id == 99 && ir_path_store_get(next, id)->coords[6] == 7.0f);
+  assert(store->count == 1 && ir_path_store_get(store, 0)->coords[0] == 9.0f);
+
+  ir_path_store_destroy(next);
+  ir_path_store_destroy(store);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 5: equality is on commands and coordinates within a tolerance
+   ------------------------------------------------------------------------ */
+static void path_test_equal_tolerance(void) {
+  puts("[equal]");
+  arena_t *arena = arena_alloc();
+  assert(arena);
+
+  ir_path_t base, near, far, other_command, longer, empty;
+  assert(path_test_parse(arena, "M 1 2 C 3 4 5 6 7 8 Z", &base) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(path_test_parse(arena, "M 1 2 c 2 2 4 4 6.0005 6 z", &near) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(path_test_parse(arena, "M 1 2 C 3 4 5 6 7 8.1 Z", &far) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(path_test_parse(arena, "M 1 2 C 3 4 5 6 7 8 L 1 2", &other_command) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(path_test_parse(arena, "M 1 2 C 3 4 5 6 7 8 Z M 0 0", &longer) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(path_test_parse(arena, "", &empty) == SVG_ANIM_STATUS_SUCCESS);
+
+  assert(ir_path_equal(&base, &base, 0.0f));
+  assert(!ir_path_equal(&base, &near, 0.0f));
+  assert(ir_path_equal(&base, &near, 1e-3f));
+  assert(ir_path_equal(&near, &base, 1e-3f));
+  assert(!ir_path_equal(&base, &far, 1e-3f));
+  assert(ir_path_equal(&base, &far, 0.2f));
+  assert(!ir_path_equal(&base, &other_command, 10.0f));
+  assert(!ir_path_equal(&base, &longer, 10.0f));
+  assert(ir_path_equal(&empty, &empty, 0.0f));
+  assert(!ir_path_equal(&empty, &base, 10.0f));
+
+  arena_release(arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 6: micro-benchmark, one long path as cairo writes it, against
+   scanning the same numbers with strtod
+   ------------------------------------------------------------------------ */
+static void path_test_perf(const size_t num_commands) {
+  printf("[perf] %zu curves, %u rounds\n", num_commands, PATH_TEST_ROUNDS);
+
+  const size_t capacity = num_commands * 96 + 64;
+  char *d = malloc(capacity);
+  if (!d) {
+    fputs("out of memory\n", stderr);
+    exit(EXIT_FAILURE);
+  }
+  uint32_t rng = 1u;
+  size_t length = (size_t)snprintf(d, capacity, "M 325.5 810 ");
+  for (size_t c = 0; c < num_commands; ++c) {
+    length += (size_t)snprintf(d + length, capacity - length, "C");
+    for (int i = 0; i < 6; ++i) {
+      const uint32_t r = path_prng_next(&rng);
+      length += (size_t)snprintf(d + length, capacity - length, " %u.%u",
+                                 r % 1920, r >> 8 & 0xfff);
+    }
+    length += (size_t)snprintf(d + length, capacity - length, " ");
+  }
+  length += (size_t)snprintf(d + length, capacity - length, "Z ");
+
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  ir_path_t path = {0};
+  const timespec_t t0 = ts_now();
+  for (uint32_t round = 0; round < PATH_TEST_ROUNDS; ++round) {
+    arena_clear(arena);
+    assert(ir_path_parse(arena, d, length, &path) == SVG_ANIM_STATUS_SUCCESS);
+  }
+  const timespec_t t1 = ts_now();
+  assert(path.num_commands == num_commands + 2);
+
+  double sum = 0;
+  for (uint32_t round = 0; round < PATH_TEST_ROUNDS; ++round) {
+    for (const char *p = d; *p;) {
+      char *end;
+      const double value = strtod(p, &end);
+      if (end == p) {
+        ++p;
+        continue;
+      }
+      sum += value;
+      p = end;
+    }
+  }
+  const timespec_t t2 = ts_now();
+  (void)sum;
+
+  arena_t *text_arena = arena_alloc();
+  assert(text_arena);
+  size_t written_length;
+  const timespec_t t3 = ts_now();
+  for (uint32_t round = 0; round < PATH_TEST_ROUNDS; ++round) {
+    arena_clear(text_arena);
+    assert(ir_path_write(text_arena, &path, 6, &written_length));
+  }
+  const timespec_t t4 = ts_now();
+
+  const double bytes = (double)length * PATH_TEST_ROUNDS;
+  const double s_parse = ts_elapsed_sec(t0, t1);
+  const double s_strtod = ts_elapsed_sec(t1, t2);
+  const double s_write = ts_elapsed_sec(t3, t4);
+  printf("  parse  : %.1f MB/s  (%.1f ns/coordinate), %zu KiB of text to "
+         "%zu KiB\n",
+         bytes / s_parse / 1e6,
+         s_parse * 1e9 / ((double)path.num_coords * PATH_TEST_ROUNDS),
+         length >> 10,
+         (path.num_coords * sizeof(float) + path.num_commands) >> 10);
+  printf("  strtod : %.1f MB/s  (%.2fx)\n", bytes / s_strtod / 1e6,
+         s_strtod / s_parse);
+  printf("  write  : %.1f MB/s\n",
+         (double)written_length * PATH_TEST_ROUNDS / s_write / 1e6);
+
+  arena_release(text_arena);
+  arena_release(arena);
+  free(d);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   PATH_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void path_tests_run_all(void) {
+  path_test_commands();
+  path_test_malformed();
+  path_test_round_trip();
+  path_test_store();
+  path_test_equal_tolerance();
+  path_test_perf(PATH_TEST_COMMANDS);
+  puts("all path tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef PATH_TEST_MAIN
+int main(void) {
+  path_tests_run_all();
+  return 0;
+}
+#endif /* PATH_TEST_MAIN */
+
+#endif /* PATH_TEST_H */
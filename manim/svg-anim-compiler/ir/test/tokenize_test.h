@@ -0,0 +1,380 @@
+/*=============================================================================
+  tokenize_test.h — validation & throughput benchmark of the svg tokenizer
+  ---------------------------------------------------------------------------
+  Usage:
+      #define TOKENIZE_TEST_MAIN   // <- optional: gives you a main() driver
+      #include "tokenize_test.h"
+
+      $ cc -O3 -std=gnu17 -march=native tokenize_test.c ir/src/svg_tokenize.c \
+           -o tokenize_test
+      $ ./tokenize_test [frames.svg]
+
+  The benchmark runs on one thread, so MB/s is per core. It tokenizes
+  generated cairo-like frames, or the given file (e.g. what --svg-out wrote).
+=============================================================================*/
+#ifndef TOKENIZE_TEST_H
+#define TOKENIZE_TEST_H
+
+#include "common/core.h"
+#include "ir/svg_tokenize.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef TOKENIZE_TEST_BENCH_BYTES /* svg generated for the benchmark */
+#define TOKENIZE_TEST_BENCH_BYTES (64u << 20) /* 64 MiB */
+#endif
+
+#ifndef TOKENIZE_TEST_PASSES
+#define TOKENIZE_TEST_PASSES 8
+#endif
+
+#define TOKENIZE_TEST_MAX_PATHS 64
+#define TOKENIZE_TEST_MAX_PAIRS 8
+
+typedef struct tokenize_test_path_t {
+  size_t offset;
+  size_t length;
+  size_t num_pairs;
+  token_pair_record_t pairs[TOKENIZE_TEST_MAX_PAIRS];
+} tokenize_test_path_t;
+
+typedef struct tokenize_test_paths_t {
+  const char *svg;
+  size_t num_paths;
+  tokenize_test_path_t paths[TOKENIZE_TEST_MAX_PATHS];
+} tokenize_test_paths_t;
+
+/* ---------------------------------------------------------------------------
+   Byte at a time reference
+   ------------------------------------------------------------------------ */
+static bool tokenize_test_space(const char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+/* Returns false if a path is malformed */
+static bool tokenize_test_reference(const char *svg, const size_t length,
+                                    tokenize_test_paths_t *out) {
+  out->svg = svg;
+  out->num_paths = 0;
+  size_t i = 0;
+  while (i < length) {
+    if (svg[i] != '<') {
+      ++i;
+      continue;
+    }
+    const bool path = length - i >= 6 && memcmp(svg + i + 1, "path", 4) == 0 &&
+                      (tokenize_test_space(svg[i + 5]) || svg[i + 5] == '/' ||
+                       svg[i + 5] == '>');
+    if (!path) {
+      bool quoted = false;
+      while (i < length && (quoted || svg[i] != '>'))
+        quoted ^= svg[i++] == '"';
+      ++i;
+      continue;
+    }
+
+    tokenize_test_path_t *p = &out->paths[out->num_paths++];
+    p->offset = i;
+    p->num_pairs = 0;
+    size_t j = i + 5;
+    for (;;) {
+      while (j < length && (tokenize_test_space(svg[j]) || svg[j] == '/'))
+        ++j;
+      if (j >= length)
+        return false;
+      if (svg[j] == '>')
+        break;
+      token_pair_record_t *pair = &p->pairs[p->num_pairs++];
+      pair->key_offset = j;
+      while (j < length && svg[j] != '=' && !tokenize_test_space(svg[j]))
+        ++j;
+      pair->key_length = j - pair->key_offset;
+      while (j < length && tokenize_test_space(svg[j]))
+        ++j;
+      if (j >= length || svg[j++] != '=' || pair->key_length == 0)
+        return false;
+      while (j < length && tokenize_test_space(svg[j]))
+        ++j;
+      if (j >= length || svg[j++] != '"')
+        return false;
+      pair->value_offset = j;
+      while (j < length && svg[j] != '"')
+        ++j;
+      if (j >= length)
+        return false;
+      pair->value_length = j++ - pair->value_offset;
+    }
+    p->length = j + 1 - i;
+    i = j + 1;
+  }
+  return true;
+}
+
+static SvgAnimStatus tokenize_test_collect(void *ctx,
+                                           const token_pair_buffer_t *path) {
+  tokenize_test_paths_t *out = ctx;
+  assert(out->num_paths < TOKENIZE_TEST_MAX_PATHS);
+  assert(path->num_pairs <= TOKENIZE_TEST_MAX_PAIRS);
+  /* no copies, everything points into the svg */
+  assert(path->blob == out->svg);
+  tokenize_test_path_t *p = &out->paths[out->num_paths++];
+  p->offset = path->offset;
+  p->length = path->length;
+  p->num_pairs = path->num_pairs;
+  for (size_t i = 0; i < path->num_pairs; ++i) {
+    p->pairs[i] = path->token_pairs[i];
+    assert((const char *)token_get_key(path, i) ==
+           out->svg + path->token_pairs[i].key_offset);
+  }
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static void tokenize_test_expect(arena_t *arena, const char *svg,
+                                 const size_t length) {
+  static tokenize_test_paths_t expected, got;
+  assert(tokenize_test_reference(svg, length, &expected));
+  got.svg = svg;
+  got.num_paths = 0;
+  assert(svg_tokenize_paths(arena, svg, length, tokenize_test_collect, &got) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(arena_get_pos(arena) == 0);
+  assert(got.num_paths == expected.num_paths);
+  for (size_t i = 0; i < got.num_paths; ++i) {
+    const tokenize_test_path_t *g = &got.paths[i], *e = &expected.paths[i];
+    assert(g->offset == e->offset && g->length == e->length);
+    assert(g->num_pairs == e->num_pairs);
+    assert(memcmp(g->pairs, e->pairs,
+                  g->num_pairs * sizeof(token_pair_record_t)) == 0);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: every structural byte at every position of a block
+   ------------------------------------------------------------------------ */
+static const char tokenize_test_frame[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"1920\" "
+    "style=\"a > b < c = d\">\n"
+    "<path fill=\"rgb(0%, 50%, 69%)\" fill-opacity=\"1\" "
+    "d=\"M 460.5 810 C 447 796.5 433.5 783 420 769.5 Z \" data-tag=\"2\"/>\n"
+    "<pattern id=\"p1\" x=\"0\"><image href=\"a\"/></pattern>\n"
+    "<path\n  stroke = \"a<b>c=d\"\td=\"\" data-tag=\"3\" />"
+    "<path d=\"M 0 0\">text<path/><path>\n"
+    "<g clip-path=\"url(#clip1)\"><path d=\"M 1 1 L 2 2\"/></g>\n"
+    "</svg>\n";
+
+static void tokenize_test_match(void) {
+  printf("[match] %s kernel\n", SVG_TOKENIZE_KERNEL);
+  arena_t *arena = arena_alloc();
+  assert(arena);
+
+  /* shift the frame through a block and cut it wherever it stays valid */
+  static tokenize_test_paths_t valid;
+  char buf[2 * SVG_TOKENIZE_BLOCK + sizeof(tokenize_test_frame)];
+  for (size_t shift = 0; shift < 2 * SVG_TOKENIZE_BLOCK; ++shift) {
+    memset(buf, ' ', shift);
+    memcpy(buf + shift, tokenize_test_frame, sizeof(tokenize_test_frame) - 1);
+    const size_t length = shift + sizeof(tokenize_test_frame) - 1;
+    for (size_t cut = shift; cut <= length; ++cut)
+      if (tokenize_test_reference(buf, cut, &valid))
+        tokenize_test_expect(arena, buf, cut);
+  }
+
+  static tokenize_test_paths_t got;
+  got.svg = tokenize_test_frame;
+  got.num_paths = 0;
+  svg_tokenize_paths(arena, tokenize_test_frame,
+                     sizeof(tokenize_test_frame) - 1, tokenize_test_collect,
+                     &got);
+  assert(got.num_paths == 6);
+  const tokenize_test_path_t *p = &got.paths[1];
+  assert(p->num_pairs == 3);
+  assert(memcmp(tokenize_test_frame + p->pairs[0].key_offset, "stroke", 6) ==
+         0);
+  assert(p->pairs[0].key_length == 6);
+  assert(memcmp(tokenize_test_frame + p->pairs[0].value_offset, "a<b>c=d",
+                7) == 0);
+  assert(p->pairs[0].value_length == 7);
+  assert(p->pairs[1].value_length == 0);
+  assert(got.paths[3].num_pairs == 0 && got.paths[4].num_pairs == 0);
+
+  arena_release(arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: cut or broken paths are malformed, callback errors are passed on
+   ------------------------------------------------------------------------ */
+static SvgAnimStatus tokenize_test_fail(void *ctx,
+                                        const token_pair_buffer_t *path) {
+  return ++*(size_t *)ctx == 2 ? SVG_ANIM_STATUS_NO_MEMORY
+                               : SVG_ANIM_STATUS_SUCCESS;
+}
+
+static void tokenize_test_malformed(void) {
+  puts("[malformed]");
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  static tokenize_test_paths_t got;
+
+  const char *frame = tokenize_test_frame;
+  const size_t length = sizeof(tokenize_test_frame) - 1;
+  for (size_t cut = 0; cut < length; ++cut) {
+    static tokenize_test_paths_t expected;
+    got.svg = frame;
+    got.num_paths = 0;
+    const SvgAnimStatus status =
+        svg_tokenize_paths(arena, frame, cut, tokenize_test_collect, &got);
+    assert(status == (tokenize_test_reference(frame, cut, &expected)
+                          ? SVG_ANIM_STATUS_SUCCESS
+                          : SVG_ANIM_STATUS_MALFORMED_SVG));
+    assert(arena_get_pos(arena) == 0);
+  }
+
+  const char *broken[] = {"<path d=M>",        "<path =\"x\">",
+                          "<path d\"x\">",      "<path d=x\"x\">",
+                          "<path d=\"x\" \">", "<path d=\"x\" <path>"};
+  for (size_t i = 0; i < sizeof(broken) / sizeof(broken[0]); ++i) {
+    got.svg = broken[i];
+    got.num_paths = 0;
+    assert(svg_tokenize_paths(arena, broken[i], strlen(broken[i]),
+                              tokenize_test_collect,
+                              &got) == SVG_ANIM_STATUS_MALFORMED_SVG);
+  }
+
+  size_t calls = 0;
+  assert(svg_tokenize_paths(arena, frame, length, tokenize_test_fail,
+                            &calls) == SVG_ANIM_STATUS_NO_MEMORY);
+  assert(calls == 2 && arena_get_pos(arena) == 0);
+
+  arena_release(arena);
+}
+
+/* ---------------------------------------------------------------------------
+   Benchmark: MB/s of svg per core against the byte at a time reference
+   ------------------------------------------------------------------------ */
+static inline uint32_t tokenize_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+/* Frames of cairo-like paths, stroked and filled */
+static char *tokenize_test_generate(const size_t size, size_t *out_length) {
+  char *svg = malloc(size + 4096);
+  assert(svg);
+  uint32_t rng = 1u;
+  size_t length = 0;
+  size_t tag = 0;
+  while (length < size) {
+    length += (size_t)sprintf(
+        svg + length,
+        "<path fill=\"rgb(0%%, %u%%, %u%%)\" fill-opacity=\"1\" d=\"M %u.5 %u ",
+        tokenize_prng_next(&rng) % 100, tokenize_prng_next(&rng) % 100,
+        tokenize_prng_next(&rng) % 1920, tokenize_prng_next(&rng) % 1080);
+    const uint32_t curves = 2 + tokenize_prng_next(&rng) % 12;
+    for (uint32_t c = 0; c < curves && length < size + 2048; ++c)
+      length += (size_t)sprintf(svg + length, "C %u.5 %u %u %u.5 %u %u ",
+                                tokenize_prng_next(&rng) % 1920,
+                                tokenize_prng_next(&rng) % 1080,
+                                tokenize_prng_next(&rng) % 1920,
+                                tokenize_prng_next(&rng) % 1080,
+                                tokenize_prng_next(&rng) % 1920,
+                                tokenize_prng_next(&rng) % 1080);
+    length += (size_t)sprintf(svg + length, "Z \" data-tag=\"%zu\"/>\n", ++tag);
+  }
+  *out_length = length;
+  return svg;
+}
+
+static SvgAnimStatus tokenize_test_count(void *ctx,
+                                         const token_pair_buffer_t *path) {
+  *(size_t *)ctx += path->num_pairs;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static void tokenize_test_bench(const char *path) {
+  size_t length;
+  char *svg;
+  if (path) {
+    FILE *fp = fopen(path, "rb");
+    assert(fp);
+    fseeko(fp, 0, SEEK_END);
+    length = (size_t)ftello(fp);
+    fseeko(fp, 0, SEEK_SET);
+    svg = malloc(length);
+    assert(svg && fread(svg, 1, length, fp) == length);
+    fclose(fp);
+  } else {
+    svg = tokenize_test_generate(TOKENIZE_TEST_BENCH_BYTES, &length);
+  }
+  const double mb = (double)length * TOKENIZE_TEST_PASSES / 1e6;
+  printf("[bench] %.1f MB x %d passes, %s kernel, one core\n",
+         (double)length / 1e6, TOKENIZE_TEST_PASSES, SVG_TOKENIZE_KERNEL);
+
+  /* the reference keeps a frame's worth of paths, feed it one line each */
+  static tokenize_test_paths_t ref;
+  size_t ref_pairs = 0;
+  timespec_t t0 = ts_now();
+  for (int pass = 0; pass < TOKENIZE_TEST_PASSES; ++pass) {
+    for (size_t line = 0; line < length;) {
+      const char *nl = memchr(svg + line, '\n', length - line);
+      const size_t end = nl ? (size_t)(nl - svg) + 1 : length;
+      tokenize_test_reference(svg + line, end - line, &ref);
+      for (size_t i = 0; i < ref.num_paths; ++i)
+        ref_pairs += ref.paths[i].num_pairs;
+      line = end;
+    }
+  }
+  timespec_t t1 = ts_now();
+
+  arena_t *arena = arena_alloc();
+  assert(arena);
+  size_t pairs = 0;
+  for (int pass = 0; pass < TOKENIZE_TEST_PASSES; ++pass)
+    assert(svg_tokenize_paths(arena, svg, length, tokenize_test_count,
+                              &pairs) == SVG_ANIM_STATUS_SUCCESS);
+  timespec_t t2 = ts_now();
+  assert(pairs == ref_pairs);
+
+  const double s_ref = ts_elapsed_sec(t0, t1);
+  const double s_tok = ts_elapsed_sec(t1, t2);
+  printf("  byte at a time    : %8.1f MB/s\n", mb / s_ref);
+  printf("  svg_tokenize_paths: %8.1f MB/s  (%.2fx, %.1f Mpairs/s)\n",
+         mb / s_tok, s_ref / s_tok, (double)pairs / s_tok / 1e6);
+
+  arena_release(arena);
+  free(svg);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   TOKENIZE_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void tokenize_tests_run_all(const char *bench_path) {
+  tokenize_test_match();
+  tokenize_test_malformed();
+  tokenize_test_bench(bench_path);
+  puts("all tokenize tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef TOKENIZE_TEST_MAIN
+int main(const int argc, const char **argv) {
+  tokenize_tests_run_all(argc > 1 ? argv[1] : NULL);
+  return 0;
+}
+#endif /* TOKENIZE_TEST_MAIN */
+
+#endif /* TOKENIZE_TEST_H */
@@ -0,0 +1,291 @@
+/*=============================================================================
+  value_test.h — validation & micro-benchmarks for ir_value.h
+  ---------------------------------------------------------------------------
+  Usage:
+      #define VALUE_TEST_MAIN      // <- optional: gives you a main() driver
+      #include "value_test.h"
+
+      $ cc -O3 -std=gnu17 value_test.c ir/src/ir_value.c ir/src/ir_path.c \
+            -lm -o value_test
+      $ ./value_test
+=============================================================================*/
+#ifndef VALUE_TEST_H
+#define VALUE_TEST_H
+
+#include "common/core.h"
+#include "ctrs/intern.h"
+#include "ir/ir.h"
+#include "ir/ir_value.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ---------------------------------------------------------------------------
+   Tunables
+   ------------------------------------------------------------------------ */
+#ifndef VALUE_TEST_ITERATIONS /* numbers parsed in the perf test */
+#define VALUE_TEST_ITERATIONS (1u << 20) /* 1 048 576 */
+#endif
+
+static bool value_test_number(const char *text, float *out) {
+  return ir_parse_number(text, strlen(text), out);
+}
+
+static bool value_test_color(const char *text, uint32_t *out) {
+  return ir_parse_color(text, strlen(text), out);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: numbers agree with strtof, anything with a tail is rejected
+   ------------------------------------------------------------------------ */
+static void value_test_numbers(void) {
+  puts("[numbers]");
+  static const char *const good[] = {
+      "0",       "1",        "-1",          "+2",       "42",
+      "3.25",    "-0.5",     ".5",          "5.",       "1e3",
+      "1E-3",    "-2.5e+2",  "0.000123456", "1.5e-40",  "123456789",
+      "0.1",     "0.7",      "1.0000001",   "3.4e38",   " 7 ",
+      "\t-8.75", "0.006250", "-0.0",        "00012.50", "12345678901234567890123"};
+  for (size_t i = 0; i < sizeof(good) / sizeof(good[0]); ++i) {
+    float parsed;
+    assert(value_test_number(good[i], &parsed));
+    const float expected = strtof(good[i], NULL);
+    assert(parsed == expected || fabsf(parsed - expected) <=
+                                     fabsf(expected) * 1e-7f);
+  }
+
+  static const char *const bad[] = {"",    " ",    "-",    ".",  "+.",
+                                    "1e",  "1e+",  "1.2.3", "12px", "1 2",
+                                    "--1", "0x10", "nan",  "inf", "4e39"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+    float parsed = 123.0f;
+    assert(!value_test_number(bad[i], &parsed));
+    assert(parsed == 123.0f);
+  }
+
+  /* only length bytes are read */
+  float parsed;
+  assert(ir_parse_number("2.5junk", 3, &parsed) && parsed == 2.5f);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: colors as cairo writes them and as hex
+   ------------------------------------------------------------------------ */
+static void value_test_colors(void) {
+  puts("[colors]");
+  uint32_t rgba;
+  assert(value_test_color("rgb(0%, 50.196078%, 69.803922%)", &rgba));
+  assert(rgba == IR_RGBA(0, 128, 178, 255));
+  assert(value_test_color("rgb(100%,100%,100%)", &rgba));
+  assert(rgba == IR_RGBA(255, 255, 255, 255));
+  assert(value_test_color("rgb(0, 128, 178)", &rgba));
+  assert(rgba == IR_RGBA(0, 128, 178, 255));
+  assert(value_test_color(" rgb( 1 ,2 , 3 ) ", &rgba));
+  assert(rgba == IR_RGBA(1, 2, 3, 255));
+  assert(value_test_color("rgb(300, -4, 120%)", &rgba));
+  assert(rgba == IR_RGBA(255, 0, 255, 255));
+  assert(value_test_color("#abc", &rgba));
+  assert(rgba == IR_RGBA(0xaa, 0xbb, 0xcc, 255));
+  assert(value_test_color("#A0B1c2", &rgba));
+  assert(rgba == IR_RGBA(0xa0, 0xb1, 0xc2, 255));
+
+  static const char *const bad[] = {
+      "",           "none",          "#",           "#ab",
+      "#abcd",      "#abcdeg",       "#gbc",        "rgb(1, 2)",
+      "rgb(1,2,3",  "rgb(1, 2, 3)x", "rgb(1 2 3)",  "rgba(1, 2, 3, 1)",
+      "rgb(a,b,c)", "url(#grad)",    "currentColor"};
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+    rgba = 7;
+    assert(!value_test_color(bad[i], &rgba));
+    assert(rgba == 7);
+  }
+}
+
+/* ---------------------------------------------------------------------------
+   Test 3: keywords round trip, typed parse falls back to strings
+   ------------------------------------------------------------------------ */
+static void value_test_keywords(void) {
+  puts("[keywords / fallback]");
+  for (size_t keyword = 0; keyword < NUM_KEYWORDS; ++keyword) {
+    const char *name = ir_keyword_name((ir_keyword_e)keyword);
+    ir_keyword_e found;
+    assert(ir_keyword_lookup(name, strlen(name), &found));
+    assert(found == (ir_keyword_e)keyword);
+  }
+  ir_keyword_e found;
+  assert(!ir_keyword_lookup("non", 3, &found));
+  assert(!ir_keyword_lookup("None", 4, &found));
+  assert(!ir_keyword_lookup("", 0, &found));
+  assert(ir_keyword_lookup(" round ", 7, &found) && found == KEYWORD_ROUND);
+
+  intern_pool_t *strings = intern_create();
+  ir_path_store_t *paths = ir_path_store_create();
+  assert(strings && paths);
+
+  ir_value_t value;
+#define PARSE(kind, text)                                                      \
+  ir_value_parse(kind, text, strlen(text), strings, paths, &value)
+  assert(PARSE(ATTR_VALUE_NUMBER, "0.75") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_NUMBER && value.number == 0.75f);
+  assert(PARSE(ATTR_VALUE_COLOR, "rgb(100%, 0%, 0%)") ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_COLOR && value.rgba == IR_RGBA(255, 0, 0, 255));
+  assert(PARSE(ATTR_VALUE_COLOR, "none") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_KEYWORD && value.keyword == KEYWORD_NONE);
+  assert(PARSE(ATTR_VALUE_KEYWORD, "evenodd") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_KEYWORD && value.keyword == KEYWORD_EVENODD);
+
+  /* a unit, a url() paint and an unknown keyword are kept as text */
+  assert(PARSE(ATTR_VALUE_NUMBER, "12px") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_STRING && value.string_id == 0);
+  assert(PARSE(ATTR_VALUE_COLOR, "url(#grad)") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_STRING && value.string_id == 1);
+  assert(PARSE(ATTR_VALUE_KEYWORD, "sideways") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_STRING && value.string_id == 2);
+  assert(PARSE(ATTR_VALUE_NUMBER, "12px") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_STRING && value.string_id == 0);
+  assert(strcmp(intern_get(strings, 1, NULL), "url(#grad)") == 0);
+
+  /* path data goes to its own pool */
+  assert(PARSE(ATTR_VALUE_PATH, "M 0 0 L 1 1 Z") == SVG_ANIM_STATUS_SUCCESS);
+  assert(value.type == IR_VALUE_PATH && value.path_id == 0);
+  assert(ir_path_store_get(paths, value.path_id)->num_commands == 3);
+  assert(PARSE(ATTR_VALUE_PATH, "M 0 0 X") == SVG_ANIM_STATUS_MALFORMED_SVG);
+  assert(strings->count == 3 && paths->count == 1);
+#undef PARSE
+
+  intern_destroy(strings);
+  ir_path_store_destroy(paths);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 4: equality, numbers within a tolerance
+   ------------------------------------------------------------------------ */
+static void value_test_equal(void) {
+  puts("[equal]");
+  const ir_value_t a = {.type = IR_VALUE_NUMBER, .number = 1.0f};
+  const ir_value_t b = {.type = IR_VALUE_NUMBER, .number = 1.0004f};
+  const ir_value_t c = {.type = IR_VALUE_NUMBER, .number = 1.01f};
+  assert(ir_value_equal(&a, NULL, &a, NULL, 0.0f));
+  assert(!ir_value_equal(&a, NULL, &b, NULL, 0.0f));
+  assert(ir_value_equal(&a, NULL, &b, NULL, 1e-3f));
+  assert(!ir_value_equal(&a, NULL, &c, NULL, 1e-3f));
+
+  const ir_value_t red = {.type = IR_VALUE_COLOR,
+                          .rgba = IR_RGBA(255, 0, 0, 255)};
+  const ir_value_t red_id = {.type = IR_VALUE_STRING,
+                             .string_id = IR_RGBA(255, 0, 0, 255)};
+  assert(ir_value_equal(&red, NULL, &red, NULL, 0.0f));
+  assert(!ir_value_equal(&red, NULL, &red_id, NULL, 0.0f));
+
+  const ir_value_t none = {.type = IR_VALUE_KEYWORD, .keyword = KEYWORD_NONE};
+  const ir_value_t round = {.type = IR_VALUE_KEYWORD,
+                            .keyword = KEYWORD_ROUND};
+  assert(!ir_value_equal(&none, NULL, &round, NULL, 1.0f));
+
+  /* paths by geometry, whichever store and id they came from */
+  ir_path_store_t *frame_a = ir_path_store_create();
+  ir_path_store_t *frame_b = ir_path_store_create();
+  assert(frame_a && frame_b);
+  ir_value_t pa, pb, pc, pd;
+#define PARSE_PATH(store, text, value)                                         \
+  ir_value_parse(ATTR_VALUE_PATH, text, strlen(text), NULL, store, value)
+  assert(PARSE_PATH(frame_a, "M 0 0 L 1 1 Z", &pa) == SVG_ANIM_STATUS_SUCCESS);
+  assert(PARSE_PATH(frame_b, "M 5 5", &pc) == SVG_ANIM_STATUS_SUCCESS);
+  assert(PARSE_PATH(frame_b, "m 0 0 l 1 1.0004 z", &pb) ==
+         SVG_ANIM_STATUS_SUCCESS);
+  assert(PARSE_PATH(frame_a, "M 0 0 L 1 1", &pd) == SVG_ANIM_STATUS_SUCCESS);
+#undef PARSE_PATH
+  assert(ir_value_equal(&pa, frame_a, &pa, frame_a, 0.0f));
+  assert(!ir_value_equal(&pa, frame_a, &pb, frame_b, 0.0f));
+  assert(ir_value_equal(&pa, frame_a, &pb, frame_b, 1e-3f));
+  /* same id in another store is another path */
+  assert(pa.path_id == pc.path_id);
+  assert(!ir_value_equal(&pa, frame_a, &pc, frame_b, 1.0f));
+  /* same coordinates, one command more */
+  assert(!ir_value_equal(&pa, frame_a, &pd, frame_a, 1.0f));
+  ir_path_store_destroy(frame_a);
+  ir_path_store_destroy(frame_b);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 5: micro-benchmark, ir_parse_number against strtof
+   ------------------------------------------------------------------------ */
+static inline uint32_t value_prng_next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+static void value_test_perf(const size_t count) {
+  printf("[perf] %zu numbers\n", count);
+
+  /* what cairo writes for widths, opacities and coordinates */
+  char *numbers = malloc(count * 16);
+  uint8_t *lengths = malloc(count);
+  if (!numbers || !lengths) {
+    fputs("out of memory\n", stderr);
+    exit(EXIT_FAILURE);
+  }
+  uint32_t rng = 1u;
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t r = value_prng_next(&rng);
+    lengths[i] = (uint8_t)snprintf(numbers + i * 16, 16, "%s%u.%06u",
+                                   r & 1 ? "-" : "", r % 2000 >> 1, r % 999983);
+  }
+
+  float sum = 0.0f;
+  const timespec_t t0 = ts_now();
+  for (size_t i = 0; i < count; ++i) {
+    float value;
+    assert(ir_parse_number(numbers + i * 16, lengths[i], &value));
+    sum += value;
+  }
+  const timespec_t t1 = ts_now();
+  float sum_strtof = 0.0f;
+  for (size_t i = 0; i < count; ++i)
+    sum_strtof += strtof(numbers + i * 16, NULL);
+  const timespec_t t2 = ts_now();
+  assert(fabsf(sum - sum_strtof) <= fabsf(sum_strtof) * 1e-3f + 1.0f);
+
+  const double s_parse = ts_elapsed_sec(t0, t1);
+  const double s_strtof = ts_elapsed_sec(t1, t2);
+  printf("  ir_parse_number : %.1f ns/op\n", s_parse * 1e9 / count);
+  printf("  strtof          : %.1f ns/op  (%.2fx)\n", s_strtof * 1e9 / count,
+         s_strtof / s_parse);
+
+  free(numbers);
+  free(lengths);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   VALUE_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void value_tests_run_all(void) {
+  value_test_numbers();
+  value_test_colors();
+  value_test_keywords();
+  value_test_equal();
+  value_test_perf(VALUE_TEST_ITERATIONS);
+  puts("all value tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef VALUE_TEST_MAIN
+int main(void) {
+  value_tests_run_all();
+  return 0;
+}
+#endif /* VALUE_TEST_MAIN */
+
+#endif /* VALUE_TEST_H */
@@ -0,0 +1,95 @@
+#ifndef SVGANIM_H
+#define SVGANIM_H
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * ===================================
+ *            LIBSVGANIM
+ * ===================================
+ */
+
+/**
+ * In-process interface to the compiler, for the exporter (through ctypes) and
+ * for services compiling many scenes in one process. Frames are pushed from
+ * memory as the exporter produces them, nothing touches the disk.
+ *
+ *   session = svganim_open(header, header_size, 0);
+ *   for each frame: svganim_push_frame(session, frame, frame_size);
+ *   svganim_finish(session);
+ *   read svganim_frame_svg(session, i, &length) and svganim_defs_svg(...)
+ *   svganim_close(session);
+ *
+ * The header and frame bytes are exactly what the exporter writes to a data
+ * binary, see manim_fe.h. Frames are rendered during the push and their svgs
+ * kept until the session is closed, ir is left to the caller.
+ *
+ * A session is used by one thread at a time, separate sessions may run on
+ * separate threads. Only plain C types cross this interface.
+ */
+
+#if defined(_WIN32)
+#define SVGANIM_API __declspec(dllexport)
+#else
+#define SVGANIM_API __attribute__((visibility("default")))
+#endif
+
+/** Flags of svganim_open **/
+#define SVGANIM_RENDERER_DIRECT (1u << 0)
+#define SVGANIM_CAIRO_FRAME_SURFACE (1u << 1)
+#define SVGANIM_NO_RENDER_CACHE (1u << 2)
+
+typedef struct svganim_session_t svganim_session_t;
+
+/**
+ * @brief Starts a scene.
+ *
+ * @param header File header of the scene, only read during the call.
+ * @param flags SVGANIM_* flags, 0 for the defaults of the command line.
+ * @return The session, or NULL if the header is malformed or memory ran out.
+ */
+SVGANIM_API svganim_session_t *svganim_open(const void *header,
+                                            size_t header_size,
+                                            uint32_t flags);
+
+/**
+ * @brief Renders the next frame of the scene.
+ *
+ * @param frame One frame record, only read during the call.
+ * @return 0 on success, 1 on failure, see svganim_error. The session takes no
+ * more frames after a failure.
+ */
+SVGANIM_API int svganim_push_frame(svganim_session_t *session,
+                                   const void *frame, size_t frame_size);
+
+/**
+ * @brief Ends the scene and emits the gradient <defs> the frames share.
+ *
+ * @return 0 on success, 1 on failure, see svganim_error.
+ */
+SVGANIM_API int svganim_finish(svganim_session_t *session);
+
+SVGANIM_API size_t svganim_frame_count(const svganim_session_t *session);
+
+/**
+ * @return Tagged svg of frame frame_num, not NUL terminated, valid until the
+ * session is closed. NULL if there is no such frame.
+ */
+SVGANIM_API const char *svganim_frame_svg(const svganim_session_t *session,
+                                          size_t frame_num,
+                                          size_t *out_length);
+
+/**
+ * @return The shared <defs>, empty before svganim_finish.
+ */
+SVGANIM_API const char *svganim_defs_svg(const svganim_session_t *session,
+                                         size_t *out_length);
+
+/**
+ * @return Why the last call failed, empty if nothing failed.
+ */
+SVGANIM_API const char *svganim_error(const svganim_session_t *session);
+
+SVGANIM_API void svganim_close(svganim_session_t *session);
+
+#endif // SVGANIM_H
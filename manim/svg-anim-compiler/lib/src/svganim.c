@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common/arena.h"
+#include "common/core.h"
+#include "manim/manim_fe.h"
+#include "svganim/svganim.h"
+
+struct svganim_session_t {
+  manim_fe_session_t fe;
+
+  /** Every frame's svg and its record, kept until close **/
+  arena_t *svg_arena;
+  arena_t *record_arena;
+  svg_record_t defs;
+
+  char error[128];
+};
+
+static SvgAnimStatus svganim_sink_frame(void *ctx, const size_t frame_num,
+                                        const size_t offset,
+                                        const size_t length) {
+  svganim_session_t *session = ctx;
+  svg_record_t *record = arena_push_struct(session->record_arena, svg_record_t);
+  if (!record)
+    return SVG_ANIM_STATUS_NO_MEMORY;
+  record->offset = offset;
+  record->length = length;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static SvgAnimStatus svganim_sink_defs(void *ctx, const size_t offset,
+                                       const size_t length) {
+  svganim_session_t *session = ctx;
+  session->defs.offset = offset;
+  session->defs.length = length;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static const char *svganim_status_message(const SvgAnimStatus status) {
+  switch (status) {
+  case SVG_ANIM_STATUS_SUCCESS:
+    return "success";
+  case SVG_ANIM_STATUS_NO_MEMORY:
+    return "out of memory";
+  case SVG_ANIM_STATUS_MALFORMED_SVG:
+    return "malformed svg";
+  case SVG_ANIM_STATUS_IO_ERROR:
+    return "i/o error";
+  }
+  return "unknown status";
+}
+
+/** Records why the session stopped, returns 1 for the caller to pass on **/
+static int svganim_fail(svganim_session_t *session, const char *what) {
+  if (session->fe.sink_status != SVG_ANIM_STATUS_SUCCESS)
+    snprintf(session->error, sizeof(session->error), "%s: %s", what,
+             svganim_status_message(session->fe.sink_status));
+  else
+    snprintf(session->error, sizeof(session->error), "%s", what);
+  return 1;
+}
+
+svganim_session_t *svganim_open(const void *header, const size_t header_size,
+                                const uint32_t flags) {
+  svganim_session_t *session = calloc(1, sizeof(*session));
+  if (!session)
+    return NULL;
+  session->svg_arena = arena_alloc();
+  session->record_arena = arena_alloc();
+  if (!session->svg_arena || !session->record_arena) {
+    svganim_close(session);
+    return NULL;
+  }
+
+  manim_fe_opts_t opts = manim_fe_opts_default();
+  if (flags & SVGANIM_RENDERER_DIRECT)
+    opts.renderer = MANIM_RENDERER_DIRECT;
+  if (flags & SVGANIM_CAIRO_FRAME_SURFACE)
+    opts.cairo_surface_mode = MANIM_CAIRO_SURFACE_PER_FRAME;
+  if (flags & SVGANIM_NO_RENDER_CACHE)
+    opts.render_cache = false;
+
+  const manim_fe_sink_t sink = {.svg_arena = session->svg_arena,
+                                .ctx = session,
+                                .frame = svganim_sink_frame,
+                                .defs = svganim_sink_defs};
+  if (!manim_fe_session_open(&session->fe, header, header_size, &opts,
+                             &sink)) {
+    svganim_close(session);
+    return NULL;
+  }
+  return session;
+}
+
+int svganim_push_frame(svganim_session_t *session, const void *frame,
+                       const size_t frame_size) {
+  // error still says why the session stopped
+  if (session->fe.failed)
+    return 1;
+  if (session->fe.finished)
+    return svganim_fail(session, "frame pushed after svganim_finish");
+  if (!manim_fe_session_push(&session->fe, frame, frame_size))
+    return svganim_fail(session, "frame could not be decoded or rendered");
+  return 0;
+}
+
+int svganim_finish(svganim_session_t *session) {
+  if (session->fe.failed)
+    return 1;
+  if (!manim_fe_session_finish(&session->fe))
+    return svganim_fail(session, "scene could not be finished");
+  return 0;
+}
+
+size_t svganim_frame_count(const svganim_session_t *session) {
+  return session->fe.num_frames;
+}
+
+const char *svganim_frame_svg(const svganim_session_t *session,
+                              const size_t frame_num, size_t *out_length) {
+  if (frame_num >= session->fe.num_frames)
+    return NULL;
+  const svg_record_t *record =
+      (const svg_record_t *)session->record_arena->base + frame_num;
+  *out_length = record->length;
+  return (const char *)session->svg_arena->base + record->offset;
+}
+
+const char *svganim_defs_svg(const svganim_session_t *session,
+                             size_t *out_length) {
+  *out_length = session->defs.length;
+  return (const char *)session->svg_arena->base + session->defs.offset;
+}
+
+const char *svganim_error(const svganim_session_t *session) {
+  return session->error;
+}
+
+void svganim_close(svganim_session_t *session) {
+  if (!session)
+    return;
+  manim_fe_session_close(&session->fe);
+  if (session->record_arena)
+    arena_release(session->record_arena);
+  if (session->svg_arena)
+    arena_release(session->svg_arena);
+  free(session);
+}
@@ -0,0 +1,179 @@
+/*=============================================================================
+  svganim_test.h — libsvganim against the file driver
+  ---------------------------------------------------------------------------
+  Usage:
+      #define SVGANIM_TEST_MAIN    // <- optional: gives you a main() driver
+      #include "svganim_test.h"
+
+      $ cc -O2 -std=gnu17 -pthread svganim_test.c lib/src/svganim.c \
+           frontends/src/manim_*.c -lcairo -lm \
+           -o svganim_test
+      $ ./svganim_test scene.dat
+
+  The data binary is split into its header and frames with the reader's frame
+  index, pushed through a session frame by frame, and every svg and the defs
+  are compared with what manim_fe_driver renders from the file.
+=============================================================================*/
+#ifndef SVGANIM_TEST_H
+#define SVGANIM_TEST_H
+
+#include "common/core.h"
+#include "manim/manim_fe.h"
+#include "svganim/svganim.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static unsigned char *svganim_test_slurp(const char *path, size_t *out_size) {
+  FILE *fp = fopen(path, "rb");
+  assert(fp);
+  fseeko(fp, 0, SEEK_END);
+  *out_size = (size_t)ftello(fp);
+  fseeko(fp, 0, SEEK_SET);
+  unsigned char *data = malloc(*out_size);
+  assert(data && fread(data, 1, *out_size, fp) == *out_size);
+  fclose(fp);
+  return data;
+}
+
+/* ---------------------------------------------------------------------------
+   Test 1: pushed frames render exactly like the file
+   ------------------------------------------------------------------------ */
+static void svganim_test_matches_driver(const char *path, const uint32_t flags) {
+  printf("[matches driver, flags %u]\n", flags);
+  size_t size;
+  unsigned char *data = svganim_test_slurp(path, &size);
+
+  /* frame boundaries from the reader's index */
+  manim_reader_t reader;
+  arena_t *index_arena = arena_alloc();
+  manim_frame_index_t index;
+  assert(manim_reader_open(&reader, path, MANIM_INPUT_STREAM));
+  assert(manim_reader_build_index(&reader, index_arena, &index));
+  manim_reader_close(&reader);
+  assert(index.num_frames > 0);
+
+  svganim_session_t *session = svganim_open(data, index.offsets[0], flags);
+  assert(session);
+  for (size_t i = 0; i < index.num_frames; ++i) {
+    const size_t end =
+        i + 1 < index.num_frames ? index.offsets[i + 1] : size;
+    assert(svganim_push_frame(session, data + index.offsets[i],
+                              end - index.offsets[i]) == 0);
+  }
+  assert(svganim_finish(session) == 0);
+  assert(svganim_frame_count(session) == index.num_frames);
+
+  manim_fe_opts_t opts = manim_fe_opts_default();
+  if (flags & SVGANIM_RENDERER_DIRECT)
+    opts.renderer = MANIM_RENDERER_DIRECT;
+  if (flags & SVGANIM_NO_RENDER_CACHE)
+    opts.render_cache = false;
+  arena_t *blob_arena = arena_alloc();
+  arena_t *record_arena = arena_alloc();
+  svg_frames_t *expected;
+  assert(manim_fe_driver(blob_arena, record_arena, path, &opts, &expected) ==
+         0);
+  assert(expected->num_frames == index.num_frames);
+
+  for (size_t i = 0; i < index.num_frames; ++i) {
+    size_t length;
+    const char *svg = svganim_frame_svg(session, i, &length);
+    assert(svg && length == expected->frames[i].length);
+    assert(memcmp(svg, svg_get_data(expected, i), length) == 0);
+  }
+  size_t defs_length;
+  const char *defs = svganim_defs_svg(session, &defs_length);
+  assert(defs_length == expected->defs.length);
+  assert(memcmp(defs, (const char *)expected->blob + expected->defs.offset,
+                defs_length) == 0);
+  assert(svganim_frame_svg(session, index.num_frames, &defs_length) == NULL);
+
+  svganim_close(session);
+  arena_release(blob_arena);
+  arena_release(record_arena);
+  arena_release(index_arena);
+  free(data);
+}
+
+/* ---------------------------------------------------------------------------
+   Test 2: malformed input fails the call and says why
+   ------------------------------------------------------------------------ */
+static void svganim_test_errors(const char *path) {
+  puts("[errors]");
+  size_t size;
+  unsigned char *data = svganim_test_slurp(path, &size);
+
+  manim_reader_t reader;
+  arena_t *index_arena = arena_alloc();
+  manim_frame_index_t index;
+  assert(manim_reader_open(&reader, path, MANIM_INPUT_STREAM));
+  assert(manim_reader_build_index(&reader, index_arena, &index));
+  manim_reader_close(&reader);
+  const size_t header_size = index.offsets[0];
+  const size_t frame_size =
+      (index.num_frames > 1 ? index.offsets[1] : size) - header_size;
+
+  /* truncated or garbage headers never open */
+  assert(svganim_open(data, 4, 0) == NULL);
+  assert(svganim_open("garbage garbage garbage garbage garbage garbage "
+                      "garbage garbage",
+                      64, 0) == NULL);
+
+  /* a truncated frame, then nothing more is taken */
+  svganim_session_t *session = svganim_open(data, header_size, 0);
+  assert(session && svganim_error(session)[0] == '\0');
+  assert(svganim_push_frame(session, data + header_size, frame_size - 1) == 1);
+  assert(svganim_error(session)[0] != '\0');
+  assert(svganim_push_frame(session, data + header_size, frame_size) == 1);
+  assert(svganim_frame_count(session) == 0);
+  svganim_close(session);
+
+  /* trailing bytes are not a frame either, pushing after finish fails */
+  session = svganim_open(data, header_size, 0);
+  assert(svganim_push_frame(session, data + header_size,
+                            index.num_frames > 1 ? frame_size + 1
+                                                 : frame_size) ==
+         (index.num_frames > 1));
+  svganim_close(session);
+
+  session = svganim_open(data, header_size, 0);
+  assert(svganim_push_frame(session, data + header_size, frame_size) == 0);
+  assert(svganim_finish(session) == 0);
+  assert(svganim_push_frame(session, data + header_size, frame_size) == 1);
+  assert(svganim_frame_count(session) == 1);
+  svganim_close(session);
+
+  arena_release(index_arena);
+  free(data);
+}
+
+/* ---------------------------------------------------------------------------
+   Public driver – call this from your unit-test harness or enable the
+   SVGANIM_TEST_MAIN block below.
+   ------------------------------------------------------------------------ */
+static inline void svganim_tests_run_all(const char *path) {
+  svganim_test_matches_driver(path, 0);
+  svganim_test_matches_driver(path, SVGANIM_NO_RENDER_CACHE);
+  svganim_test_matches_driver(path, SVGANIM_RENDERER_DIRECT);
+  svganim_test_errors(path);
+  puts("all svganim tests passed");
+}
+
+/* ---------------------------------------------------------------------------
+   Optional standalone runner
+   ------------------------------------------------------------------------ */
+#ifdef SVGANIM_TEST_MAIN
+int main(const int argc, const char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <data binary>\n", argv[0]);
+    return 1;
+  }
+  svganim_tests_run_all(argv[1]);
+  return 0;
+}
+#endif /* SVGANIM_TEST_MAIN */
+
+#endif /* SVGANIM_TEST_H */
@@ -1,16 +1,236 @@
 ﻿#include "ir/gen_ir.h"
 #include "ir/ir.h"
 #include "manim/manim_fe.h"
+#include "manim/manim_io.h"
 
+#include <ctype.h>
+#include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void print_usage(const char *prog) {
+  fprintf(stderr,
+          "Usage: %s [options] <inDataFile>\n"
+          "  --mmap                     map the input instead of reading it\n"
+          "  --ring                     read the input live from the ring\n"
+          "                             <inDataFile> names, see manim_ring.h\n"
+          "  --uring                    read ahead and write through io_uring\n"
+          "                             where available, see manim_io.h\n"
+          "  --renderer cairo|direct    path renderer (default cairo)\n"
+          "  --cairo-surface vmo|frame  cairo surface per vmo or per frame\n"
+          "  --no-render-cache          re-render vmos unchanged across frames\n"
+          "  --threads n                render frames on n threads\n"
+          "  --frames a..b              only emit frames a through b\n"
+          "  --pipeline                 decode, render and generate ir on\n"
+          "                             separate threads\n"
+          "  --batch                    render every frame before generating\n"
+          "                             ir instead of streaming frame by frame\n"
+          "  --svg-out path             write every frame's svg to path, one\n"
+          "                             frame per line, then the shared\n"
+          "                             gradient <defs> (streaming only)\n",
+          prog);
+}
+
+/**
+ * Reads the decimal number at str, which has to start with a digit. strtoull
+ * alone skips spaces and takes a sign, so "-1" would wrap around.
+ */
+static int parse_unsigned(const char *str, size_t *out, char **end) {
+  if (!isdigit((unsigned char)*str))
+    return 0;
+  errno = 0;
+  *out = strtoull(str, end, 10);
+  return errno == 0;
+}
+
+/**
+ * Parses a frame range of the form "a..b", "a.." or "a" (inclusive).
+ */
+static int parse_frame_range(const char *str, manim_fe_opts_t *opts) {
+  char *end;
+  if (!parse_unsigned(str, &opts->frame_begin, &end))
+    return 0;
+
+  if (*end == '\0') {
+    opts->frame_end = opts->frame_begin;
+    return 1;
+  }
+  if (strncmp(end, "..", 2) != 0)
+    return 0;
+
+  str = end + 2;
+  if (*str == '\0') {
+    opts->frame_end = MANIM_FE_FRAME_END;
+    return 1;
+  }
+  return parse_unsigned(str, &opts->frame_end, &end) && *end == '\0' &&
+         opts->frame_end >= opts->frame_begin;
+}
+
+/**
+ * Carries each frame from the frontend through ir generation, then drops it.
+ */
+typedef struct stream_ctx_t {
+  arena_t *svg_arena;
+  arena_t *ir_arena;
+  gen_ir_t gen;
+  /** --svg-out, NULL without **/
+  manim_io_writer_t *svg_out;
+} stream_ctx_t;
+
+/** Writes one line of svg to --svg-out **/
+static SvgAnimStatus stream_svg_out(stream_ctx_t *stream, const char *svg,
+                                    const size_t length) {
+  if (stream->svg_out && (!manim_io_writer_write(stream->svg_out, svg, length) ||
+                          !manim_io_writer_write(stream->svg_out, "\n", 1)))
+    return SVG_ANIM_STATUS_IO_ERROR;
+  return SVG_ANIM_STATUS_SUCCESS;
+}
+
+static SvgAnimStatus stream_frame(void *ctx, const size_t frame_num,
+                                  const size_t offset, const size_t length) {
+  stream_ctx_t *stream = ctx;
+  const char *svg = (const char *)stream->svg_arena->base + offset;
+  SvgAnimStatus status = stream_svg_out(stream, svg, length);
+  if (status == SVG_ANIM_STATUS_SUCCESS)
+    status = gen_ir_frame(&stream->gen, svg, length);
+
+  // The backend consumes a frame's ops here, nothing of the frame is needed
+  // past this point
+  arena_clear(stream->svg_arena);
+  arena_clear(stream->ir_arena);
+  return status;
+}
+
+/**
+ * The gradient <defs> shared by every frame, written after the last frame.
+ * They are not a frame, so they only go to --svg-out.
+ */
+static SvgAnimStatus stream_defs(void *ctx, const size_t offset,
+                                 const size_t length) {
+  stream_ctx_t *stream = ctx;
+  const char *defs = (const char *)stream->svg_arena->base + offset;
+  // Frames without gradients have no defs
+  const SvgAnimStatus status = length == 0
+                                   ? SVG_ANIM_STATUS_SUCCESS
+                                   : stream_svg_out(stream, defs, length);
+  arena_clear(stream->svg_arena);
+  return status;
+}
+
+static int run_streaming(const char *in_data_file,
+                         const manim_fe_opts_t *fe_opts, const char *svg_out,
+                         const bool use_uring) {
+  stream_ctx_t stream = {.svg_arena = arena_alloc(), .ir_arena = arena_alloc()};
+  if (!stream.svg_arena || !stream.ir_arena ||
+      gen_ir_init(&stream.gen, stream.ir_arena) != SVG_ANIM_STATUS_SUCCESS)
+    return 1;
+  if (svg_out) {
+    stream.svg_out = manim_io_writer_open(svg_out, use_uring);
+    if (!stream.svg_out) {
+      perror("svg output open failed");
+      return 1;
+    }
+  }
+
+  const manim_fe_sink_t sink = {.svg_arena = stream.svg_arena,
+                                .ctx = &stream,
+                                .frame = stream_frame,
+                                .defs = stream_defs};
+  size_t num_frames;
+  int rc = manim_fe_stream(in_data_file, fe_opts, &sink, &num_frames);
+  if (stream.svg_out && !manim_io_writer_close(stream.svg_out)) {
+    perror("svg output write failed");
+    rc = 1;
+  }
+
+  // Arenas keep their pages committed, so this is the high-water mark
+  printf("Streamed %zu frames, peak svg %zu KiB, peak ir %zu KiB, %u distinct "
+         "text values\n",
+         num_frames, stream.svg_arena->committed >> 10,
+         stream.ir_arena->committed >> 10, stream.gen.values->count);
+
+  gen_ir_release(&stream.gen);
+  arena_release(stream.svg_arena);
+  arena_release(stream.ir_arena);
+  return rc;
+}
+
 int main(const int argc, const char **argv) {
-  
-    if (argc != 2) {
-      fprintf(stderr, "Usage: %s <inDataFile>\n", argv[0]);
+
+  manim_fe_opts_t fe_opts = manim_fe_opts_default();
+  const char *in_data_file = NULL;
+  bool batch = false;
+  bool use_uring = false;
+  const char *svg_out = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--mmap") == 0) {
+      fe_opts.input_mode = MANIM_INPUT_MMAP;
+    } else if (strcmp(argv[i], "--ring") == 0) {
+      fe_opts.input_mode = MANIM_INPUT_RING;
+    } else if (strcmp(argv[i], "--uring") == 0) {
+      use_uring = true;
+    } else if (strcmp(argv[i], "--renderer") == 0 && i + 1 < argc) {
+      const char *renderer = argv[++i];
+      if (strcmp(renderer, "cairo") == 0) {
+        fe_opts.renderer = MANIM_RENDERER_CAIRO;
+      } else if (strcmp(renderer, "direct") == 0) {
+        fe_opts.renderer = MANIM_RENDERER_DIRECT;
+      } else {
+        print_usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--cairo-surface") == 0 && i + 1 < argc) {
+      const char *surface_mode = argv[++i];
+      if (strcmp(surface_mode, "vmo") == 0) {
+        fe_opts.cairo_surface_mode = MANIM_CAIRO_SURFACE_PER_VMO;
+      } else if (strcmp(surface_mode, "frame") == 0) {
+        fe_opts.cairo_surface_mode = MANIM_CAIRO_SURFACE_PER_FRAME;
+      } else {
+        print_usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--no-render-cache") == 0) {
+      fe_opts.render_cache = false;
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      char *end;
+      if (!parse_unsigned(argv[++i], &fe_opts.num_threads, &end) ||
+          *end != '\0' || fe_opts.num_threads == 0) {
+        print_usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      if (!parse_frame_range(argv[++i], &fe_opts)) {
+        print_usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--pipeline") == 0) {
+      fe_opts.pipeline = true;
+    } else if (strcmp(argv[i], "--batch") == 0) {
+      batch = true;
+    } else if (strcmp(argv[i], "--svg-out") == 0 && i + 1 < argc) {
+      svg_out = argv[++i];
+    } else if (argv[i][0] != '-' && !in_data_file) {
+      in_data_file = argv[i];
+    } else {
+      print_usage(argv[0]);
       return 1;
     }
-  
-  const char *in_data_file = argv[1];
+  }
+
+  if (!in_data_file || (batch && svg_out)) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  // --mmap and --ring keep their own input
+  if (use_uring && fe_opts.input_mode == MANIM_INPUT_STREAM)
+    fe_opts.input_mode = MANIM_INPUT_URING;
+
+  if (!batch)
+    return run_streaming(in_data_file, &fe_opts, svg_out, use_uring);
 
   /** Set up arenas **/
   arena_t *svg_frames_blob_arena = arena_alloc();
@@ -19,8 +239,9 @@ int main(const int argc, const char **argv) {
 
   // svg_frames will be allocated and pass out by the driver
   svg_frames_t *svg_frames;
-  manim_fe_driver(svg_frames_blob_arena, svg_frames_record_arena, in_data_file,
-                  &svg_frames);
+  if (manim_fe_driver(svg_frames_blob_arena, svg_frames_record_arena,
+                      in_data_file, &fe_opts, &svg_frames) != 0)
+    return 1;
 
   ir_op_frames_t *ir_op_frames;
   gen_ir_driver(ir_arena, svg_frames, &ir_op_frames);